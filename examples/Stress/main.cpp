@@ -218,7 +218,13 @@ public:
       double delta = (endFrame.tv_sec-mBeginFrame.tv_sec) * 1000000 + (endFrame.tv_usec-mBeginFrame.tv_usec);
       if(delta > 1000000)
       {
-        gp_log("FPS: %.2f - Throughput %.2fMB/s", mFrame/(delta/1000000.0), mThroughput/(delta/1000000.0));
+        UploadStats stats = mContext.GetUploadStats();
+        gp_log("FPS: %.2f - Throughput %.2fMB/s - Staging %.2fGB/s - Stalls %llu",
+               mFrame/(delta/1000000.0),
+               mThroughput/(delta/1000000.0),
+               (stats.seconds > 0.0) ? stats.bytes/stats.seconds/1000000000.0 : 0.0,
+               stats.stalls);
+        mContext.ResetUploadStats();
         mBeginFrame = endFrame;
         mFrame = 0;
         mThroughput = 0;
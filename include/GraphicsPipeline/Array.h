@@ -23,7 +23,9 @@
 #include "Common.h"
 #include "Types.h"
 #include "Context.h"
+#include "Mesh.h"
 #include "Object.h"
+#include "Shared.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,6 +49,16 @@ GP_EXPORT gp_array_data* gp_array_data_new();
  */
 GP_EXPORT gp_array_data* gp_array_data_new_with_size(unsigned int size);
 
+/*!
+ * Create a new gp_array_data object backed by shared memory.  Uploads copy
+ * a frame out of the shared memory first.  Frames torn by a producer writing
+ * during every copy attempt are skipped and the array keeps its previous
+ * contents.
+ * \param shared Shared memory written by a producer.
+ * \return Newly created array data object or NULL if shared is NULL.
+ */
+GP_EXPORT gp_array_data* gp_array_data_new_shared(gp_shared* shared);
+
 /*!
  * Allocate enough storage space to store a given number of bytes.
  * \param ad Array data object to be used.
@@ -72,6 +84,56 @@ GP_EXPORT void gp_array_data_set(gp_array_data* ad, void* data, unsigned int siz
  */
 GP_EXPORT void gp_array_data_set_chunk(gp_array_data* ad, void* data, unsigned int size, unsigned int offset);
 
+/*!
+ * Store doubles as pairs of floats.  Each element is stored as its high
+ * floats followed by its low floats, to be drawn with
+ * gp_operation_draw_add_split_array_by_index() and the
+ * #GP_SHADER_HIGH_PRECISION shader snippet.
+ * \param ad Array data object to be used.
+ * \param data Array of elements with components doubles each.
+ * \param components Number of components for each element, from 1 to 4.
+ * \param count Number of elements in data.
+ */
+GP_EXPORT void gp_array_data_set_double_split(gp_array_data* ad, const double* data, unsigned int components, unsigned int count);
+
+/*!
+ * Store doubles as floats relative to an origin.  The origin should be close
+ * to the data, such as the center of a tile, and be added back in the shader
+ * relative to the eye.
+ * \param ad Array data object to be used.
+ * \param data Array of elements with components doubles each.
+ * \param components Number of components for each element, from 1 to 4.
+ * \param count Number of elements in data.
+ * \param origin Origin with components doubles.
+ */
+GP_EXPORT void gp_array_data_set_double_relative(gp_array_data* ad,
+                                                 const double* data,
+                                                 unsigned int components,
+                                                 unsigned int count,
+                                                 const double* origin);
+
+/*!
+ * Store floats as half floats, to be drawn with #GP_DATA_TYPE_HALF.  Halves
+ * the memory and bandwidth of attributes that tolerate 11 bits of precision,
+ * such as normals and colors.
+ * \param ad Array data object to be used.
+ * \param data Array of floats to be converted.
+ * \param count Number of floats in data.
+ */
+GP_EXPORT void gp_array_data_set_half(gp_array_data* ad, const float* data, unsigned int count);
+
+/*!
+ * Convert the stored values to another data type as they are uploaded,
+ * straight into the mapped buffer for large uploads.  Useful for data that
+ * keeps its own type in memory, such as doubles written by a producer into
+ * shared memory.  Sizes and offsets of chunks count the stored values.
+ * \param ad Array data object to be used.
+ * \param type Data type of the stored values.
+ * \param storage Data type the values are uploaded as.  Set to type to
+ *                upload the values unchanged.
+ */
+GP_EXPORT void gp_array_data_set_conversion(gp_array_data* ad, GP_DATA_TYPE type, GP_DATA_TYPE storage);
+
 /*!
  * Retrieve the array of data stored in the array data object.
  * \param ad Array data object to be used.
@@ -87,11 +149,39 @@ GP_EXPORT void* gp_array_data_get_data(gp_array_data* ad);
 GP_EXPORT unsigned int gp_array_data_get_size(gp_array_data* ad);
 
 /*!
- * Create a new gp_array object tied to a context.
+ * Retrieve the shared memory sequence number of the last frame uploaded from
+ * the array data object.  A frame is fresh when this differs from
+ * gp_shared_get_sequence().
+ * \param ad Array data object to be used.
+ * \return Sequence number of the last uploaded frame.
+ */
+GP_EXPORT unsigned int gp_array_data_get_sequence(gp_array_data* ad);
+
+/*!
+ * Retrieve the shared memory backing the array data object.
+ * \param ad Array data object to be used.
+ * \return Shared memory object or NULL if the data is not shared.
+ */
+GP_EXPORT gp_shared* gp_array_data_get_shared(gp_array_data* ad);
+
+/*!
+ * Create a new gp_array object tied to a context.  The underlying GL buffer
+ * is generated the first time the array is used, so arrays may be created
+ * from any thread.
  * \param context Context object used to create array.
  * \return Newly created array.
  */
 GP_EXPORT gp_array* gp_array_new(gp_context* context);
+
+/*!
+ * Create a new gp_array object holding indices for
+ * gp_operation_draw_set_indices().  WebGL binds a buffer to one target for
+ * its lifetime, so index arrays can not hold vertex data and vertex arrays
+ * can not hold indices.
+ * \param context Context object used to create array.
+ * \return Newly created index array.
+ */
+GP_EXPORT gp_array* gp_array_new_index(gp_context* context);
   
 /*!
  * Upload data to an array object.
@@ -130,6 +220,9 @@ namespace GP
     //! Constructor
     inline ArrayData(unsigned int size);
     
+    //! Constructor
+    inline ArrayData(const Shared& shared);
+    
     /*!
      * Allocate enough storage space to store a given number of bytes.
      * \param size Number of bytes to be allocated.
@@ -152,6 +245,37 @@ namespace GP
      */
     inline void SetChunk(void* data, unsigned int size, unsigned int offset);
     
+    /*!
+     * Store doubles as pairs of high and low floats.
+     * \param data Array of elements with components doubles each.
+     * \param components Number of components for each element, from 1 to 4.
+     * \param count Number of elements in data.
+     */
+    inline void SetDoubleSplit(const double* data, unsigned int components, unsigned int count);
+    
+    /*!
+     * Store doubles as floats relative to an origin.
+     * \param data Array of elements with components doubles each.
+     * \param components Number of components for each element, from 1 to 4.
+     * \param count Number of elements in data.
+     * \param origin Origin with components doubles.
+     */
+    inline void SetDoubleRelative(const double* data, unsigned int components, unsigned int count, const double* origin);
+    
+    /*!
+     * Store floats as half floats.
+     * \param data Array of floats to be converted.
+     * \param count Number of floats in data.
+     */
+    inline void SetHalf(const float* data, unsigned int count);
+    
+    /*!
+     * Convert the stored values to another data type as they are uploaded.
+     * \param type Data type of the stored values.
+     * \param storage Data type the values are uploaded as.
+     */
+    inline void SetConversion(GP_DATA_TYPE type, GP_DATA_TYPE storage);
+    
     /*!
      * Retrieve the array of data stored in the array data object.
      * \return Pointer to array of data to be retrieved.
@@ -163,6 +287,21 @@ namespace GP
      * \return Size of the data stored in bytes.
      */
     inline unsigned int GetSize();
+    
+    /*!
+     * Retrieve the shared memory sequence number of the last uploaded frame.
+     * \return Sequence number of the last uploaded frame.
+     */
+    inline unsigned int GetSequence();
+    
+    /*!
+     * Optimize a mesh whose 32 bit triangle list indices are stored in this
+     * array data object.
+     * \param vertices Array data object holding the vertices.
+     * \param vertexSize Size of each vertex in bytes.
+     * \return ACMR before and after the optimization.
+     */
+    inline MeshStats OptimizeMesh(const ArrayData& vertices, unsigned int vertexSize);
   };
   
   /*!
@@ -179,6 +318,13 @@ namespace GP
     //! Constructor
     inline Array(const Context& context);
     
+    /*!
+     * Create an index array for DrawOperation::SetIndices().
+     * \param context %Context used to create the array.
+     * \return New index %Array.
+     */
+    inline static Array Index(const Context& context);
+    
     /*!
      * Uploads data to %Array object.
      * \param data %ArrayData to be uploaded.
@@ -193,6 +339,9 @@ namespace GP
     inline void SetDataAsync(const ArrayData& ad, std::function<void(Array*)> callback);
     
   private:
+    struct IndexTag {};
+    inline Array(const Context& context, IndexTag);
+    
     struct AsyncData
     {
       Array* mArray;
@@ -207,15 +356,36 @@ namespace GP
   ArrayData::ArrayData(gp_array_data* data) : Object((gp_object*)data) {}
   ArrayData::ArrayData() : Object((void*)gp_array_data_new()) {}
   ArrayData::ArrayData(unsigned int size) : Object((void*)gp_array_data_new_with_size(size)) {}
+  ArrayData::ArrayData(const Shared& shared) : Object((void*)gp_array_data_new_shared((gp_shared*)GetObject(shared))) {}
   void ArrayData::Allocate(unsigned int size) {gp_array_data_allocate((gp_array_data*)GetObject(*this), size);}
   void ArrayData::Set(void* data, unsigned int size) {gp_array_data_set((gp_array_data*)GetObject(*this), data, size);}
   void ArrayData::SetChunk(void* data, unsigned int size, unsigned int offset) {gp_array_data_set_chunk((gp_array_data*)GetObject(*this), data, size, offset);}
+  void ArrayData::SetDoubleSplit(const double* data, unsigned int components, unsigned int count)
+  {
+    gp_array_data_set_double_split((gp_array_data*)GetObject(*this), data, components, count);
+  }
+  void ArrayData::SetDoubleRelative(const double* data, unsigned int components, unsigned int count, const double* origin)
+  {
+    gp_array_data_set_double_relative((gp_array_data*)GetObject(*this), data, components, count, origin);
+  }
+  void ArrayData::SetHalf(const float* data, unsigned int count) {gp_array_data_set_half((gp_array_data*)GetObject(*this), data, count);}
+  void ArrayData::SetConversion(GP_DATA_TYPE type, GP_DATA_TYPE storage)
+  {
+    gp_array_data_set_conversion((gp_array_data*)GetObject(*this), type, storage);
+  }
   void* ArrayData::GetData() {return gp_array_data_get_data((gp_array_data*)GetObject(*this));}
   unsigned int ArrayData::GetSize() {return gp_array_data_get_size((gp_array_data*)GetObject(*this));}
+  unsigned int ArrayData::GetSequence() {return gp_array_data_get_sequence((gp_array_data*)GetObject(*this));}
+  MeshStats ArrayData::OptimizeMesh(const ArrayData& vertices, unsigned int vertexSize)
+  {
+    return gp_mesh_optimize((gp_array_data*)GetObject(*this), (gp_array_data*)GetObject(vertices), vertexSize);
+  }
   
   Array::Array() : Object((void*)0) {}
   Array::Array(gp_array* array) : Object((gp_object*)array) {}
   Array::Array(const Context& context) : Object((void*)gp_array_new((gp_context*)GetObject(context))) {}
+  Array::Array(const Context& context, IndexTag) : Object((void*)gp_array_new_index((gp_context*)GetObject(context))) {}
+  Array Array::Index(const Context& context) {return Array(context, IndexTag());}
   void Array::SetData(const ArrayData& ad) {gp_array_set_data((gp_array*)GetObject(*this), (gp_array_data*)GetObject(ad));}
   void Array::SetDataAsync(const ArrayData& ad, std::function<void(Array*)> callback)
   {
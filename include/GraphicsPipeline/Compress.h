@@ -0,0 +1,85 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file Compress.h
+
+#ifndef __GP_COMPRESS_H__
+#define __GP_COMPRESS_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Compress
+ * Block compression of pixels for textures that take a quarter to an
+ * eighth of the memory and upload bandwidth of 8-bit RGBA.  The encoder
+ * fits every 4x4 block to the bounding box of its colors, with the bounds
+ * found with SSE2 or NEON, and splits rows of blocks over the thread pool.
+ * It favours speed over quality, so offline encoders are still preferable
+ * for assets shipped compressed.
+ *
+ * BC1, BC3, BC4 and BC5 can be encoded.  ETC2 can only be uploaded
+ * pre-compressed.  Desktop GPUs support BC formats, while mobile GPUs
+ * usually only support ETC2.
+ * \{
+ */
+
+/*!
+ * Retrieve the size of compressed pixels.
+ * \param compression Block compressed format.
+ * \param width Width in pixels.
+ * \param height Height in pixels.
+ * \return Number of bytes in the blocks covering width by height pixels.
+ */
+GP_EXPORT size_t gp_compress_get_size(GP_COMPRESSION compression, unsigned int width, unsigned int height);
+
+/*!
+ * Compress pixels into blocks.  Pixels are converted to 8-bit first, so
+ * any format and type is accepted.  BC4 keeps the red component, and BC5
+ * the red and green components.
+ * \param src Pixels to be compressed, in rows of width pixels.
+ * \param format Number of components in each pixel.
+ * \param type Data type of the components.
+ * \param width Width in pixels.
+ * \param height Height in pixels.
+ * \param compression Block compressed format to encode.
+ * \param dst Receives gp_compress_get_size() bytes of blocks, in rows of
+ *            blocks from the top left.
+ * \return 1 on success, 0 if the format can not be encoded.
+ */
+GP_EXPORT int gp_compress(const void* src,
+                          GP_FORMAT format,
+                          GP_DATA_TYPE type,
+                          unsigned int width,
+                          unsigned int height,
+                          GP_COMPRESSION compression,
+                          void* dst);
+
+//! \} // Compress
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_COMPRESS_H__
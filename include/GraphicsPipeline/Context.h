@@ -41,6 +41,23 @@ extern "C" {
  */
 GP_EXPORT gp_context* gp_context_new(gp_system* system);
 
+/*!
+ * Retrieve statistics for data staged by uploads.  Large array and texture
+ * uploads copy their data into mapped GL buffers using several threads.
+ * Uploads run on a worker shared by every context, so the statistics are
+ * process-wide and the same for all contexts.
+ * \param context Context object to be used.
+ * \return Statistics gathered since the last reset.
+ */
+GP_EXPORT gp_upload_stats gp_context_get_upload_stats(gp_context* context);
+
+/*!
+ * Reset the statistics for data staged by uploads.  This resets the
+ * process-wide statistics seen by every context.
+ * \param context Context object to be used.
+ */
+GP_EXPORT void gp_context_reset_upload_stats(gp_context* context);
+
 //! \} // Context
 
 #ifdef __cplusplus
@@ -59,6 +76,15 @@ namespace GP
     
     //! Constructor
     inline Context(const System& system);
+    
+    /*!
+     * Retrieve the process-wide statistics for data staged by uploads.
+     * \return Statistics gathered since the last reset.
+     */
+    inline UploadStats GetUploadStats();
+    
+    //! Reset the statistics for data staged by uploads.
+    inline void ResetUploadStats();
   };
   
   /*
@@ -66,6 +92,8 @@ namespace GP
    */
   Context::Context(gp_context* context) : Object((gp_object*)context) {}
   Context::Context(const System& system) : Object((void*)gp_context_new((gp_system*)system.GetObject())) {}
+  UploadStats Context::GetUploadStats() {return gp_context_get_upload_stats((gp_context*)GetObject(*this));}
+  void Context::ResetUploadStats() {gp_context_reset_upload_stats((gp_context*)GetObject(*this));}
 }
 #endif
 
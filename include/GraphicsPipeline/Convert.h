@@ -0,0 +1,87 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Convert.h
+
+#ifndef __GP_CONVERT_H__
+#define __GP_CONVERT_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Convert
+ * Conversion of pixel and vertex data between data types, formats and
+ * component orders.  Texture and array uploads use it to write data the
+ * GPU accepts straight into mapped buffers, instead of leaving the driver
+ * to convert it on the CPU.
+ *
+ * #GP_DATA_TYPE_UBYTE, #GP_DATA_TYPE_USHORT and #GP_DATA_TYPE_SHORT values
+ * are normalized, so a UBYTE of 255 converts to a float of 1.0.
+ * #GP_DATA_TYPE_INT values are not normalized.  Conversions between INT and
+ * the other integer types keep values, clamped to the range of the
+ * converted type, so a UBYTE of 200 converts to an INT of 200.  Common
+ * conversions such as
+ * double to float, float to half, float to UBYTE, RGB to RGBA and swizzles
+ * of UBYTE pixels use SSE2, SSSE3, AVX2 or NEON, picked at run time.
+ * \{
+ */
+
+#define GP_SWIZZLE_ZERO       4   //!< Swizzle component always set to 0.
+#define GP_SWIZZLE_ONE        5   //!< Swizzle component always set to 1.
+
+/*!
+ * Convert elements between data types and formats.
+ * \param src Elements to be converted.
+ * \param src_format Number of components in each source element.
+ * \param src_type Data type of the source components.
+ * \param dst Receives the converted elements.  Must not overlap src.
+ * \param dst_format Number of components in each converted element.
+ * \param dst_type Data type of the converted components.
+ * \param swizzle Source component index for each converted component, or
+ *                #GP_SWIZZLE_ZERO or #GP_SWIZZLE_ONE.  Set to NULL to keep
+ *                the component order, filling missing colors with 0 and
+ *                missing alpha with 1.
+ * \param count Number of elements.
+ */
+GP_EXPORT void gp_convert(const void* src,
+                          GP_FORMAT src_format,
+                          GP_DATA_TYPE src_type,
+                          void* dst,
+                          GP_FORMAT dst_format,
+                          GP_DATA_TYPE dst_type,
+                          const int* swizzle,
+                          unsigned int count);
+
+/*!
+ * Retrieve the size of a single component of a data type.
+ * \param type Data type to be used.
+ * \return Number of bytes in a single component.
+ */
+GP_EXPORT unsigned int gp_data_type_get_size(GP_DATA_TYPE type);
+
+//! \} // Convert
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_CONVERT_H__
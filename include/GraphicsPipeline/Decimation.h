@@ -0,0 +1,193 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file Decimation.h
+
+#ifndef __GP_DECIMATION_H__
+#define __GP_DECIMATION_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Array.h"
+#include "Object.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Decimation
+ * Min/max pyramid of a time series for drawing huge line strips.  Level l
+ * of the pyramid stores the minimum, maximum, first and last sample of
+ * every 2^l samples.  Drawing the minimum and maximum of each bucket keeps
+ * the exact visual envelope of the series with about two vertices per pixel
+ * column, whatever the number of samples in view.
+ * \{
+ */
+
+/*!
+ * Create a new empty decimation pyramid.
+ * \return Newly created decimation pyramid.
+ */
+GP_EXPORT gp_decimation* gp_decimation_new();
+
+/*!
+ * Replace the samples of the time series and rebuild the pyramid.
+ * \param decimation Decimation pyramid to be used.
+ * \param samples Array of samples.
+ * \param count Number of samples.
+ */
+GP_EXPORT void gp_decimation_set(gp_decimation* decimation, const float* samples, unsigned int count);
+
+/*!
+ * Append samples to the time series.  Only the buckets covering the new
+ * samples are updated.
+ * \param decimation Decimation pyramid to be used.
+ * \param samples Array of samples to be appended.
+ * \param count Number of samples to be appended.
+ */
+GP_EXPORT void gp_decimation_append(gp_decimation* decimation, const float* samples, unsigned int count);
+
+/*!
+ * Retrieve the number of samples in the time series.
+ * \param decimation Decimation pyramid to be used.
+ * \return Number of samples.
+ */
+GP_EXPORT unsigned int gp_decimation_get_count(gp_decimation* decimation);
+
+/*!
+ * Retrieve the number of levels in the pyramid including the samples.
+ * \param decimation Decimation pyramid to be used.
+ * \return Number of levels.
+ */
+GP_EXPORT unsigned int gp_decimation_get_levels(gp_decimation* decimation);
+
+/*!
+ * Pick the coarsest level that still has a bucket for every pixel column.
+ * \param decimation Decimation pyramid to be used.
+ * \param count Number of samples in view.
+ * \param width Width of the view in pixels.
+ * \return Level to be passed to gp_decimation_get_data().
+ */
+GP_EXPORT unsigned int gp_decimation_get_level(gp_decimation* decimation, unsigned int count, unsigned int width);
+
+/*!
+ * Store a range of the time series as line strip vertices.  Every vertex is
+ * two floats, the sample position relative to first and the value.  Level 0
+ * stores the samples themselves, other levels store the minimum and maximum
+ * of every bucket in the order closest to the series.
+ * \param decimation Decimation pyramid to be used.
+ * \param ad Array data object receiving the vertices.
+ * \param level Level of the pyramid to be drawn.
+ * \param first First sample in view.
+ * \param count Number of samples in view.
+ * \return Number of vertices stored to be passed to
+ *         gp_operation_draw_set_verticies().
+ */
+GP_EXPORT unsigned int gp_decimation_get_data(gp_decimation* decimation,
+                                              gp_array_data* ad,
+                                              unsigned int level,
+                                              unsigned int first,
+                                              unsigned int count);
+
+//! \} // Decimation
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_decimation
+   */
+  class Decimation : public Object
+  {
+  public:
+    //! Constructor
+    inline Decimation(gp_decimation* decimation);
+    
+    //! Constructor
+    inline Decimation();
+    
+    /*!
+     * Replace the samples of the time series and rebuild the pyramid.
+     * \param samples Array of samples.
+     * \param count Number of samples.
+     */
+    inline void Set(const float* samples, unsigned int count);
+    
+    /*!
+     * Append samples to the time series.
+     * \param samples Array of samples to be appended.
+     * \param count Number of samples to be appended.
+     */
+    inline void Append(const float* samples, unsigned int count);
+    
+    /*!
+     * Retrieve the number of samples in the time series.
+     * \return Number of samples.
+     */
+    inline unsigned int GetCount();
+    
+    /*!
+     * Retrieve the number of levels in the pyramid including the samples.
+     * \return Number of levels.
+     */
+    inline unsigned int GetLevels();
+    
+    /*!
+     * Pick the coarsest level that still has a bucket for every pixel column.
+     * \param count Number of samples in view.
+     * \param width Width of the view in pixels.
+     * \return Level to be passed to GetData().
+     */
+    inline unsigned int GetLevel(unsigned int count, unsigned int width);
+    
+    /*!
+     * Store a range of the time series as line strip vertices.
+     * \param ad Array data object receiving the vertices.
+     * \param level Level of the pyramid to be drawn.
+     * \param first First sample in view.
+     * \param count Number of samples in view.
+     * \return Number of vertices stored.
+     */
+    inline unsigned int GetData(const ArrayData& ad, unsigned int level, unsigned int first, unsigned int count);
+  };
+  
+  //
+  // Implementation
+  //
+  Decimation::Decimation(gp_decimation* decimation) : Object((gp_object*)decimation) {}
+  Decimation::Decimation() : Object((void*)gp_decimation_new()) {}
+  void Decimation::Set(const float* samples, unsigned int count) {gp_decimation_set((gp_decimation*)GetObject(*this), samples, count);}
+  void Decimation::Append(const float* samples, unsigned int count) {gp_decimation_append((gp_decimation*)GetObject(*this), samples, count);}
+  unsigned int Decimation::GetCount() {return gp_decimation_get_count((gp_decimation*)GetObject(*this));}
+  unsigned int Decimation::GetLevels() {return gp_decimation_get_levels((gp_decimation*)GetObject(*this));}
+  unsigned int Decimation::GetLevel(unsigned int count, unsigned int width)
+  {
+    return gp_decimation_get_level((gp_decimation*)GetObject(*this), count, width);
+  }
+  unsigned int Decimation::GetData(const ArrayData& ad, unsigned int level, unsigned int first, unsigned int count)
+  {
+    return gp_decimation_get_data((gp_decimation*)GetObject(*this), (gp_array_data*)GetObject(ad), level, first, count);
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_DECIMATION_H__
@@ -21,17 +21,34 @@
 #define __GRAPHICS_PIPELINE_H__
 
 #include "Array.h"
+#include "Compress.h"
 #include "Context.h"
+#include "Convert.h"
+#include "Decimation.h"
 #include "FrameBuffer.h"
+#include "Half.h"
+#include "Image.h"
 #include "Input.h"
 #include "System.h"
 #include "Monitor.h"
 #include "Object.h"
 #include "Pipeline.h"
+#include "PointCloud.h"
+#include "Precision.h"
+#include "Sampler.h"
+#include "ScrollTexture.h"
 #include "Shader.h"
+#include "Shared.h"
 #include "Logging.h"
+#include "Mesh.h"
+#include "Mipmap.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureCanvas.h"
 #include "Types.h"
+#include "VertexLayout.h"
+#include "VideoTexture.h"
+#include "VirtualTexture.h"
 #include "Window.h"
 
 #endif // __GRAPHICS_PIPELINE_H__
@@ -0,0 +1,63 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Half.h
+
+#ifndef __GP_HALF_H__
+#define __GP_HALF_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Half
+ * Conversion between floats and IEEE 754 half floats, the layout of
+ * #GP_DATA_TYPE_HALF.  Uses F16C on x86 processors that support it and
+ * NEON on ARM64.
+ * \{
+ */
+
+/*!
+ * Convert floats to half floats, rounding to the nearest half float.
+ * Values out of range become infinity.
+ * \param data Array of floats to be converted.
+ * \param result Array receiving the half floats.
+ * \param count Number of floats in data.
+ */
+GP_EXPORT void gp_half_from_float(const float* data, uint16_t* result, unsigned int count);
+
+/*!
+ * Convert half floats to floats.  Every half float is exactly representable.
+ * \param data Array of half floats to be converted.
+ * \param result Array receiving the floats.
+ * \param count Number of half floats in data.
+ */
+GP_EXPORT void gp_half_to_float(const uint16_t* data, float* result, unsigned int count);
+
+//! \} // Half
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_HALF_H__
@@ -0,0 +1,71 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Image.h
+
+#ifndef __GP_IMAGE_H__
+#define __GP_IMAGE_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Image
+ * Decoding of image files in memory into RGBA pixels.  QOI is always
+ * supported, PNG and JPEG when libpng and libjpeg are found at build time.
+ * The decoders keep no state, so images may be decoded on any number of
+ * threads at once.  gp_texture_load_async() reads, decodes and uploads
+ * image files in the background.
+ * \{
+ */
+
+/*!
+ * Read the size of an image without decoding it.
+ * \param data Contents of an image file.
+ * \param size Number of bytes in data.
+ * \param width Receives the width of the image in pixels.
+ * \param height Receives the height of the image in pixels.
+ * \return 1 if the image can be decoded, 0 if its format is unknown or not
+ *         supported.
+ */
+GP_EXPORT int gp_image_get_info(const void* data, size_t size, unsigned int* width, unsigned int* height);
+
+/*!
+ * Decode an image into unsigned byte RGBA pixels.  Images without alpha
+ * are opaque and grayscale images are expanded to RGB.
+ * \param data Contents of an image file.
+ * \param size Number of bytes in data.
+ * \param pixels Receives the rows of the image, top row first.
+ * \param pitch Number of bytes between rows of pixels, at least four times
+ *              the width.
+ * \return 1 on success, 0 if the image is corrupt or not supported.
+ */
+GP_EXPORT int gp_image_decode(const void* data, size_t size, void* pixels, size_t pitch);
+
+//! \} // Image
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_IMAGE_H__
@@ -0,0 +1,100 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Mesh.h
+
+#ifndef __GP_MESH_H__
+#define __GP_MESH_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Mesh
+ * Reordering of indexed triangle meshes for faster drawing.  Triangles are
+ * reordered for post-transform vertex cache reuse with the Tipsify
+ * algorithm, then vertices are reordered in the order they are first used.
+ * Large meshes are split into clusters of triangles that are optimized on
+ * several threads.
+ * \{
+ */
+
+/*!
+ * Vertex cache size the optimization targets and ACMR is measured with.
+ */
+#define GP_MESH_CACHE_SIZE 16
+
+/*!
+ * Compute the average cache miss ratio (ACMR) of a triangle list, which is
+ * the number of vertices transformed per triangle with a FIFO cache of
+ * #GP_MESH_CACHE_SIZE vertices.  Lower is better with 0.5 being ideal.
+ * \param indices Array of triangle list indices.
+ * \param count Number of indices.
+ * \param vertices Number of vertices referenced by indices.
+ * \return The average cache miss ratio.
+ */
+GP_EXPORT double gp_mesh_get_acmr(const uint32_t* indices, unsigned int count, unsigned int vertices);
+
+/*!
+ * Reorder the triangles of a triangle list for vertex cache reuse.
+ * \param indices Array of triangle list indices, reordered in place.
+ * \param count Number of indices.
+ * \param vertices Number of vertices referenced by indices.
+ */
+GP_EXPORT void gp_mesh_optimize_vertex_cache(uint32_t* indices, unsigned int count, unsigned int vertices);
+
+/*!
+ * Reorder vertices in the order they are first used by a triangle list.
+ * Vertices that are never used are dropped.
+ * \param indices Array of triangle list indices, updated in place.
+ * \param count Number of indices.
+ * \param vertices Array of vertex data, reordered in place.
+ * \param vertex_count Number of vertices in the vertex array.
+ * \param vertex_size Size of each vertex in bytes.
+ * \return Number of vertices left in the vertex array.
+ */
+GP_EXPORT unsigned int gp_mesh_optimize_vertex_fetch(uint32_t* indices,
+                                                     unsigned int count,
+                                                     void* vertices,
+                                                     unsigned int vertex_count,
+                                                     unsigned int vertex_size);
+
+/*!
+ * Optimize a mesh stored in array data objects ready to be uploaded.  The
+ * mesh is drawn with gp_operation_draw_set_indices().  Unused vertices are
+ * dropped from the vertex data.  Array data backed by shared memory is only
+ * written by its producer and is rejected.
+ * \param indices Array data object holding 32 bit triangle list indices.
+ * \param vertices Array data object holding the vertices.
+ * \param vertex_size Size of each vertex in bytes.
+ * \return ACMR before and after the optimization.
+ */
+GP_EXPORT gp_mesh_stats gp_mesh_optimize(gp_array_data* indices, gp_array_data* vertices, unsigned int vertex_size);
+
+//! \} // Mesh
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_MESH_H__
@@ -0,0 +1,73 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Mipmap.h
+
+#ifndef __GP_MIPMAP_H__
+#define __GP_MIPMAP_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Mipmap
+ * CPU mipmap builder.  glGenerateMipmap() is usually a plain box filter,
+ * which blurs and still aliases fine detail such as text and plot lines.
+ * gp_mipmap_downsample() builds each level with a box or Kaiser windowed
+ * sinc filter across all cores and the levels are uploaded with
+ * gp_texture_set_level().
+ * \{
+ */
+
+/*!
+ * Retrieve the number of levels in a full mipmap chain.
+ * \param width Width of the base level.
+ * \param height Height of the base level.
+ * \return Number of levels down to and including 1x1.
+ */
+GP_EXPORT unsigned int gp_mipmap_get_levels(unsigned int width, unsigned int height);
+
+/*!
+ * Build the next mipmap level.  Rows are tightly packed and the result is
+ * half the size in each dimension, rounded down but at least 1.
+ * \param src Data of the level to be downsampled.
+ * \param dst Data receiving the next level.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Width of src.
+ * \param height Height of src.
+ * \param filter Filter used to downsample.
+ */
+GP_EXPORT void gp_mipmap_downsample(const void* src,
+                                    void* dst,
+                                    GP_FORMAT format,
+                                    GP_DATA_TYPE type,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    GP_MIPMAP filter);
+
+//! \} // Mipmap
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_MIPMAP_H__
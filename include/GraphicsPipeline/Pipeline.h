@@ -105,6 +105,30 @@ GP_EXPORT void gp_operation_draw_add_array_by_index(gp_operation* operation,
                                                     int stride,
                                                     int offset);
 
+/*!
+ * Add an array object holding doubles split with
+ * gp_array_data_set_double_split().  The high floats are attached at index
+ * and the low floats at index+1.
+ * \param operation Draw operation to add the array object to.
+ * \param array New array object to be added.
+ * \param index Layout index used to attach the high floats.
+ * \param components Number of components for each element.
+ */
+GP_EXPORT void gp_operation_draw_add_split_array_by_index(gp_operation* operation,
+                                                          gp_array* array,
+                                                          int index,
+                                                          int components);
+
+/*!
+ * Draw with an index array holding 32 bit unsigned indices.  The vertex
+ * count set with gp_operation_draw_set_verticies() is then the number of
+ * indices drawn.  OpenGL ES 2 needs the OES_element_index_uint extension.
+ * \param operation Draw operation to set the index array for.
+ * \param indices Array object created with gp_array_new_index() holding the
+ *                indices or NULL to draw without.
+ */
+GP_EXPORT void gp_operation_draw_set_indices(gp_operation* operation, gp_array* indices);
+
 /*!
  * Set the number of verticies in the draw operation.
  * \param operation Draw operation for which to set the vertex count.
@@ -276,6 +300,21 @@ namespace GP
      */
     inline void AddArrayByIndex(const Array& array, int index, int components, GP_DATA_TYPE type = GP_DATA_TYPE_FLOAT, int stride = 0, int offset = 0);
     
+    /*!
+     * Add an array holding doubles split into high and low floats.
+     * \param array New array object to be added.
+     * \param index Layout index used to attach the high floats.  The low
+     *              floats are attached at index+1.
+     * \param components Number of components for each element.
+     */
+    inline void AddSplitArrayByIndex(const Array& array, int index, int components);
+    
+    /*!
+     * Draw with an index array holding 32 bit unsigned indices.
+     * \param indices Array object holding the indices.
+     */
+    inline void SetIndices(const Array& indices);
+    
     /*!
      * Set the number of verticies in the draw operation.
      * \param count The number of verticies in the draw operation.
@@ -400,6 +439,11 @@ namespace GP
   {
     gp_operation_draw_add_array_by_index((gp_operation*)GetObject(*this), (gp_array*)GetObject(array), index, components, type, stride, offset);
   }
+  void DrawOperation::AddSplitArrayByIndex(const Array& array, int index, int components)
+  {
+    gp_operation_draw_add_split_array_by_index((gp_operation*)GetObject(*this), (gp_array*)GetObject(array), index, components);
+  }
+  void DrawOperation::SetIndices(const Array& indices) {gp_operation_draw_set_indices((gp_operation*)GetObject(*this), (gp_array*)GetObject(indices));}
   void DrawOperation::SetVerticies(int count) {gp_operation_draw_set_verticies((gp_operation*)GetObject(*this), count);}
   void DrawOperation::SetMode(GP_DRAW_MODE mode) {gp_operation_draw_set_mode((gp_operation*)GetObject(*this), mode);}
   
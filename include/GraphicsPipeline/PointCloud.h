@@ -0,0 +1,275 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file PointCloud.h
+
+#ifndef __GP_POINT_CLOUD_H__
+#define __GP_POINT_CLOUD_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Pipeline.h"
+#include "Shader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup PointCloud
+ * Point clouds too large to fit on the GPU.  gp_point_cloud_build() writes
+ * points to an octree file where every node holds an evenly spread subset
+ * of the points below it.  At run time gp_point_cloud_update() picks the
+ * nodes that matter most on screen within a point budget, reads missing
+ * nodes from the file on the worker thread, uploads them asynchronously and
+ * keeps loaded nodes in a least recently used cache.
+ *
+ * Nodes are drawn as points with the position at layout index 0, using the
+ * shader and uniforms given to the point cloud.
+ * \{
+ */
+
+/*!
+ * Default maximum number of points in a node.
+ */
+#define GP_POINT_CLOUD_NODE_SIZE 16384
+
+/*!
+ * Build an octree file from an array of points.  Points may be memory
+ * mapped from a file as they are only read.
+ * \param path Path of the octree file to be written.
+ * \param points Array of x, y, z floats for each point.
+ * \param count Number of points.
+ * \param node_size Maximum number of points in a node, usually
+ *                  #GP_POINT_CLOUD_NODE_SIZE.
+ * \return 1 on success, 0 on failure.
+ */
+GP_EXPORT int gp_point_cloud_build(const char* path, const float* points, unsigned int count, unsigned int node_size);
+
+/*!
+ * Open an octree file written by gp_point_cloud_build().
+ * \param context Context the point cloud is drawn in.
+ * \param path Path of the octree file.
+ * \return Newly created point cloud or NULL on failure.
+ */
+GP_EXPORT gp_point_cloud* gp_point_cloud_new(gp_context* context, const char* path);
+
+/*!
+ * Retrieve the number of points in the point cloud.
+ * \param cloud Point cloud to be used.
+ * \return Number of points.
+ */
+GP_EXPORT unsigned int gp_point_cloud_get_count(gp_point_cloud* cloud);
+
+/*!
+ * Retrieve the number of nodes in the octree.
+ * \param cloud Point cloud to be used.
+ * \return Number of nodes.
+ */
+GP_EXPORT unsigned int gp_point_cloud_get_node_count(gp_point_cloud* cloud);
+
+/*!
+ * Retrieve the bounds of the octree.
+ * \param cloud Point cloud to be used.
+ * \param bounds Array receiving the minimum x, y, z and maximum x, y, z.
+ */
+GP_EXPORT void gp_point_cloud_get_bounds(gp_point_cloud* cloud, float* bounds);
+
+/*!
+ * Set the shader used to draw the points.
+ * \param cloud Point cloud to be used.
+ * \param shader Shader object to be used.
+ */
+GP_EXPORT void gp_point_cloud_set_shader(gp_point_cloud* cloud, gp_shader* shader);
+
+/*!
+ * Add a uniform used to draw the points.
+ * \param cloud Point cloud to be used.
+ * \param uniform Uniform object to be added.
+ */
+GP_EXPORT void gp_point_cloud_add_uniform(gp_point_cloud* cloud, gp_uniform* uniform);
+
+/*!
+ * Set the maximum number of points drawn.  Defaults to 5 million.
+ * \param cloud Point cloud to be used.
+ * \param points Maximum number of points drawn.
+ */
+GP_EXPORT void gp_point_cloud_set_point_budget(gp_point_cloud* cloud, unsigned int points);
+
+/*!
+ * Set the number of points kept loaded on the GPU, which must be at least
+ * the point budget.  Defaults to 10 million.
+ * \param cloud Point cloud to be used.
+ * \param points Number of points kept loaded.
+ */
+GP_EXPORT void gp_point_cloud_set_cache_size(gp_point_cloud* cloud, unsigned int points);
+
+/*!
+ * Set the largest gap between points on screen before a node is refined.
+ * Defaults to 2 pixels.
+ * \param cloud Point cloud to be used.
+ * \param pixels Screen space error in pixels.
+ */
+GP_EXPORT void gp_point_cloud_set_error(gp_point_cloud* cloud, float pixels);
+
+/*!
+ * Retrieve the operation drawing the visible nodes, to be added to a
+ * pipeline.
+ * \param cloud Point cloud to be used.
+ * \return Group operation drawing the visible nodes.
+ */
+GP_EXPORT gp_operation* gp_point_cloud_get_operation(gp_point_cloud* cloud);
+
+/*!
+ * Select the nodes to be drawn for a view and request missing nodes.
+ * Should be called every frame the view changes and once loads finish.
+ * \param cloud Point cloud to be used.
+ * \param view_projection Column major view projection matrix.
+ * \param eye Position of the eye in point cloud coordinates.
+ * \param scale Pixels covered by one unit at distance one, which is
+ *              height/(2*tan(fovy/2)) for a perspective projection.
+ * \return Number of points drawn.
+ */
+GP_EXPORT unsigned int gp_point_cloud_update(gp_point_cloud* cloud,
+                                             const float* view_projection,
+                                             const float* eye,
+                                             float scale);
+
+//! \} // PointCloud
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_point_cloud
+   */
+  class PointCloud : public Object
+  {
+  public:
+    //! Constructor
+    inline PointCloud(gp_point_cloud* cloud);
+    
+    //! Constructor
+    inline PointCloud(const Context& context, const char* path);
+    
+    /*!
+     * Build an octree file from an array of points.
+     * \param path Path of the octree file to be written.
+     * \param points Array of x, y, z floats for each point.
+     * \param count Number of points.
+     * \param nodeSize Maximum number of points in a node.
+     * \return True on success.
+     */
+    inline static bool Build(const char* path, const float* points, unsigned int count, unsigned int nodeSize = GP_POINT_CLOUD_NODE_SIZE);
+    
+    /*!
+     * Retrieve the number of points in the point cloud.
+     * \return Number of points.
+     */
+    inline unsigned int GetCount();
+    
+    /*!
+     * Retrieve the number of nodes in the octree.
+     * \return Number of nodes.
+     */
+    inline unsigned int GetNodeCount();
+    
+    /*!
+     * Retrieve the bounds of the octree.
+     * \param bounds Array receiving the minimum x, y, z and maximum x, y, z.
+     */
+    inline void GetBounds(float* bounds);
+    
+    /*!
+     * Set the shader used to draw the points.
+     * \param shader Shader object to be used.
+     */
+    inline void SetShader(const Shader& shader);
+    
+    /*!
+     * Add a uniform used to draw the points.
+     * \param uniform Uniform object to be added.
+     */
+    inline void AddUniform(const Uniform& uniform);
+    
+    /*!
+     * Set the maximum number of points drawn.
+     * \param points Maximum number of points drawn.
+     */
+    inline void SetPointBudget(unsigned int points);
+    
+    /*!
+     * Set the number of points kept loaded on the GPU.
+     * \param points Number of points kept loaded.
+     */
+    inline void SetCacheSize(unsigned int points);
+    
+    /*!
+     * Set the largest gap between points on screen before a node is refined.
+     * \param pixels Screen space error in pixels.
+     */
+    inline void SetError(float pixels);
+    
+    /*!
+     * Retrieve the operation drawing the visible nodes.
+     * \return Group operation drawing the visible nodes.
+     */
+    inline Operation GetOperation();
+    
+    /*!
+     * Select the nodes to be drawn for a view and request missing nodes.
+     * \param viewProjection Column major view projection matrix.
+     * \param eye Position of the eye in point cloud coordinates.
+     * \param scale Pixels covered by one unit at distance one.
+     * \return Number of points drawn.
+     */
+    inline unsigned int Update(const float* viewProjection, const float* eye, float scale);
+  };
+  
+  //
+  // Implementation
+  //
+  PointCloud::PointCloud(gp_point_cloud* cloud) : Object((gp_object*)cloud) {}
+  PointCloud::PointCloud(const Context& context, const char* path)
+    : Object((void*)gp_point_cloud_new((gp_context*)GetObject(context), path)) {}
+  bool PointCloud::Build(const char* path, const float* points, unsigned int count, unsigned int nodeSize)
+  {
+    return gp_point_cloud_build(path, points, count, nodeSize) != 0;
+  }
+  unsigned int PointCloud::GetCount() {return gp_point_cloud_get_count((gp_point_cloud*)GetObject(*this));}
+  unsigned int PointCloud::GetNodeCount() {return gp_point_cloud_get_node_count((gp_point_cloud*)GetObject(*this));}
+  void PointCloud::GetBounds(float* bounds) {gp_point_cloud_get_bounds((gp_point_cloud*)GetObject(*this), bounds);}
+  void PointCloud::SetShader(const Shader& shader) {gp_point_cloud_set_shader((gp_point_cloud*)GetObject(*this), (gp_shader*)GetObject(shader));}
+  void PointCloud::AddUniform(const Uniform& uniform) {gp_point_cloud_add_uniform((gp_point_cloud*)GetObject(*this), (gp_uniform*)GetObject(uniform));}
+  void PointCloud::SetPointBudget(unsigned int points) {gp_point_cloud_set_point_budget((gp_point_cloud*)GetObject(*this), points);}
+  void PointCloud::SetCacheSize(unsigned int points) {gp_point_cloud_set_cache_size((gp_point_cloud*)GetObject(*this), points);}
+  void PointCloud::SetError(float pixels) {gp_point_cloud_set_error((gp_point_cloud*)GetObject(*this), pixels);}
+  Operation PointCloud::GetOperation() {return Operation(gp_point_cloud_get_operation((gp_point_cloud*)GetObject(*this)));}
+  unsigned int PointCloud::Update(const float* viewProjection, const float* eye, float scale)
+  {
+    return gp_point_cloud_update((gp_point_cloud*)GetObject(*this), viewProjection, eye, scale);
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_POINT_CLOUD_H__
@@ -0,0 +1,93 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Precision.h
+
+#ifndef __GP_PRECISION_H__
+#define __GP_PRECISION_H__
+
+#include "Common.h"
+#include "Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Precision
+ * Helpers for drawing double precision data with float attributes.
+ *
+ * Doubles may be split into a high and low float pair with
+ * gp_double_split().  The shader rebuilds positions relative to the eye with
+ * the #GP_SHADER_HIGH_PRECISION snippet, which keeps sub-millimeter
+ * precision at planetary scale.  The view matrix given to the shader must
+ * then leave out the eye translation.
+ *
+ * Alternatively doubles may be rebased around an origin close to the data
+ * with gp_double_rebase() and drawn with a translation of origin - eye
+ * computed in double precision on the CPU.
+ * \{
+ */
+
+/*!
+ * GLSL helper for positions split with gp_double_split().  Paste it after
+ * the version line of a vertex shader.  gp_high_precision() returns the
+ * position relative to the eye given the high and low parts of the position
+ * and the eye.
+ */
+#define GP_SHADER_HIGH_PRECISION \
+  "vec3 gp_high_precision(vec3 high, vec3 low, vec3 eyeHigh, vec3 eyeLow)\n" \
+  "{\n" \
+  "  vec3 t1 = low - eyeLow;\n" \
+  "  vec3 e = t1 - low;\n" \
+  "  vec3 t2 = ((-eyeLow - e) + (low - (t1 - e))) + high - eyeHigh;\n" \
+  "  vec3 highDifference = t1 + t2;\n" \
+  "  vec3 lowDifference = t2 - (highDifference - t1);\n" \
+  "  return highDifference + lowDifference;\n" \
+  "}\n"
+
+/*!
+ * Split doubles into high and low floats where high + low is the double to
+ * within float precision of the low part.
+ * \param data Array of doubles to be split.
+ * \param high Array receiving the nearest float to each double.
+ * \param low Array receiving the remainder of each double.
+ * \param count Number of doubles in data.
+ */
+GP_EXPORT void gp_double_split(const double* data, float* high, float* low, unsigned int count);
+
+/*!
+ * Convert doubles to floats relative to an origin.
+ * \param data Array of elements with components doubles each.
+ * \param result Array receiving components floats per element.
+ * \param components Number of components for each element, from 1 to 4.
+ * \param count Number of elements in data.
+ * \param origin Origin with components doubles subtracted from every element.
+ */
+GP_EXPORT void gp_double_rebase(const double* data,
+                                float* result,
+                                unsigned int components,
+                                unsigned int count,
+                                const double* origin);
+
+//! \} // Precision
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __GP_PRECISION_H__
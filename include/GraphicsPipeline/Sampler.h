@@ -0,0 +1,155 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file Sampler.h
+
+#ifndef __GP_SAMPLER_H__
+#define __GP_SAMPLER_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Sampler
+ * Sampling state kept apart from texture data.  A sampler bound together
+ * with a texture uniform with gp_uniform_texture_set_sampler() overrides the
+ * wrap and filter state of the texture, so one texture may be sampled
+ * several ways without changing its parameters between draws.
+ *
+ * Samplers with the same state share a single GL sampler object, so
+ * creating a sampler per material costs nothing.  Not supported by GLES2,
+ * where textures keep using their own state.
+ * \{
+ */
+
+/*!
+ * Create a new sampler.  Defaults match a new texture: clamped to the edge
+ * with linear filtering, no anisotropy and no comparison.
+ * \param context Context the sampler is used with.
+ * \return Newly created sampler.
+ */
+GP_EXPORT gp_sampler* gp_sampler_new(gp_context* context);
+
+/*!
+ * Set how texture coordinates wrap past the edge.
+ * \param sampler Sampler to be used.
+ * \param x Wrapping of the first texture coordinate.
+ * \param y Wrapping of the second texture coordinate.
+ * \param z Wrapping of the third texture coordinate.
+ */
+GP_EXPORT void gp_sampler_set_wrap(gp_sampler* sampler, GP_WRAP x, GP_WRAP y, GP_WRAP z);
+
+/*!
+ * Set the filters used when sampling.
+ * \param sampler Sampler to be used.
+ * \param min Filter used when the texture is minified.
+ * \param mag Filter used when the texture is magnified.
+ * \param mip Filter used between mipmap levels.  Ignored by textures
+ *            without mipmaps.
+ */
+GP_EXPORT void gp_sampler_set_filter(gp_sampler* sampler, GP_FILTER min, GP_FILTER mag, GP_FILTER mip);
+
+/*!
+ * Set the maximum degree of anisotropic filtering, which keeps textures
+ * seen at grazing angles sharp.  Clamped to the maximum supported by the
+ * GPU and ignored where anisotropic filtering is not available.
+ * \param sampler Sampler to be used.
+ * \param anisotropy Number of samples along the axis of anisotropy, 1 to
+ *                   disable anisotropic filtering.
+ */
+GP_EXPORT void gp_sampler_set_anisotropy(gp_sampler* sampler, float anisotropy);
+
+/*!
+ * Set the comparison of depth textures, for sampler2DShadow uniforms.
+ * \param sampler Sampler to be used.
+ * \param compare Comparison of the reference value to the texel, or
+ *                #GP_COMPARE_NONE to read depth values.
+ */
+GP_EXPORT void gp_sampler_set_compare(gp_sampler* sampler, GP_COMPARE compare);
+
+//! \} // Sampler
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_sampler
+   */
+  class Sampler : public Object
+  {
+  public:
+    //! Constructor
+    inline Sampler(gp_sampler* sampler);
+    
+    //! Constructor
+    inline Sampler(const Context& context);
+    
+    /*!
+     * Set how texture coordinates wrap past the edge.
+     * \param x Wrapping of the first texture coordinate.
+     * \param y Wrapping of the second texture coordinate.
+     * \param z Wrapping of the third texture coordinate.
+     */
+    inline void SetWrap(GP_WRAP x, GP_WRAP y, GP_WRAP z = GP_WRAP_EDGE);
+    
+    /*!
+     * Set the filters used when sampling.
+     * \param min Filter used when the texture is minified.
+     * \param mag Filter used when the texture is magnified.
+     * \param mip Filter used between mipmap levels.
+     */
+    inline void SetFilter(GP_FILTER min, GP_FILTER mag, GP_FILTER mip);
+    
+    /*!
+     * Set the maximum degree of anisotropic filtering.
+     * \param anisotropy Number of samples along the axis of anisotropy.
+     */
+    inline void SetAnisotropy(float anisotropy);
+    
+    /*!
+     * Set the comparison of depth textures.
+     * \param compare Comparison of the reference value to the texel.
+     */
+    inline void SetCompare(GP_COMPARE compare);
+  };
+  
+  //
+  // Implementation
+  //
+  Sampler::Sampler(gp_sampler* sampler) : Object((gp_object*)sampler) {}
+  Sampler::Sampler(const Context& context) : Object((void*)gp_sampler_new((gp_context*)GetObject(context))) {}
+  void Sampler::SetWrap(GP_WRAP x, GP_WRAP y, GP_WRAP z) {gp_sampler_set_wrap((gp_sampler*)GetObject(*this), x, y, z);}
+  void Sampler::SetFilter(GP_FILTER min, GP_FILTER mag, GP_FILTER mip)
+  {
+    gp_sampler_set_filter((gp_sampler*)GetObject(*this), min, mag, mip);
+  }
+  void Sampler::SetAnisotropy(float anisotropy) {gp_sampler_set_anisotropy((gp_sampler*)GetObject(*this), anisotropy);}
+  void Sampler::SetCompare(GP_COMPARE compare) {gp_sampler_set_compare((gp_sampler*)GetObject(*this), compare);}
+}
+
+#endif // __cplusplus
+
+#endif // __GP_SAMPLER_H__
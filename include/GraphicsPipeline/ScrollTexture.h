@@ -0,0 +1,186 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file ScrollTexture.h
+
+#ifndef __GP_SCROLL_TEXTURE_H__
+#define __GP_SCROLL_TEXTURE_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Texture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup ScrollTexture
+ * Texture used as a ring buffer of rows or columns, for waterfall and
+ * spectrogram displays that append a line per frame.  New lines overwrite
+ * the oldest ones in place, so every push uploads only the new lines
+ * instead of shifting and uploading the whole image.
+ *
+ * Shaders turn texture coordinates into ring buffer coordinates with the
+ * #GP_SHADER_SCROLL_TEXTURE snippet and the vector returned by
+ * gp_scroll_texture_get_info(), which changes with every push.  The oldest
+ * line is drawn at coordinate 0 and the newest at 1.
+ * \{
+ */
+
+/*!
+ * GLSL helper for scroll textures.  Paste it after the version line of a
+ * fragment shader.  gp_scroll_texture() returns the coordinate to sample the
+ * texture at given the vector returned by gp_scroll_texture_get_info() and
+ * a texture coordinate.  Works with every GLSL version.
+ */
+#define GP_SHADER_SCROLL_TEXTURE \
+  "vec2 gp_scroll_texture(vec2 info, vec2 uv)\n" \
+  "{\n" \
+  "  vec2 axis = vec2(info.y, 1.0 - info.y);\n" \
+  "  return mix(uv, fract(uv + info.x), axis);\n" \
+  "}\n"
+
+/*!
+ * Create a new scroll texture.  The texture starts out zeroed.
+ * \param context Context the scroll texture is drawn in.
+ * \param width Width of the texture in pixels.
+ * \param height Height of the texture in pixels.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param scroll Whether rows or columns are pushed.
+ * \return Newly created scroll texture.
+ */
+GP_EXPORT gp_scroll_texture* gp_scroll_texture_new(gp_context* context,
+                                                   unsigned int width,
+                                                   unsigned int height,
+                                                   GP_FORMAT format,
+                                                   GP_DATA_TYPE type,
+                                                   GP_SCROLL scroll);
+
+/*!
+ * Append lines, overwriting the oldest ones.  Uploads a single rectangle,
+ * or two when the lines wrap around the end of the texture.
+ * \param st Scroll texture to be used.
+ * \param data Image of the new lines in the format and type of the texture,
+ *             oldest first.  That is count rows of width pixels when
+ *             pushing rows, or height rows of count pixels when pushing
+ *             columns.  A single column is simply height pixels.
+ * \param count Number of lines in data.  Only the last lines are kept when
+ *              there are more than the texture holds.
+ */
+GP_EXPORT void gp_scroll_texture_push(gp_scroll_texture* st, const void* data, unsigned int count);
+
+/*!
+ * Retrieve the line the next push writes to, which holds the oldest line
+ * once the texture is full.
+ * \param st Scroll texture to be used.
+ * \return Row or column of the next line.
+ */
+GP_EXPORT unsigned int gp_scroll_texture_get_head(gp_scroll_texture* st);
+
+/*!
+ * Retrieve the vector passed as info to gp_scroll_texture().
+ * \param st Scroll texture to be used.
+ * \param info Array receiving the head as a texture coordinate and 0 for
+ *             rows or 1 for columns.
+ */
+GP_EXPORT void gp_scroll_texture_get_info(gp_scroll_texture* st, float* info);
+
+/*!
+ * Retrieve the texture holding the lines.
+ * \param st Scroll texture to be used.
+ * \return Texture of the scroll texture.
+ */
+GP_EXPORT gp_texture* gp_scroll_texture_get_texture(gp_scroll_texture* st);
+
+//! \} // ScrollTexture
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_scroll_texture
+   */
+  class ScrollTexture : public Object
+  {
+  public:
+    //! Constructor
+    inline ScrollTexture(gp_scroll_texture* st);
+    
+    //! Constructor
+    inline ScrollTexture(const Context& context,
+                         unsigned int width,
+                         unsigned int height,
+                         GP_FORMAT format,
+                         GP_DATA_TYPE type,
+                         GP_SCROLL scroll);
+    
+    /*!
+     * Append lines, overwriting the oldest ones.
+     * \param data Image of the new lines in the format and type of the texture.
+     * \param count Number of lines in data.
+     */
+    inline void Push(const void* data, unsigned int count = 1);
+    
+    /*!
+     * Retrieve the line the next push writes to.
+     * \return Row or column of the next line.
+     */
+    inline unsigned int GetHead();
+    
+    /*!
+     * Retrieve the vector passed as info to gp_scroll_texture().
+     * \param info Array receiving the head and the scroll direction.
+     */
+    inline void GetInfo(float* info);
+    
+    /*!
+     * Retrieve the texture holding the lines.
+     * \return Texture of the scroll texture.
+     */
+    inline Texture GetTexture();
+  };
+  
+  //
+  // Implementation
+  //
+  ScrollTexture::ScrollTexture(gp_scroll_texture* st) : Object((gp_object*)st) {}
+  ScrollTexture::ScrollTexture(const Context& context,
+                               unsigned int width,
+                               unsigned int height,
+                               GP_FORMAT format,
+                               GP_DATA_TYPE type,
+                               GP_SCROLL scroll)
+    : Object((void*)gp_scroll_texture_new((gp_context*)GetObject(context), width, height, format, type, scroll)) {}
+  void ScrollTexture::Push(const void* data, unsigned int count)
+  {
+    gp_scroll_texture_push((gp_scroll_texture*)GetObject(*this), data, count);
+  }
+  unsigned int ScrollTexture::GetHead() {return gp_scroll_texture_get_head((gp_scroll_texture*)GetObject(*this));}
+  void ScrollTexture::GetInfo(float* info) {gp_scroll_texture_get_info((gp_scroll_texture*)GetObject(*this), info);}
+  Texture ScrollTexture::GetTexture() {return Texture(gp_scroll_texture_get_texture((gp_scroll_texture*)GetObject(*this)));}
+}
+
+#endif // __cplusplus
+
+#endif // __GP_SCROLL_TEXTURE_H__
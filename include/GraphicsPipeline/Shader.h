@@ -23,6 +23,8 @@
 #include "Common.h"
 #include "Types.h"
 #include "Texture.h"
+#include "Sampler.h"
+#include "Array.h"
 #include "Context.h"
 #include "Object.h"
 
@@ -103,6 +105,44 @@ GP_UNIFORM_DEFINITION(dmat4, double*, double[4][4])
 
 #undef GP_UNIFORM_DEFINITION
 
+/*!
+ * Sample the texture of a texture uniform with a sampler instead of the
+ * wrap and filter state of the texture.  Ignored by GLES2.
+ * \param uniform Uniform object created with gp_uniform_texture_new_by_name().
+ * \param sampler Sampler to be used, or NULL for the state of the texture.
+ */
+GP_EXPORT void gp_uniform_texture_set_sampler(gp_uniform* uniform, gp_sampler* sampler);
+
+/*!
+ * Create a new gp_uniform exposing a gp_array to a samplerBuffer, isamplerBuffer
+ * or usamplerBuffer uniform.  The vertex data uploaded once can then be read
+ * both as attributes and with texelFetch() as random access data.  Only
+ * supported by desktop OpenGL.
+ * \param shader Shader object used to create the gp_uniform object.
+ * \param name Name of the uniform variable in the shader code.
+ * \return Newly created gp_uniform object.
+ */
+GP_EXPORT gp_uniform* gp_uniform_buffer_new_by_name(gp_shader* shader, const char* name);
+
+/*!
+ * Set the array read by a buffer uniform.  Every texel is one element of
+ * format values of type.  Three value formats are only supported for
+ * #GP_DATA_TYPE_INT and #GP_DATA_TYPE_FLOAT, doubles are not supported and
+ * #GP_DATA_TYPE_SHORT reads as integers.
+ * \param uniform Uniform object to have data loaded.
+ * \param array Array to be read by the shader, or NULL.
+ * \param format Number of values per texel.
+ * \param type The data type of the values in the array.
+ */
+GP_EXPORT void gp_uniform_buffer_set(gp_uniform* uniform, gp_array* array, GP_FORMAT format, GP_DATA_TYPE type);
+
+/*!
+ * Get the array read by a buffer uniform.
+ * \param uniform Uniform object created with gp_uniform_buffer_new_by_name().
+ * \return Array read by the shader or NULL.
+ */
+GP_EXPORT gp_array* gp_uniform_buffer_get(gp_uniform* uniform);
+
 //! \} // Shader
 
 #ifdef __cplusplus
@@ -213,6 +253,12 @@ namespace GP
      */
     inline void Set(const Texture& texture);
     
+    /*!
+     * Sample the texture with a sampler instead of its own state.
+     * \param sampler Sampler to be used.
+     */
+    inline void SetSampler(const Sampler& sampler);
+    
     /*!
      * Get texture data into Uniform object
      */
@@ -221,8 +267,44 @@ namespace GP
   UniformTexture::UniformTexture() : Uniform((void*)0) {}
   UniformTexture::UniformTexture(const Shader& shader, const char* name) : Uniform((void*)gp_uniform_texture_new_by_name((gp_shader*)GetObject(shader), name)) {}
   void UniformTexture::Set(const Texture& texture) {gp_uniform_texture_set((gp_uniform*)GetObject(*this), (gp_texture*)GetObject(texture));}
+  void UniformTexture::SetSampler(const Sampler& sampler)
+  {
+    gp_uniform_texture_set_sampler((gp_uniform*)GetObject(*this), (gp_sampler*)GetObject(sampler));
+  }
   gp_texture* UniformTexture::Get() {return 0;}
   
+  /*!
+   * \brief Uniform specialized for reading an Array as a buffer texture
+   */
+  class UniformBuffer : public Uniform
+  {
+  public:
+    inline UniformBuffer();
+    
+    /*! Constructor */
+    inline UniformBuffer(const Shader& shader, const char* name);
+    
+    /*!
+     * Set the array read by the shader.
+     * \param array Array to be read by the shader.
+     * \param format Number of values per texel.
+     * \param type The data type of the values in the array.
+     */
+    inline void Set(const Array& array, GP_FORMAT format, GP_DATA_TYPE type);
+    
+    /*!
+     * Get the array read by the shader.
+     */
+    inline gp_array* Get();
+  };
+  UniformBuffer::UniformBuffer() : Uniform((void*)0) {}
+  UniformBuffer::UniformBuffer(const Shader& shader, const char* name) : Uniform((void*)gp_uniform_buffer_new_by_name((gp_shader*)GetObject(shader), name)) {}
+  void UniformBuffer::Set(const Array& array, GP_FORMAT format, GP_DATA_TYPE type)
+  {
+    gp_uniform_buffer_set((gp_uniform*)GetObject(*this), (gp_array*)GetObject(array), format, type);
+  }
+  gp_array* UniformBuffer::Get() {return gp_uniform_buffer_get((gp_uniform*)GetObject(*this));}
+  
   CXX_UNIFORM(Float, float, float)
   CXX_UNIFORM(Vec2, vec2, float*)
   CXX_UNIFORM(Vec3, vec3, float*)
@@ -0,0 +1,213 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file Shared.h
+
+#ifndef __GP_SHARED_H__
+#define __GP_SHARED_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Object.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup Shared
+ * Memory shared between processes through a file descriptor.  A producer
+ * process creates the memory, passes the file descriptor to the renderer
+ * (over a unix socket or by inheritance) and writes frames between
+ * gp_shared_begin_write() and gp_shared_end_write().  Every write bumps a
+ * sequence number in the shared header which readers use to detect fresh
+ * and torn frames.
+ *
+ * Producers that do not render can link against the small GP::Shared
+ * library instead of GP::Native.  Only supported on Linux.
+ * \{
+ */
+
+/*!
+ * Create a new block of shared memory.
+ * \param size Number of bytes available to producers.
+ * \return Newly created shared memory object or NULL on failure.
+ */
+GP_EXPORT gp_shared* gp_shared_new(unsigned int size);
+
+/*!
+ * Map shared memory created by another process.  The file descriptor is
+ * duplicated, so the caller keeps ownership of fd.
+ * \param fd File descriptor retrieved with gp_shared_get_fd().
+ * \return Newly created shared memory object or NULL on failure.
+ */
+GP_EXPORT gp_shared* gp_shared_new_from_fd(int fd);
+
+/*!
+ * Retrieve the file descriptor backing the shared memory.
+ * \param shared Shared memory object to be used.
+ * \return File descriptor to be passed to other processes.
+ */
+GP_EXPORT int gp_shared_get_fd(gp_shared* shared);
+
+/*!
+ * Retrieve the size of the shared memory.
+ * \param shared Shared memory object to be used.
+ * \return Number of bytes available to producers.
+ */
+GP_EXPORT unsigned int gp_shared_get_size(gp_shared* shared);
+
+/*!
+ * Retrieve the shared memory.  Writers should use gp_shared_begin_write().
+ * \param shared Shared memory object to be used.
+ * \return Pointer to the start of the shared memory.
+ */
+GP_EXPORT void* gp_shared_get_data(gp_shared* shared);
+
+/*!
+ * Mark the start of a new frame.  Only one process may write at a time.
+ * \param shared Shared memory object to be used.
+ * \return Pointer to the start of the shared memory.
+ */
+GP_EXPORT void* gp_shared_begin_write(gp_shared* shared);
+
+/*!
+ * Mark the end of a frame started with gp_shared_begin_write().
+ * \param shared Shared memory object to be used.
+ */
+GP_EXPORT void gp_shared_end_write(gp_shared* shared);
+
+/*!
+ * Retrieve the current sequence number.  The sequence number is odd while
+ * a frame is being written and increases by two with every frame.
+ * \param shared Shared memory object to be used.
+ * \return The current sequence number.
+ */
+GP_EXPORT unsigned int gp_shared_get_sequence(gp_shared* shared);
+
+/*!
+ * Start reading the shared memory.
+ * \param shared Shared memory object to be used.
+ * \return Sequence number to be passed to gp_shared_read_end().
+ */
+GP_EXPORT unsigned int gp_shared_read_begin(gp_shared* shared);
+
+/*!
+ * Finish reading the shared memory.
+ * \param shared Shared memory object to be used.
+ * \param sequence Sequence number returned by gp_shared_read_begin().
+ * \return 1 if no frame was written while reading, 0 if the read is torn
+ *         and must be retried.
+ */
+GP_EXPORT int gp_shared_read_end(gp_shared* shared, unsigned int sequence);
+
+//! \} // Shared
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_shared
+   */
+  class Shared : public Object
+  {
+  public:
+    //! Constructor
+    inline Shared(gp_shared* shared);
+    
+    //! Constructor
+    inline Shared(unsigned int size);
+    
+    /*!
+     * Map shared memory created by another process.
+     * \param fd File descriptor retrieved with GetFD().
+     * \return %Shared memory object, invalid on failure.
+     */
+    inline static Shared FromFD(int fd);
+    
+    /*!
+     * Retrieve the file descriptor backing the shared memory.
+     * \return File descriptor to be passed to other processes.
+     */
+    inline int GetFD();
+    
+    /*!
+     * Retrieve the size of the shared memory.
+     * \return Number of bytes available to producers.
+     */
+    inline unsigned int GetSize();
+    
+    /*!
+     * Retrieve the shared memory.
+     * \return Pointer to the start of the shared memory.
+     */
+    inline void* GetData();
+    
+    /*!
+     * Mark the start of a new frame.
+     * \return Pointer to the start of the shared memory.
+     */
+    inline void* BeginWrite();
+    
+    //! Mark the end of a frame started with BeginWrite().
+    inline void EndWrite();
+    
+    /*!
+     * Retrieve the current sequence number.
+     * \return The current sequence number.
+     */
+    inline unsigned int GetSequence();
+    
+    /*!
+     * Start reading the shared memory.
+     * \return Sequence number to be passed to ReadEnd().
+     */
+    inline unsigned int ReadBegin();
+    
+    /*!
+     * Finish reading the shared memory.
+     * \param sequence Sequence number returned by ReadBegin().
+     * \return True if the read is consistent.
+     */
+    inline bool ReadEnd(unsigned int sequence);
+  
+  private:
+    inline Shared(void* shared);
+  };
+  
+  //
+  // Implementation
+  //
+  Shared::Shared(gp_shared* shared) : Object((gp_object*)shared) {}
+  Shared::Shared(unsigned int size) : Object((void*)gp_shared_new(size)) {}
+  Shared::Shared(void* shared) : Object(shared) {}
+  Shared Shared::FromFD(int fd) {return Shared((void*)gp_shared_new_from_fd(fd));}
+  int Shared::GetFD() {return gp_shared_get_fd((gp_shared*)GetObject(*this));}
+  unsigned int Shared::GetSize() {return gp_shared_get_size((gp_shared*)GetObject(*this));}
+  void* Shared::GetData() {return gp_shared_get_data((gp_shared*)GetObject(*this));}
+  void* Shared::BeginWrite() {return gp_shared_begin_write((gp_shared*)GetObject(*this));}
+  void Shared::EndWrite() {gp_shared_end_write((gp_shared*)GetObject(*this));}
+  unsigned int Shared::GetSequence() {return gp_shared_get_sequence((gp_shared*)GetObject(*this));}
+  unsigned int Shared::ReadBegin() {return gp_shared_read_begin((gp_shared*)GetObject(*this));}
+  bool Shared::ReadEnd(unsigned int sequence) {return gp_shared_read_end((gp_shared*)GetObject(*this), sequence) != 0;}
+}
+
+#endif // __cplusplus
+
+#endif // __GP_SHARED_H__
@@ -22,7 +22,11 @@
 
 #include "Common.h"
 #include "Types.h"
+#include "Compress.h"
+#include "Convert.h"
+#include "Mipmap.h"
 #include "Object.h"
+#include "Shared.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +34,10 @@ extern "C" {
 
 /*!
  * \defgroup Texture
+ * 3D and 2D array textures hold a stack of images sampled with sampler3D
+ * and sampler2DArray.  A single texture uniform then binds every layer of
+ * an array texture, so one draw may pick its layer from an attribute
+ * instead of binding a texture per layer.  Neither is supported by GLES2.
  * \{
  */
 
@@ -39,6 +47,79 @@ extern "C" {
  */
 GP_EXPORT gp_texture_data* gp_texture_data_new();
 
+/*!
+ * Create a new 2D gp_texture_data object backed by shared memory.  Uploads
+ * copy a frame out of the shared memory first.  Frames torn by a producer
+ * writing during every copy attempt are skipped and the texture keeps its
+ * previous contents.
+ * \param shared Shared memory written by a producer.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ * \return Newly created texture data object or NULL if the shared memory is
+ *         NULL or too small.
+ */
+GP_EXPORT gp_texture_data* gp_texture_data_new_shared(gp_shared* shared,
+                                                      GP_FORMAT format,
+                                                      GP_DATA_TYPE type,
+                                                      unsigned int width,
+                                                      unsigned int height);
+
+/*!
+ * Retrieve the shared memory sequence number of the last frame uploaded from
+ * the texture data object.  A frame is fresh when this differs from
+ * gp_shared_get_sequence().
+ * \param td Texture data object to be used.
+ * \return Sequence number of the last uploaded frame.
+ */
+GP_EXPORT unsigned int gp_texture_data_get_sequence(gp_texture_data* td);
+
+/*!
+ * Retrieve the pixels stored in the texture data object.
+ * \param td Texture data object to be used.
+ * \return Pointer to the stored pixels or NULL if there are none.
+ */
+GP_EXPORT void* gp_texture_data_get_data(gp_texture_data* td);
+
+/*!
+ * Retrieve the size of the stored pixels.
+ * \param td Texture data object to be used.
+ * \param width Receives the width.  May be NULL.
+ * \param height Receives the height, 1 for 1D data.  May be NULL.
+ * \param depth Receives the depth or number of layers, 1 for 1D and 2D
+ *              data.  May be NULL.
+ */
+GP_EXPORT void gp_texture_data_get_size(gp_texture_data* td,
+                                        unsigned int* width,
+                                        unsigned int* height,
+                                        unsigned int* depth);
+
+/*!
+ * Retrieve where the stored pixels are uploaded inside the texture.
+ * \param td Texture data object to be used.
+ * \param w_offset Receives the width offset, -1 if the data replaces the
+ *                 whole texture.  May be NULL.
+ * \param h_offset Receives the height offset.  May be NULL.
+ * \param d_offset Receives the depth offset or first layer.  May be NULL.
+ */
+GP_EXPORT void gp_texture_data_get_offset(gp_texture_data* td,
+                                          int* w_offset,
+                                          int* h_offset,
+                                          int* d_offset);
+
+/*!
+ * Reorder the components of the data as it is uploaded, such as BGRA
+ * pixels to RGBA.  Texture data is also converted on upload to the format
+ * of the texture storage, doubles are uploaded as floats and RGB bytes as
+ * RGBA bytes.
+ * \param td Texture data object to be used.
+ * \param swizzle Four source component indices, #GP_SWIZZLE_ZERO or
+ *                #GP_SWIZZLE_ONE as used by gp_convert().  Set to NULL to
+ *                keep the component order.
+ */
+GP_EXPORT void gp_texture_data_set_swizzle(gp_texture_data* td, const int* swizzle);
+
 /*!
  * Store 1D data in texture data object.  If the platform doesn't support
  * 1D textures, the data is converted to a 2D texture with a hieght of 1.
@@ -108,7 +189,206 @@ GP_EXPORT void gp_texture_data_set_2d_chunk(gp_texture_data* td,
                                             unsigned int h_offfset);
 
 /*!
- * Create a new gp_texture object tied to a context.
+ * Store a rectangle cut out of a larger 2D image in texture data object.
+ * The rows of the rectangle are gathered straight from the image, so it
+ * does not need to be repacked first.  Follows the meaning of
+ * GL_UNPACK_ROW_LENGTH and GL_UNPACK_SKIP_PIXELS/ROWS.
+ * \param td Texture data object to be used.
+ * \param data Pointer to the first pixel of the image.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in the rectangle width.
+ * \param height Number of elements in the rectangle height.
+ * \param w_offset Width offset where this chunk should be uploaded.
+ * \param h_offset Height offset where this chunk should be uploaded.
+ * \param row_length Number of elements in a row of the image, or 0 for
+ *                   width.
+ * \param skip_pixels Column of the image where the rectangle starts.
+ * \param skip_rows Row of the image where the rectangle starts.  The image
+ *                  must hold at least skip_rows + height rows, which can
+ *                  not be checked.
+ */
+GP_EXPORT void gp_texture_data_set_2d_region(gp_texture_data* td,
+                                             const void* data,
+                                             GP_FORMAT format,
+                                             GP_DATA_TYPE type,
+                                             unsigned int width,
+                                             unsigned int height,
+                                             unsigned int w_offset,
+                                             unsigned int h_offset,
+                                             unsigned int row_length,
+                                             unsigned int skip_pixels,
+                                             unsigned int skip_rows);
+
+/*!
+ * Store 3D data in texture data object.
+ * \param td Texture data object to be used.
+ * \param data Pointer to an array of data to be stored, slice after slice.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ * \param depth Number of elements in data depth.
+ */
+GP_EXPORT void gp_texture_data_set_3d(gp_texture_data* td,
+                                      void* data,
+                                      GP_FORMAT format,
+                                      GP_DATA_TYPE type,
+                                      unsigned int width,
+                                      unsigned int height,
+                                      unsigned int depth);
+
+/*!
+ * Store a slab of 3D data in texture data object.
+ * \param td Texture data object to be used.
+ * \param data Pointer to an array of data to be stored, slice after slice.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ * \param depth Number of elements in data depth.
+ * \param w_offset Width offset where this chunk should be uploaded.
+ * \param h_offset Height offset where this chunk should be uploaded.
+ * \param d_offset Depth offset where this chunk should be uploaded.
+ */
+GP_EXPORT void gp_texture_data_set_3d_chunk(gp_texture_data* td,
+                                            void* data,
+                                            GP_FORMAT format,
+                                            GP_DATA_TYPE type,
+                                            unsigned int width,
+                                            unsigned int height,
+                                            unsigned int depth,
+                                            unsigned int w_offset,
+                                            unsigned int h_offset,
+                                            unsigned int d_offset);
+
+/*!
+ * Store 2D array data in texture data object.
+ * \param td Texture data object to be used.
+ * \param data Pointer to an array of data to be stored, layer after layer.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ * \param layers Number of layers.
+ */
+GP_EXPORT void gp_texture_data_set_2d_array(gp_texture_data* td,
+                                            void* data,
+                                            GP_FORMAT format,
+                                            GP_DATA_TYPE type,
+                                            unsigned int width,
+                                            unsigned int height,
+                                            unsigned int layers);
+
+/*!
+ * Store layers of 2D array data in texture data object.
+ * \param td Texture data object to be used.
+ * \param data Pointer to an array of data to be stored, layer after layer.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ * \param layers Number of layers.
+ * \param w_offset Width offset where this chunk should be uploaded.
+ * \param h_offset Height offset where this chunk should be uploaded.
+ * \param layer First layer where this chunk should be uploaded.
+ */
+GP_EXPORT void gp_texture_data_set_2d_array_chunk(gp_texture_data* td,
+                                                  void* data,
+                                                  GP_FORMAT format,
+                                                  GP_DATA_TYPE type,
+                                                  unsigned int width,
+                                                  unsigned int height,
+                                                  unsigned int layers,
+                                                  unsigned int w_offset,
+                                                  unsigned int h_offset,
+                                                  unsigned int layer);
+
+/*!
+ * Store block compressed 2D data in texture data object, uploaded as is
+ * without any conversion.
+ * \param td Texture data object to be used.
+ * \param data Pointer to gp_compress_get_size() bytes of blocks.
+ * \param compression Block compressed format of data.
+ * \param width Number of pixels in data width.
+ * \param height Number of pixels in data height.
+ */
+GP_EXPORT void gp_texture_data_set_compressed(gp_texture_data* td,
+                                              const void* data,
+                                              GP_COMPRESSION compression,
+                                              unsigned int width,
+                                              unsigned int height);
+
+/*!
+ * Store block compressed 2D data in texture data object, to be uploaded
+ * into part of a texture with the same compression.  The size must be a
+ * multiple of 4 unless the chunk ends at the edge of the texture.
+ * \param td Texture data object to be used.
+ * \param data Pointer to gp_compress_get_size() bytes of blocks.
+ * \param compression Block compressed format of data.
+ * \param width Number of pixels in data width.
+ * \param height Number of pixels in data height.
+ * \param w_offset Width offset where this chunk should be uploaded, a
+ *                 multiple of 4.
+ * \param h_offset Height offset where this chunk should be uploaded, a
+ *                 multiple of 4.
+ */
+GP_EXPORT void gp_texture_data_set_compressed_chunk(gp_texture_data* td,
+                                                    const void* data,
+                                                    GP_COMPRESSION compression,
+                                                    unsigned int width,
+                                                    unsigned int height,
+                                                    unsigned int w_offset,
+                                                    unsigned int h_offset);
+
+/*!
+ * Compress 2D data in place with gp_compress().
+ * \param td Texture data object to be used.
+ * \param compression Block compressed format to encode.
+ * \return 1 on success, 0 if the data can not be compressed.
+ */
+GP_EXPORT int gp_texture_data_compress(gp_texture_data* td, GP_COMPRESSION compression);
+
+/*!
+ * Compress 2D data with gp_compress() every time it is uploaded with
+ * gp_texture_set_data_async(), leaving the data itself uncompressed.  The
+ * data is compressed on the upload thread, synchronous uploads ignore this
+ * and upload it uncompressed.
+ * \param td Texture data object to be used.
+ * \param compression Block compressed format to encode, or
+ *                    #GP_COMPRESSION_NONE to upload uncompressed.
+ */
+GP_EXPORT void gp_texture_data_set_compression(gp_texture_data* td, GP_COMPRESSION compression);
+
+/*!
+ * Store floats in a texture data object as 2D #GP_DATA_TYPE_HALF data.
+ * Half float textures use half the memory and bandwidth of float textures
+ * and still cover the range of HDR imagery.
+ * \param td Texture data object to be used.
+ * \param data Pointer to an array of floats to be converted.
+ * \param format Number of values per color value.
+ * \param width Number of elements in data width.
+ * \param height Number of elements in data height.
+ */
+GP_EXPORT void gp_texture_data_set_2d_half(gp_texture_data* td,
+                                           const float* data,
+                                           GP_FORMAT format,
+                                           unsigned int width,
+                                           unsigned int height);
+
+/*!
+ * Store the next mipmap level of another texture data object, built with
+ * gp_mipmap_downsample().  Only 1D and 2D data can be downsampled.
+ * \param td Texture data object receiving the level.  Must not be source.
+ * \param source Texture data object holding the previous level.
+ * \param filter Filter used to downsample.
+ */
+GP_EXPORT void gp_texture_data_downsample(gp_texture_data* td, gp_texture_data* source, GP_MIPMAP filter);
+
+/*!
+ * Create a new gp_texture object tied to a context.  The underlying GL texture
+ * is generated the first time the texture is used, so textures may be created
+ * from any thread.
  * \param context Context object used to create texture.
  * \return Newly created texture.
  */
@@ -129,6 +409,209 @@ GP_EXPORT void gp_texture_set_data(gp_texture* texture, gp_texture_data* data);
  */
 GP_EXPORT void gp_texture_set_data_async(gp_texture* texture, gp_texture_data* data, void (*callback)(void*), void* userdata);
 
+/*!
+ * Load an image file into a texture in the background.  Loads are queued
+ * and taken in batches by the worker context, which reads and decodes a
+ * batch on a pool of threads straight into mapped staging buffers and
+ * uploads every image with gp_texture_set_data_async().  The texture holds
+ * unsigned byte RGBA data once loaded.  See gp_image_decode() for the
+ * supported formats.
+ * \param texture Pointer to texture object.
+ * \param path Path of the image file.
+ * \param callback Called with 1 once the image is uploaded or 0 if it
+ *                 could not be loaded.  Set to NULL to ignore.
+ * \param userdata User defined data to be passed to callback function.
+ */
+GP_EXPORT void gp_texture_load_async(gp_texture* texture,
+                                     const char* path,
+                                     void (*callback)(int success, void* userdata),
+                                     void* userdata);
+
+/*!
+ * Allocate immutable storage for a texture and its mipmaps.  Later uploads
+ * of the same size and format update the storage in place, other sizes
+ * allocate new storage with the same number of levels.  The storage is
+ * never block compressed, so compressed data can not update it.
+ * \param texture Pointer to texture object.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Width of the base level.
+ * \param height Height of the base level.  Set to 0 for a 1D texture.
+ * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+ */
+GP_EXPORT void gp_texture_allocate(gp_texture* texture,
+                                   GP_FORMAT format,
+                                   GP_DATA_TYPE type,
+                                   unsigned int width,
+                                   unsigned int height,
+                                   unsigned int levels);
+
+/*!
+ * Allocate immutable storage for a 3D texture and its mipmaps.
+ * \param texture Pointer to texture object.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Width of the base level.
+ * \param height Height of the base level.
+ * \param depth Depth of the base level.
+ * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+ */
+GP_EXPORT void gp_texture_allocate_3d(gp_texture* texture,
+                                      GP_FORMAT format,
+                                      GP_DATA_TYPE type,
+                                      unsigned int width,
+                                      unsigned int height,
+                                      unsigned int depth,
+                                      unsigned int levels);
+
+/*!
+ * Allocate immutable storage for a 2D array texture and its mipmaps.
+ * Every level keeps all layers.
+ * \param texture Pointer to texture object.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param width Width of the base level.
+ * \param height Height of the base level.
+ * \param layers Number of layers.
+ * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+ */
+GP_EXPORT void gp_texture_allocate_2d_array(gp_texture* texture,
+                                            GP_FORMAT format,
+                                            GP_DATA_TYPE type,
+                                            unsigned int width,
+                                            unsigned int height,
+                                            unsigned int layers,
+                                            unsigned int levels);
+
+/*!
+ * Upload data to a mipmap level of a texture.  The level must be allocated
+ * with gp_texture_allocate() or gp_texture_generate_mipmaps().
+ * \param texture Pointer to texture object.
+ * \param data Pointer to texture data object to be uploaded.
+ * \param level Mipmap level to be updated, where 0 is the base level.
+ */
+GP_EXPORT void gp_texture_set_level(gp_texture* texture, gp_texture_data* data, unsigned int level);
+
+/*!
+ * Build mipmaps from the base level on the GPU.  Mipmaps must be rebuilt
+ * after the base level is updated.
+ * \param texture Pointer to texture object.
+ */
+GP_EXPORT void gp_texture_generate_mipmaps(gp_texture* texture);
+
+/*!
+ * Set how a texture is filtered when sampled.  Defaults to linear
+ * filtering.  The mipmap filter only applies to textures with mipmaps.
+ * \param texture Pointer to texture object.
+ * \param min Filter used when the texture is minified.
+ * \param mag Filter used when the texture is magnified.
+ * \param mip Filter used between mipmap levels.
+ */
+GP_EXPORT void gp_texture_set_filter(gp_texture* texture, GP_FILTER min, GP_FILTER mag, GP_FILTER mip);
+
+/*!
+ * Set the bias added to the mipmap level chosen when sampling.  Negative
+ * values sharpen minified textures.  Ignored by GLES.
+ * \param texture Pointer to texture object.
+ * \param bias Bias in mipmap levels.
+ */
+GP_EXPORT void gp_texture_set_lod_bias(gp_texture* texture, float bias);
+
+/*!
+ * Map a region of a texture for writing.  The returned memory is written
+ * directly by the GPU upload, skipping any texture data object.  The
+ * texture must already hold 1D or 2D data of at least the region size and
+ * only one region may be mapped at a time.  Rows are padded to a multiple
+ * of 4 bytes, so pixels of a row start pitch bytes after the previous row.
+ * \param texture Pointer to texture object.
+ * \param x Horizontal offset of the region.
+ * \param y Vertical offset of the region.
+ * \param width Width of the region.
+ * \param height Height of the region.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param pitch Receives the number of bytes between rows.  May be NULL.
+ * \return Pointer to the first row of the region or NULL on failure.
+ */
+GP_EXPORT void* gp_texture_map_region(gp_texture* texture,
+                                      unsigned int x,
+                                      unsigned int y,
+                                      unsigned int width,
+                                      unsigned int height,
+                                      GP_FORMAT format,
+                                      GP_DATA_TYPE type,
+                                      unsigned int* pitch);
+
+/*!
+ * Upload the region mapped with gp_texture_map_region().  Must be called on
+ * the thread that mapped the region, after every write has finished.  The
+ * mapped memory must not be used afterwards.
+ * \param texture Pointer to texture object.
+ */
+GP_EXPORT void gp_texture_unmap_commit(gp_texture* texture);
+
+/*!
+ * Upload several rectangles of an image into the base level of a 2D
+ * texture.  All rectangles are copied into a single staging buffer in one
+ * pass and uploaded from it, so many small updates cost one buffer mapping
+ * instead of one each.  The texture must already hold 2D data as large as
+ * the image.
+ * \param texture Pointer to texture object.
+ * \param image Pointer to the first pixel of the image.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param row_length Number of pixels in a row of the image.
+ * \param regions Array of count rectangles as x, y, width and height, in
+ *                pixels of both the image and the texture.
+ * \param count Number of rectangles in regions.
+ */
+GP_EXPORT void gp_texture_set_regions(gp_texture* texture,
+                                      const void* image,
+                                      GP_FORMAT format,
+                                      GP_DATA_TYPE type,
+                                      unsigned int row_length,
+                                      const unsigned int* regions,
+                                      unsigned int count);
+
+/*!
+ * Map a region of a texture for writing on the worker context.  The
+ * callback runs on the main thread, but the memory it receives belongs to
+ * a buffer mapped by the worker context and may be written from any
+ * thread, without a current context, until the region is committed.  Once
+ * every write has finished, commit the region with
+ * gp_texture_unmap_commit_async() so the buffer is unmapped on the worker
+ * context that mapped it.  The texture must not be mapped again before
+ * then.
+ * \param texture Pointer to texture object.
+ * \param x Horizontal offset of the region.
+ * \param y Vertical offset of the region.
+ * \param width Width of the region.
+ * \param height Height of the region.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param callback Called with the mapped memory, or NULL on failure, and
+ *                 the number of bytes between rows.
+ * \param userdata User defined data to be passed to callback function.
+ */
+GP_EXPORT void gp_texture_map_region_async(gp_texture* texture,
+                                           unsigned int x,
+                                           unsigned int y,
+                                           unsigned int width,
+                                           unsigned int height,
+                                           GP_FORMAT format,
+                                           GP_DATA_TYPE type,
+                                           void (*callback)(void* data, unsigned int pitch, void* userdata),
+                                           void* userdata);
+
+/*!
+ * Upload the region mapped with gp_texture_map_region_async() on the worker
+ * context.  The mapped memory must not be written once this is called.
+ * \param texture Pointer to texture object.
+ * \param callback Callback function to be called upon completion.  Set to NULL to ignore.
+ * \param userdata User defined data to be passed to callback function.
+ */
+GP_EXPORT void gp_texture_unmap_commit_async(gp_texture* texture, void (*callback)(void*), void* userdata);
+
 /*!
  * Set how data will be wrapped along the X axis.
  * \param texture Pointer to texture object.
@@ -143,6 +626,13 @@ GP_EXPORT void gp_texture_set_wrap_x(gp_texture* texture, GP_WRAP wrap);
  */
 GP_EXPORT void gp_texture_set_wrap_y(gp_texture* texture, GP_WRAP wrap);
 
+/*!
+ * Set how data will be wrapped along the Z axis of 3D textures.
+ * \param texture Pointer to texture object.
+ * \param wrap The new wrapping behavior.
+ */
+GP_EXPORT void gp_texture_set_wrap_z(gp_texture* texture, GP_WRAP wrap);
+
 //! \} // Texture
 
 #ifdef __cplusplus
@@ -162,6 +652,44 @@ namespace GP
     //! Constructor
     inline TextureData();
     
+    //! Constructor
+    inline TextureData(const Shared& shared, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height);
+    
+    /*!
+     * Retrieve the shared memory sequence number of the last uploaded frame.
+     * \return Sequence number of the last uploaded frame.
+     */
+    inline unsigned int GetSequence();
+    
+    /*!
+     * Retrieve the stored pixels.
+     * \return Pointer to the stored pixels or NULL if there are none.
+     */
+    inline void* GetData();
+    
+    /*!
+     * Retrieve the size of the stored pixels.
+     * \param width Receives the width.  May be NULL.
+     * \param height Receives the height.  May be NULL.
+     * \param depth Receives the depth or number of layers.  May be NULL.
+     */
+    inline void GetSize(unsigned int* width, unsigned int* height, unsigned int* depth);
+    
+    /*!
+     * Retrieve where the stored pixels are uploaded inside the texture.
+     * \param wOffset Receives the width offset, -1 for the whole texture.
+     * \param hOffset Receives the height offset.
+     * \param dOffset Receives the depth offset or first layer.
+     */
+    inline void GetOffset(int* wOffset, int* hOffset, int* dOffset);
+    
+    /*!
+     * Reorder the components of the data as it is uploaded.
+     * \param swizzle Four source component indices, #GP_SWIZZLE_ZERO or
+     *                #GP_SWIZZLE_ONE.  Set to NULL to keep the component order.
+     */
+    inline void SetSwizzle(const int* swizzle);
+    
     /*!
      * Store 1D data in texture data object.  If the platform doesn't support
      * 1D textures, the data is converted to a 2D texture with a hieght of 1.
@@ -210,6 +738,191 @@ namespace GP
                            unsigned int height,
                            unsigned int w_offset,
                            unsigned int h_offset);
+    
+    /*!
+     * Store a rectangle cut out of a larger 2D image in texture data object.
+     * \param data Pointer to the first pixel of the image.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Number of elements in the rectangle width.
+     * \param height Number of elements in the rectangle height.
+     * \param w_offset Width offset where this chunk should be uploaded.
+     * \param h_offset Height offset where this chunk should be uploaded.
+     * \param rowLength Number of elements in a row of the image, or 0 for width.
+     * \param skipPixels Column of the image where the rectangle starts.
+     * \param skipRows Row of the image where the rectangle starts.
+     */
+    inline void Set2DRegion(const void* data,
+                            GP_FORMAT format,
+                            GP_DATA_TYPE type,
+                            unsigned int width,
+                            unsigned int height,
+                            unsigned int w_offset,
+                            unsigned int h_offset,
+                            unsigned int rowLength,
+                            unsigned int skipPixels,
+                            unsigned int skipRows);
+    
+    /*!
+     * Store 3D data in texture data object.
+     * \param data Pointer to an array of data to be stored, slice after slice.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Number of elements in data width.
+     * \param height Number of elements in data height.
+     * \param depth Number of elements in data depth.
+     */
+    inline void Set3D(void* data, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int depth);
+    
+    /*!
+     * Store a slab of 3D data in texture data object.
+     * \param data Pointer to an array of data to be stored, slice after slice.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Number of elements in data width.
+     * \param height Number of elements in data height.
+     * \param depth Number of elements in data depth.
+     * \param w_offset Width offset where this chunk should be uploaded.
+     * \param h_offset Height offset where this chunk should be uploaded.
+     * \param d_offset Depth offset where this chunk should be uploaded.
+     */
+    inline void Set3DChunk(void* data,
+                           GP_FORMAT format,
+                           GP_DATA_TYPE type,
+                           unsigned int width,
+                           unsigned int height,
+                           unsigned int depth,
+                           unsigned int w_offset,
+                           unsigned int h_offset,
+                           unsigned int d_offset);
+    
+    /*!
+     * Store 2D array data in texture data object.
+     * \param data Pointer to an array of data to be stored, layer after layer.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Number of elements in data width.
+     * \param height Number of elements in data height.
+     * \param layers Number of layers.
+     */
+    inline void Set2DArray(void* data, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int layers);
+    
+    /*!
+     * Store layers of 2D array data in texture data object.
+     * \param data Pointer to an array of data to be stored, layer after layer.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Number of elements in data width.
+     * \param height Number of elements in data height.
+     * \param layers Number of layers.
+     * \param w_offset Width offset where this chunk should be uploaded.
+     * \param h_offset Height offset where this chunk should be uploaded.
+     * \param layer First layer where this chunk should be uploaded.
+     */
+    inline void Set2DArrayChunk(void* data,
+                                GP_FORMAT format,
+                                GP_DATA_TYPE type,
+                                unsigned int width,
+                                unsigned int height,
+                                unsigned int layers,
+                                unsigned int w_offset,
+                                unsigned int h_offset,
+                                unsigned int layer);
+    
+    /*!
+     * Store block compressed 2D data in texture data object.
+     * \param data Pointer to gp_compress_get_size() bytes of blocks.
+     * \param compression Block compressed format of data.
+     * \param width Number of pixels in data width.
+     * \param height Number of pixels in data height.
+     */
+    inline void SetCompressed(const void* data, GP_COMPRESSION compression, unsigned int width, unsigned int height);
+    
+    /*!
+     * Store block compressed 2D data to be uploaded into part of a texture.
+     * \param data Pointer to gp_compress_get_size() bytes of blocks.
+     * \param compression Block compressed format of data.
+     * \param width Number of pixels in data width.
+     * \param height Number of pixels in data height.
+     * \param w_offset Width offset where this chunk should be uploaded.
+     * \param h_offset Height offset where this chunk should be uploaded.
+     */
+    inline void SetCompressedChunk(const void* data,
+                                   GP_COMPRESSION compression,
+                                   unsigned int width,
+                                   unsigned int height,
+                                   unsigned int w_offset,
+                                   unsigned int h_offset);
+    
+    /*!
+     * Compress 2D data in place.
+     * \param compression Block compressed format to encode.
+     * \return True on success.
+     */
+    inline bool Compress(GP_COMPRESSION compression);
+    
+    /*!
+     * Compress 2D data every time it is uploaded asynchronously.
+     * \param compression Block compressed format to encode.
+     */
+    inline void SetCompression(GP_COMPRESSION compression);
+    
+    /*!
+     * Store floats as 2D half float data.
+     * \param data Pointer to an array of floats to be converted.
+     * \param format Number of values per color value.
+     * \param width Number of elements in data width.
+     * \param height Number of elements in data height.
+     */
+    inline void Set2DHalf(const float* data, GP_FORMAT format, unsigned int width, unsigned int height);
+    
+    /*!
+     * Store the next mipmap level of another texture data object.
+     * \param source Texture data object holding the previous level.
+     * \param filter Filter used to downsample.
+     */
+    inline void Downsample(const TextureData& source, GP_MIPMAP filter);
+  };
+  
+  class Texture;
+  
+  /*!
+   * \brief Region of a texture mapped for writing, uploaded when committed
+   * or destroyed.
+   */
+  class TextureMapping
+  {
+  public:
+    //! Move constructor
+    inline TextureMapping(TextureMapping&& other);
+    
+    //! Destructor, commits the region if still mapped.
+    inline ~TextureMapping();
+    
+    /*!
+     * Retrieve the mapped memory.
+     * \return Pointer to the first row of the region or NULL on failure.
+     */
+    inline void* GetData();
+    
+    /*!
+     * Retrieve the number of bytes between rows.
+     * \return Number of bytes between rows.
+     */
+    inline unsigned int GetPitch();
+    
+    //! Upload the region.  The mapped memory must not be used afterwards.
+    inline void Commit();
+    
+  private:
+    friend class Texture;
+    inline TextureMapping(gp_texture* texture, void* data, unsigned int pitch);
+    TextureMapping(const TextureMapping&) = delete;
+    TextureMapping& operator=(const TextureMapping&) = delete;
+    
+    gp_texture* mTexture;
+    void* mData;
+    unsigned int mPitch;
   };
   
   /*!
@@ -239,6 +952,139 @@ namespace GP
      */
     inline void SetDataAsync(const TextureData& data, std::function<void(Texture*)> callback);
     
+    /*!
+     * Load an image file into the %Texture object in the background.
+     * \param path Path of the image file.
+     * \param callback Callback function to be called with whether the image
+     *                 was loaded.
+     */
+    inline void LoadAsync(const char* path, std::function<void(Texture*, bool)> callback);
+    
+    /*!
+     * Map a region of the texture for writing.
+     * \param x Horizontal offset of the region.
+     * \param y Vertical offset of the region.
+     * \param width Width of the region.
+     * \param height Height of the region.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \return Mapping uploaded when committed or destroyed.
+     */
+    inline TextureMapping MapRegion(unsigned int x,
+                                    unsigned int y,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    GP_FORMAT format,
+                                    GP_DATA_TYPE type);
+    
+    /*!
+     * Map a region of the texture for writing on the worker context.
+     * \param x Horizontal offset of the region.
+     * \param y Vertical offset of the region.
+     * \param width Width of the region.
+     * \param height Height of the region.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param callback Called on the main thread with the mapped memory and
+     *                 the number of bytes between rows.  The memory may be
+     *                 written from any thread until UnmapCommitAsync().
+     */
+    inline void MapRegionAsync(unsigned int x,
+                               unsigned int y,
+                               unsigned int width,
+                               unsigned int height,
+                               GP_FORMAT format,
+                               GP_DATA_TYPE type,
+                               std::function<void(void*, unsigned int)> callback);
+    
+    /*!
+     * Upload the region mapped with MapRegionAsync() on the worker context.
+     * \param callback Callback function to be called when upload is complete.
+     */
+    inline void UnmapCommitAsync(std::function<void(Texture*)> callback);
+    
+    /*!
+     * Upload several rectangles of an image through a single staging buffer.
+     * \param image Pointer to the first pixel of the image.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param rowLength Number of pixels in a row of the image.
+     * \param regions Array of count rectangles as x, y, width and height.
+     * \param count Number of rectangles in regions.
+     */
+    inline void SetRegions(const void* image,
+                           GP_FORMAT format,
+                           GP_DATA_TYPE type,
+                           unsigned int rowLength,
+                           const unsigned int* regions,
+                           unsigned int count);
+    
+    /*!
+     * Allocate immutable storage for the texture and its mipmaps.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Width of the base level.
+     * \param height Height of the base level.  Set to 0 for a 1D texture.
+     * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+     */
+    inline void Allocate(GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int levels = 0);
+    
+    /*!
+     * Allocate immutable storage for a 3D texture and its mipmaps.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Width of the base level.
+     * \param height Height of the base level.
+     * \param depth Depth of the base level.
+     * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+     */
+    inline void Allocate3D(GP_FORMAT format,
+                           GP_DATA_TYPE type,
+                           unsigned int width,
+                           unsigned int height,
+                           unsigned int depth,
+                           unsigned int levels = 0);
+    
+    /*!
+     * Allocate immutable storage for a 2D array texture and its mipmaps.
+     * \param format Number of values per color value.
+     * \param type The data type for data values.
+     * \param width Width of the base level.
+     * \param height Height of the base level.
+     * \param layers Number of layers.
+     * \param levels Number of levels to allocate.  Set to 0 for a full mipmap chain.
+     */
+    inline void Allocate2DArray(GP_FORMAT format,
+                                GP_DATA_TYPE type,
+                                unsigned int width,
+                                unsigned int height,
+                                unsigned int layers,
+                                unsigned int levels = 0);
+    
+    /*!
+     * Upload data to a mipmap level.
+     * \param data Texture data to be uploaded.
+     * \param level Mipmap level to be updated, where 0 is the base level.
+     */
+    inline void SetLevel(const TextureData& data, unsigned int level);
+    
+    //! Build mipmaps from the base level on the GPU.
+    inline void GenerateMipmaps();
+    
+    /*!
+     * Set how the texture is filtered when sampled.
+     * \param min Filter used when the texture is minified.
+     * \param mag Filter used when the texture is magnified.
+     * \param mip Filter used between mipmap levels.
+     */
+    inline void SetFilter(GP_FILTER min, GP_FILTER mag, GP_FILTER mip = GP_FILTER_LINEAR);
+    
+    /*!
+     * Set the bias added to the mipmap level chosen when sampling.
+     * \param bias Bias in mipmap levels.
+     */
+    inline void SetLODBias(float bias);
+    
     /*!
      * Set how data will be wrapped along the X axis.
      * \param wrap The new wrapping behavior.
@@ -251,13 +1097,26 @@ namespace GP
      */
     inline void SetWrapY(GP_WRAP wrap);
     
+    /*!
+     * Set how data will be wrapped along the Z axis of 3D textures.
+     * \param wrap The new wrapping behavior.
+     */
+    inline void SetWrapZ(GP_WRAP wrap);
+    
   private:
     struct AsyncData
     {
       Texture* mTexture;
       std::function<void(Texture*)> mCallback;
     };
+    struct LoadAsyncData
+    {
+      Texture* mTexture;
+      std::function<void(Texture*, bool)> mCallback;
+    };
     inline static void AsyncCallback(void* data);
+    inline static void LoadAsyncCallback(int success, void* userdata);
+    inline static void MapAsyncCallback(void* data, unsigned int pitch, void* userdata);
   };
   
   //
@@ -265,6 +1124,19 @@ namespace GP
   //
   TextureData::TextureData(gp_texture_data* data) : Object((gp_object*)data) {}
   TextureData::TextureData() : Object((void*)gp_texture_data_new()) {}
+  TextureData::TextureData(const Shared& shared, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height)
+    : Object((void*)gp_texture_data_new_shared((gp_shared*)GetObject(shared), format, type, width, height)) {}
+  unsigned int TextureData::GetSequence() {return gp_texture_data_get_sequence((gp_texture_data*)GetObject(*this));}
+  void* TextureData::GetData() {return gp_texture_data_get_data((gp_texture_data*)GetObject(*this));}
+  void TextureData::GetSize(unsigned int* width, unsigned int* height, unsigned int* depth)
+  {
+    gp_texture_data_get_size((gp_texture_data*)GetObject(*this), width, height, depth);
+  }
+  void TextureData::GetOffset(int* wOffset, int* hOffset, int* dOffset)
+  {
+    gp_texture_data_get_offset((gp_texture_data*)GetObject(*this), wOffset, hOffset, dOffset);
+  }
+  void TextureData::SetSwizzle(const int* swizzle) {gp_texture_data_set_swizzle((gp_texture_data*)GetObject(*this), swizzle);}
   void TextureData::Set1D(void* data, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width)
   {
     gp_texture_data_set_1d((gp_texture_data*)GetObject(*this), data, format, type, width);
@@ -281,6 +1153,90 @@ namespace GP
   {
     gp_texture_data_set_2d_chunk((gp_texture_data*)GetObject(*this), data, format, type, width, height, w_offset, h_offset);
   }
+  void TextureData::Set2DRegion(const void* data,
+                                GP_FORMAT format,
+                                GP_DATA_TYPE type,
+                                unsigned int width,
+                                unsigned int height,
+                                unsigned int w_offset,
+                                unsigned int h_offset,
+                                unsigned int rowLength,
+                                unsigned int skipPixels,
+                                unsigned int skipRows)
+  {
+    gp_texture_data_set_2d_region((gp_texture_data*)GetObject(*this),
+                                  data,
+                                  format,
+                                  type,
+                                  width,
+                                  height,
+                                  w_offset,
+                                  h_offset,
+                                  rowLength,
+                                  skipPixels,
+                                  skipRows);
+  }
+  void TextureData::Set3D(void* data, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int depth)
+  {
+    gp_texture_data_set_3d((gp_texture_data*)GetObject(*this), data, format, type, width, height, depth);
+  }
+  void TextureData::Set3DChunk(void* data,
+                               GP_FORMAT format,
+                               GP_DATA_TYPE type,
+                               unsigned int width,
+                               unsigned int height,
+                               unsigned int depth,
+                               unsigned int w_offset,
+                               unsigned int h_offset,
+                               unsigned int d_offset)
+  {
+    gp_texture_data_set_3d_chunk((gp_texture_data*)GetObject(*this), data, format, type, width, height, depth, w_offset, h_offset, d_offset);
+  }
+  void TextureData::Set2DArray(void* data, GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int layers)
+  {
+    gp_texture_data_set_2d_array((gp_texture_data*)GetObject(*this), data, format, type, width, height, layers);
+  }
+  void TextureData::Set2DArrayChunk(void* data,
+                                    GP_FORMAT format,
+                                    GP_DATA_TYPE type,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    unsigned int layers,
+                                    unsigned int w_offset,
+                                    unsigned int h_offset,
+                                    unsigned int layer)
+  {
+    gp_texture_data_set_2d_array_chunk((gp_texture_data*)GetObject(*this), data, format, type, width, height, layers, w_offset, h_offset, layer);
+  }
+  void TextureData::SetCompressed(const void* data, GP_COMPRESSION compression, unsigned int width, unsigned int height)
+  {
+    gp_texture_data_set_compressed((gp_texture_data*)GetObject(*this), data, compression, width, height);
+  }
+  void TextureData::SetCompressedChunk(const void* data,
+                                       GP_COMPRESSION compression,
+                                       unsigned int width,
+                                       unsigned int height,
+                                       unsigned int w_offset,
+                                       unsigned int h_offset)
+  {
+    gp_texture_data_set_compressed_chunk((gp_texture_data*)GetObject(*this), data, compression, width, height, w_offset, h_offset);
+  }
+  bool TextureData::Compress(GP_COMPRESSION compression)
+  {
+    return gp_texture_data_compress((gp_texture_data*)GetObject(*this), compression) != 0;
+  }
+  void TextureData::SetCompression(GP_COMPRESSION compression)
+  {
+    gp_texture_data_set_compression((gp_texture_data*)GetObject(*this), compression);
+  }
+  void TextureData::Set2DHalf(const float* data, GP_FORMAT format, unsigned int width, unsigned int height)
+  {
+    gp_texture_data_set_2d_half((gp_texture_data*)GetObject(*this), data, format, width, height);
+  }
+  void TextureData::Downsample(const TextureData& source, GP_MIPMAP filter)
+  {
+    gp_texture_data_downsample((gp_texture_data*)GetObject(*this), (gp_texture_data*)GetObject(source), filter);
+  }
   
   Texture::Texture() : Object((void*)0) {}
   Texture::Texture(gp_texture* texture) : Object((gp_object*)texture) {}
@@ -299,8 +1255,119 @@ namespace GP
     async->mCallback(async->mTexture);
     delete async;
   }
+  void Texture::LoadAsync(const char* path, std::function<void(Texture*, bool)> callback)
+  {
+    LoadAsyncData* async = new LoadAsyncData();
+    async->mTexture = this;
+    async->mCallback = callback;
+    gp_texture_load_async((gp_texture*)GetObject(*this), path, &Texture::LoadAsyncCallback, async);
+  }
+  void Texture::LoadAsyncCallback(int success, void* userdata)
+  {
+    LoadAsyncData* async = (LoadAsyncData*)userdata;
+    async->mCallback(async->mTexture, success != 0);
+    delete async;
+  }
+  TextureMapping Texture::MapRegion(unsigned int x,
+                                    unsigned int y,
+                                    unsigned int width,
+                                    unsigned int height,
+                                    GP_FORMAT format,
+                                    GP_DATA_TYPE type)
+  {
+    unsigned int pitch = 0;
+    gp_texture* texture = (gp_texture*)GetObject(*this);
+    void* data = gp_texture_map_region(texture, x, y, width, height, format, type, &pitch);
+    return TextureMapping(data ? texture : nullptr, data, pitch);
+  }
+  void Texture::SetRegions(const void* image,
+                           GP_FORMAT format,
+                           GP_DATA_TYPE type,
+                           unsigned int rowLength,
+                           const unsigned int* regions,
+                           unsigned int count)
+  {
+    gp_texture_set_regions((gp_texture*)GetObject(*this), image, format, type, rowLength, regions, count);
+  }
+  void Texture::MapRegionAsync(unsigned int x,
+                               unsigned int y,
+                               unsigned int width,
+                               unsigned int height,
+                               GP_FORMAT format,
+                               GP_DATA_TYPE type,
+                               std::function<void(void*, unsigned int)> callback)
+  {
+    std::function<void(void*, unsigned int)>* async = new std::function<void(void*, unsigned int)>(callback);
+    gp_texture_map_region_async((gp_texture*)GetObject(*this), x, y, width, height, format, type, &Texture::MapAsyncCallback, async);
+  }
+  void Texture::MapAsyncCallback(void* data, unsigned int pitch, void* userdata)
+  {
+    std::function<void(void*, unsigned int)>* async = (std::function<void(void*, unsigned int)>*)userdata;
+    (*async)(data, pitch);
+    delete async;
+  }
+  void Texture::UnmapCommitAsync(std::function<void(Texture*)> callback)
+  {
+    AsyncData* async = new AsyncData();
+    async->mTexture = this;
+    async->mCallback = callback;
+    gp_texture_unmap_commit_async((gp_texture*)GetObject(*this), &Texture::AsyncCallback, async);
+  }
+  void Texture::Allocate(GP_FORMAT format, GP_DATA_TYPE type, unsigned int width, unsigned int height, unsigned int levels)
+  {
+    gp_texture_allocate((gp_texture*)GetObject(*this), format, type, width, height, levels);
+  }
+  void Texture::Allocate3D(GP_FORMAT format,
+                           GP_DATA_TYPE type,
+                           unsigned int width,
+                           unsigned int height,
+                           unsigned int depth,
+                           unsigned int levels)
+  {
+    gp_texture_allocate_3d((gp_texture*)GetObject(*this), format, type, width, height, depth, levels);
+  }
+  void Texture::Allocate2DArray(GP_FORMAT format,
+                                GP_DATA_TYPE type,
+                                unsigned int width,
+                                unsigned int height,
+                                unsigned int layers,
+                                unsigned int levels)
+  {
+    gp_texture_allocate_2d_array((gp_texture*)GetObject(*this), format, type, width, height, layers, levels);
+  }
+  void Texture::SetLevel(const TextureData& data, unsigned int level)
+  {
+    gp_texture_set_level((gp_texture*)GetObject(*this), (gp_texture_data*)GetObject(data), level);
+  }
+  void Texture::GenerateMipmaps() {gp_texture_generate_mipmaps((gp_texture*)GetObject(*this));}
+  void Texture::SetFilter(GP_FILTER min, GP_FILTER mag, GP_FILTER mip) {gp_texture_set_filter((gp_texture*)GetObject(*this), min, mag, mip);}
+  void Texture::SetLODBias(float bias) {gp_texture_set_lod_bias((gp_texture*)GetObject(*this), bias);}
   void Texture::SetWrapX(GP_WRAP wrap) {gp_texture_set_wrap_x((gp_texture*)GetObject(*this), wrap);}
   void Texture::SetWrapY(GP_WRAP wrap) {gp_texture_set_wrap_y((gp_texture*)GetObject(*this), wrap);}
+  void Texture::SetWrapZ(GP_WRAP wrap) {gp_texture_set_wrap_z((gp_texture*)GetObject(*this), wrap);}
+  
+  TextureMapping::TextureMapping(gp_texture* texture, void* data, unsigned int pitch)
+    : mTexture(texture), mData(data), mPitch(pitch)
+  {
+    if(mTexture) gp_object_ref((gp_object*)mTexture);
+  }
+  TextureMapping::TextureMapping(TextureMapping&& other)
+    : mTexture(other.mTexture), mData(other.mData), mPitch(other.mPitch)
+  {
+    other.mTexture = nullptr;
+    other.mData = nullptr;
+  }
+  TextureMapping::~TextureMapping() {Commit();}
+  void* TextureMapping::GetData() {return mData;}
+  unsigned int TextureMapping::GetPitch() {return mPitch;}
+  void TextureMapping::Commit()
+  {
+    if(mTexture == nullptr) return;
+    gp_texture_unmap_commit(mTexture);
+    gp_object_unref((gp_object*)mTexture);
+    mTexture = nullptr;
+    mData = nullptr;
+  }
 }
 
 #endif // __cplusplus
@@ -0,0 +1,207 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file TextureAtlas.h
+
+#ifndef __GP_TEXTURE_ATLAS_H__
+#define __GP_TEXTURE_ATLAS_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Texture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup TextureAtlas
+ * Many small images such as icons and glyphs packed into a few large
+ * textures, so they can be drawn in one batch from a single texture
+ * uniform.  Images are placed with the maximal rectangles algorithm into
+ * pages of a fixed size and a new page is added when no page has room.
+ * Inserting an image only uploads its own rectangle and removed images free
+ * their rectangle for later inserts.
+ *
+ * Every image is surrounded by #GP_TEXTURE_ATLAS_PADDING copies of its edge
+ * pixels so linear filtering does not bleed between neighbours.
+ * \{
+ */
+
+/*!
+ * Pixels of edge padding around every image.
+ */
+#define GP_TEXTURE_ATLAS_PADDING 1
+
+/*!
+ * Create a new texture atlas.
+ * \param context Context the atlas is drawn in.
+ * \param width Width of every page in pixels.
+ * \param height Height of every page in pixels.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param max_pages Maximum number of pages, or 0 for no limit.  Once every
+ *                  page is full inserts fail until images are removed.
+ * \return Newly created texture atlas.
+ */
+GP_EXPORT gp_texture_atlas* gp_texture_atlas_new(gp_context* context,
+                                                 unsigned int width,
+                                                 unsigned int height,
+                                                 GP_FORMAT format,
+                                                 GP_DATA_TYPE type,
+                                                 unsigned int max_pages);
+
+/*!
+ * Pack an image into the atlas and upload it.
+ * \param atlas Texture atlas to be used.
+ * \param data Pixels of the image in the format and type of the atlas.
+ * \param width Width of the image.
+ * \param height Height of the image.
+ * \param uv Array receiving the minimum u, v and maximum u, v of the image
+ *           in its page, or NULL.
+ * \return Entry of the image, or -1 if it does not fit.
+ */
+GP_EXPORT int gp_texture_atlas_insert(gp_texture_atlas* atlas,
+                                      const void* data,
+                                      unsigned int width,
+                                      unsigned int height,
+                                      float* uv);
+
+/*!
+ * Remove an image from the atlas.  Its rectangle is reused by later
+ * inserts, and the entry by later images.
+ * \param atlas Texture atlas to be used.
+ * \param entry Entry returned by gp_texture_atlas_insert().
+ */
+GP_EXPORT void gp_texture_atlas_remove(gp_texture_atlas* atlas, int entry);
+
+/*!
+ * Retrieve the texture coordinates of an image.
+ * \param atlas Texture atlas to be used.
+ * \param entry Entry returned by gp_texture_atlas_insert().
+ * \param uv Array receiving the minimum u, v and maximum u, v of the image.
+ * \return Page holding the image.
+ */
+GP_EXPORT unsigned int gp_texture_atlas_get_uv(gp_texture_atlas* atlas, int entry, float* uv);
+
+/*!
+ * Retrieve the number of pages.
+ * \param atlas Texture atlas to be used.
+ * \return Number of pages.
+ */
+GP_EXPORT unsigned int gp_texture_atlas_get_page_count(gp_texture_atlas* atlas);
+
+/*!
+ * Retrieve the texture of a page.
+ * \param atlas Texture atlas to be used.
+ * \param page Index of the page.
+ * \return Texture of the page.
+ */
+GP_EXPORT gp_texture* gp_texture_atlas_get_texture(gp_texture_atlas* atlas, unsigned int page);
+
+//! \} // TextureAtlas
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_texture_atlas
+   */
+  class TextureAtlas : public Object
+  {
+  public:
+    //! Constructor
+    inline TextureAtlas(gp_texture_atlas* atlas);
+    
+    //! Constructor
+    inline TextureAtlas(const Context& context,
+                        unsigned int width,
+                        unsigned int height,
+                        GP_FORMAT format,
+                        GP_DATA_TYPE type,
+                        unsigned int maxPages = 0);
+    
+    /*!
+     * Pack an image into the atlas and upload it.
+     * \param data Pixels of the image in the format and type of the atlas.
+     * \param width Width of the image.
+     * \param height Height of the image.
+     * \param uv Array receiving the texture coordinates of the image, or nullptr.
+     * \return Entry of the image, or -1 if it does not fit.
+     */
+    inline int Insert(const void* data, unsigned int width, unsigned int height, float* uv = nullptr);
+    
+    /*!
+     * Remove an image from the atlas.
+     * \param entry Entry returned by Insert().
+     */
+    inline void Remove(int entry);
+    
+    /*!
+     * Retrieve the texture coordinates of an image.
+     * \param entry Entry returned by Insert().
+     * \param uv Array receiving the minimum u, v and maximum u, v of the image.
+     * \return Page holding the image.
+     */
+    inline unsigned int GetUV(int entry, float* uv);
+    
+    /*!
+     * Retrieve the number of pages.
+     * \return Number of pages.
+     */
+    inline unsigned int GetPageCount();
+    
+    /*!
+     * Retrieve the texture of a page.
+     * \param page Index of the page.
+     * \return Texture of the page.
+     */
+    inline Texture GetTexture(unsigned int page);
+  };
+  
+  //
+  // Implementation
+  //
+  TextureAtlas::TextureAtlas(gp_texture_atlas* atlas) : Object((gp_object*)atlas) {}
+  TextureAtlas::TextureAtlas(const Context& context,
+                             unsigned int width,
+                             unsigned int height,
+                             GP_FORMAT format,
+                             GP_DATA_TYPE type,
+                             unsigned int maxPages)
+    : Object((void*)gp_texture_atlas_new((gp_context*)GetObject(context), width, height, format, type, maxPages)) {}
+  int TextureAtlas::Insert(const void* data, unsigned int width, unsigned int height, float* uv)
+  {
+    return gp_texture_atlas_insert((gp_texture_atlas*)GetObject(*this), data, width, height, uv);
+  }
+  void TextureAtlas::Remove(int entry) {gp_texture_atlas_remove((gp_texture_atlas*)GetObject(*this), entry);}
+  unsigned int TextureAtlas::GetUV(int entry, float* uv) {return gp_texture_atlas_get_uv((gp_texture_atlas*)GetObject(*this), entry, uv);}
+  unsigned int TextureAtlas::GetPageCount() {return gp_texture_atlas_get_page_count((gp_texture_atlas*)GetObject(*this));}
+  Texture TextureAtlas::GetTexture(unsigned int page)
+  {
+    return Texture(gp_texture_atlas_get_texture((gp_texture_atlas*)GetObject(*this), page));
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_TEXTURE_ATLAS_H__
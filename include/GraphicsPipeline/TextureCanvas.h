@@ -0,0 +1,211 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file TextureCanvas.h
+
+#ifndef __GP_TEXTURE_CANVAS_H__
+#define __GP_TEXTURE_CANVAS_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Texture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup TextureCanvas
+ * A CPU image mirrored in a texture, for images receiving many small
+ * scattered writes.  Writes only mark their rectangle dirty.  Overlapping
+ * and nearby rectangles are merged whenever uploading the pixels between
+ * them costs less than another upload call, and gp_texture_canvas_flush()
+ * uploads every remaining rectangle through a single staging buffer.
+ * \{
+ */
+
+/*!
+ * Bytes an upload call is assumed to cost.  Two dirty rectangles are merged
+ * when uploading their bounding rectangle copies fewer extra bytes than
+ * this.
+ */
+#define GP_TEXTURE_CANVAS_CALL_COST 16384
+
+/*!
+ * Most dirty rectangles kept before the cheapest merge is forced.
+ */
+#define GP_TEXTURE_CANVAS_MAX_RECTS 64
+
+/*!
+ * Create a new texture canvas.  The image starts out zeroed and entirely
+ * dirty.
+ * \param context Context the canvas is drawn in.
+ * \param width Width of the image in pixels.
+ * \param height Height of the image in pixels.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \return Newly created texture canvas.
+ */
+GP_EXPORT gp_texture_canvas* gp_texture_canvas_new(gp_context* context,
+                                                   unsigned int width,
+                                                   unsigned int height,
+                                                   GP_FORMAT format,
+                                                   GP_DATA_TYPE type);
+
+/*!
+ * Retrieve the CPU image.  Rows are tightly packed, so a row is width
+ * pixels long.  Changes must be marked with gp_texture_canvas_mark_dirty().
+ * \param canvas Texture canvas to be used.
+ * \return Pointer to the first pixel of the image.
+ */
+GP_EXPORT void* gp_texture_canvas_get_data(gp_texture_canvas* canvas);
+
+/*!
+ * Mark a rectangle of the image as changed.  Rectangles are clipped to the
+ * image.
+ * \param canvas Texture canvas to be used.
+ * \param x Horizontal offset of the rectangle.
+ * \param y Vertical offset of the rectangle.
+ * \param width Width of the rectangle.
+ * \param height Height of the rectangle.
+ */
+GP_EXPORT void gp_texture_canvas_mark_dirty(gp_texture_canvas* canvas,
+                                            unsigned int x,
+                                            unsigned int y,
+                                            unsigned int width,
+                                            unsigned int height);
+
+/*!
+ * Copy pixels into a rectangle of the image and mark it dirty.
+ * \param canvas Texture canvas to be used.
+ * \param data Tightly packed pixels in the format and type of the canvas.
+ * \param x Horizontal offset of the rectangle.
+ * \param y Vertical offset of the rectangle.
+ * \param width Width of the rectangle.
+ * \param height Height of the rectangle.
+ */
+GP_EXPORT void gp_texture_canvas_write(gp_texture_canvas* canvas,
+                                       const void* data,
+                                       unsigned int x,
+                                       unsigned int y,
+                                       unsigned int width,
+                                       unsigned int height);
+
+/*!
+ * Upload the dirty rectangles to the texture, usually once per frame.
+ * \param canvas Texture canvas to be used.
+ * \return Number of rectangles uploaded.
+ */
+GP_EXPORT unsigned int gp_texture_canvas_flush(gp_texture_canvas* canvas);
+
+/*!
+ * Retrieve the texture mirroring the image.
+ * \param canvas Texture canvas to be used.
+ * \return Texture of the canvas.
+ */
+GP_EXPORT gp_texture* gp_texture_canvas_get_texture(gp_texture_canvas* canvas);
+
+//! \} // TextureCanvas
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_texture_canvas
+   */
+  class TextureCanvas : public Object
+  {
+  public:
+    //! Constructor
+    inline TextureCanvas(gp_texture_canvas* canvas);
+    
+    //! Constructor
+    inline TextureCanvas(const Context& context,
+                         unsigned int width,
+                         unsigned int height,
+                         GP_FORMAT format,
+                         GP_DATA_TYPE type);
+    
+    /*!
+     * Retrieve the CPU image.
+     * \return Pointer to the first pixel of the image.
+     */
+    inline void* GetData();
+    
+    /*!
+     * Mark a rectangle of the image as changed.
+     * \param x Horizontal offset of the rectangle.
+     * \param y Vertical offset of the rectangle.
+     * \param width Width of the rectangle.
+     * \param height Height of the rectangle.
+     */
+    inline void MarkDirty(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+    
+    /*!
+     * Copy pixels into a rectangle of the image and mark it dirty.
+     * \param data Tightly packed pixels in the format and type of the canvas.
+     * \param x Horizontal offset of the rectangle.
+     * \param y Vertical offset of the rectangle.
+     * \param width Width of the rectangle.
+     * \param height Height of the rectangle.
+     */
+    inline void Write(const void* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+    
+    /*!
+     * Upload the dirty rectangles to the texture.
+     * \return Number of rectangles uploaded.
+     */
+    inline unsigned int Flush();
+    
+    /*!
+     * Retrieve the texture mirroring the image.
+     * \return Texture of the canvas.
+     */
+    inline Texture GetTexture();
+  };
+  
+  //
+  // Implementation
+  //
+  TextureCanvas::TextureCanvas(gp_texture_canvas* canvas) : Object((gp_object*)canvas) {}
+  TextureCanvas::TextureCanvas(const Context& context,
+                               unsigned int width,
+                               unsigned int height,
+                               GP_FORMAT format,
+                               GP_DATA_TYPE type)
+    : Object((void*)gp_texture_canvas_new((gp_context*)GetObject(context), width, height, format, type)) {}
+  void* TextureCanvas::GetData() {return gp_texture_canvas_get_data((gp_texture_canvas*)GetObject(*this));}
+  void TextureCanvas::MarkDirty(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+  {
+    gp_texture_canvas_mark_dirty((gp_texture_canvas*)GetObject(*this), x, y, width, height);
+  }
+  void TextureCanvas::Write(const void* data, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+  {
+    gp_texture_canvas_write((gp_texture_canvas*)GetObject(*this), data, x, y, width, height);
+  }
+  unsigned int TextureCanvas::Flush() {return gp_texture_canvas_flush((gp_texture_canvas*)GetObject(*this));}
+  Texture TextureCanvas::GetTexture() {return Texture(gp_texture_canvas_get_texture((gp_texture_canvas*)GetObject(*this)));}
+}
+
+#endif // __cplusplus
+
+#endif // __GP_TEXTURE_CANVAS_H__
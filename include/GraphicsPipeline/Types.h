@@ -65,6 +65,10 @@ extern "C" {
  * \brief \ref Texture object.
  * Graphics primative that stores multi-dimensional texture data.
  * 
+ * \typedef gp_sampler
+ * \brief \ref Sampler object.
+ * Wrap, filter and compare state applied to textures when sampled.
+ * 
  * \typedef gp_shader
  * \brief \ref Shader object.
  * Graphics primative that contains a shader program.
@@ -77,6 +81,38 @@ extern "C" {
  * \brief \ref Uniform object.
  * Graphics primative that stores data for a shader object's uniform variable.
  * 
+ * \typedef gp_shared
+ * \brief \ref Shared object.
+ * Memory shared with other processes.
+ * 
+ * \typedef gp_decimation
+ * \brief \ref Decimation object.
+ * Min/max pyramid of a time series for drawing line strips.
+ * 
+ * \typedef gp_point_cloud
+ * \brief \ref PointCloud object.
+ * Octree of point chunks streamed from disk.
+ * 
+ * \typedef gp_scroll_texture
+ * \brief \ref ScrollTexture object.
+ * Ring buffer of rows or columns for waterfall displays.
+ * 
+ * \typedef gp_texture_atlas
+ * \brief \ref TextureAtlas object.
+ * Small images packed into a few large textures.
+ * 
+ * \typedef gp_texture_canvas
+ * \brief \ref TextureCanvas object.
+ * CPU image mirrored in a texture through merged dirty rectangles.
+ * 
+ * \typedef gp_video_texture
+ * \brief \ref VideoTexture object.
+ * Planar YUV video frames converted to RGB on the GPU.
+ * 
+ * \typedef gp_virtual_texture
+ * \brief \ref VirtualTexture object.
+ * Tiled image paged into a cache texture.
+ * 
  * \typedef gp_pipeline
  * \brief \ref Pipeline object.
  * Manages a list of rendering commands.
@@ -106,9 +142,18 @@ typedef struct _gp_array gp_array;
 typedef struct _gp_array_data gp_array_data;
 typedef struct _gp_texture gp_texture;
 typedef struct _gp_texture_data gp_texture_data;
+typedef struct _gp_sampler gp_sampler;
 typedef struct _gp_shader gp_shader;
 typedef struct _gp_shader_source gp_shader_source;
 typedef struct _gp_uniform gp_uniform;
+typedef struct _gp_shared gp_shared;
+typedef struct _gp_decimation gp_decimation;
+typedef struct _gp_point_cloud gp_point_cloud;
+typedef struct _gp_scroll_texture gp_scroll_texture;
+typedef struct _gp_texture_atlas gp_texture_atlas;
+typedef struct _gp_texture_canvas gp_texture_canvas;
+typedef struct _gp_video_texture gp_video_texture;
+typedef struct _gp_virtual_texture gp_virtual_texture;
 typedef struct _gp_pipeline gp_pipeline;
 typedef struct _gp_operation gp_operation;
 typedef struct _gp_timer gp_timer;
@@ -127,6 +172,67 @@ typedef enum
   GP_WRAP_MIRROR    //!< Data will be mirored past the edge.
 } GP_WRAP;
 
+/*!
+ * Defines how texture data is filtered when sampled.
+ */
+typedef enum
+{
+  GP_FILTER_NEAREST,  //!< Use the nearest texel or mipmap level.
+  GP_FILTER_LINEAR    //!< Blend the nearest texels or mipmap levels.
+} GP_FILTER;
+
+/*!
+ * Defines how depth textures compare the reference value to the texel.
+ */
+typedef enum
+{
+  GP_COMPARE_NONE,      //!< Return the texel instead of comparing.
+  GP_COMPARE_LESS,      //!< Pass if the reference is less than the texel.
+  GP_COMPARE_LEQUAL,    //!< Pass if the reference is less or equal to the texel.
+  GP_COMPARE_GREATER,   //!< Pass if the reference is greater than the texel.
+  GP_COMPARE_GEQUAL,    //!< Pass if the reference is greater or equal to the texel.
+  GP_COMPARE_EQUAL,     //!< Pass if the reference equals the texel.
+  GP_COMPARE_NOTEQUAL,  //!< Pass if the reference differs from the texel.
+  GP_COMPARE_ALWAYS,    //!< Always pass.
+  GP_COMPARE_NEVER      //!< Never pass.
+} GP_COMPARE;
+
+/*!
+ * Defines filters used to build mipmaps on the CPU.
+ */
+typedef enum
+{
+  GP_MIPMAP_BOX,      //!< Average of every 2x2 block of texels.
+  GP_MIPMAP_KAISER    //!< Kaiser windowed sinc.  Sharper with less aliasing.
+} GP_MIPMAP;
+
+/*!
+ * Defines which lines a scroll texture appends.
+ */
+typedef enum
+{
+  GP_SCROLL_ROWS,     //!< Append rows, scrolling vertically.
+  GP_SCROLL_COLUMNS   //!< Append columns, scrolling horizontally.
+} GP_SCROLL;
+
+/*!
+ * Defines the plane layout of YUV 4:2:0 video frames.
+ */
+typedef enum
+{
+  GP_VIDEO_FORMAT_NV12,   //!< Y plane followed by an interleaved UV plane.
+  GP_VIDEO_FORMAT_I420    //!< Y, U and V planes.
+} GP_VIDEO_FORMAT;
+
+/*!
+ * Defines the matrix converting YUV video to RGB.
+ */
+typedef enum
+{
+  GP_VIDEO_COLOR_BT601,   //!< Standard definition video.
+  GP_VIDEO_COLOR_BT709    //!< High definition video.
+} GP_VIDEO_COLOR;
+
 /*!
  * Defines window behaviors.
  */
@@ -156,6 +262,21 @@ typedef enum
   GP_FORMAT_RGBA    = 4         //!< Full Red, Green, Blue and Alpha components.
 } GP_FORMAT;
 
+/*!
+ * Defines block compressed texture formats.  Every format stores blocks of
+ * 4x4 pixels.
+ */
+typedef enum
+{
+  GP_COMPRESSION_NONE,          //!< Uncompressed pixels.
+  GP_COMPRESSION_BC1,           //!< RGB at 4 bits per pixel, also known as DXT1.
+  GP_COMPRESSION_BC3,           //!< RGBA at 8 bits per pixel, also known as DXT5.
+  GP_COMPRESSION_BC4,           //!< Red at 4 bits per pixel, also known as RGTC1.
+  GP_COMPRESSION_BC5,           //!< Red and green at 8 bits per pixel, also known as RGTC2.
+  GP_COMPRESSION_ETC2_RGB,      //!< RGB at 4 bits per pixel, core in GLES3.
+  GP_COMPRESSION_ETC2_RGBA      //!< RGBA at 8 bits per pixel, core in GLES3.
+} GP_COMPRESSION;
+
 /*!
  * Defines different data types.
  */
@@ -164,7 +285,10 @@ typedef enum
   GP_DATA_TYPE_UBYTE,           //!< Unsigned 8-bit Interger
   GP_DATA_TYPE_INT,             //!< 32-bit Interger
   GP_DATA_TYPE_FLOAT,           //!< 32-bit Float
-  GP_DATA_TYPE_DOUBLE           //!< 64-bit Float
+  GP_DATA_TYPE_DOUBLE,          //!< 64-bit Float
+  GP_DATA_TYPE_HALF,            //!< 16-bit Float
+  GP_DATA_TYPE_USHORT,          //!< Unsigned 16-bit Integer, normalized to [0, 1] by textures on desktop GL
+  GP_DATA_TYPE_SHORT            //!< 16-bit Integer, normalized to [-1, 1] by textures on desktop GL
 } GP_DATA_TYPE;
 
 /*!
@@ -234,6 +358,27 @@ typedef struct
   gp_size                 size;
 } gp_rect;
 
+/*!
+ * Statistics for data staged by uploads.
+ */
+typedef struct
+{
+  unsigned long long      count;        //!< Number of staged uploads.
+  unsigned long long      bytes;        //!< Total number of bytes staged.
+  double                  seconds;      //!< Total time spent staging in seconds.
+  double                  bandwidth;    //!< Bandwidth of the last staged upload in GB/s.
+  unsigned long long      stalls;       //!< Uploads that waited for the GPU to free a staging buffer.
+} gp_upload_stats;
+
+/*!
+ * Result of a mesh optimization.
+ */
+typedef struct
+{
+  double                  acmr_before;  //!< Average cache miss ratio before optimizing.
+  double                  acmr_after;   //!< Average cache miss ratio after optimizing.
+} gp_mesh_stats;
+
 /*!
  * \brief Callback function to be used by gp_timer objects.
  * \param timer Pointer to gp_timer object that timed out.
@@ -272,6 +417,8 @@ namespace GP
   typedef gp_point Point;
   typedef gp_size Size;
   typedef gp_rect Rect;
+  typedef gp_upload_stats UploadStats;
+  typedef gp_mesh_stats MeshStats;
 }
 
 #endif // __cplusplus
@@ -0,0 +1,355 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file VertexLayout.h
+
+#ifndef __GP_VERTEX_LAYOUT_H__
+#define __GP_VERTEX_LAYOUT_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Array.h"
+#include "Pipeline.h"
+
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GP_VERTEX_LAYOUT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GP_VERTEX_LAYOUT_NEON
+#endif
+
+/*!
+ * Describe a single field of a vertex structure for use with GP::VertexLayout.
+ * \param vertex The vertex structure type.
+ * \param field Name of the field inside the vertex structure.
+ * \param index Layout index used to attach the field to the shader program.
+ */
+#define GP_VERTEX_ATTRIBUTE(vertex, field, index)\
+  GP::VertexAttribute<decltype(vertex::field), offsetof(vertex, field), index>
+
+namespace GP
+{
+  /*!
+   * \brief Maps a C++ type to the ::GP_DATA_TYPE and component count used
+   * to describe it to a draw operation.  Specialize this template to use
+   * custom vector types inside vertex structures.
+   */
+  template <typename T>
+  struct AttributeType
+  {
+    static_assert(sizeof(T) == 0, "Unsupported vertex attribute type.  Specialize GP::AttributeType for it.");
+  };
+  
+  template <> struct AttributeType<uint8_t> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_UBYTE; static const int Components = 1;};
+  template <> struct AttributeType<uint16_t> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_USHORT; static const int Components = 1;};
+  template <> struct AttributeType<int16_t> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_SHORT; static const int Components = 1;};
+  template <> struct AttributeType<int> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_INT; static const int Components = 1;};
+  template <> struct AttributeType<float> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_FLOAT; static const int Components = 1;};
+  template <> struct AttributeType<double> {static const GP_DATA_TYPE Type = GP_DATA_TYPE_DOUBLE; static const int Components = 1;};
+  
+  template <typename T, std::size_t N>
+  struct AttributeType<T[N]>
+  {
+    static_assert(AttributeType<T>::Components == 1, "Nested vertex attribute arrays are not supported.");
+    static_assert(N >= 1 && N <= 4, "Vertex attributes must have between 1 and 4 components.");
+    
+    static const GP_DATA_TYPE Type = AttributeType<T>::Type;
+    static const int Components = (int)N;
+  };
+  
+  /*!
+   * \brief Compile time description of a single vertex attribute.
+   * Normally created with the ::GP_VERTEX_ATTRIBUTE macro.
+   * \tparam T Type of the field inside the vertex structure.
+   * \tparam O Byte offset of the field inside the vertex structure.
+   * \tparam I Layout index used to attach the field to the shader program.
+   */
+  template <typename T, std::size_t O, int I>
+  struct VertexAttribute
+  {
+    static_assert(I >= 0, "Vertex attribute index must not be negative.");
+    
+    typedef T Type;
+    static const GP_DATA_TYPE DataType = AttributeType<T>::Type;
+    static const int Components = AttributeType<T>::Components;
+    static const std::size_t Offset = O;
+    static const std::size_t Size = sizeof(T);
+    static const int Index = I;
+  };
+  
+  namespace Detail
+  {
+    template <typename... Attributes>
+    struct LayoutCheck
+    {
+      static constexpr bool Overlaps(std::size_t, std::size_t) {return false;}
+      static constexpr bool HasIndex(int) {return false;}
+      static constexpr bool Disjoint() {return true;}
+      static constexpr bool UniqueIndices() {return true;}
+      static constexpr std::size_t End() {return 0;}
+      static constexpr std::size_t Bytes() {return 0;}
+    };
+    
+    template <typename First, typename... Rest>
+    struct LayoutCheck<First, Rest...>
+    {
+      static constexpr bool Overlaps(std::size_t begin, std::size_t end)
+      {
+        return (begin < First::Offset+First::Size && First::Offset < end) ||
+               LayoutCheck<Rest...>::Overlaps(begin, end);
+      }
+      static constexpr bool HasIndex(int index)
+      {
+        return First::Index == index || LayoutCheck<Rest...>::HasIndex(index);
+      }
+      static constexpr bool Disjoint()
+      {
+        return !LayoutCheck<Rest...>::Overlaps(First::Offset, First::Offset+First::Size) &&
+               LayoutCheck<Rest...>::Disjoint();
+      }
+      static constexpr bool UniqueIndices()
+      {
+        return !LayoutCheck<Rest...>::HasIndex(First::Index) && LayoutCheck<Rest...>::UniqueIndices();
+      }
+      static constexpr std::size_t End()
+      {
+        return (First::Offset+First::Size > LayoutCheck<Rest...>::End()) ?
+               First::Offset+First::Size : LayoutCheck<Rest...>::End();
+      }
+      static constexpr std::size_t Bytes()
+      {
+        return First::Size + LayoutCheck<Rest...>::Bytes();
+      }
+    };
+    
+    /*
+     * Copy count elements of Size bytes from a tightly packed source into
+     * a strided destination.  Common attribute sizes are moved with a
+     * single vector load/store per element.
+     */
+    template <std::size_t Size>
+    struct Scatter
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        for(std::size_t i=0; i<count; ++i, dst+=stride, src+=Size)
+          std::memcpy(dst, src, Size);
+      }
+    };
+
+#if defined(GP_VERTEX_LAYOUT_SSE2)
+    template <>
+    struct Scatter<16>
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        for(std::size_t i=0; i<count; ++i, dst+=stride, src+=16)
+          _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+      }
+    };
+    
+    template <>
+    struct Scatter<12>
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        // Full 16 byte loads are safe for every element except the last.
+        std::size_t i = 0;
+        for(; i+1<count; ++i, dst+=stride, src+=12)
+        {
+          __m128i v = _mm_loadu_si128((const __m128i*)src);
+          _mm_storel_epi64((__m128i*)dst, v);
+          int32_t z = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+          std::memcpy(dst+8, &z, 4);
+        }
+        if(i<count) std::memcpy(dst, src, 12);
+      }
+    };
+    
+    template <>
+    struct Scatter<8>
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        for(std::size_t i=0; i<count; ++i, dst+=stride, src+=8)
+          _mm_storel_epi64((__m128i*)dst, _mm_loadl_epi64((const __m128i*)src));
+      }
+    };
+#elif defined(GP_VERTEX_LAYOUT_NEON)
+    template <>
+    struct Scatter<16>
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        for(std::size_t i=0; i<count; ++i, dst+=stride, src+=16)
+          vst1q_u8((uint8_t*)dst, vld1q_u8((const uint8_t*)src));
+      }
+    };
+    
+    template <>
+    struct Scatter<8>
+    {
+      static void Copy(char* dst, std::size_t stride, const char* src, std::size_t count)
+      {
+        for(std::size_t i=0; i<count; ++i, dst+=stride, src+=8)
+          vst1_u8((uint8_t*)dst, vld1_u8((const uint8_t*)src));
+      }
+    };
+#endif
+  }
+  
+  /*!
+   * \brief Compile time description of an interleaved vertex structure.
+   *
+   * \code
+   * struct Vertex
+   * {
+   *   float position[3];
+   *   uint8_t color[4];
+   * };
+   * typedef GP::VertexLayout<Vertex,
+   *                          GP_VERTEX_ATTRIBUTE(Vertex, position, 0),
+   *                          GP_VERTEX_ATTRIBUTE(Vertex, color, 1)> Layout;
+   *
+   * GP::ArrayData ad = Layout::Interleave(count, positions, colors);
+   * array.SetData(ad);
+   * Layout::Apply(operation, array);
+   * \endcode
+   *
+   * \tparam Vertex Standard layout structure describing a single vertex.
+   * \tparam Attributes List of GP::VertexAttribute types describing the fields of Vertex.
+   */
+  template <typename Vertex, typename... Attributes>
+  class VertexLayout
+  {
+    typedef Detail::LayoutCheck<Attributes...> Check;
+    
+    static_assert(std::is_standard_layout<Vertex>::value, "Vertex type must be a standard layout type.");
+    static_assert(sizeof...(Attributes) > 0, "Vertex layout requires at least one attribute.");
+    static_assert(Check::End() <= sizeof(Vertex), "Vertex attribute extends past the end of the vertex.");
+    static_assert(Check::Disjoint(), "Vertex attributes overlap.");
+    static_assert(Check::UniqueIndices(), "Vertex attributes share a layout index.");
+  
+  public:
+    //! Byte offset between consecutive vertices.
+    static const int Stride = (int)sizeof(Vertex);
+    
+    /*!
+     * Add every attribute of this layout to a draw operation.
+     * \tparam Operation DrawOperation, or any type with a matching
+     *                   AddArrayByIndex().
+     * \param operation Draw operation to add the attributes to.
+     * \param array %Array containing the interleaved vertex data.
+     */
+    template <typename Operation>
+    inline static void Apply(Operation& operation, const Array& array);
+    
+    /*!
+     * Pack one tightly packed source array per attribute into interleaved vertices.
+     * \param dst Destination for count vertices.
+     * \param count Number of vertices to pack.
+     * \param sources One source array per attribute, in attribute order.
+     */
+    inline static void Interleave(Vertex* dst, std::size_t count, const typename Attributes::Type*... sources);
+    
+    /*!
+     * Pack one tightly packed source array per attribute into a newly
+     * allocated %ArrayData object.
+     * \param count Number of vertices to pack.
+     * \param sources One source array per attribute, in attribute order.
+     * \return %ArrayData ready to be uploaded.
+     */
+    inline static ArrayData Interleave(std::size_t count, const typename Attributes::Type*... sources);
+  
+  private:
+    // Vertices packed per pass so the destination block stays in cache
+    // while every attribute is scattered into it.
+    static const std::size_t BlockSize = 256;
+    
+    template <typename A, typename Operation>
+    inline static int ApplyAttribute(Operation& operation, const Array& array);
+    
+    template <typename A>
+    inline static int ScatterAttribute(char* dst, std::size_t begin, std::size_t count, const typename A::Type* src);
+  };
+  
+  //
+  // Implementation
+  //
+  template <typename Vertex, typename... Attributes>
+  const int VertexLayout<Vertex, Attributes...>::Stride;
+  
+  template <typename Vertex, typename... Attributes>
+  template <typename A, typename Operation>
+  int VertexLayout<Vertex, Attributes...>::ApplyAttribute(Operation& operation, const Array& array)
+  {
+    operation.AddArrayByIndex(array, A::Index, A::Components, A::DataType, Stride, (int)A::Offset);
+    return 0;
+  }
+  
+  template <typename Vertex, typename... Attributes>
+  template <typename Operation>
+  void VertexLayout<Vertex, Attributes...>::Apply(Operation& operation, const Array& array)
+  {
+    int expand[] = {ApplyAttribute<Attributes, Operation>(operation, array)...};
+    (void)expand;
+  }
+  
+  template <typename Vertex, typename... Attributes>
+  template <typename A>
+  int VertexLayout<Vertex, Attributes...>::ScatterAttribute(char* dst, std::size_t begin, std::size_t count, const typename A::Type* src)
+  {
+    Detail::Scatter<A::Size>::Copy(dst+A::Offset, sizeof(Vertex), (const char*)(src+begin), count);
+    return 0;
+  }
+  
+  template <typename Vertex, typename... Attributes>
+  void VertexLayout<Vertex, Attributes...>::Interleave(Vertex* dst, std::size_t count, const typename Attributes::Type*... sources)
+  {
+    // Clear padding so uploaded buffers are deterministic.
+    if(Check::Bytes() != sizeof(Vertex))
+      std::memset((void*)dst, 0, count*sizeof(Vertex));
+    
+    for(std::size_t begin=0; begin<count; begin+=BlockSize)
+    {
+      std::size_t n = (count-begin < BlockSize) ? count-begin : BlockSize;
+      char* block = (char*)(dst+begin);
+      int expand[] = {ScatterAttribute<Attributes>(block, begin, n, sources)...};
+      (void)expand;
+    }
+  }
+  
+  template <typename Vertex, typename... Attributes>
+  ArrayData VertexLayout<Vertex, Attributes...>::Interleave(std::size_t count, const typename Attributes::Type*... sources)
+  {
+    ArrayData ad((unsigned int)(count*sizeof(Vertex)));
+    Interleave((Vertex*)ad.GetData(), count, sources...);
+    return ad;
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_VERTEX_LAYOUT_H__
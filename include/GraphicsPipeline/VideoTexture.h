@@ -0,0 +1,248 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+//! \file VideoTexture.h
+
+#ifndef __GP_VIDEO_TEXTURE_H__
+#define __GP_VIDEO_TEXTURE_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Pipeline.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup VideoTexture
+ * Frames of planar YUV video converted to RGB on the GPU.  Every plane is
+ * uploaded as is to a texture of its own, one byte per sample for Y, U and
+ * V planes and two for the interleaved UV plane of NV12.  Compared to
+ * converting to RGBA on the CPU this uploads 1.5 instead of 4 bytes per
+ * pixel and leaves the conversion to the fragment shader.
+ *
+ * Fragment shaders sample frames with the #GP_SHADER_VIDEO_TEXTURE snippet,
+ * which needs GLSL 1.30 or GLSL ES 3.00, and uniforms created by
+ * gp_video_texture_set_uniforms().
+ * \{
+ */
+
+/*!
+ * GLSL helper sampling video frames.  Paste it after the version line of a
+ * fragment shader.  It declares the gpVideoY, gpVideoU, gpVideoV and
+ * gpVideoInfo uniforms, and gp_video_texture() returns the RGBA color at a
+ * texture coordinate using the BT.601 or BT.709 matrix of the frames.
+ */
+#define GP_SHADER_VIDEO_TEXTURE \
+  "uniform sampler2D gpVideoY;\n" \
+  "uniform sampler2D gpVideoU;\n" \
+  "uniform sampler2D gpVideoV;\n" \
+  "uniform vec4 gpVideoInfo;\n" \
+  "vec4 gp_video_texture(vec2 uv)\n" \
+  "{\n" \
+  "  float y = texture(gpVideoY, uv).r;\n" \
+  "  vec2 c = texture(gpVideoU, uv).rg;\n" \
+  "  c.y = mix(c.y, texture(gpVideoV, uv).r, gpVideoInfo.x);\n" \
+  "  y = mix((y - 16.0/255.0)*(255.0/219.0), y, gpVideoInfo.z);\n" \
+  "  c = mix((c - 128.0/255.0)*(255.0/224.0), c - 128.0/255.0, gpVideoInfo.z);\n" \
+  "  vec3 bt601 = vec3(y + 1.402*c.y, y - 0.344136*c.x - 0.714136*c.y, y + 1.772*c.x);\n" \
+  "  vec3 bt709 = vec3(y + 1.5748*c.y, y - 0.187324*c.x - 0.468124*c.y, y + 1.8556*c.x);\n" \
+  "  return vec4(clamp(mix(bt601, bt709, gpVideoInfo.y), 0.0, 1.0), 1.0);\n" \
+  "}\n"
+
+/*!
+ * Create a new video texture.  Frames use the BT.709 matrix when taller
+ * than 576 rows and BT.601 otherwise, with limited range, until changed
+ * with gp_video_texture_set_color().
+ * \param context Context the video texture is drawn in.
+ * \param width Width of the frames in pixels.
+ * \param height Height of the frames in pixels.
+ * \param format Layout of the planes.
+ * \return Newly created video texture.
+ */
+GP_EXPORT gp_video_texture* gp_video_texture_new(gp_context* context,
+                                                 unsigned int width,
+                                                 unsigned int height,
+                                                 GP_VIDEO_FORMAT format);
+
+/*!
+ * Set how samples are converted to RGB.
+ * \param vt Video texture to be used.
+ * \param color Conversion matrix of the frames.
+ * \param full_range 1 if samples use the full 0 to 255 range, 0 for the
+ *                   limited 16 to 235 (240 for chroma) range of most video.
+ */
+GP_EXPORT void gp_video_texture_set_color(gp_video_texture* vt, GP_VIDEO_COLOR color, int full_range);
+
+/*!
+ * Upload a frame.
+ * \param vt Video texture to be used.
+ * \param planes Pointers to the first row of the Y and UV planes for NV12,
+ *               or of the Y, U and V planes for I420.  Chroma planes are
+ *               half the width and height of the frame, rounded up.
+ * \param strides Number of bytes between rows of every plane, or NULL if
+ *                rows are tightly packed.  Strides of the interleaved UV
+ *                plane must be even.
+ */
+GP_EXPORT void gp_video_texture_set_frame(gp_video_texture* vt, const void* const* planes, const unsigned int* strides);
+
+/*!
+ * Upload a frame on the worker context.  The planes are copied before
+ * returning, so they may be reused right away.
+ * \param vt Video texture to be used.
+ * \param planes Pointers to the first row of every plane, as for
+ *               gp_video_texture_set_frame().
+ * \param strides Number of bytes between rows of every plane, or NULL if
+ *                rows are tightly packed.
+ * \param callback Called once every plane is uploaded, or NULL.
+ * \param userdata User defined data to be passed to callback.
+ */
+GP_EXPORT void gp_video_texture_set_frame_async(gp_video_texture* vt,
+                                                const void* const* planes,
+                                                const unsigned int* strides,
+                                                void (*callback)(void*),
+                                                void* userdata);
+
+/*!
+ * Create the uniforms declared by #GP_SHADER_VIDEO_TEXTURE and set them on
+ * a draw operation.  They keep referring to the planes, so later frames
+ * need no further changes.
+ * \param vt Video texture to be used.
+ * \param shader Shader of the draw operation.
+ * \param operation Draw operation sampling the video.
+ */
+GP_EXPORT void gp_video_texture_set_uniforms(gp_video_texture* vt, gp_shader* shader, gp_operation* operation);
+
+/*!
+ * Retrieve the texture of a plane.
+ * \param vt Video texture to be used.
+ * \param plane Index of the plane, 0 for Y.
+ * \return Texture of the plane, or NULL if the format has no such plane.
+ */
+GP_EXPORT gp_texture* gp_video_texture_get_plane(gp_video_texture* vt, unsigned int plane);
+
+//! \} // VideoTexture
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_video_texture
+   */
+  class VideoTexture : public Object
+  {
+  public:
+    //! Constructor
+    inline VideoTexture(gp_video_texture* vt);
+    
+    //! Constructor
+    inline VideoTexture(const Context& context, unsigned int width, unsigned int height, GP_VIDEO_FORMAT format);
+    
+    /*!
+     * Set how samples are converted to RGB.
+     * \param color Conversion matrix of the frames.
+     * \param fullRange True if samples use the full 0 to 255 range.
+     */
+    inline void SetColor(GP_VIDEO_COLOR color, bool fullRange = false);
+    
+    /*!
+     * Upload a frame.
+     * \param planes Pointers to the first row of every plane.
+     * \param strides Number of bytes between rows of every plane, or nullptr.
+     */
+    inline void SetFrame(const void* const* planes, const unsigned int* strides = nullptr);
+    
+    /*!
+     * Upload a frame on the worker context.
+     * \param planes Pointers to the first row of every plane.
+     * \param strides Number of bytes between rows of every plane, or nullptr.
+     * \param callback Callback function to be called when upload is complete.
+     */
+    inline void SetFrameAsync(const void* const* planes, const unsigned int* strides, std::function<void(VideoTexture*)> callback);
+    
+    /*!
+     * Create the uniforms declared by #GP_SHADER_VIDEO_TEXTURE and set them
+     * on a draw operation.
+     * \param shader Shader of the draw operation.
+     * \param operation Draw operation sampling the video.
+     */
+    inline void SetUniforms(const Shader& shader, const DrawOperation& operation);
+    
+    /*!
+     * Retrieve the texture of a plane.
+     * \param plane Index of the plane, 0 for Y.
+     * \return Texture of the plane.
+     */
+    inline Texture GetPlane(unsigned int plane);
+  
+  private:
+    struct AsyncData
+    {
+      VideoTexture* mTexture;
+      std::function<void(VideoTexture*)> mCallback;
+    };
+    inline static void AsyncCallback(void* data);
+  };
+  
+  //
+  // Implementation
+  //
+  VideoTexture::VideoTexture(gp_video_texture* vt) : Object((gp_object*)vt) {}
+  VideoTexture::VideoTexture(const Context& context, unsigned int width, unsigned int height, GP_VIDEO_FORMAT format)
+    : Object((void*)gp_video_texture_new((gp_context*)GetObject(context), width, height, format)) {}
+  void VideoTexture::SetColor(GP_VIDEO_COLOR color, bool fullRange)
+  {
+    gp_video_texture_set_color((gp_video_texture*)GetObject(*this), color, fullRange ? 1 : 0);
+  }
+  void VideoTexture::SetFrame(const void* const* planes, const unsigned int* strides)
+  {
+    gp_video_texture_set_frame((gp_video_texture*)GetObject(*this), planes, strides);
+  }
+  void VideoTexture::SetFrameAsync(const void* const* planes, const unsigned int* strides, std::function<void(VideoTexture*)> callback)
+  {
+    AsyncData* async = new AsyncData;
+    async->mTexture = this;
+    async->mCallback = callback;
+    gp_video_texture_set_frame_async((gp_video_texture*)GetObject(*this), planes, strides, &VideoTexture::AsyncCallback, async);
+  }
+  void VideoTexture::AsyncCallback(void* data)
+  {
+    AsyncData* async = (AsyncData*)data;
+    async->mCallback(async->mTexture);
+    delete async;
+  }
+  void VideoTexture::SetUniforms(const Shader& shader, const DrawOperation& operation)
+  {
+    gp_video_texture_set_uniforms((gp_video_texture*)GetObject(*this), (gp_shader*)GetObject(shader), (gp_operation*)GetObject(operation));
+  }
+  Texture VideoTexture::GetPlane(unsigned int plane)
+  {
+    return Texture(gp_video_texture_get_plane((gp_video_texture*)GetObject(*this), plane));
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_VIDEO_TEXTURE_H__
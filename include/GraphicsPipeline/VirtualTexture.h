@@ -0,0 +1,293 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+//! \file VirtualTexture.h
+
+#ifndef __GP_VIRTUAL_TEXTURE_H__
+#define __GP_VIRTUAL_TEXTURE_H__
+
+#include "Common.h"
+#include "Types.h"
+#include "Context.h"
+#include "Object.h"
+#include "Texture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * \defgroup VirtualTexture
+ * Images larger than the largest texture the GPU supports, or than fits in
+ * its memory.  The image is split into square tiles in a mipmap pyramid,
+ * where the top level is a single tile.  gp_virtual_texture_update() picks
+ * the tiles covering the visible region at the resolution of the screen,
+ * reads missing tiles through a loader on the worker thread and streams
+ * them with asynchronous texture uploads into slots of a cache texture,
+ * evicting the least recently used tiles once the cache is full.
+ *
+ * A page table texture holds the cache slot of every tile, or of its
+ * closest loaded ancestor so missing tiles draw blurry instead of black.
+ * Shaders sample the image with the #GP_SHADER_VIRTUAL_TEXTURE snippet,
+ * which needs GLSL 1.30 or GLSL ES 3.00.
+ * \{
+ */
+
+/*!
+ * Default width and height of a tile in pixels.
+ */
+#define GP_VIRTUAL_TEXTURE_TILE_SIZE 256
+
+/*!
+ * Pixels copied from neighbouring tiles around every tile so linear
+ * filtering does not bleed between cache slots.
+ */
+#define GP_VIRTUAL_TEXTURE_BORDER 1
+
+/*!
+ * GLSL helper sampling a virtual texture.  Paste it after the version line
+ * of a fragment shader.  gp_virtual_texture() returns the color at a
+ * texture coordinate given the page table and cache textures and the
+ * vector returned by gp_virtual_texture_get_info().  Regions without any
+ * loaded tile are transparent black.
+ */
+#define GP_SHADER_VIRTUAL_TEXTURE \
+  "vec4 gp_virtual_texture(sampler2D pageTable, sampler2D cache, vec4 info, vec2 uv)\n" \
+  "{\n" \
+  "  vec2 texel = uv*info.xy;\n" \
+  "  float lod = log2(max(length(dFdx(texel)), length(dFdy(texel))));\n" \
+  "  int level = int(clamp(floor(lod), 0.0, info.w - 1.0));\n" \
+  "  ivec2 page = clamp(ivec2(texel/(info.z*exp2(float(level)))), ivec2(0), textureSize(pageTable, level) - 1);\n" \
+  "  vec4 entry = floor(texelFetch(pageTable, page, level)*255.0 + 0.5);\n" \
+  "  if(entry.a == 0.0) return vec4(0.0);\n" \
+  "  vec2 local = clamp(texel/exp2(entry.b) - floor(texel/(info.z*exp2(entry.b)))*info.z, 0.0, info.z);\n" \
+  "  vec2 position = entry.xy*(info.z + 2.0) + 1.0 + local;\n" \
+  "  return textureLod(cache, position/vec2(textureSize(cache, 0)), 0.0);\n" \
+  "}\n"
+
+/*!
+ * Create a new virtual texture.
+ * \param context Context the virtual texture is drawn in.
+ * \param width Width of the image in pixels.
+ * \param height Height of the image in pixels.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param tile_size Width and height of a tile, usually
+ *                  #GP_VIRTUAL_TEXTURE_TILE_SIZE.
+ * \param cache_tiles Number of tile slots along each side of the cache
+ *                    texture, at most 255.  The cache texture is
+ *                    cache_tiles*(tile_size + 2*#GP_VIRTUAL_TEXTURE_BORDER)
+ *                    pixels wide, which must be supported by the GPU.
+ * \return Newly created virtual texture or NULL on failure.
+ */
+GP_EXPORT gp_virtual_texture* gp_virtual_texture_new(gp_context* context,
+                                                     unsigned int width,
+                                                     unsigned int height,
+                                                     GP_FORMAT format,
+                                                     GP_DATA_TYPE type,
+                                                     unsigned int tile_size,
+                                                     unsigned int cache_tiles);
+
+/*!
+ * Set the function reading tiles.  The loader fills data with
+ * tile_size + 2*#GP_VIRTUAL_TEXTURE_BORDER rows of as many pixels, in the
+ * format and type of the virtual texture.  Pixel (i, j) of data is pixel
+ * (x*tile_size + i - border, y*tile_size + j - border) of the image at the
+ * level, clamped to the edges of the level.  As for mipmaps, a level is
+ * half the size of the level below, rounded down.
+ * gp_virtual_texture_extract_tile() cuts tiles out of whole levels.  Tiles
+ * requested by gp_virtual_texture_update() are loaded on the worker thread,
+ * one at a time, so the loader must not touch state owned by the main
+ * thread.  It returns 1 on success or 0 on failure, in which case the tile
+ * is not requested again.
+ * \param vt Virtual texture to be used.
+ * \param loader Function filling the pixels of a tile.
+ * \param userdata User defined data to be passed to loader.
+ */
+GP_EXPORT void gp_virtual_texture_set_loader(gp_virtual_texture* vt,
+                                             int (*loader)(void* userdata,
+                                                           unsigned int level,
+                                                           unsigned int x,
+                                                           unsigned int y,
+                                                           void* data),
+                                             void* userdata);
+
+/*!
+ * Retrieve the number of levels in the tile pyramid.
+ * \param vt Virtual texture to be used.
+ * \return Number of levels, where the last level is a single tile.
+ */
+GP_EXPORT unsigned int gp_virtual_texture_get_levels(gp_virtual_texture* vt);
+
+/*!
+ * Retrieve the page table texture, to be bound to the pageTable sampler of
+ * gp_virtual_texture().
+ * \param vt Virtual texture to be used.
+ * \return Page table texture.
+ */
+GP_EXPORT gp_texture* gp_virtual_texture_get_page_table(gp_virtual_texture* vt);
+
+/*!
+ * Retrieve the cache texture, to be bound to the cache sampler of
+ * gp_virtual_texture().
+ * \param vt Virtual texture to be used.
+ * \return Cache texture.
+ */
+GP_EXPORT gp_texture* gp_virtual_texture_get_cache(gp_virtual_texture* vt);
+
+/*!
+ * Retrieve the vector passed as info to gp_virtual_texture().
+ * \param vt Virtual texture to be used.
+ * \param info Array receiving the width, height, tile size and number of
+ *             levels.
+ */
+GP_EXPORT void gp_virtual_texture_get_info(gp_virtual_texture* vt, float* info);
+
+/*!
+ * Select the tiles covering the visible region and request missing tiles.
+ * Should be called every frame the view changes and while tiles are
+ * missing.
+ * \param vt Virtual texture to be used.
+ * \param region Visible texture coordinates as minimum u, v and maximum u, v.
+ * \param width Number of screen pixels covered by the width of the region.
+ * \param height Number of screen pixels covered by the height of the region.
+ * \return Number of selected tiles that are not loaded yet.
+ */
+GP_EXPORT unsigned int gp_virtual_texture_update(gp_virtual_texture* vt,
+                                                 const float* region,
+                                                 unsigned int width,
+                                                 unsigned int height);
+
+/*!
+ * Copy a tile with its border out of a whole level of an image, for loaders
+ * of images that fit in memory or are memory mapped.
+ * \param image Pixels of the level.
+ * \param width Width of the level.
+ * \param height Height of the level.
+ * \param format Number of values per color value.
+ * \param type The data type for data values.
+ * \param tile_size Width and height of a tile.
+ * \param x Horizontal index of the tile.
+ * \param y Vertical index of the tile.
+ * \param data Receives tile_size + 2*#GP_VIRTUAL_TEXTURE_BORDER rows of as
+ *             many pixels.
+ */
+GP_EXPORT void gp_virtual_texture_extract_tile(const void* image,
+                                               unsigned int width,
+                                               unsigned int height,
+                                               GP_FORMAT format,
+                                               GP_DATA_TYPE type,
+                                               unsigned int tile_size,
+                                               unsigned int x,
+                                               unsigned int y,
+                                               void* data);
+
+//! \} // VirtualTexture
+
+#ifdef __cplusplus
+}
+
+namespace GP
+{
+  /*!
+   * \brief Wrapper class for ::gp_virtual_texture
+   */
+  class VirtualTexture : public Object
+  {
+  public:
+    //! Constructor
+    inline VirtualTexture(gp_virtual_texture* vt);
+    
+    //! Constructor
+    inline VirtualTexture(const Context& context,
+                          unsigned int width,
+                          unsigned int height,
+                          GP_FORMAT format,
+                          GP_DATA_TYPE type,
+                          unsigned int tileSize,
+                          unsigned int cacheTiles);
+    
+    /*!
+     * Set the function reading tiles.
+     * \param loader Function filling the pixels of a tile.
+     * \param userdata User defined data to be passed to loader.
+     */
+    inline void SetLoader(int (*loader)(void*, unsigned int, unsigned int, unsigned int, void*), void* userdata);
+    
+    /*!
+     * Retrieve the number of levels in the tile pyramid.
+     * \return Number of levels.
+     */
+    inline unsigned int GetLevels();
+    
+    /*!
+     * Retrieve the page table texture.
+     * \return Page table texture.
+     */
+    inline Texture GetPageTable();
+    
+    /*!
+     * Retrieve the cache texture.
+     * \return Cache texture.
+     */
+    inline Texture GetCache();
+    
+    /*!
+     * Retrieve the vector passed as info to gp_virtual_texture().
+     * \param info Array receiving the width, height, tile size and levels.
+     */
+    inline void GetInfo(float* info);
+    
+    /*!
+     * Select the tiles covering the visible region and request missing tiles.
+     * \param region Visible texture coordinates as minimum u, v and maximum u, v.
+     * \param width Number of screen pixels covered by the width of the region.
+     * \param height Number of screen pixels covered by the height of the region.
+     * \return Number of selected tiles that are not loaded yet.
+     */
+    inline unsigned int Update(const float* region, unsigned int width, unsigned int height);
+  };
+  
+  //
+  // Implementation
+  //
+  VirtualTexture::VirtualTexture(gp_virtual_texture* vt) : Object((gp_object*)vt) {}
+  VirtualTexture::VirtualTexture(const Context& context,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 GP_FORMAT format,
+                                 GP_DATA_TYPE type,
+                                 unsigned int tileSize,
+                                 unsigned int cacheTiles)
+    : Object((void*)gp_virtual_texture_new((gp_context*)GetObject(context), width, height, format, type, tileSize, cacheTiles)) {}
+  void VirtualTexture::SetLoader(int (*loader)(void*, unsigned int, unsigned int, unsigned int, void*), void* userdata)
+  {
+    gp_virtual_texture_set_loader((gp_virtual_texture*)GetObject(*this), loader, userdata);
+  }
+  unsigned int VirtualTexture::GetLevels() {return gp_virtual_texture_get_levels((gp_virtual_texture*)GetObject(*this));}
+  Texture VirtualTexture::GetPageTable() {return Texture(gp_virtual_texture_get_page_table((gp_virtual_texture*)GetObject(*this)));}
+  Texture VirtualTexture::GetCache() {return Texture(gp_virtual_texture_get_cache((gp_virtual_texture*)GetObject(*this)));}
+  void VirtualTexture::GetInfo(float* info) {gp_virtual_texture_get_info((gp_virtual_texture*)GetObject(*this), info);}
+  unsigned int VirtualTexture::Update(const float* region, unsigned int width, unsigned int height)
+  {
+    return gp_virtual_texture_update((gp_virtual_texture*)GetObject(*this), region, width, height);
+  }
+}
+
+#endif // __cplusplus
+
+#endif // __GP_VIRTUAL_TEXTURE_H__
@@ -16,7 +16,10 @@
 ************************************************************************/
 
 #include <GraphicsPipeline/Array.h>
+#include <GraphicsPipeline/Convert.h>
+#include <GraphicsPipeline/Half.h>
 #include <GraphicsPipeline/Logging.h>
+#include <GraphicsPipeline/Precision.h>
 
 #include "Config.h"
 
@@ -27,14 +30,19 @@
 #endif // GP_GL
 #include "GL.h"
 
+#include "../../Utils/Shared.h"
+
 #include <stdlib.h>
 #include <string.h>
 
+#define GP_SPLIT_BLOCK 256
+
 void _gp_array_data_free(gp_object* object)
 {
   gp_array_data* data = (gp_array_data*)object;
   
-  if(data->mData) free(data->mData);
+  if(data->mShared) gp_object_unref((gp_object*)data->mShared);
+  else if(data->mData) free(data->mData);
   free(data);
 }
 
@@ -45,6 +53,10 @@ gp_array_data* gp_array_data_new()
   data->mData = NULL;
   data->mSize = 0;
   data->mOffset = -1;
+  data->mType = GP_DATA_TYPE_UBYTE;
+  data->mStorage = GP_DATA_TYPE_UBYTE;
+  data->mShared = NULL;
+  data->mSequence = 0;
   
   return data;
 }
@@ -56,19 +68,58 @@ gp_array_data* gp_array_data_new_with_size(unsigned int size)
   data->mData = malloc(size);
   data->mSize = size;
   data->mOffset = -1;
+  data->mType = GP_DATA_TYPE_UBYTE;
+  data->mStorage = GP_DATA_TYPE_UBYTE;
+  data->mShared = NULL;
+  data->mSequence = 0;
+  
+  return data;
+}
+
+gp_array_data* gp_array_data_new_shared(gp_shared* shared)
+{
+  if(shared == NULL)
+  {
+    gp_log_error("Shared memory is required for shared array data");
+    return NULL;
+  }
+  
+  gp_array_data* data = malloc(sizeof(gp_array_data));
+  _gp_object_init(&data->mObject, _gp_array_data_free);
+  data->mData = gp_shared_get_data(shared);
+  data->mSize = gp_shared_get_size(shared);
+  data->mOffset = -1;
+  data->mType = GP_DATA_TYPE_UBYTE;
+  data->mStorage = GP_DATA_TYPE_UBYTE;
+  data->mShared = shared;
+  data->mSequence = 0;
+  
+  gp_object_ref((gp_object*)shared);
   
   return data;
 }
 
 void gp_array_data_allocate(gp_array_data* ad, unsigned int size)
 {
-  if(ad->mData == NULL) ad->mData = malloc(size);
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  
+  if(ad->mData == NULL || size > ad->mSize) ad->mData = realloc(ad->mData, size);
   
   ad->mSize = size;
 }
 
 void gp_array_data_set(gp_array_data* ad, void* data, unsigned int size)
 {
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  
   if(ad->mData == NULL) ad->mData = malloc(size);
   
   memcpy(ad->mData, data, size);
@@ -78,6 +129,12 @@ void gp_array_data_set(gp_array_data* ad, void* data, unsigned int size)
 
 void gp_array_data_set_chunk(gp_array_data* ad, void* data, unsigned int size, unsigned int offset)
 {
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  
   if(ad->mData == NULL) ad->mData = malloc(size);
   
   memcpy(ad->mData, data, size);
@@ -85,6 +142,94 @@ void gp_array_data_set_chunk(gp_array_data* ad, void* data, unsigned int size, u
   ad->mOffset = offset;
 }
 
+void gp_array_data_set_double_split(gp_array_data* ad, const double* data, unsigned int components, unsigned int count)
+{
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  if(components < 1 || components > 4)
+  {
+    gp_log_error("Elements must have 1 to 4 components");
+    return;
+  }
+  
+  const unsigned int size = sizeof(float)*components*count*2;
+  ad->mData = realloc(ad->mData, size);
+  ad->mSize = size;
+  ad->mOffset = -1;
+  
+  // Split in blocks that stay in the cache, then interleave the high and low
+  // parts of each element.
+  float high[GP_SPLIT_BLOCK*4];
+  float low[GP_SPLIT_BLOCK*4];
+  const size_t bytes = sizeof(float)*components;
+  
+  float* out = (float*)ad->mData;
+  unsigned int i, j;
+  for(i=0; i<count; i+=GP_SPLIT_BLOCK)
+  {
+    unsigned int n = count-i;
+    if(n > GP_SPLIT_BLOCK) n = GP_SPLIT_BLOCK;
+    
+    gp_double_split(data + i*components, high, low, n*components);
+    for(j=0; j<n; ++j)
+    {
+      memcpy(out, high + j*components, bytes);
+      memcpy(out + components, low + j*components, bytes);
+      out += components*2;
+    }
+  }
+}
+
+void gp_array_data_set_double_relative(gp_array_data* ad,
+                                       const double* data,
+                                       unsigned int components,
+                                       unsigned int count,
+                                       const double* origin)
+{
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  if(components < 1 || components > 4)
+  {
+    gp_log_error("Elements must have 1 to 4 components");
+    return;
+  }
+  
+  const unsigned int size = sizeof(float)*components*count;
+  ad->mData = realloc(ad->mData, size);
+  ad->mSize = size;
+  ad->mOffset = -1;
+  
+  gp_double_rebase(data, (float*)ad->mData, components, count, origin);
+}
+
+void gp_array_data_set_half(gp_array_data* ad, const float* data, unsigned int count)
+{
+  if(ad->mShared)
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return;
+  }
+  
+  const unsigned int size = sizeof(uint16_t)*count;
+  ad->mData = realloc(ad->mData, size);
+  ad->mSize = size;
+  ad->mOffset = -1;
+  
+  gp_half_from_float(data, (uint16_t*)ad->mData, count);
+}
+
+void gp_array_data_set_conversion(gp_array_data* ad, GP_DATA_TYPE type, GP_DATA_TYPE storage)
+{
+  ad->mType = type;
+  ad->mStorage = storage;
+}
+
 void* gp_array_data_get_data(gp_array_data* ad)
 {
   return ad->mData;
@@ -95,11 +240,21 @@ unsigned int gp_array_data_get_size(gp_array_data* ad)
   return ad->mSize;
 }
 
+unsigned int gp_array_data_get_sequence(gp_array_data* ad)
+{
+  return ad->mSequence;
+}
+
+gp_shared* gp_array_data_get_shared(gp_array_data* ad)
+{
+  return ad->mShared;
+}
+
 void _gp_array_free(gp_object* object)
 {
   gp_array* array = (gp_array*)object;
   
-  glDeleteBuffers(1, &array->mVBO);
+  _gp_handle_release(&array->mVBO);
   free(array);
 }
 
@@ -107,23 +262,101 @@ gp_array* gp_array_new(gp_context* context)
 {
   gp_array* array = malloc(sizeof(gp_array));
   _gp_object_init(&array->mObject, _gp_array_free);
-  glGenBuffers(1, &array->mVBO);
+  _gp_handle_init(&array->mVBO, GP_HANDLE_BUFFER);
+  array->mTarget = GL_ARRAY_BUFFER;
   
   return array;
 }
 
-void gp_array_set_data(gp_array* array, gp_array_data* data)
+gp_array* gp_array_new_index(gp_context* context)
+{
+  gp_array* array = gp_array_new(context);
+  array->mTarget = GL_ELEMENT_ARRAY_BUFFER;
+  
+  return array;
+}
+
+static void _gp_array_upload(gp_array* array, gp_array_data* data)
 {
-  glBindBuffer(GL_ARRAY_BUFFER, array->mVBO);
+#ifndef GP_GLES2
+  // The element buffer binding is part of the VAO state, so binding an index
+  // array with the last drawn VAO still bound would change how it draws.
+  if(array->mTarget == GL_ELEMENT_ARRAY_BUFFER)
+    glBindVertexArray(0);
+#endif
+  glBindBuffer(array->mTarget, _gp_handle_get(&array->mVBO));
+  
+  // Sizes and offsets of converted data scale with the size of the values.
+  const int convert = data->mType != data->mStorage;
+  const size_t typeSize = gp_data_type_get_size(data->mType);
+  const size_t storageSize = gp_data_type_get_size(data->mStorage);
+  const size_t count = data->mSize/typeSize;
+  const size_t size = convert ? count*storageSize : data->mSize;
+  const GLintptr offset = data->mOffset < 0 ? 0 : (GLintptr)(data->mOffset/typeSize*storageSize);
+  
+#ifndef GP_WEB
+  // Large uploads are staged through a mapping so the copy can be spread
+  // across threads instead of done by the driver on this one, and data is
+  // converted straight into the mapping.
+  if(size >= GP_COPY_PARALLEL_SIZE)
+  {
+    if(data->mOffset < 0)
+      glBufferData(array->mTarget, size, NULL, GL_STATIC_DRAW);
+    
+    void* ptr = glMapBufferRange(array->mTarget, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    if(ptr)
+    {
+      if(convert)
+        _gp_staging_convert(ptr, GP_FORMAT_R, data->mStorage, data->mData, GP_FORMAT_R, data->mType, NULL, count);
+      else
+        _gp_staging_copy(ptr, data->mData, size);
+      glUnmapBuffer(array->mTarget);
+      return;
+    }
+  }
+#endif
+  
+  const void* d = data->mData;
+  void* converted = NULL;
+  if(convert)
+  {
+    converted = malloc(size);
+    gp_convert(data->mData, GP_FORMAT_R, data->mType, converted, GP_FORMAT_R, data->mStorage, NULL, count);
+    d = converted;
+  }
   
   if(data->mOffset < 0)
   {
-    glBufferData(GL_ARRAY_BUFFER, data->mSize, data->mData, GL_STATIC_DRAW);
+    glBufferData(array->mTarget, size, d, GL_STATIC_DRAW);
   }
   else
   {
-    glBufferSubData(GL_ARRAY_BUFFER, data->mOffset, data->mSize, data->mData);
+    glBufferSubData(array->mTarget, offset, size, d);
   }
+  
+  if(converted) free(converted);
+}
+
+void gp_array_set_data(gp_array* array, gp_array_data* data)
+{
+  if(data->mShared == NULL)
+  {
+    _gp_array_upload(array, data);
+    return;
+  }
+  
+  // NOTE: The frame is copied out of the shared memory before uploading, so
+  // a torn frame never reaches the GPU and the array keeps the last one.
+  gp_array_data frame = *data;
+  frame.mData = malloc(data->mSize);
+  frame.mShared = NULL;
+  
+  if(_gp_shared_read(data->mShared, frame.mData, data->mSize, GP_SHARED_UPLOAD_TRIES, &data->mSequence))
+    _gp_array_upload(array, &frame);
+  else
+    gp_log_debug("Shared array data changed during upload, frame skipped");
+  
+  free(frame.mData);
 }
 
 typedef struct
@@ -143,6 +376,8 @@ void _gp_array_async_func(void* userdata)
   gp_object_unref((gp_object*)async->mArray);
   gp_object_unref((gp_object*)async->mData);
   
+  _gp_handle_collect(GP_HANDLE_WORKER);
+  
   glFlush();
 }
 
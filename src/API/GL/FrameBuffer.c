@@ -153,7 +153,7 @@ void gp_frame_buffer_attach(gp_frame_buffer* fb, gp_texture* texture)
   gp_object_unref((gp_object*)data);
   
   glBindFramebuffer(GL_FRAMEBUFFER, fb->mFBO);
-  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->mTexture, 0);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gp_handle_get(&texture->mTexture), 0);
   glBindFramebuffer(GL_FRAMEBUFFER, 0);
   CHECK_GL_ERROR()
 }
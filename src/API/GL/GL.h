@@ -23,10 +23,13 @@
 #include <GraphicsPipeline/Types.h>
 #include <GraphicsPipeline/Common.h>
 
+#include "../../Utils/Copy.h"
 #include "../../Utils/List.h"
 #include "../../Utils/Object.h"
 #include "../../Utils/RefCounter.h"
 
+#include <stdint.h>
+
 #ifdef GP_GL
 #ifndef __APPLE__
 #include <GL/gl.h>
@@ -48,6 +51,49 @@
   }\
 }
 
+#define GP_HANDLE_BUFFER          0
+#define GP_HANDLE_TEXTURE         1
+#define GP_HANDLE_PROGRAM         2   // Released through the queue only.
+#define GP_HANDLE_SAMPLER         3   // Released through the queue only.
+#define GP_HANDLE_TYPES           4
+
+#define GP_HANDLE_RENDER          0   // Context drawing frames.
+#define GP_HANDLE_WORKER          1   // Context running _gp_api_work jobs.
+#define GP_HANDLE_CONTEXTS        2
+
+#define GP_STAGING_MIN_CLASS      16  // Smallest staging buffer is 64KB.
+#define GP_STAGING_CLASSES        11  // Largest ring buffer is 64MB, bigger uploads get their own.
+#define GP_STAGING_RING           3   // Staging buffers kept per size class.
+
+// Attempts to upload a consistent frame from shared memory.
+#define GP_SHARED_UPLOAD_TRIES    4
+
+// Images read and decoded per pool thread by each texture load job.
+#define GP_TEXTURE_LOAD_BATCH     4
+
+/*
+ * GL object name published by one thread and read by others without a
+ * lock.  Loads acquire and stores release, so a non-zero name is only seen
+ * once the object behind it is complete.
+ */
+#ifdef GP_ATOMICS
+typedef _Atomic(GLuint) _gp_name;
+#else
+typedef volatile GLuint _gp_name;
+#endif
+
+/*
+ * Name of a GL object that is generated the first time it is used.
+ * Handles can be created from any thread, even one without a current
+ * context.  Pending names are generated in bulk with a single glGen* call.
+ */
+typedef struct
+{
+  gp_list_node            mNode;            // In the pending list until the name is published
+  _gp_name                mName;
+  int                     mType;
+} _gp_handle;
+
 typedef struct
 {
   GLenum                  mBlendEquation;
@@ -59,6 +105,7 @@ struct _gp_texture_cache_list
 {
   gp_list_node            mNode;
   gp_texture*             mTexture;
+  gp_sampler*             mSampler;
   int                     mIndex;
 };
 typedef struct _gp_texture_cache_list gp_texture_cache_list;
@@ -87,14 +134,35 @@ struct _gp_array_data
   void*                   mData;
   unsigned int            mSize;
   int                     mOffset;
+  GP_DATA_TYPE            mType;            // Type of the stored values
+  GP_DATA_TYPE            mStorage;         // Type of the uploaded values
+  gp_shared*              mShared;          // Backing shared memory or NULL
+  unsigned int            mSequence;        // Last uploaded shared frame
 };
 
 struct _gp_array
 {
   gp_object               mObject;
-  GLuint                  mVBO;
+  _gp_handle              mVBO;
+  GLenum                  mTarget;          // GL_ELEMENT_ARRAY_BUFFER for index arrays
 };
 
+#ifndef GP_WEB
+/*
+ * Pixel unpack buffer reused by uploads of the same size class.  The fence
+ * signals once the GPU has finished reading the last upload from it.
+ */
+typedef struct
+{
+  GLuint                  mBuffer;
+#ifndef GP_GLES2
+  GLsync                  mFence;
+#endif
+  int                     mBusy;
+  int                     mTransient;
+} _gp_staging_buffer;
+#endif
+
 struct _gp_texture_data
 {
   gp_object               mObject;
@@ -104,18 +172,51 @@ struct _gp_texture_data
   GP_DATA_TYPE            mType;
   unsigned int            mWidth;
   unsigned int            mHeight;
+  unsigned int            mDepth;           // Depth of 3D data or layers of array data
   int                     mWidthOffset;
   int                     mHeightOffset;
+  int                     mDepthOffset;
+  int                     mSwizzle[4];      // Component order on upload, mSwizzle[0] < 0 to keep it
+  GP_COMPRESSION          mCompression;     // Block format of mData, or none for pixels
+  GP_COMPRESSION          mCompress;        // Block format pixels are compressed to on upload
+  gp_shared*              mShared;          // Backing shared memory or NULL
+  unsigned int            mSequence;        // Last uploaded shared frame
+#ifndef GP_WEB
+  _gp_staging_buffer*     mStaging;         // Mapped buffer holding mData, uploaded without a copy
+#endif
 };
 
 struct _gp_texture
 {
   gp_object               mObject;
   GLuint                  mDimensions;
-  GLuint                  mTexture;
-  GLuint                  mPBO;
+  _gp_handle              mTexture;
   GLuint                  mWrapX;
   GLuint                  mWrapY;
+  GLuint                  mWrapZ;
+  GP_FILTER               mMinFilter;
+  GP_FILTER               mMagFilter;
+  GP_FILTER               mMipFilter;
+  float                   mLODBias;
+  
+  // Storage of the base level, reused by uploads of the same size.
+  GP_FORMAT               mFormat;
+  GP_DATA_TYPE            mType;
+  GLuint                  mInternalFormat;
+  unsigned int            mWidth;
+  unsigned int            mHeight;
+  unsigned int            mDepth;
+  unsigned int            mLevels;
+  int                     mImmutable;
+  
+  // Region mapped by gp_texture_map_region() until it is committed.
+#ifndef GP_WEB
+  _gp_staging_buffer*     mStaging;
+#endif
+  void*                   mMapped;
+  int                     mMapRegion[4];    // x, y, width, height
+  GLuint                  mMapFormat;
+  GLuint                  mMapType;
 };
 
 struct _gp_shader_source
@@ -124,6 +225,23 @@ struct _gp_shader_source
   gp_list                 mSource;
 };
 
+struct _gp_sampler_entry;
+
+struct _gp_sampler
+{
+  gp_object               mObject;
+  GP_WRAP                 mWrap[3];
+  GP_FILTER               mMinFilter;
+  GP_FILTER               mMagFilter;
+  GP_FILTER               mMipFilter;
+  float                   mAnisotropy;
+  GP_COMPARE              mCompare;
+  
+  // GL sampler shared by every sampler with the same state, resolved on
+  // first use after a change.
+  struct _gp_sampler_entry* mEntry;
+};
+
 struct _gp_shader
 {
   gp_object               mObject;
@@ -175,6 +293,65 @@ void _gp_pipeline_execute(gp_pipeline* pipeline);
 
 void _gp_pipeline_execute_with_context(gp_pipeline* pipeline, _gp_draw_context* context);
 
+void _gp_staging_copy(void* dst, const void* src, size_t size);
+
+void _gp_staging_convert(void* dst,
+                         GP_FORMAT dst_format,
+                         GP_DATA_TYPE dst_type,
+                         const void* src,
+                         GP_FORMAT src_format,
+                         GP_DATA_TYPE src_type,
+                         const int* swizzle,
+                         size_t count);
+
+/*
+ * Jobs queued with _gp_api_work, staging buffers, cached samplers and
+ * handles are process-wide rather than per context.  They assume every
+ * context shares objects with the others, as the render and worker
+ * contexts created by the platforms do.
+ */
+#ifndef GP_WEB
+_gp_staging_buffer* _gp_staging_acquire(size_t size);
+
+void _gp_staging_release(_gp_staging_buffer* buffer);
+
+void _gp_staging_discard(_gp_staging_buffer* buffer);
+
+void _gp_staging_shutdown();
+#endif
+
+GLuint _gp_wrap_to_gl(GP_WRAP wrap);
+
+uint64_t _gp_sampler_key(gp_sampler* sampler);
+
+unsigned int _gp_sampler_bucket(uint64_t key);
+
+GLuint _gp_sampler_get(gp_sampler* sampler);
+
+void _gp_sampler_shutdown();
+
+#ifdef GP_GL
+GLuint _gp_uniform_buffer_format(GP_FORMAT format, GP_DATA_TYPE type);
+#endif
+
+GLuint _gp_name_load(_gp_name* name);
+
+void _gp_name_store(_gp_name* name, GLuint value);
+
+void _gp_handle_init(_gp_handle* handle, int type);
+
+GLuint _gp_handle_get(_gp_handle* handle);
+
+void _gp_handle_release(_gp_handle* handle);
+
+void _gp_handle_generate(int type);
+
+void _gp_handle_release_name(int type, GLuint name);
+
+void _gp_handle_collect(int context);
+
+void _gp_handle_shutdown();
+
 void _gp_api_init();
 
 void _gp_api_init_context();
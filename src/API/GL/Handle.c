@@ -0,0 +1,402 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Logging.h>
+
+#include "Config.h"
+
+#ifdef GP_GL
+#ifndef __APPLE__
+#include <GL/glew.h>
+#endif // __APPLE__
+#endif // GP_GL
+#include "GL.h"
+
+#include "../../Utils/Lock.h"
+
+#include <stdlib.h>
+
+typedef struct
+{
+  GLuint*                 mNames;
+  unsigned int            mCount;
+  unsigned int            mCapacity;
+} _gp_handle_queue;
+
+/*
+ * Names released together, waiting for the GPU to finish any work that
+ * was submitted before they were released.  Both the render and worker
+ * contexts may still have commands using the objects queued, so a batch
+ * is fenced on each context before it is deleted.
+ */
+typedef struct
+{
+  gp_list_node            mNode;
+#ifndef GP_GLES2
+  GLsync                  mFences[GP_HANDLE_CONTEXTS];
+#endif
+  int                     mFenced[GP_HANDLE_CONTEXTS];
+  _gp_handle_queue        mQueues[GP_HANDLE_TYPES];
+} _gp_handle_batch;
+
+// Guards the pending handles, released names and retiring batches.
+static gp_lock sLock = GP_LOCK_INIT;
+static gp_list sPending[GP_HANDLE_TYPES];
+static _gp_handle_queue sReleased[GP_HANDLE_TYPES];
+static gp_list sRetiring;
+static int sInitialized = 0;
+static int sWorkerScheduled = 0;
+
+static void _gp_handle_lazy_init()
+{
+  if(sInitialized) return;
+
+  int i;
+  for(i=0; i<GP_HANDLE_TYPES; ++i)
+  {
+    gp_list_init(&sPending[i]);
+    sReleased[i].mNames = NULL;
+    sReleased[i].mCount = 0;
+    sReleased[i].mCapacity = 0;
+  }
+  gp_list_init(&sRetiring);
+  sInitialized = 1;
+}
+
+GLuint _gp_name_load(_gp_name* name)
+{
+#if defined(GP_ATOMICS)
+  return atomic_load_explicit(name, memory_order_acquire);
+#elif defined(_WIN32)
+  // NOTE: MSVC gives volatile accesses acquire and release semantics.
+  return *name;
+#else
+  return __atomic_load_n(name, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void _gp_name_store(_gp_name* name, GLuint value)
+{
+#if defined(GP_ATOMICS)
+  atomic_store_explicit(name, value, memory_order_release);
+#elif defined(_WIN32)
+  *name = value;
+#else
+  __atomic_store_n(name, value, __ATOMIC_RELEASE);
+#endif
+}
+
+void _gp_handle_init(_gp_handle* handle, int type)
+{
+  _gp_name_store(&handle->mName, 0);
+  handle->mType = type;
+
+  gp_lock_acquire(&sLock);
+  _gp_handle_lazy_init();
+  gp_list_push_back(&sPending[type], &handle->mNode);
+  gp_lock_release(&sLock);
+}
+
+// NOTE: sLock must be held.
+static void _gp_handle_release_name_locked(int type, GLuint name)
+{
+  _gp_handle_queue* queue = &sReleased[type];
+  if(queue->mCount == queue->mCapacity)
+  {
+    queue->mCapacity = (queue->mCapacity) ? queue->mCapacity*2 : 64;
+    queue->mNames = realloc(queue->mNames, sizeof(GLuint)*queue->mCapacity);
+  }
+  queue->mNames[queue->mCount++] = name;
+}
+
+void _gp_handle_generate(int type)
+{
+  //
+  // Take the pending handles off the list, so glGen* runs without the lock
+  // and other threads only wait for the names of this batch.  Handles
+  // released meanwhile leave the batch, and their names are released too.
+  //
+  gp_list batch;
+  gp_list_init(&batch);
+
+  gp_lock_acquire(&sLock);
+  _gp_handle_lazy_init();
+  gp_list* pending = &sPending[type];
+  unsigned int count = 0;
+  while(gp_list_front(pending) != gp_list_end(pending))
+  {
+    gp_list_node* node = gp_list_front(pending);
+    gp_list_remove(pending, node);
+    gp_list_push_back(&batch, node);
+    ++count;
+  }
+  gp_lock_release(&sLock);
+
+  if(count == 0)
+  {
+    gp_list_free(&batch);
+    return;
+  }
+
+  GLuint* names = malloc(sizeof(GLuint)*count);
+  switch(type)
+  {
+    case GP_HANDLE_BUFFER:
+      glGenBuffers(count, names);
+      break;
+    case GP_HANDLE_TEXTURE:
+      glGenTextures(count, names);
+      break;
+  }
+
+  gp_lock_acquire(&sLock);
+  unsigned int i = 0;
+  while(gp_list_front(&batch) != gp_list_end(&batch))
+  {
+    gp_list_node* node = gp_list_front(&batch);
+    gp_list_remove(&batch, node);
+    _gp_name_store(&((_gp_handle*)node)->mName, names[i++]);
+  }
+  for(; i<count; ++i)
+    _gp_handle_release_name_locked(type, names[i]);
+  gp_lock_release(&sLock);
+
+  gp_list_free(&batch);
+  free(names);
+}
+
+GLuint _gp_handle_get(_gp_handle* handle)
+{
+  // Published names never change, so binds only pay for an atomic load.
+  GLuint name = _gp_name_load(&handle->mName);
+  while(name == 0)
+  {
+    // First use of any pending handle generates every pending handle of
+    // the same type on the current context.  A handle already taken by
+    // another thread appears once that thread publishes its batch.
+    _gp_handle_generate(handle->mType);
+    name = _gp_name_load(&handle->mName);
+  }
+
+  return name;
+}
+
+void _gp_handle_release_name(int type, GLuint name)
+{
+  if(name == 0) return;
+
+  gp_lock_acquire(&sLock);
+  _gp_handle_lazy_init();
+  _gp_handle_release_name_locked(type, name);
+  gp_lock_release(&sLock);
+}
+
+void _gp_handle_release(_gp_handle* handle)
+{
+  gp_lock_acquire(&sLock);
+  GLuint name = _gp_name_load(&handle->mName);
+  if(name == 0)
+  {
+    // Never used, so there is no GL object to delete.  The handle is
+    // either pending or in a batch being generated.
+    gp_list_remove(&sPending[handle->mType], &handle->mNode);
+  }
+  else
+  {
+    // NOTE: The last reference is often dropped on a thread without a
+    // context, so the GL object is deleted later by _gp_handle_collect.
+    _gp_handle_release_name_locked(handle->mType, name);
+    _gp_name_store(&handle->mName, 0);
+  }
+  gp_lock_release(&sLock);
+}
+
+static void _gp_handle_batch_delete(_gp_handle_batch* batch)
+{
+  _gp_handle_queue* queue = batch->mQueues;
+
+  if(queue[GP_HANDLE_BUFFER].mCount)
+    glDeleteBuffers(queue[GP_HANDLE_BUFFER].mCount, queue[GP_HANDLE_BUFFER].mNames);
+  if(queue[GP_HANDLE_TEXTURE].mCount)
+    glDeleteTextures(queue[GP_HANDLE_TEXTURE].mCount, queue[GP_HANDLE_TEXTURE].mNames);
+
+#ifndef GP_GLES2
+  if(queue[GP_HANDLE_SAMPLER].mCount)
+    glDeleteSamplers(queue[GP_HANDLE_SAMPLER].mCount, queue[GP_HANDLE_SAMPLER].mNames);
+#endif
+
+  unsigned int i;
+  for(i=0; i<queue[GP_HANDLE_PROGRAM].mCount; ++i)
+    glDeleteProgram(queue[GP_HANDLE_PROGRAM].mNames[i]);
+
+  int t;
+#ifndef GP_GLES2
+  for(t=0; t<GP_HANDLE_CONTEXTS; ++t)
+    if(batch->mFenced[t]) glDeleteSync(batch->mFences[t]);
+#endif
+
+  for(t=0; t<GP_HANDLE_TYPES; ++t)
+    free(queue[t].mNames);
+  free(batch);
+}
+
+// NOTE: sLock must be held.
+static void _gp_handle_batch_locked()
+{
+  int empty = 1;
+  int t;
+  for(t=0; t<GP_HANDLE_TYPES; ++t)
+    if(sReleased[t].mCount) empty = 0;
+  if(empty) return;
+
+  _gp_handle_batch* batch = malloc(sizeof(_gp_handle_batch));
+  for(t=0; t<GP_HANDLE_TYPES; ++t)
+  {
+    batch->mQueues[t] = sReleased[t];
+    sReleased[t].mNames = NULL;
+    sReleased[t].mCount = 0;
+    sReleased[t].mCapacity = 0;
+  }
+  for(t=0; t<GP_HANDLE_CONTEXTS; ++t)
+    batch->mFenced[t] = 0;
+  gp_list_push_back(&sRetiring, &batch->mNode);
+}
+
+static void _gp_handle_collect_work(void* data)
+{
+  gp_lock_acquire(&sLock);
+  sWorkerScheduled = 0;
+  gp_lock_release(&sLock);
+
+  _gp_handle_collect(GP_HANDLE_WORKER);
+}
+
+static void _gp_handle_collect_join(void* data)
+{
+}
+
+static void _gp_handle_delete(gp_list* ready)
+{
+  gp_list_node* node = gp_list_front(ready);
+  while(node != gp_list_end(ready))
+  {
+    gp_list_node* next = gp_list_node_next(node);
+    _gp_handle_batch_delete((_gp_handle_batch*)node);
+    node = next;
+  }
+  gp_list_free(ready);
+}
+
+void _gp_handle_collect(int context)
+{
+  gp_lock_acquire(&sLock);
+  _gp_handle_lazy_init();
+
+  // Move everything released since the last collection into a new batch.
+  _gp_handle_batch_locked();
+
+  //
+  // Fence every batch this context has not fenced yet.  Commands this
+  // context submitted with the released objects all come before the fence.
+  // Batches are deleted once every context has signaled its fence.
+  //
+  gp_list ready;
+  gp_list_init(&ready);
+
+  int fenced = 0;
+  int waiting = 0;
+  gp_list_node* node = gp_list_front(&sRetiring);
+  while(node != gp_list_end(&sRetiring))
+  {
+    gp_list_node* next = gp_list_node_next(node);
+    _gp_handle_batch* batch = (_gp_handle_batch*)node;
+
+    if(!batch->mFenced[context])
+    {
+#ifndef GP_GLES2
+      batch->mFences[context] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+      batch->mFenced[context] = 1;
+      fenced = 1;
+    }
+
+    int signaled = 1;
+    int t;
+    for(t=0; t<GP_HANDLE_CONTEXTS && signaled; ++t)
+    {
+      if(!batch->mFenced[t])
+      {
+        signaled = 0;
+        if(t == GP_HANDLE_WORKER) waiting = 1;
+        continue;
+      }
+#ifndef GP_GLES2
+      GLenum status = glClientWaitSync(batch->mFences[t], 0, 0);
+      signaled = status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+#endif
+    }
+
+    if(signaled)
+    {
+      gp_list_remove(&sRetiring, node);
+      gp_list_push_back(&ready, node);
+    }
+    node = next;
+  }
+
+  // The worker context only fences when it runs a job, so queue one for
+  // batches waiting on it.  The render context fences every frame.
+  const int schedule = waiting && !sWorkerScheduled;
+  if(schedule) sWorkerScheduled = 1;
+
+  gp_lock_release(&sLock);
+
+  // Submit the fences so they signal even if this context goes idle.
+  if(fenced) glFlush();
+
+  // Delete outside of the lock with one call per object type.
+  _gp_handle_delete(&ready);
+
+  // NOTE: Web runs work immediately, so the job must not start under the lock.
+  if(schedule) _gp_api_work(_gp_handle_collect_work, _gp_handle_collect_join, NULL);
+}
+
+void _gp_handle_shutdown()
+{
+  gp_lock_acquire(&sLock);
+  _gp_handle_lazy_init();
+  _gp_handle_batch_locked();
+
+  gp_list ready;
+  gp_list_init(&ready);
+  while(gp_list_front(&sRetiring) != gp_list_end(&sRetiring))
+  {
+    gp_list_node* node = gp_list_front(&sRetiring);
+    gp_list_remove(&sRetiring, node);
+    gp_list_push_back(&ready, node);
+  }
+  gp_lock_release(&sLock);
+
+  // No more work is submitted, so wait for the GPU instead of fences.
+  glFinish();
+  _gp_handle_delete(&ready);
+  _gp_sampler_shutdown();
+
+#ifndef GP_WEB
+  _gp_staging_shutdown();
+#endif
+}
@@ -181,6 +181,7 @@ typedef struct
   gp_shader*              mShader;
   gp_list                 mArrays;
   gp_list                 mUniforms;
+  gp_array*               mIndices;
   unsigned int            mVerticies;
   GP_DRAW_MODE            mMode;
 } _gp_operation_draw;
@@ -218,7 +219,7 @@ void _gp_operation_draw_func(gp_operation* operation, _gp_draw_context* context)
   while(node != gp_list_end(&self->mArrays))
   {
     gp_array_list* array = (gp_array_list*)node;
-    glBindBuffer(GL_ARRAY_BUFFER, array->mArray->mVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, _gp_handle_get(&array->mArray->mVBO));
     
     CHECK_GL_ERROR();
     
@@ -235,6 +236,10 @@ void _gp_operation_draw_func(gp_operation* operation, _gp_draw_context* context)
     
     node = gp_list_node_next(node);
   }
+  
+  // The element buffer binding is part of the VAO state.
+  if(self->mIndices)
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _gp_handle_get(&self->mIndices->mVBO));
 #ifndef GP_GLES2
   self->mDirty = 0;
   }
@@ -249,7 +254,10 @@ void _gp_operation_draw_func(gp_operation* operation, _gp_draw_context* context)
     GL_LINE_STRIP
   };
   
-  glDrawArrays(draw_modes[self->mMode], 0, self->mVerticies);
+  if(self->mIndices)
+    glDrawElements(draw_modes[self->mMode], self->mVerticies, GL_UNSIGNED_INT, 0);
+  else
+    glDrawArrays(draw_modes[self->mMode], 0, self->mVerticies);
   CHECK_GL_ERROR();
 }
 
@@ -260,6 +268,9 @@ void _gp_operation_draw_free(gp_object* object)
   if(d->mShader)
     gp_object_unref((gp_object*)d->mShader);
   
+  if(d->mIndices)
+    gp_object_unref((gp_object*)d->mIndices);
+  
   // TODO - free VAO
   gp_list_node* node = gp_list_front(&d->mArrays);
   while(node != gp_list_end(&d->mArrays))
@@ -305,6 +316,7 @@ gp_operation* gp_operation_draw_new()
   gp_list_init(&operation->mUniforms);
   gp_list_init(&operation->mArrays);
   operation->mShader = NULL;
+  operation->mIndices = NULL;
 #ifndef GP_GLES2
   operation->mVAO = 0;
   operation->mDirty = 1;
@@ -337,6 +349,11 @@ void gp_operation_draw_add_array_by_index(gp_operation* operation,
                                           int offset)
 {
   _gp_operation_draw* self = (_gp_operation_draw*)operation;
+  if(array->mTarget != GL_ARRAY_BUFFER)
+  {
+    gp_log_error("Index arrays can not hold vertex data");
+    return;
+  }
   
   gp_array_list* a = NULL;
   
@@ -367,12 +384,23 @@ void gp_operation_draw_add_array_by_index(gp_operation* operation,
     GL_INT,
     GL_FLOAT,
 #ifdef GP_GL
-    GL_DOUBLE
+    GL_DOUBLE,
 #else
-    GL_FLOAT
+    GL_FLOAT,
 #endif
+    GL_HALF_FLOAT,
+    GL_UNSIGNED_SHORT,
+    GL_SHORT
   };
   
+#ifndef GP_GL
+  if(type == GP_DATA_TYPE_DOUBLE)
+  {
+    // NOTE: The buffer still holds doubles, so reading it as floats is wrong.
+    gp_log_error("Double arrays are not supported, use gp_array_data_set_double_split()");
+  }
+#endif
+  
   a->mArray = array;
   a->mIndex = index;
   a->mComponents = components;
@@ -387,6 +415,37 @@ void gp_operation_draw_add_array_by_index(gp_operation* operation,
 #endif
 }
 
+void gp_operation_draw_add_split_array_by_index(gp_operation* operation,
+                                                gp_array* array,
+                                                int index,
+                                                int components)
+{
+  const int stride = sizeof(float)*components*2;
+  
+  gp_operation_draw_add_array_by_index(operation, array, index, components, GP_DATA_TYPE_FLOAT, stride, 0);
+  gp_operation_draw_add_array_by_index(operation, array, index+1, components, GP_DATA_TYPE_FLOAT, stride, sizeof(float)*components);
+}
+
+void gp_operation_draw_set_indices(gp_operation* operation, gp_array* indices)
+{
+  _gp_operation_draw* self = (_gp_operation_draw*)operation;
+  if(indices && indices->mTarget != GL_ELEMENT_ARRAY_BUFFER)
+  {
+    gp_log_error("Indices must be an array created with gp_array_new_index()");
+    return;
+  }
+  
+  if(indices)
+    gp_object_ref((gp_object*)indices);
+  if(self->mIndices)
+    gp_object_unref((gp_object*)self->mIndices);
+  self->mIndices = indices;
+  
+#ifndef GP_GLES2
+  self->mDirty = 1;
+#endif
+}
+
 void gp_operation_draw_set_uniform(gp_operation* operation, gp_uniform* uniform)
 {
   _gp_operation_draw* self = (_gp_operation_draw*)operation;
@@ -633,6 +692,7 @@ void _gp_pipeline_execute(gp_pipeline* pipeline)
   {
     gp_texture_cache_list* node = malloc(sizeof(gp_texture_cache_list));
     node->mTexture = 0;
+    node->mSampler = 0;
     node->mIndex = i;
     gp_list_push_back(&context->mTextureCache, (gp_list_node*)node);
   }
@@ -652,6 +712,9 @@ void _gp_pipeline_execute(gp_pipeline* pipeline)
   }
   gp_list_free(&context->mTextureCache);
   free(context);
+  
+  // End of frame is a safe point to delete released objects.
+  _gp_handle_collect(GP_HANDLE_RENDER);
 }
 
 int _gp_pipeline_sort(gp_list_node* first, gp_list_node* second)
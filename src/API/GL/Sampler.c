@@ -0,0 +1,349 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include <GraphicsPipeline/Sampler.h>
+#include <GraphicsPipeline/Logging.h>
+
+#include "Config.h"
+
+#ifdef GP_GL
+#ifndef __APPLE__
+#include <GL/glew.h>
+#endif // __APPLE__
+#endif // GP_GL
+#include "GL.h"
+
+#include "../../Utils/Lock.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+#define GP_SAMPLER_BUCKETS 64
+
+/*
+ * GL sampler shared by every gp_sampler with the same state.
+ */
+typedef struct _gp_sampler_entry
+{
+  struct _gp_sampler_entry* mNext;
+  uint64_t                mKey;
+  _gp_name                mName;           // Zero until created, and again after shutdown
+  unsigned int            mRefs;
+} _gp_sampler_entry;
+
+// Guards the buckets, reference counts and anisotropy limit.
+static gp_lock sLock = GP_LOCK_INIT;
+static _gp_sampler_entry* sBuckets[GP_SAMPLER_BUCKETS];
+static float sMaxAnisotropy = 0.0f;   // Queried with the first anisotropic sampler
+
+uint64_t _gp_sampler_key(gp_sampler* sampler)
+{
+  uint32_t anisotropy;
+  memcpy(&anisotropy, &sampler->mAnisotropy, sizeof(uint32_t));
+  
+  return (uint64_t)sampler->mWrap[0] |
+         (uint64_t)sampler->mWrap[1] << 2 |
+         (uint64_t)sampler->mWrap[2] << 4 |
+         (uint64_t)sampler->mMinFilter << 6 |
+         (uint64_t)sampler->mMagFilter << 7 |
+         (uint64_t)sampler->mMipFilter << 8 |
+         (uint64_t)sampler->mCompare << 9 |
+         (uint64_t)anisotropy << 32;
+}
+
+unsigned int _gp_sampler_bucket(uint64_t key)
+{
+  return (unsigned int)((key*0x9E3779B97F4A7C15ull) >> 58);
+}
+
+static void _gp_sampler_release_entry(_gp_sampler_entry* entry)
+{
+  gp_lock_acquire(&sLock);
+  if(--entry->mRefs != 0)
+  {
+    gp_lock_release(&sLock);
+    return;
+  }
+  
+  _gp_sampler_entry** link = &sBuckets[_gp_sampler_bucket(entry->mKey)];
+  while(*link != entry)
+    link = &(*link)->mNext;
+  *link = entry->mNext;
+  gp_lock_release(&sLock);
+  
+  // NOTE: The last reference is often dropped on a thread without a
+  // context, so the GL sampler is deleted later by _gp_handle_collect.
+  _gp_handle_release_name(GP_HANDLE_SAMPLER, _gp_name_load(&entry->mName));
+  free(entry);
+}
+
+static void _gp_sampler_changed(gp_sampler* sampler)
+{
+  if(sampler->mEntry == NULL) return;
+  
+  _gp_sampler_release_entry(sampler->mEntry);
+  sampler->mEntry = NULL;
+}
+
+#ifndef GP_GLES2
+static float _gp_sampler_max_anisotropy()
+{
+  // Only query the limit when the extension exists, an unknown enum would
+  // raise an error that CHECK_GL_ERROR reports somewhere else.
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for(GLint i=0; i<count; ++i)
+  {
+    const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+    if(strcmp(name, "GL_EXT_texture_filter_anisotropic") == 0 ||
+       strcmp(name, "GL_ARB_texture_filter_anisotropic") == 0)
+    {
+      GLfloat max = 1.0f;
+      glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &max);
+      return max < 1.0f ? 1.0f : max;
+    }
+  }
+  
+  return 1.0f;
+}
+
+static GLuint _gp_sampler_create(gp_sampler* sampler, float* max_anisotropy)
+{
+  static const GLuint filters[2][2] = {
+    {GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST_MIPMAP_LINEAR},
+    {GL_LINEAR_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_LINEAR}
+  };
+  static const GLuint compares[] = {
+    GL_NONE, GL_LESS, GL_LEQUAL, GL_GREATER, GL_GEQUAL, GL_EQUAL, GL_NOTEQUAL, GL_ALWAYS, GL_NEVER
+  };
+  
+  GLuint name;
+  glGenSamplers(1, &name);
+  glSamplerParameteri(name, GL_TEXTURE_WRAP_S, _gp_wrap_to_gl(sampler->mWrap[0]));
+  glSamplerParameteri(name, GL_TEXTURE_WRAP_T, _gp_wrap_to_gl(sampler->mWrap[1]));
+  glSamplerParameteri(name, GL_TEXTURE_WRAP_R, _gp_wrap_to_gl(sampler->mWrap[2]));
+  
+  // NOTE: Textures limit GL_TEXTURE_MAX_LEVEL to their allocated levels, so
+  // mipmap filters also sample textures without mipmaps.
+  glSamplerParameteri(name, GL_TEXTURE_MIN_FILTER, filters[sampler->mMinFilter][sampler->mMipFilter]);
+  glSamplerParameteri(name, GL_TEXTURE_MAG_FILTER, sampler->mMagFilter == GP_FILTER_LINEAR ? GL_LINEAR : GL_NEAREST);
+  
+  if(sampler->mCompare == GP_COMPARE_NONE)
+  {
+    glSamplerParameteri(name, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+  }
+  else
+  {
+    glSamplerParameteri(name, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glSamplerParameteri(name, GL_TEXTURE_COMPARE_FUNC, compares[sampler->mCompare]);
+  }
+  
+  CHECK_GL_ERROR()
+  
+  if(sampler->mAnisotropy > 1.0f)
+  {
+    if(*max_anisotropy == 0.0f)
+      *max_anisotropy = _gp_sampler_max_anisotropy();
+    
+    if(*max_anisotropy > 1.0f)
+    {
+      float anisotropy = sampler->mAnisotropy < *max_anisotropy ? sampler->mAnisotropy : *max_anisotropy;
+      glSamplerParameterf(name, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy);
+    }
+  }
+  
+  return name;
+}
+#endif
+
+GLuint _gp_sampler_get(gp_sampler* sampler)
+{
+#ifndef GP_GLES2
+  _gp_sampler_entry* entry = sampler->mEntry;
+  if(entry)
+  {
+    GLuint name = _gp_name_load(&entry->mName);
+    if(name) return name;
+  }
+  else
+  {
+    const uint64_t key = _gp_sampler_key(sampler);
+    const unsigned int bucket = _gp_sampler_bucket(key);
+    
+    gp_lock_acquire(&sLock);
+    entry = sBuckets[bucket];
+    while(entry != NULL && entry->mKey != key)
+      entry = entry->mNext;
+    
+    if(entry == NULL)
+    {
+      entry = malloc(sizeof(_gp_sampler_entry));
+      entry->mKey = key;
+      _gp_name_store(&entry->mName, 0);
+      entry->mRefs = 0;
+      entry->mNext = sBuckets[bucket];
+      sBuckets[bucket] = entry;
+    }
+    ++entry->mRefs;
+    gp_lock_release(&sLock);
+    
+    sampler->mEntry = entry;
+    
+    GLuint name = _gp_name_load(&entry->mName);
+    if(name) return name;
+  }
+  
+  //
+  // Create the GL sampler without the lock, so GL calls never stall other
+  // threads.  Another thread may create one for the same entry meanwhile,
+  // in which case the first published name wins and ours is released.
+  //
+  gp_lock_acquire(&sLock);
+  float max_anisotropy = sMaxAnisotropy;
+  gp_lock_release(&sLock);
+  
+  GLuint created = _gp_sampler_create(sampler, &max_anisotropy);
+  
+  gp_lock_acquire(&sLock);
+  sMaxAnisotropy = max_anisotropy;
+  GLuint name = _gp_name_load(&entry->mName);
+  if(name == 0)
+    _gp_name_store(&entry->mName, created);
+  gp_lock_release(&sLock);
+  
+  if(name == 0) return created;
+  
+  _gp_handle_release_name(GP_HANDLE_SAMPLER, created);
+  return name;
+#else
+  return 0;
+#endif
+}
+
+void _gp_sampler_shutdown()
+{
+#ifndef GP_GLES2
+  //
+  // The GL samplers die with the last context, but cached entries are still
+  // referenced by live samplers.  Clear their names so the next context
+  // creates them again on first use.
+  //
+  GLuint* names = NULL;
+  unsigned int count = 0;
+  unsigned int capacity = 0;
+  
+  gp_lock_acquire(&sLock);
+  int i;
+  for(i=0; i<GP_SAMPLER_BUCKETS; ++i)
+  {
+    _gp_sampler_entry* entry;
+    for(entry = sBuckets[i]; entry != NULL; entry = entry->mNext)
+    {
+      GLuint name = _gp_name_load(&entry->mName);
+      if(name == 0) continue;
+      
+      if(count == capacity)
+      {
+        capacity = capacity ? capacity*2 : 16;
+        names = realloc(names, sizeof(GLuint)*capacity);
+      }
+      names[count++] = name;
+      _gp_name_store(&entry->mName, 0);
+    }
+  }
+  
+  // The next context may support a different anisotropy.
+  sMaxAnisotropy = 0.0f;
+  gp_lock_release(&sLock);
+  
+  if(count) glDeleteSamplers(count, names);
+  free(names);
+#endif
+}
+
+void _gp_sampler_free(gp_object* object)
+{
+  gp_sampler* sampler = (gp_sampler*)object;
+  
+  _gp_sampler_changed(sampler);
+  free(sampler);
+}
+
+gp_sampler* gp_sampler_new(gp_context* context)
+{
+  (void)context;
+  
+  gp_sampler* sampler = malloc(sizeof(gp_sampler));
+  _gp_object_init(&sampler->mObject, _gp_sampler_free);
+  sampler->mWrap[0] = GP_WRAP_EDGE;
+  sampler->mWrap[1] = GP_WRAP_EDGE;
+  sampler->mWrap[2] = GP_WRAP_EDGE;
+  sampler->mMinFilter = GP_FILTER_LINEAR;
+  sampler->mMagFilter = GP_FILTER_LINEAR;
+  sampler->mMipFilter = GP_FILTER_LINEAR;
+  sampler->mAnisotropy = 1.0f;
+  sampler->mCompare = GP_COMPARE_NONE;
+  sampler->mEntry = NULL;
+  
+  return sampler;
+}
+
+void gp_sampler_set_wrap(gp_sampler* sampler, GP_WRAP x, GP_WRAP y, GP_WRAP z)
+{
+  if(sampler->mWrap[0] == x && sampler->mWrap[1] == y && sampler->mWrap[2] == z) return;
+  
+  sampler->mWrap[0] = x;
+  sampler->mWrap[1] = y;
+  sampler->mWrap[2] = z;
+  _gp_sampler_changed(sampler);
+}
+
+void gp_sampler_set_filter(gp_sampler* sampler, GP_FILTER min, GP_FILTER mag, GP_FILTER mip)
+{
+  if(sampler->mMinFilter == min && sampler->mMagFilter == mag && sampler->mMipFilter == mip) return;
+  
+  sampler->mMinFilter = min;
+  sampler->mMagFilter = mag;
+  sampler->mMipFilter = mip;
+  _gp_sampler_changed(sampler);
+}
+
+void gp_sampler_set_anisotropy(gp_sampler* sampler, float anisotropy)
+{
+  if(anisotropy < 1.0f) anisotropy = 1.0f;
+  if(sampler->mAnisotropy == anisotropy) return;
+  
+  sampler->mAnisotropy = anisotropy;
+  _gp_sampler_changed(sampler);
+}
+
+void gp_sampler_set_compare(gp_sampler* sampler, GP_COMPARE compare)
+{
+  if(sampler->mCompare == compare) return;
+  
+  sampler->mCompare = compare;
+  _gp_sampler_changed(sampler);
+}
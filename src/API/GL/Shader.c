@@ -79,7 +79,7 @@ void _gp_shader_free(gp_object* object)
 {
   gp_shader* self = (gp_shader*)object;
   
-  glDeleteProgram(self->mProgram);
+  _gp_handle_release_name(GP_HANDLE_PROGRAM, self->mProgram);
   free(self);
 }
 
@@ -175,7 +175,24 @@ void gp_shader_compile(gp_shader* shader, gp_shader_source* source)
   shader->mAttribute = glGetAttribLocation(shader->mProgram, "position");
 }
 
-void _gp_uniform_load_texture(gp_uniform* uniform, _gp_draw_context* context)
+typedef struct
+{
+  gp_texture*                 mTexture;
+  gp_sampler*                 mSampler;
+} _gp_uniform_texture;
+
+typedef struct
+{
+  gp_texture*                 mTexture;
+  gp_array*                   mArray;
+  GLuint                      mInternalFormat;
+  int                         mAttached;
+} _gp_uniform_buffer;
+
+static void _gp_uniform_bind_texture(gp_uniform* uniform,
+                                     gp_texture* texture,
+                                     gp_sampler* sampler,
+                                     _gp_draw_context* context)
 {
   //
   // Find texture index if already bound
@@ -184,7 +201,7 @@ void _gp_uniform_load_texture(gp_uniform* uniform, _gp_draw_context* context)
   gp_texture_cache_list* node = (gp_texture_cache_list*)gp_list_back(&context->mTextureCache);
   while(node != NULL && node->mTexture != 0)
   {
-    if(node->mTexture == (gp_texture*)uniform->mData)
+    if(node->mTexture == texture && node->mSampler == sampler)
     {
       index = node->mIndex;
       break;
@@ -195,7 +212,8 @@ void _gp_uniform_load_texture(gp_uniform* uniform, _gp_draw_context* context)
   {
     node = (gp_texture_cache_list*)gp_list_front(&context->mTextureCache);
     index = node->mIndex;
-    node->mTexture = (gp_texture*)uniform->mData;
+    node->mTexture = texture;
+    node->mSampler = sampler;
     gp_list_remove(&context->mTextureCache, (gp_list_node*)node);
     gp_list_push_back(&context->mTextureCache, (gp_list_node*)node);
   }
@@ -203,13 +221,48 @@ void _gp_uniform_load_texture(gp_uniform* uniform, _gp_draw_context* context)
   //
   // Bind texture and set uniform value
   //
-  gp_texture* texture = ((gp_texture*)uniform->mData);
   glActiveTexture(GL_TEXTURE0+index);
-  glBindTexture(texture->mDimensions, texture->mTexture);
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+#ifndef GP_GLES2
+  // Units keep their sampler across frames, so always bind one even if it
+  // is none to fall back to the state of the texture.
+  glBindSampler(index, sampler ? _gp_sampler_get(sampler) : 0);
+#endif
   glUniform1i(uniform->mLocation, index);
   
   CHECK_GL_ERROR()
 }
+
+void _gp_uniform_load_texture(gp_uniform* uniform, _gp_draw_context* context)
+{
+  _gp_uniform_texture* data = (_gp_uniform_texture*)uniform->mData;
+  if(data->mTexture == NULL)
+    return;
+  
+  _gp_uniform_bind_texture(uniform, data->mTexture, data->mSampler, context);
+}
+
+void _gp_uniform_load_buffer(gp_uniform* uniform, _gp_draw_context* context)
+{
+  _gp_uniform_buffer* buffer = (_gp_uniform_buffer*)uniform->mData;
+  if(buffer->mArray == NULL)
+    return;
+  
+#ifdef GP_GL
+  // The buffer texture reads the data store of the VBO directly, so it only
+  // needs attaching once.  Later uploads to the array are seen by shaders
+  // without any copy.  Binding first makes the unit of the uniform active,
+  // so attaching never touches the texture of another unit.
+  _gp_uniform_bind_texture(uniform, buffer->mTexture, NULL, context);
+  if(!buffer->mAttached)
+  {
+    glTexBuffer(GL_TEXTURE_BUFFER, buffer->mInternalFormat, _gp_handle_get(&buffer->mArray->mVBO));
+    buffer->mAttached = 1;
+    
+    CHECK_GL_ERROR()
+  }
+#endif
+}
 void _gp_uniform_load_int(gp_uniform* uniform, _gp_draw_context* context) {glUniform1i(uniform->mLocation, *(int*)uniform->mData);}
 void _gp_uniform_load_float(gp_uniform* uniform, _gp_draw_context* context) {glUniform1f(uniform->mLocation, *(float*)uniform->mData);}
 void _gp_uniform_load_vec2(gp_uniform* uniform, _gp_draw_context* context)
@@ -286,10 +339,14 @@ void _gp_uniform_default_free(gp_object* object)
 void _gp_uniform_texture_free(gp_object* object)
 {
   gp_uniform* uniform = (gp_uniform*)object;
+  _gp_uniform_texture* data = (_gp_uniform_texture*)uniform->mData;
   
-  if(uniform->mData)
-    gp_object_unref((gp_object*)uniform->mData);
+  if(data->mTexture)
+    gp_object_unref((gp_object*)data->mTexture);
+  if(data->mSampler)
+    gp_object_unref((gp_object*)data->mSampler);
   
+  free(data);
   free(uniform);
 }
 
@@ -299,7 +356,39 @@ gp_uniform* gp_uniform_texture_new_by_name(gp_shader* shader, const char* name)
   _gp_object_init(&uniform->mObject, _gp_uniform_texture_free);
   uniform->mLocation = glGetUniformLocation(shader->mProgram, name);
   uniform->mOperation = _gp_uniform_load_texture;
-  uniform->mData = 0;
+  uniform->mData = calloc(1, sizeof(_gp_uniform_texture));
+  return uniform;
+}
+
+void _gp_uniform_buffer_free(gp_object* object)
+{
+  gp_uniform* uniform = (gp_uniform*)object;
+  _gp_uniform_buffer* buffer = (_gp_uniform_buffer*)uniform->mData;
+  
+  if(buffer->mArray)
+    gp_object_unref((gp_object*)buffer->mArray);
+  gp_object_unref((gp_object*)buffer->mTexture);
+  
+  free(buffer);
+  free(uniform);
+}
+
+gp_uniform* gp_uniform_buffer_new_by_name(gp_shader* shader, const char* name)
+{
+  _gp_uniform_buffer* buffer = malloc(sizeof(_gp_uniform_buffer));
+  buffer->mTexture = gp_texture_new(NULL);
+#ifdef GP_GL
+  buffer->mTexture->mDimensions = GL_TEXTURE_BUFFER;
+#endif
+  buffer->mArray = NULL;
+  buffer->mInternalFormat = 0;
+  buffer->mAttached = 0;
+  
+  gp_uniform* uniform = malloc(sizeof(gp_uniform));
+  _gp_object_init(&uniform->mObject, _gp_uniform_buffer_free);
+  uniform->mLocation = glGetUniformLocation(shader->mProgram, name);
+  uniform->mOperation = _gp_uniform_load_buffer;
+  uniform->mData = buffer;
   return uniform;
 }
 
@@ -345,10 +434,89 @@ UNIFORM_NEW_BY_NAME(dmat4, sizeof(double)*16)
 void gp_uniform_texture_set(gp_uniform* uniform, gp_texture* texture)
 {
   assert(uniform->mOperation == _gp_uniform_load_texture);
+  _gp_uniform_texture* data = (_gp_uniform_texture*)uniform->mData;
+  
+  if(texture) gp_object_ref((gp_object*)texture);
+  if(data->mTexture) gp_object_unref((gp_object*)data->mTexture);
+  data->mTexture = texture;
+}
+
+gp_texture* gp_uniform_texture_get(gp_uniform* uniform)
+{
+  assert(uniform->mOperation == _gp_uniform_load_texture);
+  return ((_gp_uniform_texture*)uniform->mData)->mTexture;
+}
+
+void gp_uniform_texture_set_sampler(gp_uniform* uniform, gp_sampler* sampler)
+{
+  assert(uniform->mOperation == _gp_uniform_load_texture);
+  _gp_uniform_texture* data = (_gp_uniform_texture*)uniform->mData;
+  
+  if(sampler) gp_object_ref((gp_object*)sampler);
+  if(data->mSampler) gp_object_unref((gp_object*)data->mSampler);
+  data->mSampler = sampler;
+}
+
+#ifdef GP_GL
+GLuint _gp_uniform_buffer_format(GP_FORMAT format, GP_DATA_TYPE type)
+{
+  // Buffer textures support fewer formats than textures: no three component
+  // formats below 32 bits and no signed normalized formats.
+  static const GLuint internalFormats[6][4] = {
+    {GL_R8, GL_RG8, 0, GL_RGBA8},
+    {GL_R32I, GL_RG32I, GL_RGB32I, GL_RGBA32I},
+    {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F},
+    {GL_R16F, GL_RG16F, 0, GL_RGBA16F},
+    {GL_R16, GL_RG16, 0, GL_RGBA16},
+    {GL_R16I, GL_RG16I, 0, GL_RGBA16I}
+  };
+  
+  int row = -1;
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE: row = 0; break;
+    case GP_DATA_TYPE_INT: row = 1; break;
+    case GP_DATA_TYPE_FLOAT: row = 2; break;
+    case GP_DATA_TYPE_HALF: row = 3; break;
+    case GP_DATA_TYPE_USHORT: row = 4; break;
+    case GP_DATA_TYPE_SHORT: row = 5; break;
+    default: break;
+  }
   
-  if(uniform->mData) gp_object_unref((gp_object*)uniform->mData);
-  uniform->mData = texture;
-  if(uniform->mData) gp_object_ref((gp_object*)uniform->mData);
+  if(row == -1 || format < GP_FORMAT_R || format > GP_FORMAT_RGBA)
+    return 0;
+  return internalFormats[row][format-1];
+}
+#endif
+
+void gp_uniform_buffer_set(gp_uniform* uniform, gp_array* array, GP_FORMAT format, GP_DATA_TYPE type)
+{
+  assert(uniform->mOperation == _gp_uniform_load_buffer);
+  
+#ifdef GP_GL
+  _gp_uniform_buffer* buffer = (_gp_uniform_buffer*)uniform->mData;
+  
+  GLuint internalFormat = array ? _gp_uniform_buffer_format(format, type) : 0;
+  if(array != NULL && internalFormat == 0)
+  {
+    gp_log_error("Texture buffers do not support this format and type");
+    return;
+  }
+  
+  if(array) gp_object_ref((gp_object*)array);
+  if(buffer->mArray) gp_object_unref((gp_object*)buffer->mArray);
+  buffer->mArray = array;
+  buffer->mInternalFormat = internalFormat;
+  buffer->mAttached = 0;
+#else
+  gp_log_error("Texture buffers are only supported by desktop OpenGL");
+#endif
+}
+
+gp_array* gp_uniform_buffer_get(gp_uniform* uniform)
+{
+  assert(uniform->mOperation == _gp_uniform_load_buffer);
+  return ((_gp_uniform_buffer*)uniform->mData)->mArray;
 }
 
 void gp_uniform_float_set(gp_uniform* uniform, float data)
@@ -383,7 +551,6 @@ UNIFORM_SET_FLOATPTR(vec4, sizeof(float)*4)
 UNIFORM_SET_FLOATPTR(mat3, sizeof(float)*9)
 UNIFORM_SET_FLOATPTR(mat4, sizeof(float)*16)
 
-UNIFORM_GET(texture, gp_texture*)
 UNIFORM_GET(vec2, float*)
 UNIFORM_GET(vec3, float*)
 UNIFORM_GET(vec4, float*)
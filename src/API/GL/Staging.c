@@ -0,0 +1,259 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Context.h>
+#include <GraphicsPipeline/Convert.h>
+
+#include "Config.h"
+
+#ifdef GP_GL
+#ifndef __APPLE__
+#include <GL/glew.h>
+#endif // __APPLE__
+#endif // GP_GL
+#include "GL.h"
+
+#include "../../Utils/Lock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Guards the upload statistics and, outside of Web, the rings.
+static gp_lock sLock = GP_LOCK_INIT;
+static gp_upload_stats sStats = {0, 0, 0.0, 0.0, 0};
+
+static void _gp_staging_record(size_t size, double seconds)
+{
+  gp_lock_acquire(&sLock);
+  sStats.count += 1;
+  sStats.bytes += size;
+  sStats.seconds += seconds;
+  if(seconds > 0.0) sStats.bandwidth = size/seconds/1000000000.0;
+  gp_lock_release(&sLock);
+}
+
+void _gp_staging_copy(void* dst, const void* src, size_t size)
+{
+  double begin = gp_clock();
+  gp_copy(dst, src, size);
+  _gp_staging_record(size, gp_clock() - begin);
+}
+
+void _gp_staging_convert(void* dst,
+                         GP_FORMAT dst_format,
+                         GP_DATA_TYPE dst_type,
+                         const void* src,
+                         GP_FORMAT src_format,
+                         GP_DATA_TYPE src_type,
+                         const int* swizzle,
+                         size_t count)
+{
+  double begin = gp_clock();
+  gp_convert(src, src_format, src_type, dst, dst_format, dst_type, swizzle, count);
+  _gp_staging_record(count*dst_format*gp_data_type_get_size(dst_type), gp_clock() - begin);
+}
+
+#ifndef GP_WEB
+// Rings of staging buffers for every power of two size.  Uploads cycle
+// through the ring so copying the next upload overlaps the GPU reading the
+// previous one, and buffers are never respecified.  Sizes stop at a cap so
+// rare huge uploads don't keep memory rounded up to a power of two pinned.
+static _gp_staging_buffer sRings[GP_STAGING_CLASSES][GP_STAGING_RING];
+static unsigned int sNext[GP_STAGING_CLASSES];
+
+static int _gp_staging_ready(_gp_staging_buffer* buffer, GLuint64 timeout)
+{
+#ifndef GP_GLES2
+  if(buffer->mFence == 0) return 1;
+  
+  GLenum status = glClientWaitSync(buffer->mFence, 0, timeout);
+  if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return 0;
+  
+  glDeleteSync(buffer->mFence);
+  buffer->mFence = 0;
+#endif
+  return 1;
+}
+
+static void _gp_staging_create(_gp_staging_buffer* buffer, size_t size)
+{
+  glGenBuffers(1, &buffer->mBuffer);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mBuffer);
+  glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+#ifndef GP_GLES2
+  buffer->mFence = 0;
+#endif
+}
+
+_gp_staging_buffer* _gp_staging_acquire(size_t size)
+{
+  unsigned int c = GP_STAGING_MIN_CLASS;
+  while(((size_t)1 << c) < size) ++c;
+  
+  if(c - GP_STAGING_MIN_CLASS >= GP_STAGING_CLASSES)
+  {
+    _gp_staging_buffer* buffer = malloc(sizeof(_gp_staging_buffer));
+    _gp_staging_create(buffer, size);
+    buffer->mBusy = 1;
+    buffer->mTransient = 1;
+    return buffer;
+  }
+  
+  _gp_staging_buffer* ring = sRings[c - GP_STAGING_MIN_CLASS];
+  unsigned int* next = &sNext[c - GP_STAGING_MIN_CLASS];
+  _gp_staging_buffer* buffer = NULL;
+  int stalled = 0;
+  
+  gp_lock_acquire(&sLock);
+  
+  // Take the first buffer the GPU is done with, oldest first.
+  unsigned int i;
+  for(i=0; i<GP_STAGING_RING && buffer==NULL; ++i)
+  {
+    _gp_staging_buffer* b = ring + (*next + i)%GP_STAGING_RING;
+    if(!b->mBusy && (b->mBuffer == 0 || _gp_staging_ready(b, 0)))
+      buffer = b;
+  }
+  
+  // Otherwise wait for the oldest buffer not being filled by another thread.
+  for(i=0; i<GP_STAGING_RING && buffer==NULL; ++i)
+  {
+    _gp_staging_buffer* b = ring + (*next + i)%GP_STAGING_RING;
+    if(b->mBusy) continue;
+    
+    stalled = 1;
+    sStats.stalls += 1;
+    buffer = b;
+  }
+  
+  if(buffer)
+  {
+    buffer->mBusy = 1;
+    buffer->mTransient = 0;
+    *next = (unsigned int)(buffer - ring + 1)%GP_STAGING_RING;
+  }
+  
+  gp_lock_release(&sLock);
+  
+  // NOTE: The buffer is marked busy, so its fence is only touched here.
+  if(stalled)
+    while(!_gp_staging_ready(buffer, 1000000000));
+  
+  if(buffer == NULL)
+  {
+    // Every buffer of the ring is being filled on other threads.
+    buffer = malloc(sizeof(_gp_staging_buffer));
+    _gp_staging_create(buffer, (size_t)1 << c);
+    buffer->mBusy = 1;
+    buffer->mTransient = 1;
+    return buffer;
+  }
+  
+  if(buffer->mBuffer == 0)
+    _gp_staging_create(buffer, (size_t)1 << c);
+  else
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mBuffer);
+  
+  return buffer;
+}
+
+void _gp_staging_release(_gp_staging_buffer* buffer)
+{
+  if(buffer->mTransient)
+  {
+    _gp_handle_release_name(GP_HANDLE_BUFFER, buffer->mBuffer);
+    free(buffer);
+    return;
+  }
+  
+#ifndef GP_GLES2
+  GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+#endif
+  // Start the transfer now and let other contexts wait on the fence.
+  glFlush();
+  
+  gp_lock_acquire(&sLock);
+#ifndef GP_GLES2
+  buffer->mFence = fence;
+#endif
+  buffer->mBusy = 0;
+  gp_lock_release(&sLock);
+}
+
+/*
+ * Drop a buffer that is still mapped without a current context.  Deleting
+ * the buffer later also unmaps it.
+ */
+void _gp_staging_discard(_gp_staging_buffer* buffer)
+{
+  _gp_handle_release_name(GP_HANDLE_BUFFER, buffer->mBuffer);
+  if(buffer->mTransient)
+  {
+    free(buffer);
+    return;
+  }
+  
+  gp_lock_acquire(&sLock);
+  buffer->mBuffer = 0;
+  buffer->mBusy = 0;
+  gp_lock_release(&sLock);
+}
+
+/*
+ * Delete every ring buffer with the last context.  Contexts created later
+ * are in a new share group and create their own buffers.
+ */
+void _gp_staging_shutdown()
+{
+  gp_lock_acquire(&sLock);
+  unsigned int c, i;
+  for(c=0; c<GP_STAGING_CLASSES; ++c)
+  {
+    for(i=0; i<GP_STAGING_RING; ++i)
+    {
+      _gp_staging_buffer* buffer = &sRings[c][i];
+#ifndef GP_GLES2
+      if(buffer->mFence) glDeleteSync(buffer->mFence);
+#endif
+      if(buffer->mBuffer) glDeleteBuffers(1, &buffer->mBuffer);
+    }
+  }
+  memset(sRings, 0, sizeof(sRings));
+  memset(sNext, 0, sizeof(sNext));
+  gp_lock_release(&sLock);
+}
+#endif // GP_WEB
+
+gp_upload_stats gp_context_get_upload_stats(gp_context* context)
+{
+  (void)context;
+  
+  gp_lock_acquire(&sLock);
+  gp_upload_stats stats = sStats;
+  gp_lock_release(&sLock);
+  
+  return stats;
+}
+
+void gp_context_reset_upload_stats(gp_context* context)
+{
+  (void)context;
+  
+  gp_lock_acquire(&sLock);
+  memset(&sStats, 0, sizeof(gp_upload_stats));
+  gp_lock_release(&sLock);
+}
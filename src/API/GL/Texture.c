@@ -16,7 +16,12 @@
 ************************************************************************/
 
 #include <GraphicsPipeline/Texture.h>
+#include <GraphicsPipeline/Compress.h>
+#include <GraphicsPipeline/Convert.h>
+#include <GraphicsPipeline/Half.h>
+#include <GraphicsPipeline/Image.h>
 #include <GraphicsPipeline/Logging.h>
+#include <GraphicsPipeline/Mipmap.h>
 
 #include "Config.h"
 
@@ -27,30 +32,45 @@
 #endif // GP_GL
 #include "GL.h"
 
+#include "../../Utils/Image.h"
+#include "../../Utils/Lock.h"
+#include "../../Utils/Parallel.h"
+#include "../../Utils/Shared.h"
+
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 
-size_t _gp_data_type_to_size(GP_DATA_TYPE type)
-{
-  switch(type)
-  {
-    case GP_DATA_TYPE_UBYTE:
-      return sizeof(uint8_t);
-    case GP_DATA_TYPE_INT:
-      return sizeof(int);
-    case GP_DATA_TYPE_FLOAT:
-      return sizeof(float);
-    case GP_DATA_TYPE_DOUBLE:
-      return sizeof(double);
-  }
-}
+// NOTE: BC formats come from extensions on every API and ETC2 is only core
+// in GLES3 and GL 4.3, so headers may lack them.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT  0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT  0x83F3
+#endif
+#ifndef GL_COMPRESSED_RED_RGTC1
+#define GL_COMPRESSED_RED_RGTC1           0x8DBB
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2            0x8DBD
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2           0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC      0x9278
+#endif
 
 void _gp_texture_data_free(gp_object* object)
 {
   gp_texture_data* data = (gp_texture_data*)object;
   
-  if(data->mData) free(data->mData);
+  if(data->mShared) gp_object_unref((gp_object*)data->mShared);
+#ifndef GP_WEB
+  else if(data->mStaging) _gp_staging_discard(data->mStaging);
+#endif
+  else if(data->mData) free(data->mData);
   free(data);
 }
 
@@ -63,16 +83,120 @@ gp_texture_data* gp_texture_data_new()
   data->mType = GP_DATA_TYPE_UBYTE;
   data->mWidth = 0;
   data->mHeight = 0;
+  data->mDepth = 1;
+  data->mWidthOffset = -1;
+  data->mHeightOffset = -1;
+  data->mDepthOffset = -1;
+  data->mSwizzle[0] = -1;
+  data->mCompression = GP_COMPRESSION_NONE;
+  data->mCompress = GP_COMPRESSION_NONE;
+  data->mShared = NULL;
+  data->mSequence = 0;
+#ifndef GP_WEB
+  data->mStaging = NULL;
+#endif
+  
+  return data;
+}
+
+gp_texture_data* gp_texture_data_new_shared(gp_shared* shared,
+                                            GP_FORMAT format,
+                                            GP_DATA_TYPE type,
+                                            unsigned int width,
+                                            unsigned int height)
+{
+  if(shared == NULL)
+  {
+    gp_log_error("Shared memory is required for shared texture data");
+    return NULL;
+  }
+  
+  const size_t size = gp_data_type_get_size(type)*format*width*height;
+  if(size > gp_shared_get_size(shared))
+  {
+    gp_log_error("Shared memory is too small for %ux%u texture data", width, height);
+    return NULL;
+  }
+  
+  gp_texture_data* data = malloc(sizeof(gp_texture_data));
+  _gp_object_init(&data->mObject, _gp_texture_data_free);
+  data->mData = gp_shared_get_data(shared);
+  data->mDimensions = GL_TEXTURE_2D;
+  data->mFormat = format;
+  data->mType = type;
+  data->mWidth = width;
+  data->mHeight = height;
+  data->mDepth = 1;
+  data->mWidthOffset = -1;
+  data->mHeightOffset = -1;
+  data->mDepthOffset = -1;
+  data->mSwizzle[0] = -1;
+  data->mCompression = GP_COMPRESSION_NONE;
+  data->mCompress = GP_COMPRESSION_NONE;
+  data->mShared = shared;
+  data->mSequence = 0;
+#ifndef GP_WEB
+  data->mStaging = NULL;
+#endif
+  
+  gp_object_ref((gp_object*)shared);
   
   return data;
 }
 
+unsigned int gp_texture_data_get_sequence(gp_texture_data* td)
+{
+  return td->mSequence;
+}
+
+void* gp_texture_data_get_data(gp_texture_data* td)
+{
+  return td->mData;
+}
+
+void gp_texture_data_get_size(gp_texture_data* td,
+                              unsigned int* width,
+                              unsigned int* height,
+                              unsigned int* depth)
+{
+  if(width) *width = td->mWidth;
+  if(height) *height = td->mHeight;
+  if(depth) *depth = td->mDepth;
+}
+
+void gp_texture_data_get_offset(gp_texture_data* td,
+                                int* w_offset,
+                                int* h_offset,
+                                int* d_offset)
+{
+  if(w_offset) *w_offset = td->mWidthOffset;
+  if(h_offset) *h_offset = td->mHeightOffset;
+  if(d_offset) *d_offset = td->mDepthOffset;
+}
+
+void gp_texture_data_set_swizzle(gp_texture_data* td, const int* swizzle)
+{
+  if(swizzle == NULL)
+  {
+    td->mSwizzle[0] = -1;
+    return;
+  }
+  
+  memcpy(td->mSwizzle, swizzle, sizeof(td->mSwizzle));
+}
+
 void _gp_texture_data_set_1d(gp_texture_data* td,
                              void* data,
                              GP_FORMAT format,
                              GP_DATA_TYPE type,
                              unsigned int width)
 {
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
+  
   // NOTE: Only desktop GL supports 1D textures.
   // If not supported, generate 1D textures as 2D.
 #ifdef GP_GL
@@ -82,8 +206,9 @@ void _gp_texture_data_set_1d(gp_texture_data* td,
 #endif
   td->mFormat = format;
   td->mType = type;
+  td->mCompression = GP_COMPRESSION_NONE;
   
-  const size_t size = _gp_data_type_to_size(type)*format*width;
+  const size_t size = gp_data_type_get_size(type)*format*width;
   
   if(data == NULL)
   {
@@ -92,12 +217,13 @@ void _gp_texture_data_set_1d(gp_texture_data* td,
   }
   else
   {
-    if(td->mData == NULL) td->mData = malloc(size);
+    td->mData = realloc(td->mData, size);
     
     memcpy(td->mData, data, size);
   }
   td->mWidth = width;
   td->mHeight = 1;
+  td->mDepth = 1;
 }
 
 void gp_texture_data_set_1d(gp_texture_data* td,
@@ -110,6 +236,7 @@ void gp_texture_data_set_1d(gp_texture_data* td,
   
   td->mWidthOffset = -1;
   td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
 }
 
 void gp_texture_data_set_1d_chunk(gp_texture_data* td,
@@ -123,6 +250,7 @@ void gp_texture_data_set_1d_chunk(gp_texture_data* td,
   
   td->mWidthOffset = offset;
   td->mHeightOffset = 0;
+  td->mDepthOffset = 0;
 }
 
 void _gp_texture_data_set_2d(gp_texture_data* td,
@@ -132,11 +260,18 @@ void _gp_texture_data_set_2d(gp_texture_data* td,
                              unsigned int width,
                              unsigned int height)
 {
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
+  
   td->mDimensions = GL_TEXTURE_2D;
   td->mFormat = format;
   td->mType = type;
+  td->mCompression = GP_COMPRESSION_NONE;
   
-  const size_t size = _gp_data_type_to_size(type)*format*width*height;
+  const size_t size = gp_data_type_get_size(type)*format*width*height;
   
   if(data == NULL)
   {
@@ -145,12 +280,13 @@ void _gp_texture_data_set_2d(gp_texture_data* td,
   }
   else
   {
-    if(td->mData == NULL) td->mData = malloc(size);
+    td->mData = realloc(td->mData, size);
     
     memcpy(td->mData, data, size);
   }
   td->mWidth = width;
   td->mHeight = height;
+  td->mDepth = 1;
 }
 
 void gp_texture_data_set_2d(gp_texture_data* td,
@@ -164,6 +300,7 @@ void gp_texture_data_set_2d(gp_texture_data* td,
   
   td->mWidthOffset = -1;
   td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
 }
 
 void gp_texture_data_set_2d_chunk(gp_texture_data* td,
@@ -179,127 +316,881 @@ void gp_texture_data_set_2d_chunk(gp_texture_data* td,
   
   td->mWidthOffset = w_offset;
   td->mHeightOffset = h_offfset;
+  td->mDepthOffset = 0;
 }
 
+void gp_texture_data_set_2d_region(gp_texture_data* td,
+                                   const void* data,
+                                   GP_FORMAT format,
+                                   GP_DATA_TYPE type,
+                                   unsigned int width,
+                                   unsigned int height,
+                                   unsigned int w_offset,
+                                   unsigned int h_offset,
+                                   unsigned int row_length,
+                                   unsigned int skip_pixels,
+                                   unsigned int skip_rows)
+{
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
+  if(row_length == 0) row_length = width;
+  if(data == NULL || skip_pixels + width > row_length)
+  {
+    gp_log_error("Texture region is not inside its image");
+    return;
+  }
+  
+  td->mDimensions = GL_TEXTURE_2D;
+  td->mFormat = format;
+  td->mType = type;
+  td->mCompression = GP_COMPRESSION_NONE;
+  
+  // Gather the rows of the rectangle in the one copy every other setter
+  // makes.  Unlike GL_UNPACK_ROW_LENGTH this works on GLES2 as well, and
+  // keeps uploads from the data tightly packed.
+  const size_t pixel = gp_data_type_get_size(type)*format;
+  const size_t row = pixel*width;
+  const size_t pitch = pixel*row_length;
+  const char* src = (const char*)data + pitch*skip_rows + pixel*skip_pixels;
+  
+  td->mData = realloc(td->mData, row*height);
+  gp_copy_rows(td->mData, row, src, pitch, row, height);
+  td->mWidth = width;
+  td->mHeight = height;
+  td->mDepth = 1;
+  td->mWidthOffset = w_offset;
+  td->mHeightOffset = h_offset;
+  td->mDepthOffset = 0;
+}
 
-void _gp_texture_free(gp_object* object)
+void _gp_texture_data_set_3d(gp_texture_data* td,
+                             void* data,
+                             GLuint dimensions,
+                             GP_FORMAT format,
+                             GP_DATA_TYPE type,
+                             unsigned int width,
+                             unsigned int height,
+                             unsigned int depth)
 {
-  gp_texture* texture = (gp_texture*)object;
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
   
-  glDeleteTextures(1, &texture->mTexture);
-#ifndef GP_WEB
-  glDeleteBuffers(1, &texture->mPBO);
+  // NOTE: GLES2 has neither 3D nor array textures.
+#ifdef GP_GLES2
+  gp_log_error("3D and array textures are not supported by GLES2");
+  return;
 #endif
-  free(texture);
+  
+  td->mDimensions = dimensions;
+  td->mFormat = format;
+  td->mType = type;
+  td->mCompression = GP_COMPRESSION_NONE;
+  
+  const size_t size = gp_data_type_get_size(type)*format*width*height*depth;
+  
+  if(data == NULL)
+  {
+    if(td->mData != NULL) free(td->mData);
+    td->mData = NULL;
+  }
+  else
+  {
+    td->mData = realloc(td->mData, size);
+    
+    memcpy(td->mData, data, size);
+  }
+  td->mWidth = width;
+  td->mHeight = height;
+  td->mDepth = depth;
 }
 
-gp_texture* gp_texture_new(gp_context* context)
+void gp_texture_data_set_3d(gp_texture_data* td,
+                            void* data,
+                            GP_FORMAT format,
+                            GP_DATA_TYPE type,
+                            unsigned int width,
+                            unsigned int height,
+                            unsigned int depth)
 {
-  gp_texture* texture = malloc(sizeof(gp_texture));
-  _gp_object_init(&texture->mObject, _gp_texture_free);
-  glGenTextures(1, &texture->mTexture);
-  texture->mDimensions = GL_TEXTURE_2D;
-  texture->mWrapX = GL_CLAMP_TO_EDGE;
-  texture->mWrapY = GL_CLAMP_TO_EDGE;
+  _gp_texture_data_set_3d(td, data, GL_TEXTURE_3D, format, type, width, height, depth);
   
-#ifndef GP_WEB
-  glGenBuffers(1, &texture->mPBO);
-#endif
+  td->mWidthOffset = -1;
+  td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
+}
+
+void gp_texture_data_set_3d_chunk(gp_texture_data* td,
+                                  void* data,
+                                  GP_FORMAT format,
+                                  GP_DATA_TYPE type,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  unsigned int depth,
+                                  unsigned int w_offset,
+                                  unsigned int h_offset,
+                                  unsigned int d_offset)
+{
+  _gp_texture_data_set_3d(td, data, GL_TEXTURE_3D, format, type, width, height, depth);
   
-  return texture;
+  td->mWidthOffset = w_offset;
+  td->mHeightOffset = h_offset;
+  td->mDepthOffset = d_offset;
 }
 
-void gp_texture_set_data(gp_texture* texture, gp_texture_data* data)
+void gp_texture_data_set_2d_array(gp_texture_data* td,
+                                  void* data,
+                                  GP_FORMAT format,
+                                  GP_DATA_TYPE type,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  unsigned int layers)
 {
-  glBindTexture(data->mDimensions, texture->mTexture);
+  _gp_texture_data_set_3d(td, data, GL_TEXTURE_2D_ARRAY, format, type, width, height, layers);
   
-  glTexParameteri(data->mDimensions, GL_TEXTURE_WRAP_S, texture->mWrapX);
-  glTexParameteri(data->mDimensions, GL_TEXTURE_WRAP_T, texture->mWrapY);
+  td->mWidthOffset = -1;
+  td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
+}
+
+void gp_texture_data_set_2d_array_chunk(gp_texture_data* td,
+                                        void* data,
+                                        GP_FORMAT format,
+                                        GP_DATA_TYPE type,
+                                        unsigned int width,
+                                        unsigned int height,
+                                        unsigned int layers,
+                                        unsigned int w_offset,
+                                        unsigned int h_offset,
+                                        unsigned int layer)
+{
+  _gp_texture_data_set_3d(td, data, GL_TEXTURE_2D_ARRAY, format, type, width, height, layers);
   
-  glTexParameteri(data->mDimensions, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  glTexParameteri(data->mDimensions, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  td->mWidthOffset = w_offset;
+  td->mHeightOffset = h_offset;
+  td->mDepthOffset = layer;
+}
+
+void gp_texture_data_set_2d_half(gp_texture_data* td,
+                                 const float* data,
+                                 GP_FORMAT format,
+                                 unsigned int width,
+                                 unsigned int height)
+{
+  _gp_texture_data_set_2d(td, NULL, format, GP_DATA_TYPE_HALF, width, height);
+  if(td->mShared) return;
   
-  GLvoid* d = data->mData;
-#ifndef GP_WEB
-  d = 0;
+  td->mData = malloc(sizeof(uint16_t)*format*width*height);
+  gp_half_from_float(data, (uint16_t*)td->mData, format*width*height);
+  
+  td->mWidthOffset = -1;
+  td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
+}
+
+static GLuint _gp_texture_compressed_format(GP_COMPRESSION compression)
+{
+  switch(compression)
+  {
+    case GP_COMPRESSION_BC1:
+      return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    case GP_COMPRESSION_BC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case GP_COMPRESSION_BC4:
+      return GL_COMPRESSED_RED_RGTC1;
+    case GP_COMPRESSION_BC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    case GP_COMPRESSION_ETC2_RGB:
+      return GL_COMPRESSED_RGB8_ETC2;
+    case GP_COMPRESSION_ETC2_RGBA:
+      return GL_COMPRESSED_RGBA8_ETC2_EAC;
+    default:
+      return 0;
+  }
+}
+
+static void _gp_texture_data_set_compressed(gp_texture_data* td,
+                                            const void* data,
+                                            GP_COMPRESSION compression,
+                                            unsigned int width,
+                                            unsigned int height)
+{
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
+  if(_gp_texture_compressed_format(compression) == 0)
+  {
+    gp_log_error("Texture data needs a block compressed format");
+    return;
+  }
   
-  const size_t size = _gp_data_type_to_size(data->mType)*data->mFormat*data->mWidth*data->mHeight;
+  td->mDimensions = GL_TEXTURE_2D;
+  td->mCompression = compression;
   
-  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->mPBO);
-  glBufferData(GL_PIXEL_UNPACK_BUFFER, size, 0, GL_STREAM_DRAW);
+  const size_t size = gp_compress_get_size(compression, width, height);
   
-  if(data->mData != 0)
+  if(data == NULL)
   {
-    GLubyte* ptr = (GLubyte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT);
-    if(ptr)
-    {
-        // update data directly on the mapped buffer
-        memcpy(ptr, data->mData, size);
-        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);  // release pointer to mapping buffer
-        CHECK_GL_ERROR()
-    }
+    if(td->mData != NULL) free(td->mData);
+    td->mData = NULL;
   }
-#endif
+  else
+  {
+    td->mData = realloc(td->mData, size);
+    
+    memcpy(td->mData, data, size);
+  }
+  td->mWidth = width;
+  td->mHeight = height;
+  td->mDepth = 1;
+}
+
+void gp_texture_data_set_compressed(gp_texture_data* td,
+                                    const void* data,
+                                    GP_COMPRESSION compression,
+                                    unsigned int width,
+                                    unsigned int height)
+{
+  _gp_texture_data_set_compressed(td, data, compression, width, height);
   
-  GLuint internalFormat = 0;
-  GLuint format = 0;
-  GLuint type = 0;
+  td->mWidthOffset = -1;
+  td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
+}
+
+void gp_texture_data_set_compressed_chunk(gp_texture_data* td,
+                                          const void* data,
+                                          GP_COMPRESSION compression,
+                                          unsigned int width,
+                                          unsigned int height,
+                                          unsigned int w_offset,
+                                          unsigned int h_offset)
+{
+  if(w_offset%4 != 0 || h_offset%4 != 0)
+  {
+    gp_log_error("Compressed chunks must start on a 4x4 block");
+    return;
+  }
+  
+  _gp_texture_data_set_compressed(td, data, compression, width, height);
+  
+  td->mWidthOffset = w_offset;
+  td->mHeightOffset = h_offset;
+  td->mDepthOffset = -1;
+}
+
+int gp_texture_data_compress(gp_texture_data* td, GP_COMPRESSION compression)
+{
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return 0;
+  }
+  if(td->mData == NULL || td->mCompression != GP_COMPRESSION_NONE || td->mDimensions != GL_TEXTURE_2D)
+  {
+    gp_log_error("Only uncompressed 2D texture data can be compressed");
+    return 0;
+  }
+  
+  void* blocks = malloc(gp_compress_get_size(compression, td->mWidth, td->mHeight));
+  if(!gp_compress(td->mData, td->mFormat, td->mType, td->mWidth, td->mHeight, compression, blocks))
+  {
+    gp_log_error("Texture data can not be encoded with this compression");
+    free(blocks);
+    return 0;
+  }
+  
+  free(td->mData);
+  td->mData = blocks;
+  td->mCompression = compression;
+  return 1;
+}
+
+void gp_texture_data_set_compression(gp_texture_data* td, GP_COMPRESSION compression)
+{
+  td->mCompress = compression;
+}
+
+void gp_texture_data_downsample(gp_texture_data* td, gp_texture_data* source, GP_MIPMAP filter)
+{
+  if(td->mShared)
+  {
+    gp_log_error("Shared texture data is only written by its producer");
+    return;
+  }
+  if(source->mData == NULL)
+  {
+    gp_log_error("Texture data has nothing to downsample");
+    return;
+  }
+  if(source->mDepth > 1 || source->mCompression != GP_COMPRESSION_NONE)
+  {
+    gp_log_error("Only uncompressed 1D and 2D texture data can be downsampled");
+    return;
+  }
+  
+  const unsigned int width = source->mWidth > 1 ? source->mWidth/2 : 1;
+  const unsigned int height = source->mHeight > 1 ? source->mHeight/2 : 1;
+  const size_t size = gp_data_type_get_size(source->mType)*source->mFormat*width*height;
   
+  if(td->mData) free(td->mData);
+  td->mData = malloc(size);
+  td->mCompression = GP_COMPRESSION_NONE;
+  td->mDimensions = source->mDimensions;
+  td->mFormat = source->mFormat;
+  td->mType = source->mType;
+  td->mWidth = width;
+  td->mHeight = height;
+  td->mDepth = 1;
+  td->mWidthOffset = -1;
+  td->mHeightOffset = -1;
+  td->mDepthOffset = -1;
+  
+  gp_mipmap_downsample(source->mData,
+                       td->mData,
+                       source->mFormat,
+                       source->mType,
+                       source->mWidth,
+                       source->mHeight,
+                       filter);
+}
+
+
+static void _gp_texture_formats(GP_FORMAT f, GP_DATA_TYPE t, GLuint* internalFormat, GLuint* format, GLuint* type)
+{
   static const GLuint formats[] = {GL_RED, GL_RG, GL_RGB, GL_RGBA};
-  static const GLuint internalFormats[3][4] = {
+  static const GLuint integerFormats[] = {GL_RED_INTEGER, GL_RG_INTEGER, GL_RGB_INTEGER, GL_RGBA_INTEGER};
+  static const GLuint internalFormats[6][4] = {
     {GL_R8, GL_RG8, GL_RGB8, GL_RGBA8}, 
     {GL_R32I, GL_RG32I, GL_RGB32I, GL_RGBA32I},
-    {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F}
+    {GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F},
+    {GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F},
+#ifdef GP_GL
+    {GL_R16, GL_RG16, GL_RGB16, GL_RGBA16},
+    {GL_R16_SNORM, GL_RG16_SNORM, GL_RGB16_SNORM, GL_RGBA16_SNORM}
+#else
+    // NOTE: GLES has no 16-bit normalized formats, so they stay integers.
+    {GL_R16UI, GL_RG16UI, GL_RGB16UI, GL_RGBA16UI},
+    {GL_R16I, GL_RG16I, GL_RGB16I, GL_RGBA16I}
+#endif
   };
   
-  format = formats[data->mFormat-1];
-  switch(data->mType)
+  *format = formats[f-1];
+  switch(t)
   {
     case GP_DATA_TYPE_UBYTE:
-      type = GL_UNSIGNED_BYTE;
-      internalFormat = internalFormats[0][data->mFormat-1];
+      *type = GL_UNSIGNED_BYTE;
+      *internalFormat = internalFormats[0][f-1];
       break;
     case GP_DATA_TYPE_INT:
-      type = GL_INT;
-      internalFormat = internalFormats[1][data->mFormat-1];
+      // Integer internal formats only accept integer pixel formats.
+      *type = GL_INT;
+      *format = integerFormats[f-1];
+      *internalFormat = internalFormats[1][f-1];
       break;
     case GP_DATA_TYPE_FLOAT:
-      type = GL_FLOAT;
-      internalFormat = internalFormats[2][data->mFormat-1];
+      *type = GL_FLOAT;
+      *internalFormat = internalFormats[2][f-1];
+      break;
+    case GP_DATA_TYPE_HALF:
+      *type = GL_HALF_FLOAT;
+      *internalFormat = internalFormats[3][f-1];
+      break;
+    case GP_DATA_TYPE_USHORT:
+      *type = GL_UNSIGNED_SHORT;
+      *internalFormat = internalFormats[4][f-1];
+#ifndef GP_GL
+      *format = integerFormats[f-1];
+#endif
+      break;
+    case GP_DATA_TYPE_SHORT:
+      *type = GL_SHORT;
+      *internalFormat = internalFormats[5][f-1];
+#ifndef GP_GL
+      *format = integerFormats[f-1];
+#endif
       break;
     case GP_DATA_TYPE_DOUBLE:
       // NOTE: Only desktop GL supports GL_DOUBLE.
       // If not supported, convert to GL_FLOAT.
 #ifdef GP_GL
-      type = GL_DOUBLE;
+      *type = GL_DOUBLE;
 #else
-      type = GL_FLOAT;
+      *type = GL_FLOAT;
 #endif
-      internalFormat = internalFormats[2][data->mFormat-1];
+      *internalFormat = internalFormats[2][f-1];
       break;
   }
+}
+
+static GLuint _gp_texture_min_filter(gp_texture* texture)
+{
+  static const GLuint filters[2][2] = {
+    {GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST_MIPMAP_LINEAR},
+    {GL_LINEAR_MIPMAP_NEAREST, GL_LINEAR_MIPMAP_LINEAR}
+  };
   
-  switch(data->mDimensions)
-  {
+  // NOTE: Mipmap filters leave a texture without mipmaps incomplete.
+  if(texture->mLevels < 2)
+    return texture->mMinFilter == GP_FILTER_LINEAR ? GL_LINEAR : GL_NEAREST;
+  
+  return filters[texture->mMinFilter][texture->mMipFilter];
+}
+
+// NOTE: The texture must be bound.
+static void _gp_texture_apply_filter(gp_texture* texture)
+{
+  glTexParameteri(texture->mDimensions, GL_TEXTURE_MIN_FILTER, _gp_texture_min_filter(texture));
+  glTexParameteri(texture->mDimensions, GL_TEXTURE_MAG_FILTER, texture->mMagFilter == GP_FILTER_LINEAR ? GL_LINEAR : GL_NEAREST);
+#ifndef GP_GLES2
+  glTexParameteri(texture->mDimensions, GL_TEXTURE_MAX_LEVEL, texture->mLevels - 1);
+#endif
 #ifdef GP_GL
-    case GL_TEXTURE_1D:
-      if(data->mWidthOffset < 0)
-      {
-        glTexImage1D(data->mDimensions,
-          0,                            // Level of detail (mip-level) (0 is base image)
-          internalFormat,               // Internal format
-          data->mWidth,                 // Width
-          0,                            // Border
-          format,                       // Image format
-          type,                         // Image type
-          (GLvoid*)d                    // data
-        );
-      }
+  // NOTE: GLES has no texture LOD bias.
+  glTexParameterf(texture->mDimensions, GL_TEXTURE_LOD_BIAS, texture->mLODBias);
+#endif
+}
+
+void _gp_texture_free(gp_object* object)
+{
+  gp_texture* texture = (gp_texture*)object;
+  
+  if(texture->mMapped)
+  {
+#ifndef GP_WEB
+    _gp_staging_discard(texture->mStaging);
+#else
+    free(texture->mMapped);
+#endif
+  }
+  
+  _gp_handle_release(&texture->mTexture);
+  free(texture);
+}
+
+gp_texture* gp_texture_new(gp_context* context)
+{
+  gp_texture* texture = malloc(sizeof(gp_texture));
+  _gp_object_init(&texture->mObject, _gp_texture_free);
+  _gp_handle_init(&texture->mTexture, GP_HANDLE_TEXTURE);
+  texture->mDimensions = GL_TEXTURE_2D;
+  texture->mWrapX = GL_CLAMP_TO_EDGE;
+  texture->mWrapY = GL_CLAMP_TO_EDGE;
+  texture->mWrapZ = GL_CLAMP_TO_EDGE;
+  texture->mMinFilter = GP_FILTER_LINEAR;
+  texture->mMagFilter = GP_FILTER_LINEAR;
+  texture->mMipFilter = GP_FILTER_LINEAR;
+  texture->mLODBias = 0.0f;
+  texture->mFormat = GP_FORMAT_RGBA;
+  texture->mType = GP_DATA_TYPE_UBYTE;
+  texture->mInternalFormat = 0;
+  texture->mWidth = 0;
+  texture->mHeight = 0;
+  texture->mDepth = 1;
+  texture->mLevels = 1;
+  texture->mImmutable = 0;
+#ifndef GP_WEB
+  texture->mStaging = NULL;
+#endif
+  texture->mMapped = NULL;
+  
+  return texture;
+}
+
+/*
+ * Retrieve the format and type textures store data as.  Doubles are not a
+ * valid pixel type, and RGB bytes take a slow swizzle path in most drivers,
+ * so both are converted on upload instead.
+ */
+static void _gp_texture_natural(GP_FORMAT format, GP_DATA_TYPE type, GP_FORMAT* f, GP_DATA_TYPE* t)
+{
+  *f = format;
+  *t = type;
+  
+  if(type == GP_DATA_TYPE_DOUBLE)
+    *t = GP_DATA_TYPE_FLOAT;
+  else if(type == GP_DATA_TYPE_UBYTE && format == GP_FORMAT_RGB)
+    *f = GP_FORMAT_RGBA;
+}
+
+/*
+ * Retrieve the number of levels in a full mipmap chain.  Layers of array
+ * textures keep their count down the chain, depth of 3D textures shrinks.
+ */
+static unsigned int _gp_texture_levels(GLuint dimensions, unsigned int width, unsigned int height, unsigned int depth)
+{
+#ifndef GP_GLES2
+  if(dimensions == GL_TEXTURE_3D && depth > width)
+    return gp_mipmap_get_levels(depth, height);
+#endif
+  return gp_mipmap_get_levels(width, height);
+}
+
+/*
+ * Allocate immutable storage for a chain of levels and leave the texture
+ * bound.  Immutable storage can't be reallocated, so a new texture name is
+ * swapped in if storage already exists.
+ */
+static void _gp_texture_storage(gp_texture* texture,
+                                GLuint dimensions,
+                                GP_FORMAT format,
+                                GP_DATA_TYPE type,
+                                unsigned int width,
+                                unsigned int height,
+                                unsigned int depth,
+                                unsigned int levels)
+{
+  GLuint internalFormat = 0;
+  GLuint f = 0;
+  GLuint t = 0;
+  _gp_texture_formats(format, type, &internalFormat, &f, &t);
+  
+  if(texture->mImmutable)
+  {
+    _gp_handle_release(&texture->mTexture);
+    _gp_handle_init(&texture->mTexture, GP_HANDLE_TEXTURE);
+  }
+  
+  glBindTexture(dimensions, _gp_handle_get(&texture->mTexture));
+  
+#ifndef GP_GLES2
+#ifdef GP_GL
+  if(dimensions == GL_TEXTURE_1D)
+    glTexStorage1D(GL_TEXTURE_1D, levels, internalFormat, width);
+  else
+#endif
+  if(dimensions == GL_TEXTURE_3D || dimensions == GL_TEXTURE_2D_ARRAY)
+    glTexStorage3D(dimensions, levels, internalFormat, width, height, depth);
+  else
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height);
+  texture->mImmutable = 1;
+#else
+  // NOTE: GLES2 has no immutable storage, so every level is specified.
+  unsigned int i, w = width, h = height;
+  for(i=0; i<levels; ++i)
+  {
+    glTexImage2D(GL_TEXTURE_2D, i, internalFormat, w, h, 0, f, t, NULL);
+    if(w > 1) w /= 2;
+    if(h > 1) h /= 2;
+  }
+#endif
+  
+  texture->mDimensions = dimensions;
+  texture->mFormat = format;
+  texture->mType = type;
+  texture->mInternalFormat = internalFormat;
+  texture->mWidth = width;
+  texture->mHeight = height;
+  texture->mDepth = depth;
+  texture->mLevels = levels;
+}
+
+/*
+ * Upload blocks as they are.  Mutable textures allocate the base level when
+ * its size or compression changes, and mipmap levels as they arrive in
+ * order.
+ */
+static void _gp_texture_upload_compressed(gp_texture* texture,
+                                          gp_texture_data* data,
+                                          unsigned int level,
+                                          const void* blocks,
+                                          GP_COMPRESSION compression)
+{
+  const GLuint internalFormat = _gp_texture_compressed_format(compression);
+  const GLsizei size = (GLsizei)gp_compress_get_size(compression, data->mWidth, data->mHeight);
+  const int full = data->mWidthOffset < 0;
+  const int resize = texture->mDimensions != GL_TEXTURE_2D ||
+                     data->mWidth != texture->mWidth ||
+                     data->mHeight != texture->mHeight ||
+                     internalFormat != texture->mInternalFormat;
+  const int allocate = full && !texture->mImmutable &&
+                       ((level == 0 && resize) ||
+                        (level > 0 && level == texture->mLevels && internalFormat == texture->mInternalFormat));
+  
+  if(!allocate && level < texture->mLevels && internalFormat != texture->mInternalFormat)
+  {
+    // NOTE: Storage from gp_texture_allocate() is never compressed.
+    gp_log_error("Compressed texture data can not update uncompressed storage");
+    return;
+  }
+  if(!allocate && level >= texture->mLevels)
+  {
+    gp_log_error("Compressed texture data does not match the texture storage");
+    return;
+  }
+  if(!allocate)
+  {
+    // Partial blocks are only allowed where a chunk ends at the edge of the
+    // level.
+    const unsigned int x = data->mWidthOffset < 0 ? 0 : data->mWidthOffset;
+    const unsigned int y = data->mHeightOffset < 0 ? 0 : data->mHeightOffset;
+    const unsigned int width = texture->mWidth >> level ? texture->mWidth >> level : 1;
+    const unsigned int height = texture->mHeight >> level ? texture->mHeight >> level : 1;
+    if((data->mWidth%4 != 0 && x + data->mWidth != width) ||
+       (data->mHeight%4 != 0 && y + data->mHeight != height))
+    {
+      gp_log_error("Compressed chunks must cover whole 4x4 blocks");
+      return;
+    }
+  }
+  
+  glBindTexture(GL_TEXTURE_2D, _gp_handle_get(&texture->mTexture));
+  
+  if(allocate)
+  {
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, data->mWidth, data->mHeight, 0, size, blocks);
+    if(level == 0)
+    {
+      texture->mDimensions = GL_TEXTURE_2D;
+      texture->mInternalFormat = internalFormat;
+      texture->mWidth = data->mWidth;
+      texture->mHeight = data->mHeight;
+      texture->mDepth = 1;
+      texture->mLevels = 1;
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture->mWrapX);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture->mWrapY);
+    }
+    else
+    {
+      texture->mLevels = level + 1;
+    }
+    _gp_texture_apply_filter(texture);
+  }
+  else
+  {
+    glCompressedTexSubImage2D(GL_TEXTURE_2D,
+                              level,
+                              data->mWidthOffset < 0 ? 0 : data->mWidthOffset,
+                              data->mHeightOffset < 0 ? 0 : data->mHeightOffset,
+                              data->mWidth,
+                              data->mHeight,
+                              internalFormat,
+                              size,
+                              blocks);
+  }
+  
+  glBindTexture(GL_TEXTURE_2D, 0);
+  
+  CHECK_GL_ERROR()
+}
+
+static void _gp_texture_upload(gp_texture* texture, gp_texture_data* data, unsigned int level, int compress)
+{
+  if(data->mCompression != GP_COMPRESSION_NONE)
+  {
+    _gp_texture_upload_compressed(texture, data, level, data->mData, data->mCompression);
+    return;
+  }
+  
+  // NOTE: Only asynchronous uploads compress, encoding on the render thread
+  // would stall the frame.
+  if(compress && data->mCompress != GP_COMPRESSION_NONE && data->mData != NULL && data->mDimensions == GL_TEXTURE_2D)
+  {
+    void* blocks = malloc(gp_compress_get_size(data->mCompress, data->mWidth, data->mHeight));
+    if(gp_compress(data->mData, data->mFormat, data->mType, data->mWidth, data->mHeight, data->mCompress, blocks))
+      _gp_texture_upload_compressed(texture, data, level, blocks, data->mCompress);
+    else
+      gp_log_error("Texture data can not be encoded with this compression");
+    free(blocks);
+    return;
+  }
+  
+  GP_FORMAT f;
+  GP_DATA_TYPE t;
+  GLuint internalFormat = 0;
+  GLuint format = 0;
+  GLuint type = 0;
+  _gp_texture_natural(data->mFormat, data->mType, &f, &t);
+  _gp_texture_formats(f, t, &internalFormat, &format, &type);
+  
+  // Full uploads only allocate storage when the size changes, or for
+  // mutable storage the format.  Everything else updates the existing
+  // storage in place, converted to the format it was allocated with.
+  const int full = level == 0 && data->mWidthOffset < 0;
+  const int resize = data->mDimensions != texture->mDimensions ||
+                     data->mWidth != texture->mWidth ||
+                     data->mHeight != texture->mHeight ||
+                     data->mDepth != texture->mDepth;
+  int allocate = full && (resize || (!texture->mImmutable && internalFormat != texture->mInternalFormat));
+  
+  // Wrap and filter state belongs to the texture object and survives
+  // uploads, so it only needs setting when storage is allocated.
+  const int allocated = allocate;
+  
+  if(!allocate && level >= texture->mLevels)
+  {
+    gp_log_error("Texture level %u is not allocated", level);
+    return;
+  }
+  
+  if(allocate && texture->mImmutable)
+  {
+    unsigned int levels = _gp_texture_levels(data->mDimensions, data->mWidth, data->mHeight, data->mDepth);
+    if(levels > texture->mLevels) levels = texture->mLevels;
+    
+    _gp_texture_storage(texture,
+                        data->mDimensions,
+                        texture->mFormat,
+                        texture->mType,
+                        data->mWidth,
+                        data->mHeight,
+                        data->mDepth,
+                        levels);
+    allocate = 0;
+  }
+  else
+  {
+    glBindTexture(data->mDimensions, _gp_handle_get(&texture->mTexture));
+  }
+  
+  if(!allocate)
+  {
+    f = texture->mFormat;
+    t = texture->mType;
+    _gp_texture_formats(f, t, &internalFormat, &format, &type);
+  }
+  
+  if(allocated)
+  {
+    glTexParameteri(data->mDimensions, GL_TEXTURE_WRAP_S, texture->mWrapX);
+    glTexParameteri(data->mDimensions, GL_TEXTURE_WRAP_T, texture->mWrapY);
+#ifndef GP_GLES2
+    if(data->mDimensions == GL_TEXTURE_3D)
+      glTexParameteri(data->mDimensions, GL_TEXTURE_WRAP_R, texture->mWrapZ);
+#endif
+  }
+  
+  // Nothing to write into storage that already exists.
+  if(!allocate && data->mData == NULL)
+  {
+    if(allocated) _gp_texture_apply_filter(texture);
+    glBindTexture(data->mDimensions, 0);
+    return;
+  }
+  
+  const int* swizzle = data->mSwizzle[0] < 0 ? NULL : data->mSwizzle;
+  const int convert = f != data->mFormat || t != data->mType || swizzle != NULL;
+  const size_t count = (size_t)data->mWidth*data->mHeight*data->mDepth;
+  const size_t size = gp_data_type_get_size(t)*f*count;
+  
+  GLvoid* d = data->mData;
+  void* converted = NULL;
+#ifndef GP_WEB
+  if(data->mStaging && convert)
+  {
+    // Pixels were written straight into a staging buffer in a format the
+    // storage does not hold.  The mapping is write only, so map it again
+    // for reading to copy them out for conversion.
+    const size_t mapped = gp_data_type_get_size(data->mType)*data->mFormat*count;
+    d = malloc(mapped);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, data->mStaging->mBuffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    const void* pixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, mapped, GL_MAP_READ_BIT);
+    if(pixels)
+    {
+      memcpy(d, pixels, mapped);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    _gp_staging_release(data->mStaging);
+    data->mStaging = NULL;
+    data->mData = d;
+    if(pixels == NULL)
+    {
+      gp_log_error("Staged texture data could not be read back for conversion");
+      glBindTexture(data->mDimensions, 0);
+      return;
+    }
+  }
+  
+  _gp_staging_buffer* staging = NULL;
+  if(data->mStaging)
+  {
+    // Pixels were written straight into the staging buffer, so the upload
+    // only needs to unmap it.
+    staging = data->mStaging;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging->mBuffer);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    data->mStaging = NULL;
+    data->mData = NULL;
+    d = 0;
+  }
+  else if(data->mData != 0)
+  {
+    // The staging buffer is no longer read by the GPU, so there is nothing
+    // to synchronize with when mapping it.  Data is converted straight into
+    // the mapping.
+    staging = _gp_staging_acquire(size);
+    GLubyte* ptr = (GLubyte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                              0,
+                                              size,
+                                              GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if(ptr)
+    {
+      if(convert)
+        _gp_staging_convert(ptr, f, t, data->mData, data->mFormat, data->mType, swizzle, count);
+      else
+        _gp_staging_copy(ptr, data->mData, size);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      d = 0;
+    }
+    else
+    {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      _gp_staging_release(staging);
+      staging = NULL;
+    }
+    CHECK_GL_ERROR()
+  }
+#endif
+  
+  if(d && convert)
+  {
+    converted = malloc(size);
+    gp_convert(data->mData, data->mFormat, data->mType, converted, f, t, swizzle, count);
+    d = converted;
+  }
+  
+  // Rows of odd RGB widths and small mipmap levels are rarely a multiple
+  // of the default unpack alignment of 4.  Data is tightly packed, so use
+  // the largest alignment its rows satisfy.
+  const size_t row = gp_data_type_get_size(t)*f*data->mWidth;
+  const GLint alignment = (GLint)gp_copy_alignment(row);
+  const int packed = alignment != 4;
+  if(packed) glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  
+  const GLint x = data->mWidthOffset < 0 ? 0 : data->mWidthOffset;
+  const GLint y = data->mHeightOffset < 0 ? 0 : data->mHeightOffset;
+  const GLint z = data->mDepthOffset < 0 ? 0 : data->mDepthOffset;
+  
+  switch(data->mDimensions)
+  {
+#ifdef GP_GL
+    case GL_TEXTURE_1D:
+      if(allocate)
+      {
+        glTexImage1D(data->mDimensions,
+          0,                            // Level of detail (mip-level) (0 is base image)
+          internalFormat,               // Internal format
+          data->mWidth,                 // Width
+          0,                            // Border
+          format,                       // Image format
+          type,                         // Image type
+          (GLvoid*)d                    // data
+        );
+      }
       else
       {
         glTexSubImage1D(data->mDimensions,
-          0,
-          data->mWidthOffset,
+          level,
+          x,
           data->mWidth,
           format,
           type,
@@ -309,7 +1200,7 @@ void gp_texture_set_data(gp_texture* texture, gp_texture_data* data)
       break;
 #endif
     case GL_TEXTURE_2D:
-      if(data->mWidthOffset < 0)
+      if(allocate)
       {
         glTexImage2D(data->mDimensions,
           0,                            // Level of detail (mip-level) (0 is base image)
@@ -325,29 +1216,536 @@ void gp_texture_set_data(gp_texture* texture, gp_texture_data* data)
       else
       {
         glTexSubImage2D(data->mDimensions,
-          0,
-          data->mWidthOffset,
-          data->mHeightOffset,
+          level,
+          x,
+          y,
+          data->mWidth,
+          data->mHeight,
+          format,
+          type,
+          (GLvoid*)d
+        );
+      }
+      break;
+#ifndef GP_GLES2
+    case GL_TEXTURE_3D:
+    case GL_TEXTURE_2D_ARRAY:
+      if(allocate)
+      {
+        glTexImage3D(data->mDimensions,
+          0,                            // Level of detail (mip-level) (0 is base image)
+          internalFormat,               // Internal format
+          data->mWidth,                 // Width
+          data->mHeight,                // Height
+          data->mDepth,                 // Depth or layers
+          0,                            // Border
+          format,                       // Image format
+          type,                         // Image type
+          (GLvoid*)d                    // data
+        );
+      }
+      else
+      {
+        glTexSubImage3D(data->mDimensions,
+          level,
+          x,
+          y,
+          z,
           data->mWidth,
           data->mHeight,
+          data->mDepth,
           format,
           type,
           (GLvoid*)d
         );
       }
       break;
+#endif
+  }
+  
+  if(packed) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  
+#ifndef GP_WEB
+  if(staging)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    _gp_staging_release(staging);
+  }
+#endif
+  if(converted) free(converted);
+  
+  if(allocate)
+  {
+    texture->mDimensions = data->mDimensions;
+    texture->mFormat = f;
+    texture->mType = t;
+    texture->mInternalFormat = internalFormat;
+    texture->mWidth = data->mWidth;
+    texture->mHeight = data->mHeight;
+    texture->mDepth = data->mDepth;
+    texture->mLevels = 1;
+  }
+  if(allocated) _gp_texture_apply_filter(texture);
+  
+  glBindTexture(data->mDimensions, 0);
+  
+  CHECK_GL_ERROR()
+}
+
+static void _gp_texture_set_data(gp_texture* texture, gp_texture_data* data, unsigned int level, int compress)
+{
+  if(data->mShared == NULL)
+  {
+    _gp_texture_upload(texture, data, level, compress);
+    return;
+  }
+  
+  // NOTE: The frame is copied out of the shared memory before uploading, so
+  // a torn frame never reaches the GPU and the texture keeps the last one.
+  const size_t size = gp_data_type_get_size(data->mType)*data->mFormat*data->mWidth*data->mHeight;
+  gp_texture_data frame = *data;
+  frame.mData = malloc(size);
+  frame.mShared = NULL;
+  
+  if(_gp_shared_read(data->mShared, frame.mData, size, GP_SHARED_UPLOAD_TRIES, &data->mSequence))
+    _gp_texture_upload(texture, &frame, level, compress);
+  else
+    gp_log_debug("Shared texture data changed during upload, frame skipped");
+  
+  free(frame.mData);
+}
+
+void gp_texture_set_data(gp_texture* texture, gp_texture_data* data)
+{
+  _gp_texture_set_data(texture, data, 0, 0);
+}
+
+void gp_texture_set_level(gp_texture* texture, gp_texture_data* data, unsigned int level)
+{
+  _gp_texture_set_data(texture, data, level, 0);
+}
+
+static void _gp_texture_allocate(gp_texture* texture,
+                                 GLuint dimensions,
+                                 GP_FORMAT format,
+                                 GP_DATA_TYPE type,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 unsigned int depth,
+                                 unsigned int levels)
+{
+  GP_FORMAT f;
+  GP_DATA_TYPE t;
+  _gp_texture_natural(format, type, &f, &t);
+  
+  const unsigned int maxLevels = _gp_texture_levels(dimensions, width, height, depth);
+  if(levels == 0 || levels > maxLevels) levels = maxLevels;
+  
+  _gp_texture_storage(texture, dimensions, f, t, width, height, depth, levels);
+  
+  glTexParameteri(dimensions, GL_TEXTURE_WRAP_S, texture->mWrapX);
+  glTexParameteri(dimensions, GL_TEXTURE_WRAP_T, texture->mWrapY);
+#ifndef GP_GLES2
+  if(dimensions == GL_TEXTURE_3D)
+    glTexParameteri(dimensions, GL_TEXTURE_WRAP_R, texture->mWrapZ);
+#endif
+  _gp_texture_apply_filter(texture);
+  glBindTexture(dimensions, 0);
+  
+  CHECK_GL_ERROR()
+}
+
+void gp_texture_allocate(gp_texture* texture,
+                         GP_FORMAT format,
+                         GP_DATA_TYPE type,
+                         unsigned int width,
+                         unsigned int height,
+                         unsigned int levels)
+{
+  // NOTE: Only desktop GL supports 1D textures.
+#ifdef GP_GL
+  const GLuint dimensions = height == 0 ? GL_TEXTURE_1D : GL_TEXTURE_2D;
+#else
+  const GLuint dimensions = GL_TEXTURE_2D;
+#endif
+  if(height == 0) height = 1;
+  
+  _gp_texture_allocate(texture, dimensions, format, type, width, height, 1, levels);
+}
+
+void gp_texture_allocate_3d(gp_texture* texture,
+                            GP_FORMAT format,
+                            GP_DATA_TYPE type,
+                            unsigned int width,
+                            unsigned int height,
+                            unsigned int depth,
+                            unsigned int levels)
+{
+#ifndef GP_GLES2
+  _gp_texture_allocate(texture, GL_TEXTURE_3D, format, type, width, height, depth, levels);
+#else
+  gp_log_error("3D textures are not supported by GLES2");
+#endif
+}
+
+void gp_texture_allocate_2d_array(gp_texture* texture,
+                                  GP_FORMAT format,
+                                  GP_DATA_TYPE type,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  unsigned int layers,
+                                  unsigned int levels)
+{
+#ifndef GP_GLES2
+  _gp_texture_allocate(texture, GL_TEXTURE_2D_ARRAY, format, type, width, height, layers, levels);
+#else
+  gp_log_error("Array textures are not supported by GLES2");
+#endif
+}
+
+void gp_texture_generate_mipmaps(gp_texture* texture)
+{
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+  
+  // Mutable storage grows a full chain, immutable storage keeps its levels.
+  if(!texture->mImmutable)
+    texture->mLevels = _gp_texture_levels(texture->mDimensions, texture->mWidth, texture->mHeight, texture->mDepth);
+  
+  // NOTE: The level range must be set before generating, as
+  // glGenerateMipmap only fills levels up to GL_TEXTURE_MAX_LEVEL.
+  _gp_texture_apply_filter(texture);
+  glGenerateMipmap(texture->mDimensions);
+  glBindTexture(texture->mDimensions, 0);
+  
+  CHECK_GL_ERROR()
+}
+
+void gp_texture_set_filter(gp_texture* texture, GP_FILTER min, GP_FILTER mag, GP_FILTER mip)
+{
+  texture->mMinFilter = min;
+  texture->mMagFilter = mag;
+  texture->mMipFilter = mip;
+  
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+  _gp_texture_apply_filter(texture);
+  glBindTexture(texture->mDimensions, 0);
+}
+
+void gp_texture_set_lod_bias(gp_texture* texture, float bias)
+{
+  texture->mLODBias = bias;
+  
+#ifdef GP_GL
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+  glTexParameterf(texture->mDimensions, GL_TEXTURE_LOD_BIAS, bias);
+  glBindTexture(texture->mDimensions, 0);
+#endif
+}
+
+void* gp_texture_map_region(gp_texture* texture,
+                            unsigned int x,
+                            unsigned int y,
+                            unsigned int width,
+                            unsigned int height,
+                            GP_FORMAT format,
+                            GP_DATA_TYPE type,
+                            unsigned int* pitch)
+{
+  if(texture->mMapped)
+  {
+    gp_log_error("Texture already has a mapped region");
+    return NULL;
+  }
+  if(type == GP_DATA_TYPE_DOUBLE)
+  {
+    gp_log_error("Double texture regions are not supported");
+    return NULL;
+  }
+  if(texture->mDepth > 1)
+  {
+    gp_log_error("Regions of 3D and array textures are not supported");
+    return NULL;
+  }
+  if(texture->mWidth == 0)
+  {
+    gp_log_error("Regions can only be mapped in allocated textures");
+    return NULL;
+  }
+  if(x + width > texture->mWidth || y + height > texture->mHeight)
+  {
+    gp_log_error("Texture region is not inside the texture");
+    return NULL;
   }
   
+  // Rows are padded to the default GL_UNPACK_ALIGNMENT of 4.
+  const unsigned int row = (unsigned int)gp_copy_pitch(gp_data_type_get_size(type)*format*width, 4);
+  const size_t size = (size_t)row*height;
+  
 #ifndef GP_WEB
+  _gp_staging_buffer* staging = _gp_staging_acquire(size);
+  void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                               0,
+                               size,
+                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  if(ptr == NULL)
+  {
+    gp_log_error("Failed to map texture region");
+    _gp_staging_release(staging);
+    return NULL;
+  }
+  texture->mStaging = staging;
+#else
+  void* ptr = malloc(size);
+#endif
+  
+  GLuint internalFormat;
+  _gp_texture_formats(format, type, &internalFormat, &texture->mMapFormat, &texture->mMapType);
+  texture->mMapped = ptr;
+  texture->mMapRegion[0] = x;
+  texture->mMapRegion[1] = y;
+  texture->mMapRegion[2] = width;
+  texture->mMapRegion[3] = height;
+  
+  if(pitch) *pitch = row;
+  return ptr;
+}
+
+void gp_texture_unmap_commit(gp_texture* texture)
+{
+  if(texture->mMapped == NULL)
+  {
+    gp_log_error("Texture has no mapped region");
+    return;
+  }
+  
+  GLvoid* d = texture->mMapped;
+#ifndef GP_WEB
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, texture->mStaging->mBuffer);
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  d = 0;
 #endif
-  glBindTexture(data->mDimensions, texture->mTexture);
   
-  texture->mDimensions = data->mDimensions;
+  const int* region = texture->mMapRegion;
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+#ifdef GP_GL
+  if(texture->mDimensions == GL_TEXTURE_1D)
+    glTexSubImage1D(GL_TEXTURE_1D, 0, region[0], region[2], texture->mMapFormat, texture->mMapType, d);
+  else
+#endif
+    glTexSubImage2D(GL_TEXTURE_2D, 0, region[0], region[1], region[2], region[3], texture->mMapFormat, texture->mMapType, d);
+  
+#ifndef GP_WEB
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  _gp_staging_release(texture->mStaging);
+  texture->mStaging = NULL;
+#else
+  free(texture->mMapped);
+#endif
+  texture->mMapped = NULL;
   
   CHECK_GL_ERROR()
 }
 
+void gp_texture_set_regions(gp_texture* texture,
+                            const void* image,
+                            GP_FORMAT format,
+                            GP_DATA_TYPE type,
+                            unsigned int row_length,
+                            const unsigned int* regions,
+                            unsigned int count)
+{
+  if(count == 0) return;
+  if(texture->mDimensions != GL_TEXTURE_2D || texture->mDepth > 1)
+  {
+    gp_log_error("Regions can only be uploaded to allocated 2D textures");
+    return;
+  }
+  
+  // Rectangles are packed one after the other, with rows padded to the
+  // default GL_UNPACK_ALIGNMENT of 4 so every rectangle starts aligned.
+  const GP_FORMAT f = texture->mFormat;
+  const GP_DATA_TYPE t = texture->mType;
+  const int convert = f != format || t != type;
+  const size_t srcPixel = gp_data_type_get_size(type)*format;
+  const size_t dstPixel = gp_data_type_get_size(t)*f;
+  size_t size = 0;
+  unsigned int i, y;
+  for(i=0; i<count; ++i)
+  {
+    const unsigned int* r = regions + i*4;
+    if(r[0] + r[2] > texture->mWidth || r[1] + r[3] > texture->mHeight)
+    {
+      gp_log_error("Texture region is not inside the texture");
+      return;
+    }
+    size += gp_copy_pitch(dstPixel*r[2], 4)*r[3];
+  }
+  
+#ifndef GP_WEB
+  _gp_staging_buffer* staging = _gp_staging_acquire(size);
+  GLubyte* ptr = (GLubyte*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                            0,
+                                            size,
+                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+  if(ptr == NULL)
+  {
+    gp_log_error("Failed to map texture regions");
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    _gp_staging_release(staging);
+    return;
+  }
+#else
+  GLubyte* ptr = malloc(size);
+#endif
+  
+  size_t offset = 0;
+  for(i=0; i<count; ++i)
+  {
+    const unsigned int* r = regions + i*4;
+    const size_t row = gp_copy_pitch(dstPixel*r[2], 4);
+    const GLubyte* src = (const GLubyte*)image + srcPixel*((size_t)r[1]*row_length + r[0]);
+    for(y=0; y<r[3]; ++y)
+    {
+      if(convert)
+        gp_convert(src, format, type, ptr + offset + row*y, f, t, NULL, r[2]);
+      else
+        memcpy(ptr + offset + row*y, src, dstPixel*r[2]);
+      src += srcPixel*row_length;
+    }
+    offset += row*r[3];
+  }
+  
+  GLuint internalFormat, glFormat, glType;
+  _gp_texture_formats(f, t, &internalFormat, &glFormat, &glType);
+  
+#ifndef GP_WEB
+  glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  const uintptr_t base = 0;
+#else
+  const uintptr_t base = (uintptr_t)ptr;
+#endif
+  
+  glBindTexture(GL_TEXTURE_2D, _gp_handle_get(&texture->mTexture));
+  offset = 0;
+  for(i=0; i<count; ++i)
+  {
+    const unsigned int* r = regions + i*4;
+    glTexSubImage2D(GL_TEXTURE_2D, 0, r[0], r[1], r[2], r[3], glFormat, glType, (const GLvoid*)(base + offset));
+    offset += ((dstPixel*r[2] + 3) & ~(size_t)3)*r[3];
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  
+#ifndef GP_WEB
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  _gp_staging_release(staging);
+#else
+  free(ptr);
+#endif
+  
+  CHECK_GL_ERROR()
+}
+
+typedef struct
+{
+  gp_texture*             mTexture;
+  unsigned int            mRegion[4];
+  GP_FORMAT               mFormat;
+  GP_DATA_TYPE            mType;
+  void*                   mData;
+  unsigned int            mPitch;
+  void                    (*mMapCallback)(void*, unsigned int, void*);
+  void                    (*mCallback)(void*);
+  void*                   mUserData;
+} _gp_texture_map_async;
+
+void _gp_texture_map_async_func(void* data)
+{
+  _gp_texture_map_async* async = (_gp_texture_map_async*)data;
+  
+  async->mData = gp_texture_map_region(async->mTexture,
+                                       async->mRegion[0],
+                                       async->mRegion[1],
+                                       async->mRegion[2],
+                                       async->mRegion[3],
+                                       async->mFormat,
+                                       async->mType,
+                                       &async->mPitch);
+}
+
+void _gp_texture_map_join_func(void* data)
+{
+  _gp_texture_map_async* async = (_gp_texture_map_async*)data;
+  
+  if(async->mMapCallback)
+    async->mMapCallback(async->mData, async->mPitch, async->mUserData);
+  
+  gp_object_unref((gp_object*)async->mTexture);
+  free(async);
+}
+
+void gp_texture_map_region_async(gp_texture* texture,
+                                 unsigned int x,
+                                 unsigned int y,
+                                 unsigned int width,
+                                 unsigned int height,
+                                 GP_FORMAT format,
+                                 GP_DATA_TYPE type,
+                                 void (*callback)(void* data, unsigned int pitch, void* userdata),
+                                 void* userdata)
+{
+  _gp_texture_map_async* async = malloc(sizeof(_gp_texture_map_async));
+  async->mTexture = texture;
+  async->mRegion[0] = x;
+  async->mRegion[1] = y;
+  async->mRegion[2] = width;
+  async->mRegion[3] = height;
+  async->mFormat = format;
+  async->mType = type;
+  async->mData = NULL;
+  async->mPitch = 0;
+  async->mMapCallback = callback;
+  async->mUserData = userdata;
+  
+  gp_object_ref((gp_object*)texture);
+  
+  _gp_api_work(_gp_texture_map_async_func, _gp_texture_map_join_func, (void*)async);
+}
+
+void _gp_texture_commit_async_func(void* data)
+{
+  _gp_texture_map_async* async = (_gp_texture_map_async*)data;
+  
+  gp_texture_unmap_commit(async->mTexture);
+  
+  _gp_handle_collect(GP_HANDLE_WORKER);
+  
+  glFlush();
+}
+
+void _gp_texture_commit_join_func(void* data)
+{
+  _gp_texture_map_async* async = (_gp_texture_map_async*)data;
+  
+  if(async->mCallback)
+    async->mCallback(async->mUserData);
+  
+  gp_object_unref((gp_object*)async->mTexture);
+  free(async);
+}
+
+void gp_texture_unmap_commit_async(gp_texture* texture, void (*callback)(void*), void* userdata)
+{
+  _gp_texture_map_async* async = malloc(sizeof(_gp_texture_map_async));
+  async->mTexture = texture;
+  async->mCallback = callback;
+  async->mUserData = userdata;
+  
+  gp_object_ref((gp_object*)texture);
+  
+  _gp_api_work(_gp_texture_commit_async_func, _gp_texture_commit_join_func, (void*)async);
+}
+
 GLuint _gp_wrap_to_gl(GP_WRAP wrap)
 {
   switch(wrap)
@@ -375,7 +1773,7 @@ void gp_texture_set_wrap_x(gp_texture* texture, GP_WRAP wrap)
   
   texture->mWrapX = w;
   
-  glBindTexture(texture->mDimensions, texture->mTexture);
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
   glTexParameteri(texture->mDimensions, GL_TEXTURE_WRAP_S, texture->mWrapX);
   glBindTexture(texture->mDimensions, 0);
 }
@@ -387,11 +1785,27 @@ void gp_texture_set_wrap_y(gp_texture* texture, GP_WRAP wrap)
   
   texture->mWrapY = w;
   
-  glBindTexture(texture->mDimensions, texture->mTexture);
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
   glTexParameteri(texture->mDimensions, GL_TEXTURE_WRAP_T, texture->mWrapY);
   glBindTexture(texture->mDimensions, 0);
 }
 
+void gp_texture_set_wrap_z(gp_texture* texture, GP_WRAP wrap)
+{
+  GLuint w = _gp_wrap_to_gl(wrap);
+  if(w == texture->mWrapZ) return;
+  
+  texture->mWrapZ = w;
+  
+#ifndef GP_GLES2
+  if(texture->mDimensions != GL_TEXTURE_3D) return;
+  
+  glBindTexture(texture->mDimensions, _gp_handle_get(&texture->mTexture));
+  glTexParameteri(texture->mDimensions, GL_TEXTURE_WRAP_R, texture->mWrapZ);
+  glBindTexture(texture->mDimensions, 0);
+#endif
+}
+
 typedef struct
 {
   gp_texture*         mTexture;
@@ -404,11 +1818,13 @@ void _gp_texture_async_func(void* data)
 {
   _gp_texture_async* async = (_gp_texture_async*)data;
   
-  gp_texture_set_data(async->mTexture, async->mData);
+  _gp_texture_set_data(async->mTexture, async->mData, 0, 1);
   
   gp_object_unref((gp_object*)async->mTexture);
   gp_object_unref((gp_object*)async->mData);
   
+  _gp_handle_collect(GP_HANDLE_WORKER);
+  
   glFlush();
 }
 
@@ -437,3 +1853,227 @@ void gp_texture_set_data_async(gp_texture* texture, gp_texture_data* data, void
   
   _gp_api_work(_gp_texture_async_func, _gp_texture_join_func, (void*)async);
 }
+
+/*
+ * Image file waiting to be loaded by gp_texture_load_async().
+ */
+typedef struct
+{
+  gp_list_node            mNode;
+  gp_texture*             mTexture;
+  char*                   mPath;
+  void                    (*mCallback)(int, void*);
+  void*                   mUserData;
+  void*                   mFile;            // Contents of the file once read
+  size_t                  mSize;
+  unsigned int            mWidth;
+  unsigned int            mHeight;
+  gp_texture_data*        mData;            // Pixels, mapped in a staging buffer if possible
+  int                     mDecoded;
+  int                     mConvert;         // Storage held another format when queued
+} _gp_texture_load;
+
+/*
+ * Loads taken off the queue by one job.  Loads handed to
+ * gp_texture_set_data_async() are cleared, the rest failed.
+ */
+typedef struct
+{
+  _gp_texture_load*       mLoads[GP_PARALLEL_MAX_THREADS*GP_TEXTURE_LOAD_BATCH];
+  size_t                  mCount;
+} _gp_texture_load_batch;
+
+// Images queued by gp_texture_load_async() from any thread.
+static gp_lock sLoadLock = GP_LOCK_INIT;
+static gp_list sLoads;
+static int sLoadInitialized = 0;
+static int sLoadScheduled = 0;
+
+static void _gp_texture_load_read(void* userdata, size_t index)
+{
+  _gp_texture_load* load = ((_gp_texture_load**)userdata)[index];
+  
+  load->mFile = _gp_image_read(load->mPath, &load->mSize, &load->mWidth, &load->mHeight);
+}
+
+static void _gp_texture_load_decode(void* userdata, size_t index)
+{
+  _gp_texture_load* load = ((_gp_texture_load**)userdata)[index];
+  if(load->mData == NULL) return;
+  
+  load->mDecoded = gp_image_decode(load->mFile, load->mSize, load->mData->mData, (size_t)load->mWidth*4);
+  
+  free(load->mFile);
+  load->mFile = NULL;
+}
+
+static void _gp_texture_load_finish(_gp_texture_load* load, int success)
+{
+  if(!success)
+    gp_log_error("Failed to load image %s", load->mPath);
+  
+  if(load->mCallback)
+    load->mCallback(success, load->mUserData);
+  
+  gp_object_unref((gp_object*)load->mTexture);
+  free(load->mPath);
+  free(load);
+}
+
+static void _gp_texture_load_done(void* userdata)
+{
+  _gp_texture_load_finish((_gp_texture_load*)userdata, 1);
+}
+
+static void _gp_texture_load_func(void* data);
+static void _gp_texture_load_join(void* data);
+
+static void _gp_texture_load_schedule()
+{
+  _gp_texture_load_batch* batch = malloc(sizeof(_gp_texture_load_batch));
+  batch->mCount = 0;
+  
+  _gp_api_work(_gp_texture_load_func, _gp_texture_load_join, (void*)batch);
+}
+
+/*
+ * Read and decode a batch of images on the pool.  Pixels are decoded
+ * straight into staging buffers mapped on the worker context, then every
+ * image is queued for upload behind this job.  Later batches are queued
+ * after those uploads, which bounds the memory held by mapped buffers.
+ */
+static void _gp_texture_load_func(void* data)
+{
+  _gp_texture_load_batch* batch = (_gp_texture_load_batch*)data;
+  const size_t max = (size_t)gp_parallel_get_threads()*GP_TEXTURE_LOAD_BATCH;
+  
+  gp_lock_acquire(&sLoadLock);
+  while(batch->mCount < max && gp_list_front(&sLoads) != gp_list_end(&sLoads))
+  {
+    gp_list_node* node = gp_list_front(&sLoads);
+    gp_list_remove(&sLoads, node);
+    batch->mLoads[batch->mCount++] = (_gp_texture_load*)node;
+  }
+  gp_lock_release(&sLoadLock);
+  
+  gp_parallel_for(batch->mCount, _gp_texture_load_read, batch->mLoads);
+  
+  size_t i;
+  for(i=0; i<batch->mCount; ++i)
+  {
+    _gp_texture_load* load = batch->mLoads[i];
+    if(load->mFile == NULL) continue;
+    
+    gp_texture_data* td = gp_texture_data_new();
+    gp_texture_data_set_2d(td, NULL, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, load->mWidth, load->mHeight);
+    
+    const size_t size = (size_t)load->mWidth*load->mHeight*4;
+#ifndef GP_WEB
+    // Mappings are write only, so pixels converted to the format of
+    // immutable storage are decoded into memory the upload can read.
+    if(!load->mConvert)
+    {
+      _gp_staging_buffer* staging = _gp_staging_acquire(size);
+      td->mData = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                   0,
+                                   size,
+                                   GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+      if(td->mData)
+        td->mStaging = staging;
+      else
+        _gp_staging_release(staging);
+    }
+#endif
+    if(td->mData == NULL) td->mData = malloc(size);
+    
+    load->mData = td;
+  }
+#ifndef GP_WEB
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+#endif
+  
+  gp_parallel_for(batch->mCount, _gp_texture_load_decode, batch->mLoads);
+  
+  for(i=0; i<batch->mCount; ++i)
+  {
+    _gp_texture_load* load = batch->mLoads[i];
+    if(load->mData == NULL) continue;
+    
+    // Freeing data that was not uploaded discards its staging buffer.
+    if(load->mDecoded)
+    {
+      gp_texture_set_data_async(load->mTexture, load->mData, _gp_texture_load_done, load);
+      batch->mLoads[i] = NULL;
+    }
+    gp_object_unref((gp_object*)load->mData);
+    load->mData = NULL;
+  }
+  
+  _gp_handle_collect(GP_HANDLE_WORKER);
+  
+  glFlush();
+  
+  gp_lock_acquire(&sLoadLock);
+  const int more = gp_list_front(&sLoads) != gp_list_end(&sLoads);
+  sLoadScheduled = more;
+  gp_lock_release(&sLoadLock);
+  
+  if(more) _gp_texture_load_schedule();
+}
+
+static void _gp_texture_load_join(void* data)
+{
+  _gp_texture_load_batch* batch = (_gp_texture_load_batch*)data;
+  
+  size_t i;
+  for(i=0; i<batch->mCount; ++i)
+  {
+    if(batch->mLoads[i])
+      _gp_texture_load_finish(batch->mLoads[i], 0);
+  }
+  
+  free(batch);
+}
+
+void gp_texture_load_async(gp_texture* texture,
+                           const char* path,
+                           void (*callback)(int success, void* userdata),
+                           void* userdata)
+{
+  _gp_texture_load* load = malloc(sizeof(_gp_texture_load));
+  load->mTexture = texture;
+  load->mPath = strdup(path);
+  load->mCallback = callback;
+  load->mUserData = userdata;
+  load->mFile = NULL;
+  load->mSize = 0;
+  load->mWidth = 0;
+  load->mHeight = 0;
+  load->mData = NULL;
+  load->mDecoded = 0;
+  
+  gp_object_ref((gp_object*)texture);
+  
+  gp_lock_acquire(&sLoadLock);
+  
+  //
+  // Snapshot the storage format here, on the thread that allocates it, as
+  // the worker must not read texture state.  Storage allocated after this
+  // is still handled, the upload reads staged pixels back to convert them.
+  //
+  load->mConvert = texture->mImmutable &&
+                   (texture->mFormat != GP_FORMAT_RGBA || texture->mType != GP_DATA_TYPE_UBYTE);
+  
+  if(!sLoadInitialized)
+  {
+    gp_list_init(&sLoads);
+    sLoadInitialized = 1;
+  }
+  gp_list_push_back(&sLoads, &load->mNode);
+  const int schedule = !sLoadScheduled;
+  sLoadScheduled = 1;
+  gp_lock_release(&sLoadLock);
+  
+  // NOTE: Web runs work immediately, so the job must not start under the lock.
+  if(schedule) _gp_texture_load_schedule();
+}
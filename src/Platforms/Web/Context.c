@@ -115,6 +115,8 @@ void _gp_context_free(gp_object* object)
 {
   gp_context* context = (gp_context*)object;
   
+  _gp_handle_shutdown();
+  
   free(context);
 }
 
@@ -116,6 +116,15 @@ void _gp_context_free(gp_object* object)
 {
   gp_context* context = (gp_context*)object;
   
+  pthread_mutex_lock(&context->mWorkMutex);
+  context->mState &= ~GP_STATE_RUNNING;
+  pthread_cond_signal(&sContext->mWorkCV);
+  pthread_mutex_unlock(&context->mWorkMutex);
+  pthread_join(context->mWorkThread, NULL);
+  
+  // Objects released since the last frame still need the context.
+  _gp_handle_shutdown();
+  
   glXDestroyContext(context->mDisplay, context->mShare);
   XFreeColormap(context->mDisplay, context->mColorMap);
   XFree(context->mVisualInfo);
@@ -124,11 +133,6 @@ void _gp_context_free(gp_object* object)
   close(context->mWorkPipe[0]);
   close(context->mWorkPipe[1]);
   
-  pthread_mutex_lock(&context->mWorkMutex);
-  context->mState &= ~GP_STATE_RUNNING;
-  pthread_cond_signal(&sContext->mWorkCV);
-  pthread_mutex_unlock(&context->mWorkMutex);
-  pthread_join(context->mWorkThread, NULL);
   free(context);
 }
 
@@ -0,0 +1,367 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include <GraphicsPipeline/Compress.h>
+#include <GraphicsPipeline/Convert.h>
+
+#include "Parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_COMPRESS_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_COMPRESS_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct
+{
+  const uint8_t*          mSrc;
+  GP_FORMAT               mFormat;
+  GP_DATA_TYPE            mType;
+  unsigned int            mWidth;
+  unsigned int            mHeight;
+  GP_COMPRESSION          mCompression;
+  uint8_t*                mDst;
+} _gp_compress_job;
+
+static unsigned int _gp_compress_block_size(GP_COMPRESSION compression)
+{
+  switch(compression)
+  {
+    case GP_COMPRESSION_BC1:
+    case GP_COMPRESSION_BC4:
+    case GP_COMPRESSION_ETC2_RGB:
+      return 8;
+    case GP_COMPRESSION_BC3:
+    case GP_COMPRESSION_BC5:
+    case GP_COMPRESSION_ETC2_RGBA:
+      return 16;
+    default:
+      return 0;
+  }
+}
+
+size_t gp_compress_get_size(GP_COMPRESSION compression, unsigned int width, unsigned int height)
+{
+  return (size_t)((width + 3)/4)*((height + 3)/4)*_gp_compress_block_size(compression);
+}
+
+/*
+ * Minimum and maximum of every component over the 16 RGBA pixels of a block.
+ */
+static void _gp_compress_bounds(const uint8_t* block, uint8_t* lo, uint8_t* hi)
+{
+#if defined(GP_COMPRESS_SSE2)
+  __m128i r0 = _mm_loadu_si128((const __m128i*)(block));
+  __m128i r1 = _mm_loadu_si128((const __m128i*)(block+16));
+  __m128i r2 = _mm_loadu_si128((const __m128i*)(block+32));
+  __m128i r3 = _mm_loadu_si128((const __m128i*)(block+48));
+  __m128i mn = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+  __m128i mx = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 8));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 8));
+  mn = _mm_min_epu8(mn, _mm_srli_si128(mn, 4));
+  mx = _mm_max_epu8(mx, _mm_srli_si128(mx, 4));
+  uint32_t l = (uint32_t)_mm_cvtsi128_si32(mn);
+  uint32_t h = (uint32_t)_mm_cvtsi128_si32(mx);
+  memcpy(lo, &l, 4);
+  memcpy(hi, &h, 4);
+#elif defined(GP_COMPRESS_NEON)
+  uint8x16_t r0 = vld1q_u8(block);
+  uint8x16_t r1 = vld1q_u8(block+16);
+  uint8x16_t r2 = vld1q_u8(block+32);
+  uint8x16_t r3 = vld1q_u8(block+48);
+  uint8x16_t mn = vminq_u8(vminq_u8(r0, r1), vminq_u8(r2, r3));
+  uint8x16_t mx = vmaxq_u8(vmaxq_u8(r0, r1), vmaxq_u8(r2, r3));
+  uint8x8_t mn8 = vmin_u8(vget_low_u8(mn), vget_high_u8(mn));
+  uint8x8_t mx8 = vmax_u8(vget_low_u8(mx), vget_high_u8(mx));
+  mn8 = vmin_u8(mn8, vext_u8(mn8, mn8, 4));
+  mx8 = vmax_u8(mx8, vext_u8(mx8, mx8, 4));
+  vst1_lane_u32((uint32_t*)lo, vreinterpret_u32_u8(mn8), 0);
+  vst1_lane_u32((uint32_t*)hi, vreinterpret_u32_u8(mx8), 0);
+#else
+  int c, i;
+  for(c=0; c<4; ++c)
+  {
+    lo[c] = 255;
+    hi[c] = 0;
+    for(i=0; i<16; ++i)
+    {
+      uint8_t v = block[i*4 + c];
+      if(v < lo[c]) lo[c] = v;
+      if(v > hi[c]) hi[c] = v;
+    }
+  }
+#endif
+}
+
+static uint16_t _gp_compress_565(const int* color)
+{
+  return (uint16_t)(((color[0]*31 + 127)/255) << 11 | ((color[1]*63 + 127)/255) << 5 | ((color[2]*31 + 127)/255));
+}
+
+static void _gp_compress_unpack_565(uint16_t c, int* color)
+{
+  const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+  color[0] = (r << 3) | (r >> 2);
+  color[1] = (g << 2) | (g >> 4);
+  color[2] = (b << 3) | (b >> 2);
+}
+
+/*
+ * Encode the colors of a block between the inset corners of their bounding
+ * box, on the diagonal that follows how the components vary together.
+ * Always uses the four color mode, which BC3 requires.
+ */
+static void _gp_compress_bc1(const uint8_t* block, const uint8_t* lo, const uint8_t* hi, uint8_t* dst)
+{
+  int a[3], b[3];
+  int c, i;
+  for(c=0; c<3; ++c)
+  {
+    const int inset = (hi[c] - lo[c]) >> 4;
+    a[c] = hi[c] - inset;
+    b[c] = lo[c] + inset;
+  }
+  
+  // Components moving against the component with the widest range run
+  // along the other diagonal.
+  int axis = 0;
+  for(c=1; c<3; ++c)
+    if(hi[c] - lo[c] > hi[axis] - lo[axis]) axis = c;
+  for(c=0; c<3; ++c)
+  {
+    if(c == axis) continue;
+    int covariance = 0;
+    for(i=0; i<16; ++i)
+      covariance += (2*block[i*4 + axis] - lo[axis] - hi[axis])*(2*block[i*4 + c] - lo[c] - hi[c]);
+    if(covariance < 0)
+    {
+      const int t = a[c];
+      a[c] = b[c];
+      b[c] = t;
+    }
+  }
+  
+  uint16_t c0 = _gp_compress_565(a);
+  uint16_t c1 = _gp_compress_565(b);
+  if(c0 < c1)
+  {
+    uint16_t t = c0;
+    c0 = c1;
+    c1 = t;
+  }
+  
+  uint32_t indices = 0;
+  if(c0 != c1)
+  {
+    int palette[4][3];
+    _gp_compress_unpack_565(c0, palette[0]);
+    _gp_compress_unpack_565(c1, palette[1]);
+    for(c=0; c<3; ++c)
+    {
+      palette[2][c] = (2*palette[0][c] + palette[1][c])/3;
+      palette[3][c] = (palette[0][c] + 2*palette[1][c])/3;
+    }
+    
+    int p;
+    for(i=0; i<16; ++i)
+    {
+      const uint8_t* pixel = block + i*4;
+      int best = 0, bestDistance = 0x7FFFFFFF;
+      for(p=0; p<4; ++p)
+      {
+        const int dr = pixel[0] - palette[p][0];
+        const int dg = pixel[1] - palette[p][1];
+        const int db = pixel[2] - palette[p][2];
+        const int distance = dr*dr + dg*dg + db*db;
+        if(distance < bestDistance)
+        {
+          best = p;
+          bestDistance = distance;
+        }
+      }
+      indices |= (uint32_t)best << (2*i);
+    }
+  }
+  
+  dst[0] = c0 & 0xFF;
+  dst[1] = c0 >> 8;
+  dst[2] = c1 & 0xFF;
+  dst[3] = c1 >> 8;
+  dst[4] = indices & 0xFF;
+  dst[5] = (indices >> 8) & 0xFF;
+  dst[6] = (indices >> 16) & 0xFF;
+  dst[7] = indices >> 24;
+}
+
+/*
+ * Encode one component of a block with the maximum as the first endpoint,
+ * which selects eight interpolated values.
+ */
+static void _gp_compress_bc4(const uint8_t* block, int component, uint8_t lo, uint8_t hi, uint8_t* dst)
+{
+  dst[0] = hi;
+  dst[1] = lo;
+  
+  uint64_t indices = 0;
+  const int range = hi - lo;
+  if(range != 0)
+  {
+    int i;
+    for(i=0; i<16; ++i)
+    {
+      // Position between the minimum (0) and maximum (7), then the index
+      // of the palette entry at that position.
+      const int position = ((block[i*4 + component] - lo)*7 + range/2)/range;
+      const int index = position == 7 ? 0 : (position == 0 ? 1 : 8 - position);
+      indices |= (uint64_t)index << (3*i);
+    }
+  }
+  
+  int b;
+  for(b=0; b<6; ++b)
+    dst[2 + b] = (indices >> (8*b)) & 0xFF;
+}
+
+static void _gp_compress_block(const uint8_t* block, GP_COMPRESSION compression, uint8_t* dst)
+{
+  uint8_t lo[4], hi[4];
+  _gp_compress_bounds(block, lo, hi);
+  
+  switch(compression)
+  {
+    case GP_COMPRESSION_BC1:
+      _gp_compress_bc1(block, lo, hi, dst);
+      break;
+    case GP_COMPRESSION_BC3:
+      _gp_compress_bc4(block, 3, lo[3], hi[3], dst);
+      _gp_compress_bc1(block, lo, hi, dst + 8);
+      break;
+    case GP_COMPRESSION_BC4:
+      _gp_compress_bc4(block, 0, lo[0], hi[0], dst);
+      break;
+    case GP_COMPRESSION_BC5:
+      _gp_compress_bc4(block, 0, lo[0], hi[0], dst);
+      _gp_compress_bc4(block, 1, lo[1], hi[1], dst + 8);
+      break;
+    default:
+      break;
+  }
+}
+
+static void _gp_compress_row(void* userdata, size_t index)
+{
+  _gp_compress_job* job = (_gp_compress_job*)userdata;
+  
+  //
+  // Convert the four pixel rows of this block row to RGBA bytes
+  //
+  const unsigned int y = (unsigned int)index*4;
+  const unsigned int rows = job->mHeight - y < 4 ? job->mHeight - y : 4;
+  const size_t pitch = (size_t)job->mWidth*job->mFormat*gp_data_type_get_size(job->mType);
+  
+  uint8_t* pixels = NULL;
+  const uint8_t* src[4];
+  unsigned int r;
+  if(job->mFormat == GP_FORMAT_RGBA && job->mType == GP_DATA_TYPE_UBYTE)
+  {
+    for(r=0; r<rows; ++r)
+      src[r] = job->mSrc + (y + r)*pitch;
+  }
+  else
+  {
+    pixels = malloc((size_t)job->mWidth*4*rows);
+    gp_convert(job->mSrc + y*pitch,
+               job->mFormat,
+               job->mType,
+               pixels,
+               GP_FORMAT_RGBA,
+               GP_DATA_TYPE_UBYTE,
+               NULL,
+               job->mWidth*rows);
+    for(r=0; r<rows; ++r)
+      src[r] = pixels + (size_t)r*job->mWidth*4;
+  }
+  
+  //
+  // Gather every block, repeating the last row and column past the edges
+  //
+  const unsigned int blockSize = _gp_compress_block_size(job->mCompression);
+  const unsigned int blocks = (job->mWidth + 3)/4;
+  uint8_t* dst = job->mDst + (size_t)index*blocks*blockSize;
+  
+  uint8_t block[64];
+  unsigned int bx;
+  for(bx=0; bx<blocks; ++bx)
+  {
+    const unsigned int x = bx*4;
+    for(r=0; r<4; ++r)
+    {
+      const uint8_t* row = src[r < rows ? r : rows - 1];
+      if(x + 4 <= job->mWidth)
+      {
+        memcpy(block + r*16, row + x*4, 16);
+      }
+      else
+      {
+        unsigned int i;
+        for(i=0; i<4; ++i)
+        {
+          const unsigned int sx = x + i < job->mWidth ? x + i : job->mWidth - 1;
+          memcpy(block + r*16 + i*4, row + sx*4, 4);
+        }
+      }
+    }
+    
+    _gp_compress_block(block, job->mCompression, dst + bx*blockSize);
+  }
+  
+  free(pixels);
+}
+
+int gp_compress(const void* src,
+                GP_FORMAT format,
+                GP_DATA_TYPE type,
+                unsigned int width,
+                unsigned int height,
+                GP_COMPRESSION compression,
+                void* dst)
+{
+  switch(compression)
+  {
+    case GP_COMPRESSION_BC1:
+    case GP_COMPRESSION_BC3:
+    case GP_COMPRESSION_BC4:
+    case GP_COMPRESSION_BC5:
+      break;
+    default:
+      return 0;
+  }
+  
+  if(width == 0 || height == 0) return 1;
+  
+  _gp_compress_job job = {(const uint8_t*)src, format, type, width, height, compression, (uint8_t*)dst};
+  gp_parallel_for((height + 3)/4, _gp_compress_row, &job);
+  return 1;
+}
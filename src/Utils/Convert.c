@@ -0,0 +1,598 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Convert.h>
+#include <GraphicsPipeline/Half.h>
+
+#include "Copy.h"
+#include "Parallel.h"
+
+#include <string.h>
+#include <stdint.h>
+
+// NOTE: SSE2 is part of the x86-64 baseline.  SSSE3, AVX and AVX2 kernels
+// are compiled separately by GCC and Clang and picked at run time.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && defined(__SSE2__)
+#define GP_CONVERT_SSE2
+#define GP_CONVERT_DISPATCH
+#define GP_CONVERT_TARGET(isa)    __attribute__((target(isa)))
+#define GP_CONVERT_SUPPORTS(isa)  __builtin_cpu_supports(isa)
+#include <immintrin.h>
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_CONVERT_SSE2
+#include <immintrin.h>
+#if defined(__AVX2__)
+#define GP_CONVERT_DISPATCH
+#define GP_CONVERT_TARGET(isa)
+#define GP_CONVERT_SUPPORTS(isa)  1
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_CONVERT_NEON
+#include <arm_neon.h>
+#endif
+
+#define GP_CONVERT_CHUNK          16384 // Elements per parallel job.
+#define GP_CONVERT_BLOCK          256   // Elements converted through floats at a time.
+
+typedef struct
+{
+  const char*             mSrc;
+  unsigned int            mSrcFormat;
+  GP_DATA_TYPE            mSrcType;
+  char*                   mDst;
+  unsigned int            mDstFormat;
+  GP_DATA_TYPE            mDstType;
+  int                     mSwizzle[4];
+  int                     mIdentity;
+  size_t                  mCount;
+} _gp_convert_job;
+
+unsigned int gp_data_type_get_size(GP_DATA_TYPE type)
+{
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      return sizeof(uint8_t);
+    case GP_DATA_TYPE_INT:
+      return sizeof(int);
+    case GP_DATA_TYPE_FLOAT:
+      return sizeof(float);
+    case GP_DATA_TYPE_DOUBLE:
+      return sizeof(double);
+    case GP_DATA_TYPE_HALF:
+    case GP_DATA_TYPE_USHORT:
+    case GP_DATA_TYPE_SHORT:
+      return sizeof(uint16_t);
+  }
+  return 0;
+}
+
+//
+// Double to float
+//
+#ifdef GP_CONVERT_DISPATCH
+GP_CONVERT_TARGET("avx") static size_t _gp_convert_double_float_avx(const double* src, float* dst, size_t count)
+{
+  size_t i = 0;
+  for(; i+8<=count; i+=8)
+  {
+    _mm_storeu_ps(dst+i, _mm256_cvtpd_ps(_mm256_loadu_pd(src+i)));
+    _mm_storeu_ps(dst+i+4, _mm256_cvtpd_ps(_mm256_loadu_pd(src+i+4)));
+  }
+  return i;
+}
+#endif
+
+static void _gp_convert_double_float(const double* src, float* dst, size_t count)
+{
+  size_t i = 0;
+  
+#if defined(GP_CONVERT_DISPATCH)
+  if(GP_CONVERT_SUPPORTS("avx"))
+    i = _gp_convert_double_float_avx(src, dst, count);
+#endif
+#if defined(GP_CONVERT_SSE2)
+  for(; i+4<=count; i+=4)
+  {
+    __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src+i));
+    __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src+i+2));
+    _mm_storeu_ps(dst+i, _mm_movelh_ps(lo, hi));
+  }
+#elif defined(GP_CONVERT_NEON)
+  for(; i+4<=count; i+=4)
+  {
+    float32x2_t lo = vcvt_f32_f64(vld1q_f64(src+i));
+    float32x2_t hi = vcvt_f32_f64(vld1q_f64(src+i+2));
+    vst1q_f32(dst+i, vcombine_f32(lo, hi));
+  }
+#endif
+  
+  for(; i<count; ++i)
+    dst[i] = (float)src[i];
+}
+
+//
+// Float to normalized unsigned byte.  Values are clamped to [0, 1] and
+// rounded half up, the same way in every kernel.
+//
+#ifdef GP_CONVERT_DISPATCH
+GP_CONVERT_TARGET("avx2") static size_t _gp_convert_float_unorm8_avx2(const float* src, uint8_t* dst, size_t count)
+{
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 scale = _mm256_set1_ps(255.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  
+  size_t i = 0;
+  for(; i+32<=count; i+=32)
+  {
+    __m256i v[4];
+    int j;
+    for(j=0; j<4; ++j)
+    {
+      __m256 f = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src+i+j*8), zero), one);
+      v[j] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(f, scale), half));
+    }
+    
+    // Packing works within 128-bit lanes, so the result is put back in
+    // order afterwards.
+    __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(v[0], v[1]), _mm256_packs_epi32(v[2], v[3]));
+    _mm256_storeu_si256((__m256i*)(dst+i), _mm256_permutevar8x32_epi32(packed, order));
+  }
+  return i;
+}
+#endif
+
+static void _gp_convert_float_unorm8(const float* src, uint8_t* dst, size_t count)
+{
+  size_t i = 0;
+  
+#if defined(GP_CONVERT_DISPATCH)
+  if(GP_CONVERT_SUPPORTS("avx2"))
+    i = _gp_convert_float_unorm8_avx2(src, dst, count);
+#endif
+#if defined(GP_CONVERT_SSE2)
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 scale = _mm_set1_ps(255.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  for(; i+16<=count; i+=16)
+  {
+    __m128i v[4];
+    int j;
+    for(j=0; j<4; ++j)
+    {
+      __m128 f = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src+i+j*4), zero), one);
+      v[j] = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(f, scale), half));
+    }
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+    _mm_storeu_si128((__m128i*)(dst+i), packed);
+  }
+#elif defined(GP_CONVERT_NEON)
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  for(; i+8<=count; i+=8)
+  {
+    float32x4_t f0 = vminq_f32(vmaxq_f32(vld1q_f32(src+i), zero), one);
+    float32x4_t f1 = vminq_f32(vmaxq_f32(vld1q_f32(src+i+4), zero), one);
+    uint32x4_t u0 = vcvtq_u32_f32(vmlaq_n_f32(half, f0, 255.0f));
+    uint32x4_t u1 = vcvtq_u32_f32(vmlaq_n_f32(half, f1, 255.0f));
+    vst1_u8(dst+i, vmovn_u16(vcombine_u16(vmovn_u32(u0), vmovn_u32(u1))));
+  }
+#endif
+  
+  for(; i<count; ++i)
+  {
+    float f = src[i];
+    if(!(f > 0.0f)) f = 0.0f;
+    if(f > 1.0f) f = 1.0f;
+    dst[i] = (uint8_t)(f*255.0f + 0.5f);
+  }
+}
+
+//
+// Shuffle of 3 or 4 byte pixels into 4 byte pixels, which covers RGB to
+// RGBA padding and channel swizzles such as BGRA to RGBA.
+//
+#ifdef GP_CONVERT_DISPATCH
+GP_CONVERT_TARGET("ssse3") static size_t _gp_convert_shuffle8_ssse3(const uint8_t* src,
+                                                                    unsigned int format,
+                                                                    uint8_t* dst,
+                                                                    const int* swizzle,
+                                                                    size_t count)
+{
+  uint8_t m[16], o[16];
+  int p, c;
+  for(p=0; p<4; ++p)
+  {
+    for(c=0; c<4; ++c)
+    {
+      m[p*4+c] = swizzle[c] < (int)format ? (uint8_t)(p*format + swizzle[c]) : 0x80;
+      o[p*4+c] = swizzle[c] == GP_SWIZZLE_ONE ? 0xFF : 0x00;
+    }
+  }
+  const __m128i mask = _mm_loadu_si128((const __m128i*)m);
+  const __m128i ones = _mm_loadu_si128((const __m128i*)o);
+  
+  // Every load reads 16 bytes, so stop while 16 bytes remain.
+  size_t i = 0;
+  for(; i+4<=count && (i*format+16)<=count*format; i+=4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i*)(src+i*format));
+    _mm_storeu_si128((__m128i*)(dst+i*4), _mm_or_si128(_mm_shuffle_epi8(v, mask), ones));
+  }
+  return i;
+}
+#endif
+
+static void _gp_convert_shuffle8(const uint8_t* src, unsigned int format, uint8_t* dst, const int* swizzle, size_t count)
+{
+  size_t i = 0;
+  
+#if defined(GP_CONVERT_DISPATCH)
+  if(GP_CONVERT_SUPPORTS("ssse3"))
+    i = _gp_convert_shuffle8_ssse3(src, format, dst, swizzle, count);
+#elif defined(GP_CONVERT_NEON)
+  uint8x16_t in[6];
+  uint8x16x4_t out;
+  in[GP_SWIZZLE_ZERO] = vdupq_n_u8(0);
+  in[GP_SWIZZLE_ONE] = vdupq_n_u8(0xFF);
+  for(; i+16<=count; i+=16)
+  {
+    if(format == 3)
+    {
+      uint8x16x3_t v = vld3q_u8(src+i*3);
+      in[0] = v.val[0];
+      in[1] = v.val[1];
+      in[2] = v.val[2];
+      in[3] = in[GP_SWIZZLE_ZERO];
+    }
+    else
+    {
+      uint8x16x4_t v = vld4q_u8(src+i*4);
+      in[0] = v.val[0];
+      in[1] = v.val[1];
+      in[2] = v.val[2];
+      in[3] = v.val[3];
+    }
+    out.val[0] = in[swizzle[0]];
+    out.val[1] = in[swizzle[1]];
+    out.val[2] = in[swizzle[2]];
+    out.val[3] = in[swizzle[3]];
+    vst4q_u8(dst+i*4, out);
+  }
+#endif
+  
+  for(; i<count; ++i)
+  {
+    int c;
+    for(c=0; c<4; ++c)
+    {
+      const int s = swizzle[c];
+      dst[i*4+c] = s < (int)format ? src[i*format+s] : (s == GP_SWIZZLE_ONE ? 0xFF : 0x00);
+    }
+  }
+}
+
+//
+// Generic conversion through floats.
+//
+static void _gp_convert_load(const char* src, GP_DATA_TYPE type, float* dst, size_t count)
+{
+  size_t i;
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      for(i=0; i<count; ++i) dst[i] = ((const uint8_t*)src)[i]*(1.0f/255.0f);
+      break;
+    case GP_DATA_TYPE_INT:
+      for(i=0; i<count; ++i) dst[i] = (float)((const int*)src)[i];
+      break;
+    case GP_DATA_TYPE_FLOAT:
+      memcpy(dst, src, sizeof(float)*count);
+      break;
+    case GP_DATA_TYPE_DOUBLE:
+      _gp_convert_double_float((const double*)src, dst, count);
+      break;
+    case GP_DATA_TYPE_HALF:
+      gp_half_to_float((const uint16_t*)src, dst, count);
+      break;
+    case GP_DATA_TYPE_USHORT:
+      for(i=0; i<count; ++i) dst[i] = ((const uint16_t*)src)[i]*(1.0f/65535.0f);
+      break;
+    case GP_DATA_TYPE_SHORT:
+      for(i=0; i<count; ++i)
+      {
+        float f = ((const int16_t*)src)[i]*(1.0f/32767.0f);
+        dst[i] = f < -1.0f ? -1.0f : f;
+      }
+      break;
+  }
+}
+
+static inline float _gp_convert_clamp(float value, float min, float max)
+{
+  if(!(value > min)) return min;
+  if(value > max) return max;
+  return value;
+}
+
+static void _gp_convert_store(const float* src, char* dst, GP_DATA_TYPE type, size_t count)
+{
+  size_t i;
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      _gp_convert_float_unorm8(src, (uint8_t*)dst, count);
+      break;
+    case GP_DATA_TYPE_INT:
+      for(i=0; i<count; ++i)
+        ((int*)dst)[i] = (int)(src[i] < 0.0f ? src[i] - 0.5f : src[i] + 0.5f);
+      break;
+    case GP_DATA_TYPE_FLOAT:
+      memcpy(dst, src, sizeof(float)*count);
+      break;
+    case GP_DATA_TYPE_DOUBLE:
+      for(i=0; i<count; ++i) ((double*)dst)[i] = src[i];
+      break;
+    case GP_DATA_TYPE_HALF:
+      gp_half_from_float(src, (uint16_t*)dst, count);
+      break;
+    case GP_DATA_TYPE_USHORT:
+      for(i=0; i<count; ++i)
+        ((uint16_t*)dst)[i] = (uint16_t)(_gp_convert_clamp(src[i], 0.0f, 1.0f)*65535.0f + 0.5f);
+      break;
+    case GP_DATA_TYPE_SHORT:
+      for(i=0; i<count; ++i)
+      {
+        float f = _gp_convert_clamp(src[i], -1.0f, 1.0f)*32767.0f;
+        ((int16_t*)dst)[i] = (int16_t)(f < 0.0f ? f - 0.5f : f + 0.5f);
+      }
+      break;
+  }
+}
+
+static void _gp_convert_generic(const _gp_convert_job* job, size_t first, size_t count)
+{
+  const size_t srcSize = gp_data_type_get_size(job->mSrcType);
+  const size_t dstSize = gp_data_type_get_size(job->mDstType);
+  const unsigned int sf = job->mSrcFormat;
+  const unsigned int df = job->mDstFormat;
+  
+  float in[GP_CONVERT_BLOCK*4];
+  float out[GP_CONVERT_BLOCK*4];
+  size_t i, j;
+  int c;
+  
+  for(i=0; i<count; i+=GP_CONVERT_BLOCK)
+  {
+    size_t n = count - i < GP_CONVERT_BLOCK ? count - i : GP_CONVERT_BLOCK;
+    
+    _gp_convert_load(job->mSrc + (first+i)*sf*srcSize, job->mSrcType, in, n*sf);
+    
+    const float* values = in;
+    if(!job->mIdentity)
+    {
+      for(j=0; j<n; ++j)
+      {
+        for(c=0; c<(int)df; ++c)
+        {
+          const int s = job->mSwizzle[c];
+          out[j*df+c] = s < (int)sf ? in[j*sf+s] : (s == GP_SWIZZLE_ONE ? 1.0f : 0.0f);
+        }
+      }
+      values = out;
+    }
+    
+    _gp_convert_store(values, job->mDst + (first+i)*df*dstSize, job->mDstType, n*df);
+  }
+}
+
+static int _gp_convert_is_integer(GP_DATA_TYPE type)
+{
+  return type == GP_DATA_TYPE_UBYTE || type == GP_DATA_TYPE_USHORT ||
+         type == GP_DATA_TYPE_SHORT || type == GP_DATA_TYPE_INT;
+}
+
+static int64_t _gp_convert_integer_load(const char* src, GP_DATA_TYPE type)
+{
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      return *(const uint8_t*)src;
+    case GP_DATA_TYPE_USHORT:
+      return *(const uint16_t*)src;
+    case GP_DATA_TYPE_SHORT:
+      return *(const int16_t*)src;
+    default:
+      return *(const int*)src;
+  }
+}
+
+static void _gp_convert_integer_store(int64_t value, char* dst, GP_DATA_TYPE type)
+{
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      *(uint8_t*)dst = (uint8_t)(value < 0 ? 0 : (value > UINT8_MAX ? UINT8_MAX : value));
+      break;
+    case GP_DATA_TYPE_USHORT:
+      *(uint16_t*)dst = (uint16_t)(value < 0 ? 0 : (value > UINT16_MAX ? UINT16_MAX : value));
+      break;
+    case GP_DATA_TYPE_SHORT:
+      *(int16_t*)dst = (int16_t)(value < INT16_MIN ? INT16_MIN : (value > INT16_MAX ? INT16_MAX : value));
+      break;
+    default:
+      *(int*)dst = (int)value;
+      break;
+  }
+}
+
+//
+// INT is not normalized, so converting it to or from another integer type
+// through normalized floats would scale its values.  Keep them instead,
+// clamped to the range of the converted type.
+//
+static void _gp_convert_integer(const _gp_convert_job* job, size_t first, size_t count)
+{
+  const size_t srcSize = gp_data_type_get_size(job->mSrcType);
+  const size_t dstSize = gp_data_type_get_size(job->mDstType);
+  const unsigned int sf = job->mSrcFormat;
+  const unsigned int df = job->mDstFormat;
+  
+  // NOTE: Ones match _gp_convert_components, so the maximum of normalized types.
+  char one[sizeof(int)];
+  float f = 1.0f;
+  _gp_convert_store(&f, one, job->mDstType, 1);
+  
+  const char* src = job->mSrc + first*sf*srcSize;
+  char* dst = job->mDst + first*df*dstSize;
+  size_t i;
+  int c;
+  for(i=0; i<count; ++i)
+  {
+    for(c=0; c<(int)df; ++c)
+    {
+      const int s = job->mSwizzle[c];
+      if(s < (int)sf)
+        _gp_convert_integer_store(_gp_convert_integer_load(src + s*srcSize, job->mSrcType), dst + c*dstSize, job->mDstType);
+      else if(s == GP_SWIZZLE_ONE)
+        memcpy(dst + c*dstSize, one, dstSize);
+      else
+        memset(dst + c*dstSize, 0, dstSize);
+    }
+    src += sf*srcSize;
+    dst += df*dstSize;
+  }
+}
+
+// Reorders components of the same type without changing their values.
+static void _gp_convert_components(const _gp_convert_job* job, size_t first, size_t count)
+{
+  const size_t size = gp_data_type_get_size(job->mSrcType);
+  const unsigned int sf = job->mSrcFormat;
+  const unsigned int df = job->mDstFormat;
+  
+  // NOTE: Zeros of every type are all zero bits, ones are converted once.
+  char one[sizeof(double)];
+  float f = 1.0f;
+  _gp_convert_store(&f, one, job->mDstType, 1);
+  
+  const char* src = job->mSrc + first*sf*size;
+  char* dst = job->mDst + first*df*size;
+  size_t i;
+  int c;
+  for(i=0; i<count; ++i)
+  {
+    for(c=0; c<(int)df; ++c)
+    {
+      const int s = job->mSwizzle[c];
+      if(s < (int)sf)
+        memcpy(dst + c*size, src + s*size, size);
+      else if(s == GP_SWIZZLE_ONE)
+        memcpy(dst + c*size, one, size);
+      else
+        memset(dst + c*size, 0, size);
+    }
+    src += sf*size;
+    dst += df*size;
+  }
+}
+
+static void _gp_convert_range(const _gp_convert_job* job, size_t first, size_t count)
+{
+  const GP_DATA_TYPE st = job->mSrcType;
+  const GP_DATA_TYPE dt = job->mDstType;
+  const size_t sf = job->mSrcFormat;
+  const size_t df = job->mDstFormat;
+  const char* src = job->mSrc + first*sf*gp_data_type_get_size(st);
+  char* dst = job->mDst + first*df*gp_data_type_get_size(dt);
+  
+  if(st == dt && job->mIdentity)
+    memcpy(dst, src, count*sf*gp_data_type_get_size(st));
+  else if(st == GP_DATA_TYPE_UBYTE && dt == GP_DATA_TYPE_UBYTE && df == 4 && sf >= 3)
+    _gp_convert_shuffle8((const uint8_t*)src, sf, (uint8_t*)dst, job->mSwizzle, count);
+  else if(st == dt)
+    _gp_convert_components(job, first, count);
+  else if(job->mIdentity && st == GP_DATA_TYPE_DOUBLE && dt == GP_DATA_TYPE_FLOAT)
+    _gp_convert_double_float((const double*)src, (float*)dst, count*sf);
+  else if(job->mIdentity && st == GP_DATA_TYPE_FLOAT && dt == GP_DATA_TYPE_HALF)
+    gp_half_from_float((const float*)src, (uint16_t*)dst, count*sf);
+  else if(job->mIdentity && st == GP_DATA_TYPE_HALF && dt == GP_DATA_TYPE_FLOAT)
+    gp_half_to_float((const uint16_t*)src, (float*)dst, count*sf);
+  else if(job->mIdentity && st == GP_DATA_TYPE_FLOAT && dt == GP_DATA_TYPE_UBYTE)
+    _gp_convert_float_unorm8((const float*)src, (uint8_t*)dst, count*sf);
+  else if((st == GP_DATA_TYPE_INT || dt == GP_DATA_TYPE_INT) && _gp_convert_is_integer(st) && _gp_convert_is_integer(dt))
+    _gp_convert_integer(job, first, count);
+  else
+    _gp_convert_generic(job, first, count);
+}
+
+static void _gp_convert_chunk(void* userdata, size_t index)
+{
+  const _gp_convert_job* job = (const _gp_convert_job*)userdata;
+  
+  size_t first = index*GP_CONVERT_CHUNK;
+  size_t count = job->mCount - first;
+  if(count > GP_CONVERT_CHUNK) count = GP_CONVERT_CHUNK;
+  
+  _gp_convert_range(job, first, count);
+}
+
+void gp_convert(const void* src,
+                GP_FORMAT src_format,
+                GP_DATA_TYPE src_type,
+                void* dst,
+                GP_FORMAT dst_format,
+                GP_DATA_TYPE dst_type,
+                const int* swizzle,
+                unsigned int count)
+{
+  _gp_convert_job job;
+  job.mSrc = (const char*)src;
+  job.mSrcFormat = src_format;
+  job.mSrcType = src_type;
+  job.mDst = (char*)dst;
+  job.mDstFormat = dst_format;
+  job.mDstType = dst_type;
+  job.mCount = count;
+  job.mIdentity = src_format == dst_format;
+  
+  int c;
+  for(c=0; c<4; ++c)
+  {
+    if(swizzle && c < (int)dst_format)
+      job.mSwizzle[c] = swizzle[c];
+    else if(c < (int)src_format)
+      job.mSwizzle[c] = c;
+    else
+      job.mSwizzle[c] = c == 3 ? GP_SWIZZLE_ONE : GP_SWIZZLE_ZERO;
+    
+    if(c < (int)dst_format && job.mSwizzle[c] != c) job.mIdentity = 0;
+  }
+  
+  const size_t size = (size_t)count*dst_format*gp_data_type_get_size(dst_type);
+  if(size < GP_COPY_PARALLEL_SIZE)
+  {
+    _gp_convert_range(&job, 0, count);
+    return;
+  }
+  
+  gp_parallel_for((job.mCount + GP_CONVERT_CHUNK - 1)/GP_CONVERT_CHUNK, _gp_convert_chunk, &job);
+}
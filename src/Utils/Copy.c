@@ -0,0 +1,148 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include "Copy.h"
+#include "Parallel.h"
+
+#include <string.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_COPY_STREAM
+#include <emmintrin.h>
+#endif
+
+/*
+ * Copy without pulling the destination into the cache.  Mapped buffers are
+ * usually write-combined memory, which streaming stores fill most efficiently.
+ */
+static void _gp_copy_stream(char* dst, const char* src, size_t size)
+{
+#ifdef GP_COPY_STREAM
+  size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+  if(head > size) head = size;
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+  
+  while(size >= 64)
+  {
+    __m128i a = _mm_loadu_si128((const __m128i*)(src));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src+16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(src+32));
+    __m128i d = _mm_loadu_si128((const __m128i*)(src+48));
+    _mm_stream_si128((__m128i*)(dst), a);
+    _mm_stream_si128((__m128i*)(dst+16), b);
+    _mm_stream_si128((__m128i*)(dst+32), c);
+    _mm_stream_si128((__m128i*)(dst+48), d);
+    dst += 64;
+    src += 64;
+    size -= 64;
+  }
+  
+  while(size >= 16)
+  {
+    _mm_stream_si128((__m128i*)dst, _mm_loadu_si128((const __m128i*)src));
+    dst += 16;
+    src += 16;
+    size -= 16;
+  }
+  
+  memcpy(dst, src, size);
+  
+  // Streaming stores are weakly ordered, so make them visible before the
+  // copy is reported as finished.
+  _mm_sfence();
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+typedef struct
+{
+  char*                   mDst;
+  const char*             mSrc;
+  size_t                  mSize;
+} _gp_copy_job;
+
+static void _gp_copy_chunk(void* userdata, size_t index)
+{
+  _gp_copy_job* job = (_gp_copy_job*)userdata;
+  
+  size_t offset = index*GP_COPY_CHUNK_SIZE;
+  size_t size = job->mSize - offset;
+  if(size > GP_COPY_CHUNK_SIZE) size = GP_COPY_CHUNK_SIZE;
+  
+  _gp_copy_stream(job->mDst + offset, job->mSrc + offset, size);
+}
+
+void gp_copy(void* dst, const void* src, size_t size)
+{
+  if(size < GP_COPY_PARALLEL_SIZE)
+  {
+    memcpy(dst, src, size);
+    return;
+  }
+  
+  _gp_copy_job job = {(char*)dst, (const char*)src, size};
+  gp_parallel_for((size + GP_COPY_CHUNK_SIZE - 1)/GP_COPY_CHUNK_SIZE, _gp_copy_chunk, &job);
+}
+
+size_t gp_copy_pitch(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+size_t gp_copy_alignment(size_t size)
+{
+  return (size & 7) == 0 ? 8 : (size & 3) == 0 ? 4 : (size & 1) == 0 ? 2 : 1;
+}
+
+void gp_copy_rows(void* dst, size_t dst_pitch, const void* src, size_t src_pitch, size_t size, size_t count)
+{
+  if(dst_pitch == size && src_pitch == size)
+  {
+    memcpy(dst, src, size*count);
+    return;
+  }
+  
+  size_t i;
+  for(i=0; i<count; ++i)
+    memcpy((char*)dst + dst_pitch*i, (const char*)src + src_pitch*i, size);
+}
+
+double gp_clock()
+{
+#ifdef _WIN32
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart/(double)frequency.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec/1000000000.0;
+#endif
+}
@@ -0,0 +1,64 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#ifndef __GP_COPY_H__
+#define __GP_COPY_H__
+
+#include <stddef.h>
+
+#define GP_COPY_CHUNK_SIZE        (512*1024)        // Fits in most L2 caches
+#define GP_COPY_PARALLEL_SIZE     (8*1024*1024)     // Smaller copies stay on the calling thread
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Copy a large block of memory that will not be read back soon, such as
+ * data staged in a mapped GL buffer.  Large copies are split into chunks
+ * run with gp_parallel_for() and use non-temporal stores where available.
+ */
+void gp_copy(void* dst, const void* src, size_t size);
+
+/*
+ * Round a row of size bytes up to a multiple of alignment, which must be a
+ * power of two like GL_UNPACK_ALIGNMENT.
+ */
+size_t gp_copy_pitch(size_t size, size_t alignment);
+
+/*
+ * Retrieve the largest GL_UNPACK_ALIGNMENT up to 8 that rows of size bytes
+ * satisfy, for uploading tightly packed rows.
+ */
+size_t gp_copy_alignment(size_t size);
+
+/*
+ * Copy count rows of size bytes between images with different pitches.
+ * Rows that are already contiguous on both sides are copied at once.
+ */
+void gp_copy_rows(void* dst, size_t dst_pitch, const void* src, size_t src_pitch, size_t size, size_t count);
+
+/*
+ * Retrieve a monotonic time in seconds.
+ */
+double gp_clock();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_COPY_H__
@@ -0,0 +1,316 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include "Decimation.h"
+#include "Parallel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_DECIMATION_SSE2
+#include <xmmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_DECIMATION_NEON
+#include <arm_neon.h>
+#endif
+
+typedef struct
+{
+  gp_decimation*          mDecimation;
+  unsigned int            mLevel;
+  unsigned int            mBegin;
+  unsigned int            mEnd;
+} _gp_decimation_job;
+
+static unsigned int _gp_decimation_buckets(unsigned int count, unsigned int level)
+{
+  return (unsigned int)(((unsigned long long)count + (1ull << level) - 1) >> level);
+}
+
+/*
+ * Build buckets [begin, end) of level 1 from pairs of samples.
+ */
+static void _gp_decimation_build_samples(const float* samples,
+                                         unsigned int count,
+                                         _gp_decimation_bucket* out,
+                                         unsigned int begin,
+                                         unsigned int end)
+{
+  unsigned int j = begin;
+  
+#if defined(GP_DECIMATION_SSE2)
+  for(; j+4<=end && 2*j+8<=count; j+=4)
+  {
+    __m128 a = _mm_loadu_ps(samples + 2*j);
+    __m128 b = _mm_loadu_ps(samples + 2*j + 4);
+    __m128 first = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 last = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 min = _mm_min_ps(first, last);
+    __m128 max = _mm_max_ps(first, last);
+    _MM_TRANSPOSE4_PS(min, max, first, last);
+    _mm_storeu_ps((float*)(out + j), min);
+    _mm_storeu_ps((float*)(out + j + 1), max);
+    _mm_storeu_ps((float*)(out + j + 2), first);
+    _mm_storeu_ps((float*)(out + j + 3), last);
+  }
+#elif defined(GP_DECIMATION_NEON)
+  for(; j+4<=end && 2*j+8<=count; j+=4)
+  {
+    float32x4x2_t pairs = vld2q_f32(samples + 2*j);
+    float32x4x4_t buckets;
+    buckets.val[0] = vminq_f32(pairs.val[0], pairs.val[1]);
+    buckets.val[1] = vmaxq_f32(pairs.val[0], pairs.val[1]);
+    buckets.val[2] = pairs.val[0];
+    buckets.val[3] = pairs.val[1];
+    vst4q_f32((float*)(out + j), buckets);
+  }
+#endif
+
+  for(; j<end; ++j)
+  {
+    float a = samples[2*j];
+    float b = (2*j+1 < count) ? samples[2*j+1] : a;
+    out[j].mMin = a < b ? a : b;
+    out[j].mMax = a > b ? a : b;
+    out[j].mFirst = a;
+    out[j].mLast = b;
+  }
+}
+
+/*
+ * Build buckets [begin, end) of a level from pairs of buckets of the level
+ * below.
+ */
+static void _gp_decimation_build_buckets(const _gp_decimation_bucket* in,
+                                         unsigned int count,
+                                         _gp_decimation_bucket* out,
+                                         unsigned int begin,
+                                         unsigned int end)
+{
+  unsigned int j = begin;
+  
+#if defined(GP_DECIMATION_SSE2)
+  for(; j<end && 2*j+2<=count; ++j)
+  {
+    __m128 a = _mm_loadu_ps((const float*)(in + 2*j));
+    __m128 b = _mm_loadu_ps((const float*)(in + 2*j + 1));
+    __m128 min = _mm_min_ps(a, b);
+    __m128 max = _mm_max_ps(a, b);
+    __m128 envelope = _mm_shuffle_ps(min, max, _MM_SHUFFLE(1, 1, 0, 0));
+    __m128 ends = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 3, 2, 2));
+    _mm_storeu_ps((float*)(out + j), _mm_shuffle_ps(envelope, ends, _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+#elif defined(GP_DECIMATION_NEON)
+  for(; j+4<=end && 2*j+8<=count; j+=4)
+  {
+    float32x4x4_t a = vld4q_f32((const float*)(in + 2*j));
+    float32x4x4_t b = vld4q_f32((const float*)(in + 2*j + 4));
+    float32x4x4_t buckets;
+    buckets.val[0] = vpminq_f32(a.val[0], b.val[0]);
+    buckets.val[1] = vpmaxq_f32(a.val[1], b.val[1]);
+    buckets.val[2] = vuzp1q_f32(a.val[2], b.val[2]);
+    buckets.val[3] = vuzp2q_f32(a.val[3], b.val[3]);
+    vst4q_f32((float*)(out + j), buckets);
+  }
+#endif
+
+  for(; j<end; ++j)
+  {
+    const _gp_decimation_bucket* a = in + 2*j;
+    if(2*j+1 < count)
+    {
+      const _gp_decimation_bucket* b = a + 1;
+      out[j].mMin = a->mMin < b->mMin ? a->mMin : b->mMin;
+      out[j].mMax = a->mMax > b->mMax ? a->mMax : b->mMax;
+      out[j].mFirst = a->mFirst;
+      out[j].mLast = b->mLast;
+    }
+    else
+    {
+      out[j] = *a;
+    }
+  }
+}
+
+static void _gp_decimation_build_chunk(void* userdata, size_t index)
+{
+  _gp_decimation_job* job = (_gp_decimation_job*)userdata;
+  gp_decimation* decimation = job->mDecimation;
+  
+  unsigned int begin = job->mBegin + index*GP_DECIMATION_CHUNK_SIZE;
+  unsigned int end = begin + GP_DECIMATION_CHUNK_SIZE;
+  if(end > job->mEnd) end = job->mEnd;
+  
+  if(job->mLevel == 1)
+  {
+    _gp_decimation_build_samples(decimation->mSamples, decimation->mCount, decimation->mLevels[1], begin, end);
+  }
+  else
+  {
+    _gp_decimation_build_buckets(decimation->mLevels[job->mLevel-1],
+                                 _gp_decimation_buckets(decimation->mCount, job->mLevel-1),
+                                 decimation->mLevels[job->mLevel],
+                                 begin,
+                                 end);
+  }
+}
+
+/*
+ * Rebuild every bucket covering samples from first onwards.
+ */
+static void _gp_decimation_update(gp_decimation* decimation, unsigned int first)
+{
+  unsigned int level = 1;
+  for(; level<GP_DECIMATION_MAX_LEVELS; ++level)
+  {
+    // Stop once the level below is a single bucket.
+    if(_gp_decimation_buckets(decimation->mCount, level-1) <= 1) break;
+    
+    unsigned int buckets = _gp_decimation_buckets(decimation->mCount, level);
+    if(buckets > decimation->mCapacities[level])
+    {
+      unsigned int capacity = decimation->mCapacities[level] ? decimation->mCapacities[level] : 64;
+      while(capacity < buckets) capacity *= 2;
+      decimation->mLevels[level] = realloc(decimation->mLevels[level], sizeof(_gp_decimation_bucket)*capacity);
+      decimation->mCapacities[level] = capacity;
+    }
+    
+    _gp_decimation_job job = {decimation, level, first >> level, buckets};
+    gp_parallel_for((job.mEnd - job.mBegin + GP_DECIMATION_CHUNK_SIZE - 1)/GP_DECIMATION_CHUNK_SIZE,
+                    _gp_decimation_build_chunk,
+                    &job);
+  }
+  
+  decimation->mLevelCount = level;
+}
+
+void _gp_decimation_free(gp_object* object)
+{
+  gp_decimation* decimation = (gp_decimation*)object;
+  
+  for(int i=0; i<GP_DECIMATION_MAX_LEVELS; ++i)
+    free(decimation->mLevels[i]);
+  free(decimation->mSamples);
+  free(decimation);
+}
+
+gp_decimation* gp_decimation_new()
+{
+  gp_decimation* decimation = calloc(1, sizeof(gp_decimation));
+  _gp_object_init(&decimation->mObject, _gp_decimation_free);
+  decimation->mLevelCount = 1;
+  
+  return decimation;
+}
+
+void gp_decimation_set(gp_decimation* decimation, const float* samples, unsigned int count)
+{
+  decimation->mCount = 0;
+  gp_decimation_append(decimation, samples, count);
+}
+
+void gp_decimation_append(gp_decimation* decimation, const float* samples, unsigned int count)
+{
+  const unsigned int first = decimation->mCount;
+  if(first + count > decimation->mCapacity)
+  {
+    unsigned int capacity = decimation->mCapacity ? decimation->mCapacity : 1024;
+    while(capacity < first + count) capacity *= 2;
+    decimation->mSamples = realloc(decimation->mSamples, sizeof(float)*capacity);
+    decimation->mCapacity = capacity;
+  }
+  
+  memcpy(decimation->mSamples + first, samples, sizeof(float)*count);
+  decimation->mCount += count;
+  
+  _gp_decimation_update(decimation, first);
+}
+
+unsigned int gp_decimation_get_count(gp_decimation* decimation)
+{
+  return decimation->mCount;
+}
+
+unsigned int gp_decimation_get_levels(gp_decimation* decimation)
+{
+  return decimation->mLevelCount;
+}
+
+unsigned int gp_decimation_get_level(gp_decimation* decimation, unsigned int count, unsigned int width)
+{
+  if(width == 0 || count <= 2*width) return 0;
+  
+  unsigned int level = 0;
+  while(level+1 < decimation->mLevelCount && (count >> (level+1)) >= width)
+    ++level;
+  
+  return level;
+}
+
+unsigned int gp_decimation_get_data(gp_decimation* decimation,
+                                    gp_array_data* ad,
+                                    unsigned int level,
+                                    unsigned int first,
+                                    unsigned int count)
+{
+  if(first >= decimation->mCount || count == 0)
+  {
+    gp_array_data_allocate(ad, 0);
+    return 0;
+  }
+  
+  if(count > decimation->mCount - first) count = decimation->mCount - first;
+  if(level >= decimation->mLevelCount) level = decimation->mLevelCount-1;
+  
+  if(level == 0)
+  {
+    gp_array_data_allocate(ad, sizeof(float)*2*count);
+    float* out = (float*)gp_array_data_get_data(ad);
+    for(unsigned int i=0; i<count; ++i)
+    {
+      out[i*2] = (float)i;
+      out[i*2+1] = decimation->mSamples[first+i];
+    }
+    
+    return count;
+  }
+  
+  const unsigned int begin = first >> level;
+  const unsigned int end = ((first + count - 1) >> level) + 1;
+  const _gp_decimation_bucket* buckets = decimation->mLevels[level];
+  
+  gp_array_data_allocate(ad, sizeof(float)*4*(end-begin));
+  float* out = (float*)gp_array_data_get_data(ad);
+  for(unsigned int j=begin; j<end; ++j)
+  {
+    const _gp_decimation_bucket* b = buckets + j;
+    float x = (float)(((double)j + 0.5)*(double)(1u << level) - (double)first);
+    
+    // Visit the extreme closest to the first sample first so the strip
+    // follows the series between buckets.
+    int rising = fabsf(b->mFirst - b->mMin) + fabsf(b->mLast - b->mMax) <= fabsf(b->mFirst - b->mMax) + fabsf(b->mLast - b->mMin);
+    out[0] = x;
+    out[1] = rising ? b->mMin : b->mMax;
+    out[2] = x;
+    out[3] = rising ? b->mMax : b->mMin;
+    out += 4;
+  }
+  
+  return (end-begin)*2;
+}
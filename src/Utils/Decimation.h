@@ -0,0 +1,56 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_DECIMATION_H__
+#define __GP_UTILS_DECIMATION_H__
+
+#include <GraphicsPipeline/Decimation.h>
+#include "Object.h"
+
+#define GP_DECIMATION_MAX_LEVELS  32
+
+// Number of buckets built per parallel job.
+#define GP_DECIMATION_CHUNK_SIZE  65536
+
+/*
+ * Envelope of the samples covered by a bucket.  Kept as four floats so a
+ * bucket fills one SIMD register.
+ */
+typedef struct
+{
+  float                     mMin;
+  float                     mMax;
+  float                     mFirst;
+  float                     mLast;
+} _gp_decimation_bucket;
+
+struct _gp_decimation
+{
+  gp_object                 mObject;
+  float*                    mSamples;
+  unsigned int              mCount;
+  unsigned int              mCapacity;
+  
+  // Level l groups 2^l samples per bucket.  Level 0 is mSamples, so
+  // mLevels[0] is unused.  The last bucket of every level may be partial.
+  _gp_decimation_bucket*    mLevels[GP_DECIMATION_MAX_LEVELS];
+  unsigned int              mCapacities[GP_DECIMATION_MAX_LEVELS];
+  unsigned int              mLevelCount;
+};
+
+#endif // __GP_UTILS_DECIMATION_H__
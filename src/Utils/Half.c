@@ -0,0 +1,148 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Half.h>
+
+// NOTE: F16C is not part of the x86-64 baseline, so GCC and Clang compile
+// the kernels for it separately and pick them at run time.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GP_HALF_F16C
+#define GP_HALF_TARGET            __attribute__((target("avx,f16c")))
+#define GP_HALF_SUPPORTED()       (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c"))
+#include <immintrin.h>
+#elif defined(_M_X64) && defined(__AVX2__)
+#define GP_HALF_F16C
+#define GP_HALF_TARGET
+#define GP_HALF_SUPPORTED()       1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_HALF_NEON
+#include <arm_neon.h>
+#endif
+
+typedef union
+{
+  float                   mFloat;
+  uint32_t                mBits;
+} _gp_half_float;
+
+// Round to nearest even, with NaNs kept quiet and subnormals rounded by the
+// FPU through a magic addition.
+static uint16_t _gp_half_from_float(float value)
+{
+  const uint32_t infinity = 255u << 23;
+  const uint32_t overflow = (127u + 16u) << 23;
+  const _gp_half_float denormal = {.mBits = ((127u - 15u) + (23u - 10u) + 1u) << 23};
+  
+  _gp_half_float f = {.mFloat = value};
+  const uint32_t sign = f.mBits & 0x80000000u;
+  f.mBits ^= sign;
+  
+  uint16_t h;
+  if(f.mBits >= overflow)
+  {
+    h = f.mBits > infinity ? 0x7E00 : 0x7C00;
+  }
+  else if(f.mBits < (113u << 23))
+  {
+    f.mFloat += denormal.mFloat;
+    h = (uint16_t)(f.mBits - denormal.mBits);
+  }
+  else
+  {
+    const uint32_t odd = (f.mBits >> 13) & 1;
+    f.mBits += ((uint32_t)(15 - 127) << 23) + 0xFFF + odd;
+    h = (uint16_t)(f.mBits >> 13);
+  }
+  
+  return h | (uint16_t)(sign >> 16);
+}
+
+static float _gp_half_to_float(uint16_t value)
+{
+  const _gp_half_float magic = {.mBits = 113u << 23};
+  const uint32_t exponent = 0x7C00u << 13;
+  
+  _gp_half_float f = {.mBits = (uint32_t)(value & 0x7FFF) << 13};
+  const uint32_t e = f.mBits & exponent;
+  f.mBits += (127u - 15u) << 23;
+  
+  if(e == exponent)
+  {
+    // Infinity or NaN.
+    f.mBits += (128u - 16u) << 23;
+  }
+  else if(e == 0)
+  {
+    // Zero or subnormal.
+    f.mBits += 1u << 23;
+    f.mFloat -= magic.mFloat;
+  }
+  
+  f.mBits |= (uint32_t)(value & 0x8000) << 16;
+  return f.mFloat;
+}
+
+#ifdef GP_HALF_F16C
+GP_HALF_TARGET static unsigned int _gp_half_from_float_f16c(const float* data, uint16_t* result, unsigned int count)
+{
+  unsigned int i = 0;
+  for(; i+8<=count; i+=8)
+    _mm_storeu_si128((__m128i*)(result+i), _mm256_cvtps_ph(_mm256_loadu_ps(data+i), _MM_FROUND_TO_NEAREST_INT));
+  return i;
+}
+
+GP_HALF_TARGET static unsigned int _gp_half_to_float_f16c(const uint16_t* data, float* result, unsigned int count)
+{
+  unsigned int i = 0;
+  for(; i+8<=count; i+=8)
+    _mm256_storeu_ps(result+i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(data+i))));
+  return i;
+}
+#endif
+
+void gp_half_from_float(const float* data, uint16_t* result, unsigned int count)
+{
+  unsigned int i = 0;
+  
+#if defined(GP_HALF_F16C)
+  if(GP_HALF_SUPPORTED())
+    i = _gp_half_from_float_f16c(data, result, count);
+#elif defined(GP_HALF_NEON)
+  for(; i+4<=count; i+=4)
+    vst1_u16(result+i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(data+i))));
+#endif
+  
+  for(; i<count; ++i)
+    result[i] = _gp_half_from_float(data[i]);
+}
+
+void gp_half_to_float(const uint16_t* data, float* result, unsigned int count)
+{
+  unsigned int i = 0;
+  
+#if defined(GP_HALF_F16C)
+  if(GP_HALF_SUPPORTED())
+    i = _gp_half_to_float_f16c(data, result, count);
+#elif defined(GP_HALF_NEON)
+  for(; i+4<=count; i+=4)
+    vst1q_f32(result+i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(data+i))));
+#endif
+  
+  for(; i<count; ++i)
+    result[i] = _gp_half_to_float(data[i]);
+}
@@ -0,0 +1,374 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include "Image.h"
+#include <GraphicsPipeline/Logging.h>
+#include "Config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef GP_IMAGE_PNG
+#include <png.h>
+#endif
+
+#ifdef GP_IMAGE_JPEG
+#include <setjmp.h>
+#include <jpeglib.h>
+#endif
+
+// Largest image decoded, in pixels, so corrupt headers can't overflow sizes.
+#define GP_IMAGE_MAX_PIXELS       400000000
+
+typedef enum
+{
+  GP_IMAGE_UNKNOWN,
+  GP_IMAGE_QOI,
+  GP_IMAGE_PNG_FILE,
+  GP_IMAGE_JPEG_FILE
+} _gp_image_format;
+
+static _gp_image_format _gp_image_detect(const unsigned char* bytes, size_t size)
+{
+  static const unsigned char png[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  
+  if(size >= 14 && memcmp(bytes, "qoif", 4) == 0)
+    return GP_IMAGE_QOI;
+  if(size >= 8 && memcmp(bytes, png, 8) == 0)
+    return GP_IMAGE_PNG_FILE;
+  if(size >= 3 && bytes[0] == 0xFF && bytes[1] == 0xD8 && bytes[2] == 0xFF)
+    return GP_IMAGE_JPEG_FILE;
+  return GP_IMAGE_UNKNOWN;
+}
+
+static int _gp_image_check_size(unsigned int width, unsigned int height)
+{
+  return width > 0 && height > 0 && (uint64_t)width*height <= GP_IMAGE_MAX_PIXELS;
+}
+
+//
+// QOI
+//
+
+static uint32_t _gp_qoi_read32(const unsigned char* bytes)
+{
+  return (uint32_t)bytes[0] << 24 | (uint32_t)bytes[1] << 16 | (uint32_t)bytes[2] << 8 | bytes[3];
+}
+
+static int _gp_qoi_info(const unsigned char* bytes, unsigned int* width, unsigned int* height)
+{
+  *width = _gp_qoi_read32(bytes + 4);
+  *height = _gp_qoi_read32(bytes + 8);
+  
+  return (bytes[12] == 3 || bytes[12] == 4) && _gp_image_check_size(*width, *height);
+}
+
+/*
+ * Decode the operations of a QOI stream, see https://qoiformat.org.  The
+ * stream ends with seven zero bytes and a one, which are never read as
+ * operations.
+ */
+static int _gp_qoi_decode(const unsigned char* bytes, size_t size, unsigned char* pixels, size_t pitch)
+{
+  unsigned int width, height;
+  if(!_gp_qoi_info(bytes, &width, &height) || size < 22) return 0;
+  
+  const unsigned char* p = bytes + 14;
+  const unsigned char* end = bytes + size - 8;
+  unsigned char index[64][4];
+  unsigned char px[4] = {0, 0, 0, 255};
+  unsigned int run = 0;
+  memset(index, 0, sizeof(index));
+  
+  unsigned int x, y;
+  for(y=0; y<height; ++y)
+  {
+    unsigned char* row = pixels + y*pitch;
+    for(x=0; x<width; ++x)
+    {
+      if(run > 0)
+      {
+        --run;
+      }
+      else
+      {
+        if(p >= end) return 0;
+        
+        const unsigned char b1 = *p++;
+        if(b1 == 0xFE)
+        {
+          if(end - p < 3) return 0;
+          px[0] = p[0];
+          px[1] = p[1];
+          px[2] = p[2];
+          p += 3;
+        }
+        else if(b1 == 0xFF)
+        {
+          if(end - p < 4) return 0;
+          memcpy(px, p, 4);
+          p += 4;
+        }
+        else
+        {
+          switch(b1 & 0xC0)
+          {
+            case 0x00:
+              memcpy(px, index[b1], 4);
+              break;
+            case 0x40:
+              px[0] += ((b1 >> 4) & 3) - 2;
+              px[1] += ((b1 >> 2) & 3) - 2;
+              px[2] += (b1 & 3) - 2;
+              break;
+            case 0x80:
+            {
+              if(p >= end) return 0;
+              const unsigned char b2 = *p++;
+              const int green = (b1 & 0x3F) - 32;
+              px[0] += green - 8 + (b2 >> 4);
+              px[1] += green;
+              px[2] += green - 8 + (b2 & 0x0F);
+              break;
+            }
+            default:
+              run = b1 & 0x3F;
+              break;
+          }
+        }
+        
+        memcpy(index[(px[0]*3 + px[1]*5 + px[2]*7 + px[3]*11)%64], px, 4);
+      }
+      
+      memcpy(row + x*4, px, 4);
+    }
+  }
+  
+  return 1;
+}
+
+//
+// PNG
+//
+
+#ifdef GP_IMAGE_PNG
+static int _gp_png_info(const unsigned char* bytes, size_t size, unsigned int* width, unsigned int* height)
+{
+  png_image image;
+  memset(&image, 0, sizeof(image));
+  image.version = PNG_IMAGE_VERSION;
+  
+  if(!png_image_begin_read_from_memory(&image, bytes, size)) return 0;
+  
+  *width = image.width;
+  *height = image.height;
+  png_image_free(&image);
+  
+  return _gp_image_check_size(*width, *height);
+}
+
+static int _gp_png_decode(const unsigned char* bytes, size_t size, unsigned char* pixels, size_t pitch)
+{
+  png_image image;
+  memset(&image, 0, sizeof(image));
+  image.version = PNG_IMAGE_VERSION;
+  
+  if(!png_image_begin_read_from_memory(&image, bytes, size)) return 0;
+  if(!_gp_image_check_size(image.width, image.height))
+  {
+    png_image_free(&image);
+    return 0;
+  }
+  
+  image.format = PNG_FORMAT_RGBA;
+  if(!png_image_finish_read(&image, NULL, pixels, (png_int_32)pitch, NULL))
+  {
+    gp_log_debug("PNG: %s", image.message);
+    png_image_free(&image);
+    return 0;
+  }
+  
+  return 1;
+}
+#endif // GP_IMAGE_PNG
+
+//
+// JPEG
+//
+
+#ifdef GP_IMAGE_JPEG
+typedef struct
+{
+  struct jpeg_error_mgr   mManager;
+  jmp_buf                 mJump;
+} _gp_jpeg_error;
+
+static void _gp_jpeg_error_exit(j_common_ptr info)
+{
+  _gp_jpeg_error* error = (_gp_jpeg_error*)info->err;
+  longjmp(error->mJump, 1);
+}
+
+static void _gp_jpeg_output_message(j_common_ptr info)
+{
+  char message[JMSG_LENGTH_MAX];
+  info->err->format_message(info, message);
+  gp_log_debug("JPEG: %s", message);
+}
+
+/*
+ * Decode the header, and the pixels if pixels is not NULL.  libjpeg reports
+ * errors by calling error_exit, which must not return.
+ */
+static int _gp_jpeg_read(const unsigned char* bytes,
+                         size_t size,
+                         unsigned int* width,
+                         unsigned int* height,
+                         unsigned char* pixels,
+                         size_t pitch)
+{
+  struct jpeg_decompress_struct info;
+  _gp_jpeg_error error;
+  
+  info.err = jpeg_std_error(&error.mManager);
+  error.mManager.error_exit = _gp_jpeg_error_exit;
+  error.mManager.output_message = _gp_jpeg_output_message;
+  if(setjmp(error.mJump))
+  {
+    jpeg_destroy_decompress(&info);
+    return 0;
+  }
+  
+  jpeg_create_decompress(&info);
+  jpeg_mem_src(&info, (unsigned char*)bytes, (unsigned long)size);
+  jpeg_read_header(&info, TRUE);
+  
+  *width = info.image_width;
+  *height = info.image_height;
+  const int valid = _gp_image_check_size(*width, *height);
+  if(pixels == NULL || !valid)
+  {
+    jpeg_destroy_decompress(&info);
+    return valid;
+  }
+  
+  // Every libjpeg converts YCbCr to RGB, but only some expand grayscale.
+  info.out_color_space = info.jpeg_color_space == JCS_GRAYSCALE ? JCS_GRAYSCALE : JCS_RGB;
+  jpeg_start_decompress(&info);
+  
+  // Rows are decoded into the front of their RGBA row and expanded from
+  // the back so the expansion never overwrites unread values.
+  const unsigned int components = info.output_components;
+  while(info.output_scanline < info.output_height)
+  {
+    unsigned char* row = pixels + info.output_scanline*pitch;
+    jpeg_read_scanlines(&info, &row, 1);
+    
+    unsigned int x = info.output_width;
+    while(x-- > 0)
+    {
+      const unsigned char* src = row + x*components;
+      unsigned char* dst = row + x*4;
+      dst[3] = 255;
+      dst[2] = src[components - 1];
+      dst[1] = src[components/2];
+      dst[0] = src[0];
+    }
+  }
+  
+  jpeg_finish_decompress(&info);
+  jpeg_destroy_decompress(&info);
+  
+  return 1;
+}
+#endif // GP_IMAGE_JPEG
+
+int gp_image_get_info(const void* data, size_t size, unsigned int* width, unsigned int* height)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  
+  *width = 0;
+  *height = 0;
+  
+  switch(_gp_image_detect(bytes, size))
+  {
+    case GP_IMAGE_QOI:
+      return _gp_qoi_info(bytes, width, height);
+#ifdef GP_IMAGE_PNG
+    case GP_IMAGE_PNG_FILE:
+      return _gp_png_info(bytes, size, width, height);
+#endif
+#ifdef GP_IMAGE_JPEG
+    case GP_IMAGE_JPEG_FILE:
+      return _gp_jpeg_read(bytes, size, width, height, NULL, 0);
+#endif
+    default:
+      return 0;
+  }
+}
+
+int gp_image_decode(const void* data, size_t size, void* pixels, size_t pitch)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  
+  switch(_gp_image_detect(bytes, size))
+  {
+    case GP_IMAGE_QOI:
+      return _gp_qoi_decode(bytes, size, (unsigned char*)pixels, pitch);
+#ifdef GP_IMAGE_PNG
+    case GP_IMAGE_PNG_FILE:
+      return _gp_png_decode(bytes, size, (unsigned char*)pixels, pitch);
+#endif
+#ifdef GP_IMAGE_JPEG
+    case GP_IMAGE_JPEG_FILE:
+    {
+      unsigned int width, height;
+      return _gp_jpeg_read(bytes, size, &width, &height, (unsigned char*)pixels, pitch);
+    }
+#endif
+    default:
+      gp_log_error("Image format is not supported");
+      return 0;
+  }
+}
+
+void* _gp_image_read(const char* path, size_t* size, unsigned int* width, unsigned int* height)
+{
+  *size = 0;
+  
+  FILE* file = fopen(path, "rb");
+  if(file == NULL) return NULL;
+  
+  void* data = NULL;
+  long length = -1;
+  if(fseek(file, 0, SEEK_END) == 0) length = ftell(file);
+  if(length > 0 && fseek(file, 0, SEEK_SET) == 0)
+  {
+    data = malloc(length);
+    *size = fread(data, 1, length, file);
+  }
+  fclose(file);
+  
+  if(data && !gp_image_get_info(data, *size, width, height))
+  {
+    free(data);
+    data = NULL;
+  }
+  return data;
+}
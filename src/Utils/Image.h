@@ -0,0 +1,40 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#ifndef __GP_UTILS_IMAGE_H__
+#define __GP_UTILS_IMAGE_H__
+
+#include <GraphicsPipeline/Image.h>
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Read an image file into memory to be decoded with gp_image_decode().
+ * Returns the contents of the file, freed with free(), or NULL if it can't
+ * be read or is not a supported image.
+ */
+void* _gp_image_read(const char* path, size_t* size, unsigned int* width, unsigned int* height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_IMAGE_H__
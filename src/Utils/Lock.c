@@ -0,0 +1,54 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include "Lock.h"
+
+#if !defined(GP_ATOMICS) && defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+void gp_lock_init(gp_lock* lock)
+{
+#ifndef GP_ATOMICS
+  lock->mFlag = 0;
+#else
+  atomic_flag_clear(&lock->mFlag);
+#endif
+}
+
+void gp_lock_acquire(gp_lock* lock)
+{
+#if !defined(GP_ATOMICS) && defined(_WIN32)
+  while(InterlockedExchange(&lock->mFlag, 1));
+#elif !defined(GP_ATOMICS)
+  while(__sync_lock_test_and_set(&lock->mFlag, 1));
+#else
+  while(atomic_flag_test_and_set_explicit(&lock->mFlag, memory_order_acquire));
+#endif
+}
+
+void gp_lock_release(gp_lock* lock)
+{
+#if !defined(GP_ATOMICS) && defined(_WIN32)
+  InterlockedExchange(&lock->mFlag, 0);
+#elif !defined(GP_ATOMICS)
+  __sync_lock_release(&lock->mFlag);
+#else
+  atomic_flag_clear_explicit(&lock->mFlag, memory_order_release);
+#endif
+}
@@ -0,0 +1,57 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#ifndef __GP_LOCK_H__
+#define __GP_LOCK_H__
+
+#include "RefCounter.h"
+
+// NOTE: Locks are only meant to guard short critical sections in C code.
+// Without C11 atomics they fall back to the interlocked intrinsics of the
+// compiler.
+#ifndef GP_ATOMICS
+#if defined(_WIN32)
+typedef volatile long _gp_lock_type;
+#elif defined(__GNUC__)
+typedef volatile int _gp_lock_type;
+#else
+#error "Locks need C11 atomics, Windows interlocked functions or GCC builtins"
+#endif
+#define GP_LOCK_INIT {0}
+#else
+typedef atomic_flag _gp_lock_type;
+#define GP_LOCK_INIT {ATOMIC_FLAG_INIT}
+#endif
+
+typedef struct
+{
+  _gp_lock_type mFlag;
+} gp_lock;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gp_lock_init(gp_lock* lock);
+void gp_lock_acquire(gp_lock* lock);
+void gp_lock_release(gp_lock* lock);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_LOCK_H__
@@ -0,0 +1,352 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Mesh.h>
+#include <GraphicsPipeline/Array.h>
+#include <GraphicsPipeline/Logging.h>
+#include "Parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//! Number of triangles optimized together on one thread.
+#define GP_MESH_CLUSTER_SIZE 65536
+
+#define GP_MESH_EMPTY 0xFFFFFFFF
+
+typedef struct
+{
+  uint32_t*               mIndices;
+  unsigned int            mCount;
+} _gp_mesh_job;
+
+/*
+ * Per cluster state.  Vertices are renumbered to the cluster so every table
+ * is sized by the cluster rather than by the whole mesh.
+ */
+typedef struct
+{
+  uint32_t*               mLocal;       // Cluster indices.
+  uint32_t*               mGlobal;      // Mesh index for every cluster vertex.
+  uint32_t*               mOffsets;     // Start of every vertex in mAdjacency.
+  uint32_t*               mAdjacency;   // Triangles using every vertex.
+  uint32_t*               mLive;        // Triangles left to emit for every vertex.
+  uint32_t*               mTime;        // Time every vertex entered the cache.
+  uint32_t*               mDeadEnd;     // Stack of recently used vertices.
+  uint32_t*               mCandidates;  // Vertices of the last emitted fan.
+  uint32_t*               mOutput;      // Reordered cluster indices.
+  unsigned char*          mEmitted;     // Triangles already emitted.
+  unsigned int            mVertices;
+  unsigned int            mTriangles;
+} _gp_mesh_cluster;
+
+static unsigned int _gp_mesh_remap(_gp_mesh_cluster* cluster, const uint32_t* indices, unsigned int count)
+{
+  unsigned int size = 1;
+  while(size < count*2) size <<= 1;
+  
+  uint32_t* keys = malloc(sizeof(uint32_t)*size);
+  uint32_t* values = malloc(sizeof(uint32_t)*size);
+  memset(keys, 0xFF, sizeof(uint32_t)*size);
+  
+  unsigned int vertices = 0;
+  for(unsigned int i=0; i<count; ++i)
+  {
+    uint32_t index = indices[i];
+    unsigned int slot = (index*2654435761u) & (size-1);
+    while(keys[slot] != GP_MESH_EMPTY && keys[slot] != index)
+      slot = (slot+1) & (size-1);
+    
+    if(keys[slot] == GP_MESH_EMPTY)
+    {
+      keys[slot] = index;
+      values[slot] = vertices;
+      cluster->mGlobal[vertices++] = index;
+    }
+    cluster->mLocal[i] = values[slot];
+  }
+  
+  free(keys);
+  free(values);
+  return vertices;
+}
+
+static uint32_t _gp_mesh_skip_dead_end(_gp_mesh_cluster* cluster, unsigned int* dead_end, unsigned int* cursor)
+{
+  while(*dead_end > 0)
+  {
+    uint32_t v = cluster->mDeadEnd[--(*dead_end)];
+    if(cluster->mLive[v] > 0) return v;
+  }
+  
+  for(; *cursor<cluster->mVertices; ++(*cursor))
+  {
+    if(cluster->mLive[*cursor] > 0) return *cursor;
+  }
+  
+  return GP_MESH_EMPTY;
+}
+
+/*
+ * Tipsify, from Sander, Nehab and Barczak, "Fast Triangle Reordering for
+ * Vertex Locality and Reduced Overdraw".  Emits every triangle around a
+ * fanning vertex, then moves to the neighbor still in the cache with the
+ * most triangles left.
+ */
+static void _gp_mesh_tipsify(_gp_mesh_cluster* cluster)
+{
+  const unsigned int k = GP_MESH_CACHE_SIZE;
+  unsigned int output = 0;
+  unsigned int dead_end = 0;
+  unsigned int cursor = 0;
+  uint32_t time = k+1;
+  uint32_t fan = 0;
+  
+  while(fan != GP_MESH_EMPTY)
+  {
+    unsigned int candidates = 0;
+    for(uint32_t a=cluster->mOffsets[fan]; a<cluster->mOffsets[fan+1]; ++a)
+    {
+      uint32_t t = cluster->mAdjacency[a];
+      if(cluster->mEmitted[t]) continue;
+      
+      for(int c=0; c<3; ++c)
+      {
+        uint32_t v = cluster->mLocal[t*3+c];
+        cluster->mOutput[output++] = v;
+        cluster->mDeadEnd[dead_end++] = v;
+        cluster->mCandidates[candidates++] = v;
+        cluster->mLive[v]--;
+        if(time - cluster->mTime[v] > k)
+          cluster->mTime[v] = time++;
+      }
+      cluster->mEmitted[t] = 1;
+    }
+    
+    uint32_t best = GP_MESH_EMPTY;
+    uint32_t priority = 0;
+    for(unsigned int i=0; i<candidates; ++i)
+    {
+      uint32_t v = cluster->mCandidates[i];
+      if(cluster->mLive[v] == 0) continue;
+      
+      // Prefer vertices entered most recently that will still be cached
+      // once all of their triangles are emitted.
+      uint32_t p = 0;
+      if(time - cluster->mTime[v] + 2*cluster->mLive[v] <= k)
+        p = time - cluster->mTime[v];
+      if(p > priority)
+      {
+        priority = p;
+        best = v;
+      }
+    }
+    
+    fan = best != GP_MESH_EMPTY ? best : _gp_mesh_skip_dead_end(cluster, &dead_end, &cursor);
+  }
+}
+
+static void _gp_mesh_optimize_cluster(void* userdata, size_t index)
+{
+  _gp_mesh_job* job = (_gp_mesh_job*)userdata;
+  
+  unsigned int first = index*GP_MESH_CLUSTER_SIZE*3;
+  unsigned int count = job->mCount - first;
+  if(count > GP_MESH_CLUSTER_SIZE*3) count = GP_MESH_CLUSTER_SIZE*3;
+  uint32_t* indices = job->mIndices + first;
+  
+  _gp_mesh_cluster cluster;
+  cluster.mTriangles = count/3;
+  cluster.mLocal = malloc(sizeof(uint32_t)*count);
+  cluster.mGlobal = malloc(sizeof(uint32_t)*count);
+  cluster.mVertices = _gp_mesh_remap(&cluster, indices, count);
+  
+  const unsigned int vertices = cluster.mVertices;
+  cluster.mOffsets = calloc(vertices+1, sizeof(uint32_t));
+  cluster.mAdjacency = malloc(sizeof(uint32_t)*count);
+  cluster.mLive = calloc(vertices, sizeof(uint32_t));
+  cluster.mTime = calloc(vertices, sizeof(uint32_t));
+  cluster.mDeadEnd = malloc(sizeof(uint32_t)*count);
+  cluster.mCandidates = malloc(sizeof(uint32_t)*count);
+  cluster.mOutput = malloc(sizeof(uint32_t)*count);
+  cluster.mEmitted = calloc(cluster.mTriangles, 1);
+  
+  // Build the triangles using every vertex.
+  for(unsigned int i=0; i<count; ++i)
+    cluster.mLive[cluster.mLocal[i]]++;
+  for(unsigned int v=0; v<vertices; ++v)
+    cluster.mOffsets[v+1] = cluster.mOffsets[v] + cluster.mLive[v];
+  for(unsigned int i=0; i<count; ++i)
+  {
+    uint32_t v = cluster.mLocal[i];
+    cluster.mAdjacency[cluster.mOffsets[v+1] - cluster.mLive[v]] = i/3;
+    cluster.mLive[v]--;
+  }
+  for(unsigned int v=0; v<vertices; ++v)
+    cluster.mLive[v] = cluster.mOffsets[v+1] - cluster.mOffsets[v];
+  
+  if(vertices > 0)
+    _gp_mesh_tipsify(&cluster);
+  
+  for(unsigned int i=0; i<count; ++i)
+    indices[i] = cluster.mGlobal[cluster.mOutput[i]];
+  
+  free(cluster.mLocal);
+  free(cluster.mGlobal);
+  free(cluster.mOffsets);
+  free(cluster.mAdjacency);
+  free(cluster.mLive);
+  free(cluster.mTime);
+  free(cluster.mDeadEnd);
+  free(cluster.mCandidates);
+  free(cluster.mOutput);
+  free(cluster.mEmitted);
+}
+
+double gp_mesh_get_acmr(const uint32_t* indices, unsigned int count, unsigned int vertices)
+{
+  if(count < 3) return 0.0;
+  
+  // A vertex is cached while fewer than the cache size misses happened
+  // since it was loaded, which models a FIFO cache.
+  uint32_t* loaded = calloc(vertices, sizeof(uint32_t));
+  uint32_t misses = 0;
+  for(unsigned int i=0; i<count; ++i)
+  {
+    uint32_t v = indices[i];
+    if(loaded[v] == 0 || misses - loaded[v] >= GP_MESH_CACHE_SIZE)
+      loaded[v] = ++misses;
+  }
+  free(loaded);
+  
+  return (double)misses/(double)(count/3);
+}
+
+/*
+ * Order triangles by their lowest vertex with a counting sort, so clusters
+ * cut from the triangle list are made of neighboring triangles even when
+ * the input triangle order is random.
+ */
+static void _gp_mesh_sort_triangles(uint32_t* indices, unsigned int count, unsigned int vertices)
+{
+  uint32_t* offsets = calloc(vertices+1, sizeof(uint32_t));
+  uint32_t* sorted = malloc(sizeof(uint32_t)*count);
+  
+  for(unsigned int i=0; i<count; i+=3)
+  {
+    uint32_t v = indices[i];
+    if(indices[i+1] < v) v = indices[i+1];
+    if(indices[i+2] < v) v = indices[i+2];
+    offsets[v+1]++;
+  }
+  for(unsigned int v=0; v<vertices; ++v)
+    offsets[v+1] += offsets[v];
+  
+  for(unsigned int i=0; i<count; i+=3)
+  {
+    uint32_t v = indices[i];
+    if(indices[i+1] < v) v = indices[i+1];
+    if(indices[i+2] < v) v = indices[i+2];
+    memcpy(sorted + offsets[v]++*3, indices + i, sizeof(uint32_t)*3);
+  }
+  
+  memcpy(indices, sorted, sizeof(uint32_t)*count);
+  free(sorted);
+  free(offsets);
+}
+
+void gp_mesh_optimize_vertex_cache(uint32_t* indices, unsigned int count, unsigned int vertices)
+{
+  count -= count%3;
+  if(count == 0) return;
+  
+  if(count/3 > GP_MESH_CLUSTER_SIZE)
+    _gp_mesh_sort_triangles(indices, count, vertices);
+  
+  _gp_mesh_job job = {indices, count};
+  gp_parallel_for((count/3 + GP_MESH_CLUSTER_SIZE - 1)/GP_MESH_CLUSTER_SIZE, _gp_mesh_optimize_cluster, &job);
+}
+
+unsigned int gp_mesh_optimize_vertex_fetch(uint32_t* indices,
+                                           unsigned int count,
+                                           void* vertices,
+                                           unsigned int vertex_count,
+                                           unsigned int vertex_size)
+{
+  uint32_t* remap = malloc(sizeof(uint32_t)*vertex_count);
+  memset(remap, 0xFF, sizeof(uint32_t)*vertex_count);
+  
+  uint32_t used = 0;
+  for(unsigned int i=0; i<count; ++i)
+  {
+    uint32_t v = indices[i];
+    if(remap[v] == GP_MESH_EMPTY) remap[v] = used++;
+    indices[i] = remap[v];
+  }
+  
+  char* data = (char*)vertices;
+  char* copy = malloc((size_t)vertex_count*vertex_size);
+  memcpy(copy, data, (size_t)vertex_count*vertex_size);
+  for(unsigned int v=0; v<vertex_count; ++v)
+  {
+    if(remap[v] != GP_MESH_EMPTY)
+      memcpy(data + (size_t)remap[v]*vertex_size, copy + (size_t)v*vertex_size, vertex_size);
+  }
+  
+  free(copy);
+  free(remap);
+  return used;
+}
+
+gp_mesh_stats gp_mesh_optimize(gp_array_data* indices, gp_array_data* vertices, unsigned int vertex_size)
+{
+  gp_mesh_stats stats = {0.0, 0.0};
+  
+  if(gp_array_data_get_shared(indices) || gp_array_data_get_shared(vertices))
+  {
+    gp_log_error("Shared array data is only written by its producer");
+    return stats;
+  }
+  
+  uint32_t* index_data = (uint32_t*)gp_array_data_get_data(indices);
+  unsigned int count = gp_array_data_get_size(indices)/sizeof(uint32_t);
+  unsigned int vertex_count = gp_array_data_get_size(vertices)/vertex_size;
+  if(index_data == NULL || gp_array_data_get_data(vertices) == NULL)
+  {
+    gp_log_error("Mesh data is empty");
+    return stats;
+  }
+  
+  for(unsigned int i=0; i<count; ++i)
+  {
+    if(index_data[i] >= vertex_count)
+    {
+      gp_log_error("Mesh index %u is out of range", index_data[i]);
+      return stats;
+    }
+  }
+  
+  stats.acmr_before = gp_mesh_get_acmr(index_data, count, vertex_count);
+  gp_mesh_optimize_vertex_cache(index_data, count, vertex_count);
+  stats.acmr_after = gp_mesh_get_acmr(index_data, count, vertex_count);
+  
+  unsigned int used = gp_mesh_optimize_vertex_fetch(index_data, count, gp_array_data_get_data(vertices), vertex_count, vertex_size);
+  if(used < vertex_count)
+    gp_array_data_allocate(vertices, used*vertex_size);
+  
+  return stats;
+}
@@ -0,0 +1,307 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Convert.h>
+#include <GraphicsPipeline/Half.h>
+#include <GraphicsPipeline/Mipmap.h>
+
+#include "Parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_MIPMAP_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_MIPMAP_NEON
+#include <arm_neon.h>
+#endif
+
+#define GP_MIPMAP_ROWS            16  // Destination rows per parallel job.
+#define GP_MIPMAP_BLOCK           256 // Half floats converted at a time.
+
+// Box filter, averaging the two source texels under a destination texel.
+static const int sBoxOffsets[] = {0, 1};
+static const float sBoxWeights[] = {0.5f, 0.5f};
+
+// Sinc with a cutoff of half the source rate, windowed by a Kaiser window
+// with a beta of 4 and a radius of 3 source texels, normalized to 1.
+static const int sKaiserOffsets[] = {-2, -1, 0, 1, 2, 3};
+static const float sKaiserWeights[] = {-0.0209925f, 0.0945023f, 0.4264901f, 0.4264901f, 0.0945023f, -0.0209925f};
+
+typedef struct
+{
+  const char*             mSrc;
+  char*                   mDst;
+  unsigned int            mFormat;
+  GP_DATA_TYPE            mType;
+  size_t                  mTypeSize;
+  unsigned int            mWidth;
+  unsigned int            mHeight;
+  unsigned int            mDstWidth;
+  unsigned int            mDstHeight;
+  unsigned int            mTaps;
+  const int*              mOffsets;
+  const float*            mWeights;
+} _gp_mipmap_job;
+
+unsigned int gp_mipmap_get_levels(unsigned int width, unsigned int height)
+{
+  unsigned int size = width > height ? width : height;
+  unsigned int levels = 1;
+  while(size > 1)
+  {
+    size >>= 1;
+    ++levels;
+  }
+  return levels;
+}
+
+static inline unsigned int _gp_mipmap_clamp(int i, unsigned int size)
+{
+  if(i < 0) return 0;
+  if((unsigned int)i >= size) return size - 1;
+  return i;
+}
+
+/*
+ * Add a weighted source row to the accumulated row.  Vertical filtering
+ * does not depend on the format, so whole rows are filtered at once.
+ */
+static void _gp_mipmap_accumulate(float* row, const void* src, GP_DATA_TYPE type, size_t count, float weight)
+{
+  size_t i = 0;
+  
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+    {
+      const uint8_t* s = (const uint8_t*)src;
+#if defined(GP_MIPMAP_SSE2)
+      const __m128 w = _mm_set1_ps(weight);
+      const __m128i zero = _mm_setzero_si128();
+      for(; i+16<=count; i+=16)
+      {
+        __m128i b = _mm_loadu_si128((const __m128i*)(s+i));
+        __m128i lo = _mm_unpacklo_epi8(b, zero);
+        __m128i hi = _mm_unpackhi_epi8(b, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero));
+        _mm_storeu_ps(row+i, _mm_add_ps(_mm_loadu_ps(row+i), _mm_mul_ps(f0, w)));
+        _mm_storeu_ps(row+i+4, _mm_add_ps(_mm_loadu_ps(row+i+4), _mm_mul_ps(f1, w)));
+        _mm_storeu_ps(row+i+8, _mm_add_ps(_mm_loadu_ps(row+i+8), _mm_mul_ps(f2, w)));
+        _mm_storeu_ps(row+i+12, _mm_add_ps(_mm_loadu_ps(row+i+12), _mm_mul_ps(f3, w)));
+      }
+#elif defined(GP_MIPMAP_NEON)
+      for(; i+8<=count; i+=8)
+      {
+        uint16x8_t b = vmovl_u8(vld1_u8(s+i));
+        float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b)));
+        float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(b)));
+        vst1q_f32(row+i, vmlaq_n_f32(vld1q_f32(row+i), f0, weight));
+        vst1q_f32(row+i+4, vmlaq_n_f32(vld1q_f32(row+i+4), f1, weight));
+      }
+#endif
+      for(; i<count; ++i)
+        row[i] += s[i]*weight;
+      break;
+    }
+    case GP_DATA_TYPE_INT:
+    {
+      const int* s = (const int*)src;
+      for(; i<count; ++i)
+        row[i] += s[i]*weight;
+      break;
+    }
+    case GP_DATA_TYPE_FLOAT:
+    {
+      const float* s = (const float*)src;
+#if defined(GP_MIPMAP_SSE2)
+      const __m128 w = _mm_set1_ps(weight);
+      for(; i+4<=count; i+=4)
+        _mm_storeu_ps(row+i, _mm_add_ps(_mm_loadu_ps(row+i), _mm_mul_ps(_mm_loadu_ps(s+i), w)));
+#elif defined(GP_MIPMAP_NEON)
+      for(; i+4<=count; i+=4)
+        vst1q_f32(row+i, vmlaq_n_f32(vld1q_f32(row+i), vld1q_f32(s+i), weight));
+#endif
+      for(; i<count; ++i)
+        row[i] += s[i]*weight;
+      break;
+    }
+    case GP_DATA_TYPE_DOUBLE:
+    {
+      const double* s = (const double*)src;
+      for(; i<count; ++i)
+        row[i] += (float)(s[i]*weight);
+      break;
+    }
+    case GP_DATA_TYPE_HALF:
+    {
+      float block[GP_MIPMAP_BLOCK];
+      const uint16_t* s = (const uint16_t*)src;
+      while(i < count)
+      {
+        unsigned int n = count - i < GP_MIPMAP_BLOCK ? count - i : GP_MIPMAP_BLOCK;
+        gp_half_to_float(s+i, block, n);
+        _gp_mipmap_accumulate(row+i, block, GP_DATA_TYPE_FLOAT, n, weight);
+        i += n;
+      }
+      break;
+    }
+    case GP_DATA_TYPE_USHORT:
+    {
+      const uint16_t* s = (const uint16_t*)src;
+      for(; i<count; ++i)
+        row[i] += s[i]*weight;
+      break;
+    }
+    case GP_DATA_TYPE_SHORT:
+    {
+      const int16_t* s = (const int16_t*)src;
+      for(; i<count; ++i)
+        row[i] += s[i]*weight;
+      break;
+    }
+  }
+}
+
+static inline float _gp_mipmap_round(float value, float min, float max)
+{
+  // Negative lobes of the Kaiser filter may overshoot the range.
+  if(value < min) value = min;
+  if(value > max) value = max;
+  return value < 0.0f ? value - 0.5f : value + 0.5f;
+}
+
+static void _gp_mipmap_store(void* dst, const float* values, GP_DATA_TYPE type, size_t count)
+{
+  size_t i;
+  switch(type)
+  {
+    case GP_DATA_TYPE_UBYTE:
+      for(i=0; i<count; ++i)
+        ((uint8_t*)dst)[i] = (uint8_t)_gp_mipmap_round(values[i], 0.0f, 255.0f);
+      break;
+    case GP_DATA_TYPE_INT:
+      for(i=0; i<count; ++i)
+        ((int*)dst)[i] = (int)(values[i] < 0.0f ? values[i] - 0.5f : values[i] + 0.5f);
+      break;
+    case GP_DATA_TYPE_FLOAT:
+      memcpy(dst, values, sizeof(float)*count);
+      break;
+    case GP_DATA_TYPE_DOUBLE:
+      for(i=0; i<count; ++i)
+        ((double*)dst)[i] = values[i];
+      break;
+    case GP_DATA_TYPE_HALF:
+      gp_half_from_float(values, (uint16_t*)dst, count);
+      break;
+    case GP_DATA_TYPE_USHORT:
+      for(i=0; i<count; ++i)
+        ((uint16_t*)dst)[i] = (uint16_t)_gp_mipmap_round(values[i], 0.0f, 65535.0f);
+      break;
+    case GP_DATA_TYPE_SHORT:
+      for(i=0; i<count; ++i)
+        ((int16_t*)dst)[i] = (int16_t)_gp_mipmap_round(values[i], -32768.0f, 32767.0f);
+      break;
+  }
+}
+
+static void _gp_mipmap_rows(void* userdata, size_t index)
+{
+  _gp_mipmap_job* job = (_gp_mipmap_job*)userdata;
+  
+  const unsigned int format = job->mFormat;
+  const size_t count = (size_t)job->mWidth*format;
+  const size_t pitch = count*job->mTypeSize;
+  float* row = malloc(sizeof(float)*count);
+  float* out = malloc(sizeof(float)*job->mDstWidth*format);
+  
+  unsigned int first = index*GP_MIPMAP_ROWS;
+  unsigned int last = first + GP_MIPMAP_ROWS;
+  if(last > job->mDstHeight) last = job->mDstHeight;
+  
+  unsigned int y, x, c, t;
+  for(y=first; y<last; ++y)
+  {
+    memset(row, 0, sizeof(float)*count);
+    for(t=0; t<job->mTaps; ++t)
+    {
+      unsigned int sy = _gp_mipmap_clamp(2*y + job->mOffsets[t], job->mHeight);
+      _gp_mipmap_accumulate(row, job->mSrc + sy*pitch, job->mType, count, job->mWeights[t]);
+    }
+    
+    for(x=0; x<job->mDstWidth; ++x)
+    {
+      for(c=0; c<format; ++c)
+      {
+        float value = 0.0f;
+        for(t=0; t<job->mTaps; ++t)
+        {
+          unsigned int sx = _gp_mipmap_clamp(2*x + job->mOffsets[t], job->mWidth);
+          value += row[sx*format + c]*job->mWeights[t];
+        }
+        out[x*format + c] = value;
+      }
+    }
+    
+    void* dst = job->mDst + (size_t)y*job->mDstWidth*format*job->mTypeSize;
+    _gp_mipmap_store(dst, out, job->mType, (size_t)job->mDstWidth*format);
+  }
+  
+  free(out);
+  free(row);
+}
+
+void gp_mipmap_downsample(const void* src,
+                          void* dst,
+                          GP_FORMAT format,
+                          GP_DATA_TYPE type,
+                          unsigned int width,
+                          unsigned int height,
+                          GP_MIPMAP filter)
+{
+  _gp_mipmap_job job;
+  job.mSrc = (const char*)src;
+  job.mDst = (char*)dst;
+  job.mFormat = format;
+  job.mType = type;
+  job.mTypeSize = gp_data_type_get_size(type);
+  job.mWidth = width;
+  job.mHeight = height;
+  job.mDstWidth = width > 1 ? width/2 : 1;
+  job.mDstHeight = height > 1 ? height/2 : 1;
+  
+  if(filter == GP_MIPMAP_KAISER)
+  {
+    job.mTaps = sizeof(sKaiserWeights)/sizeof(float);
+    job.mOffsets = sKaiserOffsets;
+    job.mWeights = sKaiserWeights;
+  }
+  else
+  {
+    job.mTaps = sizeof(sBoxWeights)/sizeof(float);
+    job.mOffsets = sBoxOffsets;
+    job.mWeights = sBoxWeights;
+  }
+  
+  gp_parallel_for((job.mDstHeight + GP_MIPMAP_ROWS - 1)/GP_MIPMAP_ROWS, _gp_mipmap_rows, &job);
+}
@@ -0,0 +1,143 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include "Parallel.h"
+#include "RefCounter.h"
+
+// NOTE: Web builds are single threaded and Windows runs jobs on the calling
+// thread until the pool is ported to Win32 threads.
+#if defined(GP_ATOMICS) && !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define GP_PARALLEL_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef GP_PARALLEL_THREADS
+typedef struct
+{
+  pthread_mutex_t         mMutex;
+  pthread_cond_t          mStart;
+  pthread_cond_t          mDone;
+  unsigned int            mGeneration;      // Bumped for every job
+  int                     mThreads;
+  int                     mActive;          // Workers still running
+  gp_parallel_func        mFunc;
+  void*                   mUserData;
+  size_t                  mCount;
+  atomic_size_t           mNext;            // Next index to be run
+} _gp_parallel_pool;
+
+static _gp_parallel_pool sPool;
+static pthread_once_t sPoolOnce = PTHREAD_ONCE_INIT;
+static atomic_flag sPoolBusy = ATOMIC_FLAG_INIT;
+
+static void _gp_parallel_run(_gp_parallel_pool* pool)
+{
+  size_t index;
+  while((index = atomic_fetch_add(&pool->mNext, 1)) < pool->mCount)
+    pool->mFunc(pool->mUserData, index);
+}
+
+static void* _gp_parallel_worker(void* data)
+{
+  _gp_parallel_pool* pool = (_gp_parallel_pool*)data;
+  unsigned int generation = 0;
+  
+  pthread_mutex_lock(&pool->mMutex);
+  while(1)
+  {
+    while(pool->mGeneration == generation)
+      pthread_cond_wait(&pool->mStart, &pool->mMutex);
+    generation = pool->mGeneration;
+    pthread_mutex_unlock(&pool->mMutex);
+    
+    _gp_parallel_run(pool);
+    
+    pthread_mutex_lock(&pool->mMutex);
+    if(--pool->mActive == 0) pthread_cond_signal(&pool->mDone);
+  }
+  
+  return NULL;
+}
+
+static void _gp_parallel_pool_init()
+{
+  pthread_mutex_init(&sPool.mMutex, NULL);
+  pthread_cond_init(&sPool.mStart, NULL);
+  pthread_cond_init(&sPool.mDone, NULL);
+  sPool.mGeneration = 0;
+  sPool.mThreads = 0;
+  sPool.mActive = 0;
+  
+  // The calling thread runs jobs as well.
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  if(count > GP_PARALLEL_MAX_THREADS) count = GP_PARALLEL_MAX_THREADS;
+  
+  int i;
+  for(i=1; i<count; ++i)
+  {
+    pthread_t thread;
+    if(pthread_create(&thread, NULL, _gp_parallel_worker, &sPool) != 0) break;
+    pthread_detach(thread);
+    ++sPool.mThreads;
+  }
+}
+#endif // GP_PARALLEL_THREADS
+
+void gp_parallel_for(size_t count, gp_parallel_func func, void* userdata)
+{
+#ifdef GP_PARALLEL_THREADS
+  pthread_once(&sPoolOnce, _gp_parallel_pool_init);
+  
+  if(count > 1 && sPool.mThreads > 0 && !atomic_flag_test_and_set(&sPoolBusy))
+  {
+    pthread_mutex_lock(&sPool.mMutex);
+    sPool.mFunc = func;
+    sPool.mUserData = userdata;
+    sPool.mCount = count;
+    atomic_store(&sPool.mNext, 0);
+    sPool.mActive = sPool.mThreads;
+    ++sPool.mGeneration;
+    pthread_cond_broadcast(&sPool.mStart);
+    pthread_mutex_unlock(&sPool.mMutex);
+    
+    _gp_parallel_run(&sPool);
+    
+    pthread_mutex_lock(&sPool.mMutex);
+    while(sPool.mActive > 0)
+      pthread_cond_wait(&sPool.mDone, &sPool.mMutex);
+    pthread_mutex_unlock(&sPool.mMutex);
+    
+    atomic_flag_clear(&sPoolBusy);
+    return;
+  }
+#endif
+  
+  size_t i;
+  for(i=0; i<count; ++i)
+    func(userdata, i);
+}
+
+int gp_parallel_get_threads()
+{
+#ifdef GP_PARALLEL_THREADS
+  pthread_once(&sPoolOnce, _gp_parallel_pool_init);
+  return sPool.mThreads + 1;
+#else
+  return 1;
+#endif
+}
@@ -0,0 +1,54 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#ifndef __GP_PARALLEL_H__
+#define __GP_PARALLEL_H__
+
+#include <stddef.h>
+
+#define GP_PARALLEL_MAX_THREADS   8
+
+typedef void(*gp_parallel_func)(void* userdata, size_t index);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Call func once for every index in [0, count) using a pool of threads and
+ * the calling thread, returning once every call has finished.  Only one
+ * job runs on the pool at a time; concurrent callers run their job on
+ * their own thread.
+ */
+void gp_parallel_for(size_t count, gp_parallel_func func, void* userdata);
+
+/*
+ * Retrieve the number of threads that run jobs, including the caller.
+ */
+int gp_parallel_get_threads();
+
+/*
+ * Run work on the worker thread of the graphics API, then join on the
+ * thread running the event loop.  Implemented by each platform.
+ */
+void _gp_api_work(void(*work)(void*), void(*join)(void*), void* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_PARALLEL_H__
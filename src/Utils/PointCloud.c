@@ -0,0 +1,670 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "PointCloud.h"
+#include <GraphicsPipeline/Array.h>
+#include <GraphicsPipeline/Logging.h>
+#include "Parallel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define _gp_fseek _fseeki64
+#define _gp_ftell _ftelli64
+#else
+#define _gp_fseek fseeko
+#define _gp_ftell ftello
+#endif
+
+//
+// Octree building
+//
+
+typedef struct
+{
+  FILE*                       mFile;
+  const float*                mPoints;
+  uint32_t*                   mIndices;
+  uint32_t*                   mScratch;
+  float*                      mBuffer;      // Points of the node being written.
+  unsigned char*              mCells;       // Occupied sampling cells.
+  unsigned int                mGrid;
+  unsigned int                mNodeSize;
+  _gp_point_cloud_file_node*  mNodes;
+  unsigned int                mNodeCount;
+  unsigned int                mNodeCapacity;
+  uint64_t                    mOffset;
+  int                         mError;
+} _gp_point_cloud_builder;
+
+static unsigned int _gp_point_cloud_cell(const float* p, const float* bounds, float size, unsigned int grid)
+{
+  unsigned int cell[3];
+  for(int a=0; a<3; ++a)
+  {
+    int c = (int)((p[a] - bounds[a])/size*grid);
+    cell[a] = c < 0 ? 0 : (c >= (int)grid ? grid-1 : (unsigned int)c);
+  }
+  
+  return (cell[2]*grid + cell[1])*grid + cell[0];
+}
+
+/*
+ * Write a node holding an evenly spread subset of the points in
+ * [begin, end) and build its children from the points left over.
+ * Returns the index of the node.
+ */
+static int _gp_point_cloud_build_node(_gp_point_cloud_builder* builder,
+                                      unsigned int begin,
+                                      unsigned int end,
+                                      const float* bounds,
+                                      int depth)
+{
+  if(builder->mNodeCount == builder->mNodeCapacity)
+  {
+    builder->mNodeCapacity = builder->mNodeCapacity ? builder->mNodeCapacity*2 : 64;
+    builder->mNodes = realloc(builder->mNodes, sizeof(_gp_point_cloud_file_node)*builder->mNodeCapacity);
+  }
+  
+  const int index = builder->mNodeCount++;
+  const float size = bounds[3] - bounds[0];
+  uint32_t* indices = builder->mIndices;
+  unsigned int count = end - begin;
+  
+  // Keep the first point in every sampling cell, moving kept points to the
+  // front of the range.
+  unsigned int kept = count;
+  if(count > builder->mNodeSize && depth < GP_POINT_CLOUD_MAX_DEPTH)
+  {
+    const unsigned int grid = builder->mGrid;
+    memset(builder->mCells, 0, grid*grid*grid);
+    
+    kept = 0;
+    for(unsigned int i=begin; i<end && kept<builder->mNodeSize; ++i)
+    {
+      unsigned int cell = _gp_point_cloud_cell(builder->mPoints + (size_t)indices[i]*3, bounds, size, grid);
+      if(builder->mCells[cell]) continue;
+      
+      builder->mCells[cell] = 1;
+      uint32_t swap = indices[begin+kept];
+      indices[begin+kept] = indices[i];
+      indices[i] = swap;
+      ++kept;
+    }
+  }
+  
+  // Write the kept points.
+  _gp_point_cloud_file_node node;
+  memcpy(node.mBounds, bounds, sizeof(node.mBounds));
+  node.mOffset = builder->mOffset;
+  node.mCount = kept;
+  node.mReserved = 0;
+  for(int c=0; c<8; ++c)
+    node.mChildren[c] = -1;
+  
+  builder->mBuffer = realloc(builder->mBuffer, sizeof(float)*3*(kept ? kept : 1));
+  for(unsigned int i=0; i<kept; ++i)
+    memcpy(builder->mBuffer + i*3, builder->mPoints + (size_t)indices[begin+i]*3, sizeof(float)*3);
+  
+  if(fwrite(builder->mBuffer, sizeof(float)*3, kept, builder->mFile) != kept)
+    builder->mError = 1;
+  builder->mOffset += (uint64_t)kept*sizeof(float)*3;
+  
+  // Split the remaining points between the octants.
+  begin += kept;
+  if(begin < end && !builder->mError)
+  {
+    const float half = size/2.0f;
+    unsigned int offsets[9] = {0};
+    for(unsigned int i=begin; i<end; ++i)
+    {
+      const float* p = builder->mPoints + (size_t)indices[i]*3;
+      int octant = (p[0] >= bounds[0]+half) | ((p[1] >= bounds[1]+half) << 1) | ((p[2] >= bounds[2]+half) << 2);
+      offsets[octant+1]++;
+    }
+    for(int c=0; c<8; ++c)
+      offsets[c+1] += offsets[c];
+    
+    unsigned int cursor[8];
+    memcpy(cursor, offsets, sizeof(cursor));
+    for(unsigned int i=begin; i<end; ++i)
+    {
+      const float* p = builder->mPoints + (size_t)indices[i]*3;
+      int octant = (p[0] >= bounds[0]+half) | ((p[1] >= bounds[1]+half) << 1) | ((p[2] >= bounds[2]+half) << 2);
+      builder->mScratch[begin + cursor[octant]++] = indices[i];
+    }
+    memcpy(indices + begin, builder->mScratch + begin, sizeof(uint32_t)*(end-begin));
+    
+    for(int c=0; c<8; ++c)
+    {
+      if(offsets[c] == offsets[c+1]) continue;
+      
+      float child[6];
+      for(int a=0; a<3; ++a)
+      {
+        child[a] = bounds[a] + (((c >> a) & 1) ? half : 0.0f);
+        child[a+3] = child[a] + half;
+      }
+      node.mChildren[c] = _gp_point_cloud_build_node(builder, begin+offsets[c], begin+offsets[c+1], child, depth+1);
+    }
+  }
+  
+  builder->mNodes[index] = node;
+  return index;
+}
+
+int gp_point_cloud_build(const char* path, const float* points, unsigned int count, unsigned int node_size)
+{
+  if(node_size == 0)
+  {
+    gp_log_error("Point cloud nodes must hold at least one point");
+    return 0;
+  }
+  
+  FILE* file = fopen(path, "wb");
+  if(file == NULL)
+  {
+    gp_log_error("Failed to create point cloud file %s", path);
+    return 0;
+  }
+  
+  _gp_point_cloud_builder builder;
+  memset(&builder, 0, sizeof(builder));
+  builder.mFile = file;
+  builder.mPoints = points;
+  builder.mNodeSize = node_size;
+  builder.mGrid = (unsigned int)ceil(cbrt((double)node_size));
+  builder.mCells = malloc((size_t)builder.mGrid*builder.mGrid*builder.mGrid);
+  builder.mIndices = malloc(sizeof(uint32_t)*(count ? count : 1));
+  builder.mScratch = malloc(sizeof(uint32_t)*(count ? count : 1));
+  builder.mOffset = sizeof(_gp_point_cloud_header);
+  
+  // The root is a cube around every point so children stay cubes.
+  float bounds[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+  for(unsigned int i=0; i<count; ++i)
+  {
+    builder.mIndices[i] = i;
+    for(int a=0; a<3; ++a)
+    {
+      float v = points[(size_t)i*3+a];
+      if(i == 0 || v < bounds[a]) bounds[a] = v;
+      if(i == 0 || v > bounds[a+3]) bounds[a+3] = v;
+    }
+  }
+  float size = 0.0f;
+  for(int a=0; a<3; ++a)
+    if(bounds[a+3] - bounds[a] > size) size = bounds[a+3] - bounds[a];
+  size = size > 0.0f ? size*1.0001f : 1.0f;
+  for(int a=0; a<3; ++a)
+    bounds[a+3] = bounds[a] + size;
+  
+  _gp_point_cloud_header header;
+  memset(&header, 0, sizeof(header));
+  fwrite(&header, sizeof(header), 1, file);
+  
+  _gp_point_cloud_build_node(&builder, 0, count, bounds, 0);
+  
+  header.mMagic = GP_POINT_CLOUD_MAGIC;
+  header.mVersion = GP_POINT_CLOUD_VERSION;
+  header.mNodeCount = builder.mNodeCount;
+  header.mGrid = builder.mGrid;
+  header.mTable = builder.mOffset;
+  header.mCount = count;
+  
+  if(fwrite(builder.mNodes, sizeof(_gp_point_cloud_file_node), builder.mNodeCount, file) != builder.mNodeCount ||
+     _gp_fseek(file, 0, SEEK_SET) != 0 ||
+     fwrite(&header, sizeof(header), 1, file) != 1)
+  {
+    builder.mError = 1;
+  }
+  
+  if(fclose(file) != 0) builder.mError = 1;
+  if(builder.mError) gp_log_error("Failed to write point cloud file %s", path);
+  
+  free(builder.mCells);
+  free(builder.mIndices);
+  free(builder.mScratch);
+  free(builder.mBuffer);
+  free(builder.mNodes);
+  
+  return !builder.mError;
+}
+
+//
+// Streaming
+//
+
+static void _gp_point_cloud_evict(gp_point_cloud* cloud, _gp_point_cloud_node* node)
+{
+  gp_pipeline_remove_operation(gp_operation_group_get_pipeline(cloud->mOperation), node->mOperation);
+  gp_object_unref((gp_object*)node->mOperation);
+  gp_object_unref((gp_object*)node->mArray);
+  node->mOperation = NULL;
+  node->mArray = NULL;
+  node->mState = GP_POINT_CLOUD_UNLOADED;
+  
+  gp_list_remove(&cloud->mResident, &node->mNode);
+  cloud->mResidentPoints -= node->mFile.mCount;
+}
+
+void _gp_point_cloud_loaded(void* userdata)
+{
+  _gp_point_cloud_node* node = (_gp_point_cloud_node*)userdata;
+  gp_point_cloud* cloud = node->mCloud;
+  
+  gp_operation* operation = gp_operation_draw_new();
+  if(cloud->mShader)
+    gp_operation_draw_set_shader(operation, cloud->mShader);
+  for(unsigned int i=0; i<cloud->mUniformCount; ++i)
+    gp_operation_draw_set_uniform(operation, cloud->mUniforms[i]);
+  gp_operation_draw_add_array_by_index(operation, node->mArray, 0, 3, GP_DATA_TYPE_FLOAT, 0, 0);
+  gp_operation_draw_set_mode(operation, GP_MODE_POINTS);
+  gp_operation_draw_set_verticies(operation, 0);
+  gp_pipeline_add_operation(gp_operation_group_get_pipeline(cloud->mOperation), operation);
+  
+  node->mOperation = operation;
+  node->mState = GP_POINT_CLOUD_RESIDENT;
+  gp_list_push_back(&cloud->mResident, &node->mNode);
+  cloud->mResidentPoints += node->mFile.mCount;
+  cloud->mLoads--;
+  
+  gp_object_unref((gp_object*)cloud);
+}
+
+void _gp_point_cloud_failed(_gp_point_cloud_node* node)
+{
+  gp_point_cloud* cloud = node->mCloud;
+  
+  gp_log_error("Failed to read point cloud node");
+  gp_object_unref((gp_object*)node->mArray);
+  node->mArray = NULL;
+  node->mState = GP_POINT_CLOUD_FAILED;
+  cloud->mLoads--;
+  gp_object_unref((gp_object*)cloud);
+}
+
+typedef struct
+{
+  _gp_point_cloud_node*     mNode;
+  gp_array_data*            mData;
+  int                       mSuccess;
+} _gp_point_cloud_read;
+
+/*
+ * Runs on the worker thread.  Jobs run one at a time, so the file is never
+ * read from two threads at once.
+ */
+static void _gp_point_cloud_read_func(void* userdata)
+{
+  _gp_point_cloud_read* job = (_gp_point_cloud_read*)userdata;
+  _gp_point_cloud_node* node = job->mNode;
+  const unsigned int size = node->mFile.mCount*sizeof(float)*3;
+  
+  job->mData = gp_array_data_new_with_size(size);
+  job->mSuccess = _gp_fseek(node->mCloud->mFile, (long long)node->mFile.mOffset, SEEK_SET) == 0 &&
+                  fread(gp_array_data_get_data(job->mData), 1, size, node->mCloud->mFile) == size;
+}
+
+static void _gp_point_cloud_read_join(void* userdata)
+{
+  _gp_point_cloud_read* job = (_gp_point_cloud_read*)userdata;
+  _gp_point_cloud_node* node = job->mNode;
+  
+  if(job->mSuccess)
+    gp_array_set_data_async(node->mArray, job->mData, _gp_point_cloud_loaded, node);
+  else
+    _gp_point_cloud_failed(node);
+  
+  gp_object_unref((gp_object*)job->mData);
+  free(job);
+}
+
+static void _gp_point_cloud_request(_gp_point_cloud_node* node)
+{
+  _gp_point_cloud_read* job = malloc(sizeof(_gp_point_cloud_read));
+  job->mNode = node;
+  job->mData = NULL;
+  job->mSuccess = 0;
+  _gp_api_work(_gp_point_cloud_read_func, _gp_point_cloud_read_join, job);
+}
+
+static void _gp_point_cloud_load(gp_point_cloud* cloud, _gp_point_cloud_node* node)
+{
+  node->mArray = gp_array_new(cloud->mContext);
+  node->mState = GP_POINT_CLOUD_LOADING;
+  cloud->mLoads++;
+  
+  // Keep the node alive until the upload finishes.
+  gp_object_ref((gp_object*)cloud);
+  cloud->mRequest(node);
+}
+
+void _gp_point_cloud_free(gp_object* object)
+{
+  gp_point_cloud* cloud = (gp_point_cloud*)object;
+  
+  for(unsigned int i=0; i<cloud->mHeader.mNodeCount; ++i)
+  {
+    _gp_point_cloud_node* node = cloud->mNodes + i;
+    if(node->mOperation) gp_object_unref((gp_object*)node->mOperation);
+    if(node->mArray) gp_object_unref((gp_object*)node->mArray);
+  }
+  gp_list_free(&cloud->mResident);
+  
+  for(unsigned int i=0; i<cloud->mUniformCount; ++i)
+    gp_object_unref((gp_object*)cloud->mUniforms[i]);
+  if(cloud->mShader)
+    gp_object_unref((gp_object*)cloud->mShader);
+  gp_object_unref((gp_object*)cloud->mOperation);
+  
+  fclose(cloud->mFile);
+  free(cloud->mNodes);
+  free(cloud);
+}
+
+gp_point_cloud* gp_point_cloud_new(gp_context* context, const char* path)
+{
+  FILE* file = fopen(path, "rb");
+  if(file == NULL)
+  {
+    gp_log_error("Failed to open point cloud file %s", path);
+    return NULL;
+  }
+  
+  _gp_point_cloud_header header;
+  if(fread(&header, sizeof(header), 1, file) != 1 ||
+     header.mMagic != GP_POINT_CLOUD_MAGIC ||
+     header.mVersion != GP_POINT_CLOUD_VERSION ||
+     header.mNodeCount == 0)
+  {
+    gp_log_error("Invalid point cloud file %s", path);
+    fclose(file);
+    return NULL;
+  }
+  
+  _gp_point_cloud_file_node* nodes = malloc(sizeof(_gp_point_cloud_file_node)*header.mNodeCount);
+  if(_gp_fseek(file, (long long)header.mTable, SEEK_SET) != 0 ||
+     fread(nodes, sizeof(_gp_point_cloud_file_node), header.mNodeCount, file) != header.mNodeCount)
+  {
+    gp_log_error("Invalid point cloud file %s", path);
+    free(nodes);
+    fclose(file);
+    return NULL;
+  }
+  
+  gp_point_cloud* cloud = calloc(1, sizeof(gp_point_cloud));
+  _gp_object_init(&cloud->mObject, _gp_point_cloud_free);
+  cloud->mContext = context;
+  cloud->mFile = file;
+  cloud->mHeader = header;
+  cloud->mNodes = calloc(header.mNodeCount, sizeof(_gp_point_cloud_node));
+  cloud->mOperation = gp_operation_group_new();
+  cloud->mRequest = _gp_point_cloud_request;
+  gp_list_init(&cloud->mResident);
+  cloud->mBudget = 5000000;
+  cloud->mCacheSize = 10000000;
+  cloud->mError = 2.0f;
+  
+  for(unsigned int i=0; i<header.mNodeCount; ++i)
+  {
+    cloud->mNodes[i].mFile = nodes[i];
+    cloud->mNodes[i].mCloud = cloud;
+    cloud->mNodes[i].mFrame = 0;
+    cloud->mNodes[i].mState = GP_POINT_CLOUD_UNLOADED;
+  }
+  free(nodes);
+  
+  return cloud;
+}
+
+unsigned int gp_point_cloud_get_count(gp_point_cloud* cloud)
+{
+  return (unsigned int)cloud->mHeader.mCount;
+}
+
+unsigned int gp_point_cloud_get_node_count(gp_point_cloud* cloud)
+{
+  return cloud->mHeader.mNodeCount;
+}
+
+void gp_point_cloud_get_bounds(gp_point_cloud* cloud, float* bounds)
+{
+  memcpy(bounds, cloud->mNodes[0].mFile.mBounds, sizeof(float)*6);
+}
+
+void gp_point_cloud_set_shader(gp_point_cloud* cloud, gp_shader* shader)
+{
+  gp_object_ref((gp_object*)shader);
+  if(cloud->mShader)
+    gp_object_unref((gp_object*)cloud->mShader);
+  cloud->mShader = shader;
+  
+  for(unsigned int i=0; i<cloud->mHeader.mNodeCount; ++i)
+  {
+    if(cloud->mNodes[i].mOperation)
+      gp_operation_draw_set_shader(cloud->mNodes[i].mOperation, shader);
+  }
+}
+
+void gp_point_cloud_add_uniform(gp_point_cloud* cloud, gp_uniform* uniform)
+{
+  if(cloud->mUniformCount == GP_POINT_CLOUD_MAX_UNIFORMS)
+  {
+    gp_log_error("Point clouds support at most %d uniforms", GP_POINT_CLOUD_MAX_UNIFORMS);
+    return;
+  }
+  
+  gp_object_ref((gp_object*)uniform);
+  cloud->mUniforms[cloud->mUniformCount++] = uniform;
+  
+  for(unsigned int i=0; i<cloud->mHeader.mNodeCount; ++i)
+  {
+    if(cloud->mNodes[i].mOperation)
+      gp_operation_draw_set_uniform(cloud->mNodes[i].mOperation, uniform);
+  }
+}
+
+void gp_point_cloud_set_point_budget(gp_point_cloud* cloud, unsigned int points)
+{
+  cloud->mBudget = points;
+}
+
+void gp_point_cloud_set_cache_size(gp_point_cloud* cloud, unsigned int points)
+{
+  cloud->mCacheSize = points;
+}
+
+void gp_point_cloud_set_error(gp_point_cloud* cloud, float pixels)
+{
+  cloud->mError = pixels;
+}
+
+gp_operation* gp_point_cloud_get_operation(gp_point_cloud* cloud)
+{
+  return cloud->mOperation;
+}
+
+//
+// Node selection
+//
+
+typedef struct
+{
+  float                     mPriority;
+  unsigned int              mIndex;
+} _gp_point_cloud_candidate;
+
+static void _gp_point_cloud_push(_gp_point_cloud_candidate* heap, unsigned int* size, float priority, unsigned int index)
+{
+  unsigned int i = (*size)++;
+  while(i > 0 && heap[(i-1)/2].mPriority < priority)
+  {
+    heap[i] = heap[(i-1)/2];
+    i = (i-1)/2;
+  }
+  heap[i].mPriority = priority;
+  heap[i].mIndex = index;
+}
+
+static _gp_point_cloud_candidate _gp_point_cloud_pop(_gp_point_cloud_candidate* heap, unsigned int* size)
+{
+  _gp_point_cloud_candidate top = heap[0];
+  _gp_point_cloud_candidate last = heap[--(*size)];
+  
+  unsigned int i = 0;
+  for(;;)
+  {
+    unsigned int child = i*2+1;
+    if(child >= *size) break;
+    if(child+1 < *size && heap[child+1].mPriority > heap[child].mPriority) ++child;
+    if(heap[child].mPriority <= last.mPriority) break;
+    heap[i] = heap[child];
+    i = child;
+  }
+  heap[i] = last;
+  
+  return top;
+}
+
+static int _gp_point_cloud_visible(const float* planes, const float* bounds)
+{
+  for(int p=0; p<6; ++p)
+  {
+    const float* plane = planes + p*4;
+    float d = plane[3];
+    for(int a=0; a<3; ++a)
+      d += plane[a]*(plane[a] >= 0.0f ? bounds[a+3] : bounds[a]);
+    if(d < 0.0f) return 0;
+  }
+  
+  return 1;
+}
+
+/*
+ * Projected size of a node in pixels, which is also its priority.  Nodes
+ * around the eye get the largest priority.
+ */
+static float _gp_point_cloud_priority(const float* bounds, const float* eye, float scale)
+{
+  const float size = bounds[3] - bounds[0];
+  float distance = 0.0f;
+  for(int a=0; a<3; ++a)
+  {
+    float d = (bounds[a] + bounds[a+3])*0.5f - eye[a];
+    distance += d*d;
+  }
+  distance = sqrtf(distance) - size*0.8660254f;
+  
+  return distance > 0.0f ? size*scale/distance : INFINITY;
+}
+
+unsigned int gp_point_cloud_update(gp_point_cloud* cloud,
+                                   const float* view_projection,
+                                   const float* eye,
+                                   float scale)
+{
+  const float* m = view_projection;
+  float planes[24];
+  for(int p=0; p<6; ++p)
+  {
+    // Planes are the last row of the matrix plus or minus another row.
+    const int row = p/2;
+    const float sign = (p & 1) ? -1.0f : 1.0f;
+    for(int c=0; c<4; ++c)
+      planes[p*4+c] = m[c*4+3] + sign*m[c*4+row];
+  }
+  
+  cloud->mFrame++;
+  
+  _gp_point_cloud_candidate* heap = malloc(sizeof(_gp_point_cloud_candidate)*cloud->mHeader.mNodeCount);
+  unsigned int size = 0;
+  unsigned int points = 0;
+  
+  if(_gp_point_cloud_visible(planes, cloud->mNodes[0].mFile.mBounds))
+    _gp_point_cloud_push(heap, &size, _gp_point_cloud_priority(cloud->mNodes[0].mFile.mBounds, eye, scale), 0);
+  
+  while(size > 0)
+  {
+    _gp_point_cloud_candidate candidate = _gp_point_cloud_pop(heap, &size);
+    _gp_point_cloud_node* node = cloud->mNodes + candidate.mIndex;
+    
+    // Failed nodes and their children are left out, instead of reading
+    // them again every frame.
+    if(node->mState == GP_POINT_CLOUD_FAILED) continue;
+    if(points + node->mFile.mCount > cloud->mBudget) break;
+    
+    node->mFrame = cloud->mFrame;
+    if(node->mState == GP_POINT_CLOUD_UNLOADED && cloud->mLoads < GP_POINT_CLOUD_MAX_LOADS)
+      _gp_point_cloud_load(cloud, node);
+    
+    // Children are refined once their parent is drawn so coarse nodes
+    // stream in first.
+    if(node->mState != GP_POINT_CLOUD_RESIDENT) continue;
+    
+    points += node->mFile.mCount;
+    
+    // Refine while the gap between points of the node is too wide.
+    if(candidate.mPriority/cloud->mHeader.mGrid <= cloud->mError) continue;
+    
+    for(int c=0; c<8; ++c)
+    {
+      int child = node->mFile.mChildren[c];
+      if(child < 0) continue;
+      
+      const float* bounds = cloud->mNodes[child].mFile.mBounds;
+      if(_gp_point_cloud_visible(planes, bounds))
+        _gp_point_cloud_push(heap, &size, _gp_point_cloud_priority(bounds, eye, scale), child);
+    }
+  }
+  free(heap);
+  
+  // Draw selected nodes and move them to the back of the LRU list.
+  gp_list_node* it = gp_list_front(&cloud->mResident);
+  gp_list_node* last = gp_list_back(&cloud->mResident);
+  while(it != gp_list_end(&cloud->mResident))
+  {
+    _gp_point_cloud_node* node = (_gp_point_cloud_node*)it;
+    gp_list_node* next = gp_list_node_next(it);
+    
+    int drawn = node->mFrame == cloud->mFrame;
+    gp_operation_draw_set_verticies(node->mOperation, drawn ? node->mFile.mCount : 0);
+    if(drawn && it != last)
+    {
+      gp_list_remove(&cloud->mResident, it);
+      gp_list_push_back(&cloud->mResident, it);
+    }
+    
+    if(it == last) break;
+    it = next;
+  }
+  
+  // Evict the least recently used nodes past the cache size.
+  while(cloud->mResidentPoints > cloud->mCacheSize && gp_list_front(&cloud->mResident) != gp_list_end(&cloud->mResident))
+  {
+    _gp_point_cloud_node* node = (_gp_point_cloud_node*)gp_list_front(&cloud->mResident);
+    if(node->mFrame == cloud->mFrame) break;
+    _gp_point_cloud_evict(cloud, node);
+  }
+  
+  return points;
+}
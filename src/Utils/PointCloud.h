@@ -0,0 +1,117 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_POINT_CLOUD_H__
+#define __GP_UTILS_POINT_CLOUD_H__
+
+#include <GraphicsPipeline/PointCloud.h>
+#include "List.h"
+#include "Object.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define GP_POINT_CLOUD_MAGIC      0x43505047  // "GPPC"
+#define GP_POINT_CLOUD_VERSION    1
+#define GP_POINT_CLOUD_MAX_DEPTH  24          // Stops splitting duplicate points.
+#define GP_POINT_CLOUD_MAX_LOADS  4           // Node loads in flight at once.
+#define GP_POINT_CLOUD_MAX_UNIFORMS 16
+
+#define GP_POINT_CLOUD_UNLOADED   0
+#define GP_POINT_CLOUD_LOADING    1
+#define GP_POINT_CLOUD_RESIDENT   2
+#define GP_POINT_CLOUD_FAILED     3
+
+/*
+ * Start of an octree file.  Points of every node follow the header as
+ * x, y, z floats and the node table comes last.
+ */
+typedef struct
+{
+  uint32_t                  mMagic;
+  uint32_t                  mVersion;
+  uint32_t                  mNodeCount;
+  uint32_t                  mGrid;        // Sampling cells along each axis of a node.
+  uint64_t                  mTable;       // Offset of the node table.
+  uint64_t                  mCount;       // Number of points.
+} _gp_point_cloud_header;
+
+typedef struct
+{
+  float                     mBounds[6];   // Cube holding the node.
+  uint64_t                  mOffset;      // Offset of the node points.
+  uint32_t                  mCount;
+  uint32_t                  mReserved;
+  int32_t                   mChildren[8]; // -1 for missing children.
+} _gp_point_cloud_file_node;
+
+typedef struct _gp_point_cloud_node _gp_point_cloud_node;
+
+struct _gp_point_cloud_node
+{
+  gp_list_node              mNode;        // Position in the LRU list while resident.
+  _gp_point_cloud_file_node mFile;
+  gp_point_cloud*           mCloud;
+  gp_array*                 mArray;
+  gp_operation*             mOperation;
+  unsigned int              mFrame;       // Last frame the node was selected.
+  int                       mState;
+};
+
+struct _gp_point_cloud
+{
+  gp_object                 mObject;
+  gp_context*               mContext;
+  FILE*                     mFile;
+  _gp_point_cloud_header    mHeader;
+  _gp_point_cloud_node*     mNodes;
+  gp_operation*             mOperation;
+  gp_shader*                mShader;
+  gp_uniform*               mUniforms[GP_POINT_CLOUD_MAX_UNIFORMS];
+  unsigned int              mUniformCount;
+  void(*mRequest)(_gp_point_cloud_node* node); // Starts reading a node.
+  gp_list                   mResident;    // Least recently used first.
+  unsigned int              mResidentPoints;
+  unsigned int              mLoads;
+  unsigned int              mBudget;
+  unsigned int              mCacheSize;
+  float                     mError;
+  unsigned int              mFrame;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Make a node resident once its array has been uploaded.  Balances the
+ * reference taken on the cloud when the node was requested.
+ */
+void _gp_point_cloud_loaded(void* userdata);
+
+/*
+ * Give up on a node whose points could not be read, so it is never
+ * requested again.  Balances the reference taken on the cloud.
+ */
+void _gp_point_cloud_failed(_gp_point_cloud_node* node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_POINT_CLOUD_H__
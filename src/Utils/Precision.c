@@ -0,0 +1,111 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#include <GraphicsPipeline/Precision.h>
+#include <GraphicsPipeline/Logging.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GP_PRECISION_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GP_PRECISION_NEON
+#include <arm_neon.h>
+#endif
+
+void gp_double_split(const double* data, float* high, float* low, unsigned int count)
+{
+  unsigned int i = 0;
+
+#if defined(GP_PRECISION_SSE2)
+  for(; i+4<=count; i+=4)
+  {
+    __m128d d0 = _mm_loadu_pd(data+i);
+    __m128d d1 = _mm_loadu_pd(data+i+2);
+    __m128 h0 = _mm_cvtpd_ps(d0);
+    __m128 h1 = _mm_cvtpd_ps(d1);
+    __m128 l0 = _mm_cvtpd_ps(_mm_sub_pd(d0, _mm_cvtps_pd(h0)));
+    __m128 l1 = _mm_cvtpd_ps(_mm_sub_pd(d1, _mm_cvtps_pd(h1)));
+    _mm_storeu_ps(high+i, _mm_movelh_ps(h0, h1));
+    _mm_storeu_ps(low+i, _mm_movelh_ps(l0, l1));
+  }
+#elif defined(GP_PRECISION_NEON)
+  for(; i+4<=count; i+=4)
+  {
+    float64x2_t d0 = vld1q_f64(data+i);
+    float64x2_t d1 = vld1q_f64(data+i+2);
+    float32x2_t h0 = vcvt_f32_f64(d0);
+    float32x2_t h1 = vcvt_f32_f64(d1);
+    float32x2_t l0 = vcvt_f32_f64(vsubq_f64(d0, vcvt_f64_f32(h0)));
+    float32x2_t l1 = vcvt_f32_f64(vsubq_f64(d1, vcvt_f64_f32(h1)));
+    vst1q_f32(high+i, vcombine_f32(h0, h1));
+    vst1q_f32(low+i, vcombine_f32(l0, l1));
+  }
+#endif
+
+  for(; i<count; ++i)
+  {
+    float h = (float)data[i];
+    high[i] = h;
+    low[i] = (float)(data[i] - (double)h);
+  }
+}
+
+void gp_double_rebase(const double* data,
+                      float* result,
+                      unsigned int components,
+                      unsigned int count,
+                      const double* origin)
+{
+  if(components < 1 || components > 4)
+  {
+    gp_log_error("Elements must have 1 to 4 components");
+    return;
+  }
+  
+  // Repeat the origin so any two consecutive components can be loaded
+  // starting from the component of the current value.
+  double pattern[6];
+  unsigned int i;
+  for(i=0; i<components+2; ++i)
+    pattern[i] = origin[i%components];
+  
+  const unsigned int size = components*count;
+  unsigned int c = 0;
+  i = 0;
+
+#if defined(GP_PRECISION_SSE2)
+  for(; i+2<=size; i+=2)
+  {
+    __m128d d = _mm_sub_pd(_mm_loadu_pd(data+i), _mm_loadu_pd(pattern+c));
+    _mm_storel_pi((__m64*)(result+i), _mm_cvtpd_ps(d));
+    c = (c+2)%components;
+  }
+#elif defined(GP_PRECISION_NEON)
+  for(; i+2<=size; i+=2)
+  {
+    float64x2_t d = vsubq_f64(vld1q_f64(data+i), vld1q_f64(pattern+c));
+    vst1_f32(result+i, vcvt_f32_f64(d));
+    c = (c+2)%components;
+  }
+#endif
+
+  for(; i<size; ++i)
+  {
+    result[i] = (float)(data[i] - pattern[c]);
+    c = (c+1)%components;
+  }
+}
@@ -0,0 +1,146 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include "ScrollTexture.h"
+#include <GraphicsPipeline/Logging.h>
+
+#include <stdlib.h>
+
+void _gp_scroll_texture_free(gp_object* object)
+{
+  gp_scroll_texture* st = (gp_scroll_texture*)object;
+  
+  gp_object_unref((gp_object*)st->mTexture);
+  gp_object_unref((gp_object*)st->mData);
+  free(st);
+}
+
+gp_scroll_texture* gp_scroll_texture_new(gp_context* context,
+                                         unsigned int width,
+                                         unsigned int height,
+                                         GP_FORMAT format,
+                                         GP_DATA_TYPE type,
+                                         GP_SCROLL scroll)
+{
+  if(width == 0 || height == 0)
+  {
+    gp_log_error("Scroll textures must have a size");
+    return NULL;
+  }
+  
+  gp_scroll_texture* st = malloc(sizeof(gp_scroll_texture));
+  _gp_object_init(&st->mObject, _gp_scroll_texture_free);
+  st->mTexture = gp_texture_new(context);
+  st->mData = gp_texture_data_new();
+  st->mFormat = format;
+  st->mType = type;
+  st->mScroll = scroll;
+  st->mWidth = width;
+  st->mHeight = height;
+  st->mHead = 0;
+  st->mAllocated = 0;
+  
+  return st;
+}
+
+unsigned int _gp_scroll_texture_split(unsigned int size,
+                                      unsigned int* head,
+                                      unsigned int count,
+                                      unsigned int* spans)
+{
+  // Lines older than a whole texture would be overwritten right away.
+  unsigned int first = 0;
+  if(count > size)
+  {
+    first = count - size;
+    *head = (*head + first)%size;
+    count = size;
+  }
+  
+  // Lines reaching past the end of the texture wrap around to line 0.
+  const unsigned int tail = size - *head;
+  spans[0] = first;
+  spans[1] = count <= tail ? count : tail;
+  spans[2] = *head;
+  if(count > tail)
+  {
+    spans[3] = first + tail;
+    spans[4] = count - tail;
+    spans[5] = 0;
+  }
+  
+  *head = (*head + count)%size;
+  return count > tail ? 2 : 1;
+}
+
+/*
+ * Upload lines first to first + count of the data, which all fit before
+ * the end of the texture, starting at line head.
+ */
+static void _gp_scroll_texture_upload(gp_scroll_texture* st,
+                                      const void* data,
+                                      unsigned int lines,
+                                      unsigned int first,
+                                      unsigned int count,
+                                      unsigned int head)
+{
+  if(st->mScroll == GP_SCROLL_ROWS)
+    gp_texture_data_set_2d_region(st->mData, data, st->mFormat, st->mType, st->mWidth, count, 0, head, st->mWidth, 0, first);
+  else
+    gp_texture_data_set_2d_region(st->mData, data, st->mFormat, st->mType, count, st->mHeight, head, 0, lines, first, 0);
+  
+  gp_texture_set_data(st->mTexture, st->mData);
+}
+
+void gp_scroll_texture_push(gp_scroll_texture* st, const void* data, unsigned int count)
+{
+  const unsigned int size = st->mScroll == GP_SCROLL_ROWS ? st->mHeight : st->mWidth;
+  
+  if(!st->mAllocated)
+  {
+    void* zero = calloc((size_t)st->mWidth*st->mHeight, st->mFormat*gp_data_type_get_size(st->mType));
+    gp_texture_data_set_2d(st->mData, zero, st->mFormat, st->mType, st->mWidth, st->mHeight);
+    gp_texture_set_data(st->mTexture, st->mData);
+    free(zero);
+    st->mAllocated = 1;
+  }
+  
+  unsigned int spans[6];
+  const unsigned int n = _gp_scroll_texture_split(size, &st->mHead, count, spans);
+  
+  unsigned int i;
+  for(i=0; i<n; ++i)
+    _gp_scroll_texture_upload(st, data, count, spans[i*3], spans[i*3 + 1], spans[i*3 + 2]);
+}
+
+unsigned int gp_scroll_texture_get_head(gp_scroll_texture* st)
+{
+  return st->mHead;
+}
+
+void gp_scroll_texture_get_info(gp_scroll_texture* st, float* info)
+{
+  const unsigned int size = st->mScroll == GP_SCROLL_ROWS ? st->mHeight : st->mWidth;
+  info[0] = (float)st->mHead/(float)size;
+  info[1] = st->mScroll == GP_SCROLL_ROWS ? 0.0f : 1.0f;
+}
+
+gp_texture* gp_scroll_texture_get_texture(gp_scroll_texture* st)
+{
+  return st->mTexture;
+}
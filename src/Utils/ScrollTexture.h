@@ -0,0 +1,59 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_SCROLL_TEXTURE_H__
+#define __GP_UTILS_SCROLL_TEXTURE_H__
+
+#include <GraphicsPipeline/ScrollTexture.h>
+#include "Object.h"
+
+struct _gp_scroll_texture
+{
+  gp_object                 mObject;
+  gp_texture*               mTexture;
+  gp_texture_data*          mData;        // Reused for every upload.
+  GP_FORMAT                 mFormat;
+  GP_DATA_TYPE              mType;
+  GP_SCROLL                 mScroll;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  unsigned int              mHead;        // Next line to be written.
+  int                       mAllocated;   // Storage is allocated by the first push.
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Split pushing count lines into a ring of size lines at *head into at most
+ * two uploads of spans, each the first line of the data, the number of
+ * lines and the line of the ring they are written to.  Lines older than a
+ * whole ring are skipped.  Returns the number of spans and moves *head past
+ * the pushed lines.
+ */
+unsigned int _gp_scroll_texture_split(unsigned int size,
+                                      unsigned int* head,
+                                      unsigned int count,
+                                      unsigned int* spans);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_SCROLL_TEXTURE_H__
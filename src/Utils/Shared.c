@@ -0,0 +1,222 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+// NOTE: This file is also built into the GP_Shared producer library, so it
+// must not depend on anything beyond the object and reference counter code.
+
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "Shared.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC               0x0001U
+#define MFD_ALLOW_SEALING         0x0002U
+#endif
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS               1033
+#define F_SEAL_SEAL               0x0001
+#define F_SEAL_SHRINK             0x0002
+#define F_SEAL_GROW               0x0004
+#endif
+#endif // __linux__
+
+//
+// Sequence helpers.  Writers make the sequence odd, write the frame and
+// make it even again.  Readers retry if the sequence moved while reading.
+//
+#ifdef GP_ATOMICS
+#define _gp_sequence_load(s, order)     atomic_load_explicit(s, order)
+#define _gp_sequence_store(s, v, order) atomic_store_explicit(s, v, order)
+#define _gp_sequence_fence(order)       atomic_thread_fence(order)
+#else
+#define memory_order_relaxed            0
+#define memory_order_acquire            0
+#define memory_order_release            0
+#define _gp_sequence_load(s, order)     (*(s))
+#define _gp_sequence_store(s, v, order) (*(s) = (v))
+#define _gp_sequence_fence(order)       __sync_synchronize()
+#endif
+
+void _gp_shared_free(gp_object* object)
+{
+  gp_shared* shared = (gp_shared*)object;
+
+#ifdef __linux__
+  munmap(shared->mHeader, GP_SHARED_HEADER_SIZE + shared->mSize);
+  close(shared->mFD);
+#endif
+  free(shared);
+}
+
+#ifdef __linux__
+static gp_shared* _gp_shared_map(int fd, unsigned int size)
+{
+  void* map = mmap(NULL, GP_SHARED_HEADER_SIZE + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(map == MAP_FAILED) return NULL;
+  
+  gp_shared* shared = malloc(sizeof(gp_shared));
+  _gp_object_init(&shared->mObject, _gp_shared_free);
+  shared->mFD = fd;
+  shared->mHeader = (_gp_shared_header*)map;
+  shared->mData = (char*)map + GP_SHARED_HEADER_SIZE;
+  shared->mSize = size;
+  
+  return shared;
+}
+#endif
+
+gp_shared* gp_shared_new(unsigned int size)
+{
+#ifdef __linux__
+  // NOTE: Called through syscall() as older C libraries lack memfd_create.
+  int fd = syscall(SYS_memfd_create, "gp_shared", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if(fd < 0) return NULL;
+  
+  if(ftruncate(fd, GP_SHARED_HEADER_SIZE + size) != 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  
+  // Consumers map the full size, so the memory must never shrink under them.
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+  
+  gp_shared* shared = _gp_shared_map(fd, size);
+  if(shared == NULL)
+  {
+    close(fd);
+    return NULL;
+  }
+  
+  shared->mHeader->mMagic = GP_SHARED_MAGIC;
+  shared->mHeader->mSize = size;
+  _gp_sequence_store(&shared->mHeader->mSequence, 0, memory_order_release);
+  
+  return shared;
+#else
+  return NULL;
+#endif
+}
+
+gp_shared* gp_shared_new_from_fd(int fd)
+{
+#ifdef __linux__
+  struct stat st;
+  if(fstat(fd, &st) != 0 || st.st_size < GP_SHARED_HEADER_SIZE) return NULL;
+  
+  _gp_shared_header header;
+  if(pread(fd, &header, sizeof(uint32_t)*2, 0) != sizeof(uint32_t)*2) return NULL;
+  if(header.mMagic != GP_SHARED_MAGIC) return NULL;
+  if(st.st_size < GP_SHARED_HEADER_SIZE + (off_t)header.mSize) return NULL;
+  
+  int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if(dup_fd < 0) return NULL;
+  
+  gp_shared* shared = _gp_shared_map(dup_fd, header.mSize);
+  if(shared == NULL) close(dup_fd);
+  
+  return shared;
+#else
+  return NULL;
+#endif
+}
+
+int gp_shared_get_fd(gp_shared* shared)
+{
+  return shared->mFD;
+}
+
+unsigned int gp_shared_get_size(gp_shared* shared)
+{
+  return shared->mSize;
+}
+
+void* gp_shared_get_data(gp_shared* shared)
+{
+  return shared->mData;
+}
+
+void* gp_shared_begin_write(gp_shared* shared)
+{
+  _gp_shared_sequence_type* sequence = &shared->mHeader->mSequence;
+  
+  uint32_t s = _gp_sequence_load(sequence, memory_order_relaxed);
+  _gp_sequence_store(sequence, s + 1, memory_order_relaxed);
+  _gp_sequence_fence(memory_order_release);
+  
+  return shared->mData;
+}
+
+void gp_shared_end_write(gp_shared* shared)
+{
+  _gp_shared_sequence_type* sequence = &shared->mHeader->mSequence;
+  
+  uint32_t s = _gp_sequence_load(sequence, memory_order_relaxed);
+  _gp_sequence_store(sequence, s + 1, memory_order_release);
+}
+
+unsigned int gp_shared_get_sequence(gp_shared* shared)
+{
+  return _gp_sequence_load(&shared->mHeader->mSequence, memory_order_acquire);
+}
+
+unsigned int gp_shared_read_begin(gp_shared* shared)
+{
+  return _gp_sequence_load(&shared->mHeader->mSequence, memory_order_acquire);
+}
+
+int gp_shared_read_end(gp_shared* shared, unsigned int sequence)
+{
+  _gp_sequence_fence(memory_order_acquire);
+  
+  // An odd sequence means a frame was being written when reading started.
+  if(sequence & 1) return 0;
+  
+  return _gp_sequence_load(&shared->mHeader->mSequence, memory_order_relaxed) == sequence;
+}
+
+int _gp_shared_read(gp_shared* shared, void* dst, size_t size, int tries, unsigned int* sequence)
+{
+  int i;
+  for(i=0; i<tries; ++i)
+  {
+    unsigned int s = gp_shared_read_begin(shared);
+    if(s & 1) continue;
+    
+    memcpy(dst, shared->mData, size);
+    if(gp_shared_read_end(shared, s))
+    {
+      *sequence = s;
+      return 1;
+    }
+  }
+  
+  return 0;
+}
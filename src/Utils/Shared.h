@@ -0,0 +1,69 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+#ifndef __GP_UTILS_SHARED_H__
+#define __GP_UTILS_SHARED_H__
+
+#include <GraphicsPipeline/Shared.h>
+#include "Object.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GP_SHARED_MAGIC           0x48535047  // "GPSH"
+#define GP_SHARED_HEADER_SIZE     64          // Keeps data cache line aligned
+
+#ifndef GP_ATOMICS
+typedef volatile uint32_t _gp_shared_sequence_type;
+#else
+typedef _Atomic(uint32_t) _gp_shared_sequence_type;
+#endif
+
+/*
+ * Lives at the start of the shared mapping and is seen by every process.
+ */
+typedef struct
+{
+  uint32_t                  mMagic;
+  uint32_t                  mSize;
+  _gp_shared_sequence_type  mSequence;
+} _gp_shared_header;
+
+struct _gp_shared
+{
+  gp_object                 mObject;
+  int                       mFD;
+  _gp_shared_header*        mHeader;
+  void*                     mData;
+  unsigned int              mSize;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Copy a consistent frame out of the shared memory.  Returns 1 and the
+ * frame sequence number on success, 0 if every try saw a write.
+ */
+int _gp_shared_read(gp_shared* shared, void* dst, size_t size, int tries, unsigned int* sequence);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_SHARED_H__
@@ -0,0 +1,440 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include "TextureAtlas.h"
+#include <GraphicsPipeline/Logging.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Packing
+//
+
+static int _gp_texture_atlas_intersects(const _gp_texture_atlas_rect* a, const _gp_texture_atlas_rect* b)
+{
+  return a->mX < b->mX + b->mWidth && b->mX < a->mX + a->mWidth &&
+         a->mY < b->mY + b->mHeight && b->mY < a->mY + a->mHeight;
+}
+
+static int _gp_texture_atlas_contains(const _gp_texture_atlas_rect* outer, const _gp_texture_atlas_rect* inner)
+{
+  return inner->mX >= outer->mX && inner->mX + inner->mWidth <= outer->mX + outer->mWidth &&
+         inner->mY >= outer->mY && inner->mY + inner->mHeight <= outer->mY + outer->mHeight;
+}
+
+static void _gp_texture_atlas_push(_gp_texture_atlas_page* page,
+                                   unsigned int x,
+                                   unsigned int y,
+                                   unsigned int width,
+                                   unsigned int height)
+{
+  if(page->mFreeCount == page->mFreeCapacity)
+  {
+    page->mFreeCapacity = page->mFreeCapacity ? page->mFreeCapacity*2 : 16;
+    page->mFree = realloc(page->mFree, sizeof(_gp_texture_atlas_rect)*page->mFreeCapacity);
+  }
+  
+  _gp_texture_atlas_rect* rect = &page->mFree[page->mFreeCount++];
+  rect->mX = x;
+  rect->mY = y;
+  rect->mWidth = width;
+  rect->mHeight = height;
+}
+
+/*
+ * Drop free rectangles lying inside another one, so only maximal
+ * rectangles are left.
+ */
+static void _gp_texture_atlas_prune(_gp_texture_atlas_page* page)
+{
+  unsigned int i = 0;
+  while(i < page->mFreeCount)
+  {
+    unsigned int j;
+    for(j=0; j<page->mFreeCount; ++j)
+    {
+      if(j != i && _gp_texture_atlas_contains(&page->mFree[j], &page->mFree[i]))
+        break;
+    }
+    
+    if(j < page->mFreeCount)
+      page->mFree[i] = page->mFree[--page->mFreeCount];
+    else
+      ++i;
+  }
+}
+
+/*
+ * Replace every free rectangle overlapping a used rectangle with the parts
+ * of it left of, right of, above and below the used rectangle.
+ */
+static void _gp_texture_atlas_split(_gp_texture_atlas_page* page, const _gp_texture_atlas_rect* used)
+{
+  _gp_texture_atlas_rect* rects = page->mFree;
+  const unsigned int count = page->mFreeCount;
+  page->mFree = NULL;
+  page->mFreeCount = 0;
+  page->mFreeCapacity = 0;
+  
+  const unsigned int right = used->mX + used->mWidth;
+  const unsigned int bottom = used->mY + used->mHeight;
+  
+  for(unsigned int i=0; i<count; ++i)
+  {
+    const _gp_texture_atlas_rect* f = &rects[i];
+    if(!_gp_texture_atlas_intersects(f, used))
+    {
+      _gp_texture_atlas_push(page, f->mX, f->mY, f->mWidth, f->mHeight);
+      continue;
+    }
+    
+    if(used->mX > f->mX)
+      _gp_texture_atlas_push(page, f->mX, f->mY, used->mX - f->mX, f->mHeight);
+    if(right < f->mX + f->mWidth)
+      _gp_texture_atlas_push(page, right, f->mY, f->mX + f->mWidth - right, f->mHeight);
+    if(used->mY > f->mY)
+      _gp_texture_atlas_push(page, f->mX, f->mY, f->mWidth, used->mY - f->mY);
+    if(bottom < f->mY + f->mHeight)
+      _gp_texture_atlas_push(page, f->mX, bottom, f->mWidth, f->mY + f->mHeight - bottom);
+  }
+  
+  free(rects);
+  _gp_texture_atlas_prune(page);
+}
+
+/*
+ * Join free rectangles sharing a whole edge, to undo some of the
+ * fragmentation left by removed images.
+ */
+static void _gp_texture_atlas_merge(_gp_texture_atlas_page* page)
+{
+  int merged = 1;
+  while(merged)
+  {
+    merged = 0;
+    for(unsigned int i=0; i<page->mFreeCount && !merged; ++i)
+    {
+      for(unsigned int j=i+1; j<page->mFreeCount; ++j)
+      {
+        _gp_texture_atlas_rect* a = &page->mFree[i];
+        const _gp_texture_atlas_rect* b = &page->mFree[j];
+        
+        if(a->mX == b->mX && a->mWidth == b->mWidth &&
+           (a->mY + a->mHeight == b->mY || b->mY + b->mHeight == a->mY))
+        {
+          if(b->mY < a->mY) a->mY = b->mY;
+          a->mHeight += b->mHeight;
+        }
+        else if(a->mY == b->mY && a->mHeight == b->mHeight &&
+                (a->mX + a->mWidth == b->mX || b->mX + b->mWidth == a->mX))
+        {
+          if(b->mX < a->mX) a->mX = b->mX;
+          a->mWidth += b->mWidth;
+        }
+        else
+        {
+          continue;
+        }
+        
+        page->mFree[j] = page->mFree[--page->mFreeCount];
+        merged = 1;
+        break;
+      }
+    }
+  }
+}
+
+void _gp_texture_atlas_page_reset(_gp_texture_atlas_page* page)
+{
+  page->mFreeCount = 0;
+  page->mUsed = 0;
+  _gp_texture_atlas_push(page, 0, 0, page->mWidth, page->mHeight);
+}
+
+int _gp_texture_atlas_page_insert(_gp_texture_atlas_page* page,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  _gp_texture_atlas_rect* rect)
+{
+  int best = -1;
+  unsigned int bestShort = (unsigned int)-1;
+  unsigned int bestLong = (unsigned int)-1;
+  
+  for(unsigned int i=0; i<page->mFreeCount; ++i)
+  {
+    const _gp_texture_atlas_rect* f = &page->mFree[i];
+    if(f->mWidth < width || f->mHeight < height) continue;
+    
+    const unsigned int dx = f->mWidth - width;
+    const unsigned int dy = f->mHeight - height;
+    const unsigned int shortSide = dx < dy ? dx : dy;
+    const unsigned int longSide = dx < dy ? dy : dx;
+    if(shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+    {
+      best = i;
+      bestShort = shortSide;
+      bestLong = longSide;
+    }
+  }
+  
+  if(best < 0) return 0;
+  
+  rect->mX = page->mFree[best].mX;
+  rect->mY = page->mFree[best].mY;
+  rect->mWidth = width;
+  rect->mHeight = height;
+  
+  _gp_texture_atlas_split(page, rect);
+  page->mUsed++;
+  return 1;
+}
+
+void _gp_texture_atlas_page_remove(_gp_texture_atlas_page* page, const _gp_texture_atlas_rect* rect)
+{
+  // An empty page starts over without any fragmentation.
+  if(--page->mUsed == 0)
+  {
+    _gp_texture_atlas_page_reset(page);
+    return;
+  }
+  
+  _gp_texture_atlas_push(page, rect->mX, rect->mY, rect->mWidth, rect->mHeight);
+  _gp_texture_atlas_merge(page);
+  _gp_texture_atlas_prune(page);
+}
+
+//
+// Atlas
+//
+
+static void _gp_texture_atlas_add_page(gp_texture_atlas* atlas)
+{
+  atlas->mPages = realloc(atlas->mPages, sizeof(_gp_texture_atlas_page)*(atlas->mPageCount + 1));
+  
+  _gp_texture_atlas_page* page = &atlas->mPages[atlas->mPageCount++];
+  page->mFree = NULL;
+  page->mFreeCapacity = 0;
+  page->mWidth = atlas->mWidth;
+  page->mHeight = atlas->mHeight;
+  _gp_texture_atlas_page_reset(page);
+  
+  // Mipmaps would blend neighbouring images, so pages have none.
+  page->mTexture = gp_texture_new(atlas->mContext);
+  gp_texture_set_filter(page->mTexture, GP_FILTER_LINEAR, GP_FILTER_LINEAR, GP_FILTER_NEAREST);
+  gp_texture_allocate(page->mTexture, atlas->mFormat, atlas->mType, atlas->mWidth, atlas->mHeight, 1);
+}
+
+/*
+ * Upload an image surrounded by copies of its edge pixels into a rectangle
+ * of a page.
+ */
+static void _gp_texture_atlas_upload(gp_texture_atlas* atlas,
+                                     _gp_texture_atlas_page* page,
+                                     const _gp_texture_atlas_rect* rect,
+                                     const void* data,
+                                     unsigned int width,
+                                     unsigned int height)
+{
+  const size_t pixel = atlas->mFormat*gp_data_type_get_size(atlas->mType);
+  const size_t size = (size_t)rect->mWidth*rect->mHeight*pixel;
+  if(size > atlas->mScratchSize)
+  {
+    atlas->mScratch = realloc(atlas->mScratch, size);
+    atlas->mScratchSize = size;
+  }
+  
+  for(unsigned int j=0; j<rect->mHeight; ++j)
+  {
+    int y = (int)j - GP_TEXTURE_ATLAS_PADDING;
+    y = y < 0 ? 0 : (y >= (int)height ? (int)height - 1 : y);
+    
+    const char* src = (const char*)data + (size_t)y*width*pixel;
+    char* dst = (char*)atlas->mScratch + (size_t)j*rect->mWidth*pixel;
+    memcpy(dst + GP_TEXTURE_ATLAS_PADDING*pixel, src, width*pixel);
+    for(unsigned int i=0; i<GP_TEXTURE_ATLAS_PADDING; ++i)
+    {
+      memcpy(dst + i*pixel, src, pixel);
+      memcpy(dst + (GP_TEXTURE_ATLAS_PADDING + width + i)*pixel, src + (width - 1)*pixel, pixel);
+    }
+  }
+  
+  gp_texture_data* td = gp_texture_data_new();
+  gp_texture_data_set_2d_chunk(td,
+                               atlas->mScratch,
+                               atlas->mFormat,
+                               atlas->mType,
+                               rect->mWidth,
+                               rect->mHeight,
+                               rect->mX,
+                               rect->mY);
+  gp_texture_set_data(page->mTexture, td);
+  gp_object_unref((gp_object*)td);
+}
+
+void _gp_texture_atlas_free(gp_object* object)
+{
+  gp_texture_atlas* atlas = (gp_texture_atlas*)object;
+  
+  for(unsigned int p=0; p<atlas->mPageCount; ++p)
+  {
+    gp_object_unref((gp_object*)atlas->mPages[p].mTexture);
+    free(atlas->mPages[p].mFree);
+  }
+  
+  free(atlas->mPages);
+  free(atlas->mEntries);
+  free(atlas->mFreeEntries);
+  free(atlas->mScratch);
+  free(atlas);
+}
+
+gp_texture_atlas* gp_texture_atlas_new(gp_context* context,
+                                       unsigned int width,
+                                       unsigned int height,
+                                       GP_FORMAT format,
+                                       GP_DATA_TYPE type,
+                                       unsigned int max_pages)
+{
+  gp_texture_atlas* atlas = malloc(sizeof(gp_texture_atlas));
+  _gp_object_init(&atlas->mObject, _gp_texture_atlas_free);
+  atlas->mContext = context;
+  atlas->mFormat = format;
+  atlas->mType = type;
+  atlas->mWidth = width;
+  atlas->mHeight = height;
+  atlas->mMaxPages = max_pages;
+  atlas->mPages = NULL;
+  atlas->mPageCount = 0;
+  atlas->mEntries = NULL;
+  atlas->mEntryCount = 0;
+  atlas->mEntryCapacity = 0;
+  atlas->mFreeEntries = NULL;
+  atlas->mFreeEntryCount = 0;
+  atlas->mScratch = NULL;
+  atlas->mScratchSize = 0;
+  
+  return atlas;
+}
+
+int gp_texture_atlas_insert(gp_texture_atlas* atlas,
+                            const void* data,
+                            unsigned int width,
+                            unsigned int height,
+                            float* uv)
+{
+  const unsigned int paddedWidth = width + 2*GP_TEXTURE_ATLAS_PADDING;
+  const unsigned int paddedHeight = height + 2*GP_TEXTURE_ATLAS_PADDING;
+  if(width == 0 || height == 0 || paddedWidth > atlas->mWidth || paddedHeight > atlas->mHeight)
+  {
+    gp_log_error("Image of %ux%u does not fit in texture atlas pages of %ux%u", width, height, atlas->mWidth, atlas->mHeight);
+    return -1;
+  }
+  
+  //
+  // Place the image in the first page with room, or a new page
+  //
+  _gp_texture_atlas_rect rect;
+  unsigned int p;
+  for(p=0; p<atlas->mPageCount; ++p)
+  {
+    if(_gp_texture_atlas_page_insert(&atlas->mPages[p], paddedWidth, paddedHeight, &rect))
+      break;
+  }
+  if(p == atlas->mPageCount)
+  {
+    if(atlas->mMaxPages != 0 && atlas->mPageCount == atlas->mMaxPages)
+      return -1;
+    
+    _gp_texture_atlas_add_page(atlas);
+    _gp_texture_atlas_page_insert(&atlas->mPages[p], paddedWidth, paddedHeight, &rect);
+  }
+  
+  //
+  // Reuse removed entries before growing
+  //
+  int entry;
+  if(atlas->mFreeEntryCount)
+  {
+    entry = atlas->mFreeEntries[--atlas->mFreeEntryCount];
+  }
+  else
+  {
+    if(atlas->mEntryCount == atlas->mEntryCapacity)
+    {
+      atlas->mEntryCapacity = atlas->mEntryCapacity ? atlas->mEntryCapacity*2 : 64;
+      atlas->mEntries = realloc(atlas->mEntries, sizeof(_gp_texture_atlas_entry)*atlas->mEntryCapacity);
+      atlas->mFreeEntries = realloc(atlas->mFreeEntries, sizeof(int)*atlas->mEntryCapacity);
+    }
+    entry = atlas->mEntryCount++;
+  }
+  atlas->mEntries[entry].mRect = rect;
+  atlas->mEntries[entry].mPage = p;
+  
+  _gp_texture_atlas_upload(atlas, &atlas->mPages[p], &rect, data, width, height);
+  
+  if(uv) gp_texture_atlas_get_uv(atlas, entry, uv);
+  return entry;
+}
+
+void gp_texture_atlas_remove(gp_texture_atlas* atlas, int entry)
+{
+  if(entry < 0 || (unsigned int)entry >= atlas->mEntryCount || atlas->mEntries[entry].mPage < 0)
+  {
+    gp_log_error("Texture atlas entry %d does not exist", entry);
+    return;
+  }
+  
+  _gp_texture_atlas_entry* e = &atlas->mEntries[entry];
+  _gp_texture_atlas_page_remove(&atlas->mPages[e->mPage], &e->mRect);
+  e->mPage = -1;
+  atlas->mFreeEntries[atlas->mFreeEntryCount++] = entry;
+}
+
+unsigned int gp_texture_atlas_get_uv(gp_texture_atlas* atlas, int entry, float* uv)
+{
+  if(entry < 0 || (unsigned int)entry >= atlas->mEntryCount || atlas->mEntries[entry].mPage < 0)
+  {
+    gp_log_error("Texture atlas entry %d does not exist", entry);
+    return 0;
+  }
+  
+  const _gp_texture_atlas_rect* rect = &atlas->mEntries[entry].mRect;
+  uv[0] = (float)(rect->mX + GP_TEXTURE_ATLAS_PADDING)/atlas->mWidth;
+  uv[1] = (float)(rect->mY + GP_TEXTURE_ATLAS_PADDING)/atlas->mHeight;
+  uv[2] = (float)(rect->mX + rect->mWidth - GP_TEXTURE_ATLAS_PADDING)/atlas->mWidth;
+  uv[3] = (float)(rect->mY + rect->mHeight - GP_TEXTURE_ATLAS_PADDING)/atlas->mHeight;
+  
+  return atlas->mEntries[entry].mPage;
+}
+
+unsigned int gp_texture_atlas_get_page_count(gp_texture_atlas* atlas)
+{
+  return atlas->mPageCount;
+}
+
+gp_texture* gp_texture_atlas_get_texture(gp_texture_atlas* atlas, unsigned int page)
+{
+  if(page >= atlas->mPageCount)
+  {
+    gp_log_error("Texture atlas page %u does not exist", page);
+    return NULL;
+  }
+  
+  return atlas->mPages[page].mTexture;
+}
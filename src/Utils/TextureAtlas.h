@@ -0,0 +1,100 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_TEXTURE_ATLAS_H__
+#define __GP_UTILS_TEXTURE_ATLAS_H__
+
+#include <GraphicsPipeline/TextureAtlas.h>
+#include "Object.h"
+
+#include <stddef.h>
+
+typedef struct
+{
+  unsigned int              mX;
+  unsigned int              mY;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+} _gp_texture_atlas_rect;
+
+typedef struct
+{
+  gp_texture*               mTexture;
+  _gp_texture_atlas_rect*   mFree;        // Maximal free rectangles, which may overlap.
+  unsigned int              mFreeCount;
+  unsigned int              mFreeCapacity;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  unsigned int              mUsed;        // Number of images in the page.
+} _gp_texture_atlas_page;
+
+typedef struct
+{
+  _gp_texture_atlas_rect    mRect;        // Includes the padding.
+  int                       mPage;        // -1 once removed.
+} _gp_texture_atlas_entry;
+
+struct _gp_texture_atlas
+{
+  gp_object                 mObject;
+  gp_context*               mContext;
+  GP_FORMAT                 mFormat;
+  GP_DATA_TYPE              mType;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  unsigned int              mMaxPages;
+  _gp_texture_atlas_page*   mPages;
+  unsigned int              mPageCount;
+  _gp_texture_atlas_entry*  mEntries;
+  unsigned int              mEntryCount;
+  unsigned int              mEntryCapacity;
+  int*                      mFreeEntries; // Removed entries to be reused.
+  unsigned int              mFreeEntryCount;
+  void*                     mScratch;     // Padded copy of the image being inserted.
+  size_t                    mScratchSize;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Empty a page, leaving a single free rectangle covering all of it.
+ */
+void _gp_texture_atlas_page_reset(_gp_texture_atlas_page* page);
+
+/*
+ * Find room for a rectangle with the best short side fit and mark it used.
+ * Returns 1 and sets rect on success, 0 if the page has no room.
+ */
+int _gp_texture_atlas_page_insert(_gp_texture_atlas_page* page,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  _gp_texture_atlas_rect* rect);
+
+/*
+ * Return a rectangle placed by _gp_texture_atlas_page_insert to the free
+ * rectangles of the page.
+ */
+void _gp_texture_atlas_page_remove(_gp_texture_atlas_page* page, const _gp_texture_atlas_rect* rect);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_TEXTURE_ATLAS_H__
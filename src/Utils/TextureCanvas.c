@@ -0,0 +1,212 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include "TextureCanvas.h"
+#include <GraphicsPipeline/Logging.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Dirty rectangles
+//
+
+static void _gp_texture_canvas_union(const unsigned int* a, const unsigned int* b, unsigned int* result)
+{
+  const unsigned int x0 = a[0] < b[0] ? a[0] : b[0];
+  const unsigned int y0 = a[1] < b[1] ? a[1] : b[1];
+  const unsigned int x1 = a[0] + a[2] > b[0] + b[2] ? a[0] + a[2] : b[0] + b[2];
+  const unsigned int y1 = a[1] + a[3] > b[1] + b[3] ? a[1] + a[3] : b[1] + b[3];
+  result[0] = x0;
+  result[1] = y0;
+  result[2] = x1 - x0;
+  result[3] = y1 - y0;
+}
+
+/*
+ * Extra cost of uploading the bounding rectangle of a and b instead of
+ * both separately, in bytes.  Negative when merging is cheaper.
+ */
+static long long _gp_texture_canvas_merge_cost(const unsigned int* a, const unsigned int* b, size_t pixel)
+{
+  unsigned int u[4];
+  _gp_texture_canvas_union(a, b, u);
+  
+  const long long separate = ((long long)a[2]*a[3] + (long long)b[2]*b[3])*pixel + 2*GP_TEXTURE_CANVAS_CALL_COST;
+  const long long merged = (long long)u[2]*u[3]*pixel + GP_TEXTURE_CANVAS_CALL_COST;
+  return merged - separate;
+}
+
+unsigned int _gp_texture_canvas_add_rect(unsigned int* rects,
+                                         unsigned int count,
+                                         const unsigned int* rect,
+                                         size_t pixel)
+{
+  unsigned int r[4] = {rect[0], rect[1], rect[2], rect[3]};
+  
+  // Merging grows the rectangle, which may make more merges pay off.
+  unsigned int i = 0;
+  while(i < count)
+  {
+    if(_gp_texture_canvas_merge_cost(rects + i*4, r, pixel) <= 0)
+    {
+      _gp_texture_canvas_union(rects + i*4, r, r);
+      --count;
+      memcpy(rects + i*4, rects + count*4, sizeof(unsigned int)*4);
+      i = 0;
+    }
+    else
+    {
+      ++i;
+    }
+  }
+  
+  // A full list takes the merge adding the fewest bytes.
+  if(count == GP_TEXTURE_CANVAS_MAX_RECTS)
+  {
+    unsigned int best = 0;
+    long long bestCost = _gp_texture_canvas_merge_cost(rects, r, pixel);
+    for(i=1; i<count; ++i)
+    {
+      const long long cost = _gp_texture_canvas_merge_cost(rects + i*4, r, pixel);
+      if(cost < bestCost)
+      {
+        best = i;
+        bestCost = cost;
+      }
+    }
+    
+    _gp_texture_canvas_union(rects + best*4, r, r);
+    --count;
+    memcpy(rects + best*4, rects + count*4, sizeof(unsigned int)*4);
+    return _gp_texture_canvas_add_rect(rects, count, r, pixel);
+  }
+  
+  memcpy(rects + count*4, r, sizeof(unsigned int)*4);
+  return count + 1;
+}
+
+//
+// Canvas
+//
+
+void _gp_texture_canvas_free(gp_object* object)
+{
+  gp_texture_canvas* canvas = (gp_texture_canvas*)object;
+  
+  gp_object_unref((gp_object*)canvas->mTexture);
+  free(canvas->mData);
+  free(canvas);
+}
+
+gp_texture_canvas* gp_texture_canvas_new(gp_context* context,
+                                         unsigned int width,
+                                         unsigned int height,
+                                         GP_FORMAT format,
+                                         GP_DATA_TYPE type)
+{
+  gp_texture_canvas* canvas = malloc(sizeof(gp_texture_canvas));
+  _gp_object_init(&canvas->mObject, _gp_texture_canvas_free);
+  canvas->mContext = context;
+  canvas->mTexture = gp_texture_new(context);
+  canvas->mAllocated = 0;
+  canvas->mFormat = format;
+  canvas->mType = type;
+  canvas->mWidth = width;
+  canvas->mHeight = height;
+  canvas->mData = calloc((size_t)width*height, format*gp_data_type_get_size(type));
+  canvas->mDirty[0] = 0;
+  canvas->mDirty[1] = 0;
+  canvas->mDirty[2] = width;
+  canvas->mDirty[3] = height;
+  canvas->mDirtyCount = 1;
+  
+  return canvas;
+}
+
+void* gp_texture_canvas_get_data(gp_texture_canvas* canvas)
+{
+  return canvas->mData;
+}
+
+void gp_texture_canvas_mark_dirty(gp_texture_canvas* canvas,
+                                  unsigned int x,
+                                  unsigned int y,
+                                  unsigned int width,
+                                  unsigned int height)
+{
+  if(x >= canvas->mWidth || y >= canvas->mHeight) return;
+  if(width > canvas->mWidth - x) width = canvas->mWidth - x;
+  if(height > canvas->mHeight - y) height = canvas->mHeight - y;
+  if(width == 0 || height == 0) return;
+  
+  const unsigned int rect[4] = {x, y, width, height};
+  canvas->mDirtyCount = _gp_texture_canvas_add_rect(canvas->mDirty,
+                                                    canvas->mDirtyCount,
+                                                    rect,
+                                                    canvas->mFormat*gp_data_type_get_size(canvas->mType));
+}
+
+void gp_texture_canvas_write(gp_texture_canvas* canvas,
+                             const void* data,
+                             unsigned int x,
+                             unsigned int y,
+                             unsigned int width,
+                             unsigned int height)
+{
+  if(x + width > canvas->mWidth || y + height > canvas->mHeight)
+  {
+    gp_log_error("Texture canvas write is not inside the image");
+    return;
+  }
+  
+  const size_t pixel = canvas->mFormat*gp_data_type_get_size(canvas->mType);
+  for(unsigned int j=0; j<height; ++j)
+  {
+    memcpy((char*)canvas->mData + ((size_t)(y + j)*canvas->mWidth + x)*pixel,
+           (const char*)data + (size_t)j*width*pixel,
+           width*pixel);
+  }
+  
+  gp_texture_canvas_mark_dirty(canvas, x, y, width, height);
+}
+
+unsigned int gp_texture_canvas_flush(gp_texture_canvas* canvas)
+{
+  if(!canvas->mAllocated)
+  {
+    canvas->mAllocated = 1;
+    gp_texture_allocate(canvas->mTexture, canvas->mFormat, canvas->mType, canvas->mWidth, canvas->mHeight, 1);
+  }
+  
+  const unsigned int count = canvas->mDirtyCount;
+  gp_texture_set_regions(canvas->mTexture,
+                         canvas->mData,
+                         canvas->mFormat,
+                         canvas->mType,
+                         canvas->mWidth,
+                         canvas->mDirty,
+                         count);
+  canvas->mDirtyCount = 0;
+  return count;
+}
+
+gp_texture* gp_texture_canvas_get_texture(gp_texture_canvas* canvas)
+{
+  return canvas->mTexture;
+}
@@ -0,0 +1,60 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_TEXTURE_CANVAS_H__
+#define __GP_UTILS_TEXTURE_CANVAS_H__
+
+#include <GraphicsPipeline/TextureCanvas.h>
+#include "Object.h"
+
+#include <stddef.h>
+
+struct _gp_texture_canvas
+{
+  gp_object                 mObject;
+  gp_context*               mContext;
+  gp_texture*               mTexture;
+  int                       mAllocated;   // Storage is allocated by the first flush.
+  GP_FORMAT                 mFormat;
+  GP_DATA_TYPE              mType;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  void*                     mData;
+  unsigned int              mDirty[GP_TEXTURE_CANVAS_MAX_RECTS*4]; // x, y, width, height
+  unsigned int              mDirtyCount;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Add a rectangle to a list of at most GP_TEXTURE_CANVAS_MAX_RECTS
+ * rectangles, merging it with rectangles it is cheaper to upload together
+ * with.  Returns the new number of rectangles.
+ */
+unsigned int _gp_texture_canvas_add_rect(unsigned int* rects,
+                                         unsigned int count,
+                                         const unsigned int* rect,
+                                         size_t pixel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_TEXTURE_CANVAS_H__
@@ -0,0 +1,207 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include "VideoTexture.h"
+#include <GraphicsPipeline/Logging.h>
+
+#include <stdlib.h>
+
+typedef struct
+{
+  gp_video_texture*         mTexture;
+  unsigned int              mPending;     // Planes still being uploaded.
+  void                      (*mCallback)(void*);
+  void*                     mUserData;
+} _gp_video_texture_async;
+
+void _gp_video_texture_free(gp_object* object)
+{
+  gp_video_texture* vt = (gp_video_texture*)object;
+  
+  for(unsigned int p=0; p<3; ++p)
+  {
+    if(vt->mPlanes[p]) gp_object_unref((gp_object*)vt->mPlanes[p]);
+  }
+  if(vt->mInfo) gp_object_unref((gp_object*)vt->mInfo);
+  free(vt);
+}
+
+gp_video_texture* gp_video_texture_new(gp_context* context,
+                                       unsigned int width,
+                                       unsigned int height,
+                                       GP_VIDEO_FORMAT format)
+{
+  if(width == 0 || height == 0)
+  {
+    gp_log_error("Video textures must have a size");
+    return NULL;
+  }
+  
+  gp_video_texture* vt = malloc(sizeof(gp_video_texture));
+  _gp_object_init(&vt->mObject, _gp_video_texture_free);
+  vt->mFormat = format;
+  vt->mColor = height > 576 ? GP_VIDEO_COLOR_BT709 : GP_VIDEO_COLOR_BT601;
+  vt->mFullRange = 0;
+  vt->mWidth = width;
+  vt->mHeight = height;
+  vt->mAllocated = 0;
+  vt->mInfo = NULL;
+  
+  const unsigned int planes = format == GP_VIDEO_FORMAT_NV12 ? 2 : 3;
+  for(unsigned int p=0; p<3; ++p)
+  {
+    vt->mPlanes[p] = p < planes ? gp_texture_new(context) : NULL;
+  }
+  
+  return vt;
+}
+
+static void _gp_video_texture_update_info(gp_video_texture* vt)
+{
+  if(vt->mInfo == NULL) return;
+  
+  float info[4];
+  info[0] = vt->mFormat == GP_VIDEO_FORMAT_I420 ? 1.0f : 0.0f;
+  info[1] = vt->mColor == GP_VIDEO_COLOR_BT709 ? 1.0f : 0.0f;
+  info[2] = vt->mFullRange ? 1.0f : 0.0f;
+  info[3] = 0.0f;
+  gp_uniform_vec4_set(vt->mInfo, info);
+}
+
+void gp_video_texture_set_color(gp_video_texture* vt, GP_VIDEO_COLOR color, int full_range)
+{
+  vt->mColor = color;
+  vt->mFullRange = full_range;
+  _gp_video_texture_update_info(vt);
+}
+
+static void _gp_video_texture_plane_size(gp_video_texture* vt,
+                                         unsigned int plane,
+                                         GP_FORMAT* format,
+                                         unsigned int* width,
+                                         unsigned int* height)
+{
+  *format = vt->mFormat == GP_VIDEO_FORMAT_NV12 && plane == 1 ? GP_FORMAT_RG : GP_FORMAT_R;
+  *width = plane == 0 ? vt->mWidth : (vt->mWidth + 1)/2;
+  *height = plane == 0 ? vt->mHeight : (vt->mHeight + 1)/2;
+}
+
+unsigned int _gp_video_texture_gather(gp_video_texture* vt,
+                                      const void* const* planes,
+                                      const unsigned int* strides,
+                                      gp_texture_data** data)
+{
+  const unsigned int count = vt->mFormat == GP_VIDEO_FORMAT_NV12 ? 2 : 3;
+  unsigned int n = 0;
+  GP_FORMAT format;
+  unsigned int width, height;
+  
+  if(!vt->mAllocated)
+  {
+    for(unsigned int p=0; p<count; ++p)
+    {
+      _gp_video_texture_plane_size(vt, p, &format, &width, &height);
+      data[n] = gp_texture_data_new();
+      gp_texture_data_set_2d(data[n++], NULL, format, GP_DATA_TYPE_UBYTE, width, height);
+    }
+    vt->mAllocated = 1;
+  }
+  
+  for(unsigned int p=0; p<count; ++p)
+  {
+    _gp_video_texture_plane_size(vt, p, &format, &width, &height);
+    const unsigned int rowLength = strides && strides[p] ? strides[p]/format : width;
+    
+    data[n] = gp_texture_data_new();
+    gp_texture_data_set_2d_region(data[n++], planes[p], format, GP_DATA_TYPE_UBYTE, width, height, 0, 0, rowLength, 0, 0);
+  }
+  return n;
+}
+
+void gp_video_texture_set_frame(gp_video_texture* vt, const void* const* planes, const unsigned int* strides)
+{
+  const unsigned int count = vt->mFormat == GP_VIDEO_FORMAT_NV12 ? 2 : 3;
+  gp_texture_data* data[6];
+  const unsigned int n = _gp_video_texture_gather(vt, planes, strides, data);
+  
+  for(unsigned int i=0; i<n; ++i)
+  {
+    gp_texture_set_data(vt->mPlanes[i%count], data[i]);
+    gp_object_unref((gp_object*)data[i]);
+  }
+}
+
+static void _gp_video_texture_async_callback(void* userdata)
+{
+  _gp_video_texture_async* async = (_gp_video_texture_async*)userdata;
+  
+  if(--async->mPending > 0) return;
+  
+  if(async->mCallback) async->mCallback(async->mUserData);
+  gp_object_unref((gp_object*)async->mTexture);
+  free(async);
+}
+
+void gp_video_texture_set_frame_async(gp_video_texture* vt,
+                                      const void* const* planes,
+                                      const unsigned int* strides,
+                                      void (*callback)(void*),
+                                      void* userdata)
+{
+  const unsigned int count = vt->mFormat == GP_VIDEO_FORMAT_NV12 ? 2 : 3;
+  gp_texture_data* data[6];
+  const unsigned int n = _gp_video_texture_gather(vt, planes, strides, data);
+  
+  _gp_video_texture_async* async = malloc(sizeof(_gp_video_texture_async));
+  async->mTexture = vt;
+  async->mPending = n;
+  async->mCallback = callback;
+  async->mUserData = userdata;
+  gp_object_ref((gp_object*)vt);
+  
+  // The worker runs uploads in order, so allocations finish before the
+  // planes are written.
+  for(unsigned int i=0; i<n; ++i)
+  {
+    gp_texture_set_data_async(vt->mPlanes[i%count], data[i], _gp_video_texture_async_callback, async);
+    gp_object_unref((gp_object*)data[i]);
+  }
+}
+
+void gp_video_texture_set_uniforms(gp_video_texture* vt, gp_shader* shader, gp_operation* operation)
+{
+  static const char* names[3] = {"gpVideoY", "gpVideoU", "gpVideoV"};
+  
+  for(unsigned int p=0; p<3; ++p)
+  {
+    gp_uniform* uniform = gp_uniform_texture_new_by_name(shader, names[p]);
+    gp_uniform_texture_set(uniform, vt->mPlanes[p] ? vt->mPlanes[p] : vt->mPlanes[1]);
+    gp_operation_draw_set_uniform(operation, uniform);
+    gp_object_unref((gp_object*)uniform);
+  }
+  
+  if(vt->mInfo) gp_object_unref((gp_object*)vt->mInfo);
+  vt->mInfo = gp_uniform_vec4_new_by_name(shader, "gpVideoInfo");
+  _gp_video_texture_update_info(vt);
+  gp_operation_draw_set_uniform(operation, vt->mInfo);
+}
+
+gp_texture* gp_video_texture_get_plane(gp_video_texture* vt, unsigned int plane)
+{
+  return plane < 3 ? vt->mPlanes[plane] : NULL;
+}
@@ -0,0 +1,58 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_VIDEO_TEXTURE_H__
+#define __GP_UTILS_VIDEO_TEXTURE_H__
+
+#include <GraphicsPipeline/VideoTexture.h>
+#include "Object.h"
+
+struct _gp_video_texture
+{
+  gp_object                 mObject;
+  gp_texture*               mPlanes[3];   // Y and UV for NV12, Y, U and V for I420.
+  GP_VIDEO_FORMAT           mFormat;
+  GP_VIDEO_COLOR            mColor;
+  int                       mFullRange;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  int                       mAllocated;   // Storage is allocated by the first frame.
+  gp_uniform*               mInfo;        // Set by gp_video_texture_set_uniforms(), or NULL.
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Copy every plane of a frame into texture data, gathering rows of padded
+ * planes straight from the frame.  The first frame is preceded by data
+ * allocating the planes, so every frame updates storage in place.  Data i
+ * belongs to plane i modulo the number of planes.  Returns the number of
+ * texture data objects, each holding a reference for the caller.
+ */
+unsigned int _gp_video_texture_gather(gp_video_texture* vt,
+                                      const void* const* planes,
+                                      const unsigned int* strides,
+                                      gp_texture_data** data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_VIDEO_TEXTURE_H__
@@ -0,0 +1,524 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#include "VirtualTexture.h"
+#include <GraphicsPipeline/Logging.h>
+#include "Parallel.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned int _gp_virtual_texture_level_size(unsigned int size, unsigned int level)
+{
+  size >>= level;
+  return size ? size : 1;
+}
+
+static unsigned int _gp_virtual_texture_pixel_size(gp_virtual_texture* vt)
+{
+  return vt->mFormat*gp_data_type_get_size(vt->mType);
+}
+
+//
+// Tiles
+//
+
+void gp_virtual_texture_extract_tile(const void* image,
+                                     unsigned int width,
+                                     unsigned int height,
+                                     GP_FORMAT format,
+                                     GP_DATA_TYPE type,
+                                     unsigned int tile_size,
+                                     unsigned int x,
+                                     unsigned int y,
+                                     void* data)
+{
+  const size_t pixel = format*gp_data_type_get_size(type);
+  const unsigned int padded = tile_size + 2*GP_VIRTUAL_TEXTURE_BORDER;
+  const long long left = (long long)x*tile_size - GP_VIRTUAL_TEXTURE_BORDER;
+  const long long top = (long long)y*tile_size - GP_VIRTUAL_TEXTURE_BORDER;
+  
+  for(unsigned int j=0; j<padded; ++j)
+  {
+    long long sy = top + j;
+    sy = sy < 0 ? 0 : (sy >= height ? height-1 : sy);
+    const char* row = (const char*)image + (size_t)sy*width*pixel;
+    char* out = (char*)data + (size_t)j*padded*pixel;
+    
+    // Pixels past the edges repeat the edge, the rest is copied in one run.
+    unsigned int i = 0;
+    while(i < padded)
+    {
+      long long sx = left + i;
+      if(sx < 0 || sx >= width)
+      {
+        sx = sx < 0 ? 0 : width-1;
+        memcpy(out + i*pixel, row + (size_t)sx*pixel, pixel);
+        ++i;
+        continue;
+      }
+      
+      unsigned int run = padded - i;
+      if(run > width - sx) run = (unsigned int)(width - sx);
+      memcpy(out + i*pixel, row + (size_t)sx*pixel, run*pixel);
+      i += run;
+    }
+  }
+}
+
+static _gp_virtual_texture_tile* _gp_virtual_texture_get_tile(gp_virtual_texture* vt,
+                                                              unsigned int level,
+                                                              unsigned int x,
+                                                              unsigned int y)
+{
+  return vt->mTiles + vt->mFirstTile[level] + y*vt->mTilesX[level] + x;
+}
+
+void _gp_virtual_texture_build_pages(gp_virtual_texture* vt)
+{
+  for(int level=(int)vt->mLevels-1; level>=0; --level)
+  {
+    const unsigned int width = _gp_virtual_texture_level_size(vt->mPagesX, level);
+    const unsigned int height = _gp_virtual_texture_level_size(vt->mPagesY, level);
+    const unsigned int parentWidth = _gp_virtual_texture_level_size(vt->mPagesX, level+1);
+    uint8_t* pages = vt->mPages + (size_t)vt->mFirstPage[level]*4;
+    const uint8_t* parent = vt->mPages + (size_t)vt->mFirstPage[level+1]*4;
+    
+    for(unsigned int y=0; y<height; ++y)
+    {
+      for(unsigned int x=0; x<width; ++x)
+      {
+        uint8_t* entry = pages + ((size_t)y*width + x)*4;
+        
+        if(x < vt->mTilesX[level] && y < vt->mTilesY[level])
+        {
+          _gp_virtual_texture_tile* tile = _gp_virtual_texture_get_tile(vt, level, x, y);
+          if(tile->mState == GP_VIRTUAL_TEXTURE_RESIDENT)
+          {
+            entry[0] = tile->mSlot%vt->mCacheTiles;
+            entry[1] = tile->mSlot/vt->mCacheTiles;
+            entry[2] = level;
+            entry[3] = 255;
+            continue;
+          }
+        }
+        
+        // Fall back to the parent, which already points at the closest
+        // resident ancestor.
+        if(level+1 < (int)vt->mLevels)
+          memcpy(entry, parent + ((size_t)(y/2)*parentWidth + x/2)*4, 4);
+        else
+          memset(entry, 0, 4);
+      }
+    }
+  }
+}
+
+static void _gp_virtual_texture_upload_pages(gp_virtual_texture* vt)
+{
+  _gp_virtual_texture_build_pages(vt);
+  
+  for(unsigned int level=0; level<vt->mLevels; ++level)
+  {
+    gp_texture_data* td = gp_texture_data_new();
+    gp_texture_data_set_2d(td,
+                           vt->mPages + (size_t)vt->mFirstPage[level]*4,
+                           GP_FORMAT_RGBA,
+                           GP_DATA_TYPE_UBYTE,
+                           _gp_virtual_texture_level_size(vt->mPagesX, level),
+                           _gp_virtual_texture_level_size(vt->mPagesY, level));
+    gp_texture_set_level(vt->mPageTable, td, level);
+    gp_object_unref((gp_object*)td);
+  }
+  
+  vt->mDirty = 0;
+}
+
+//
+// Streaming
+//
+
+static void _gp_virtual_texture_evict(gp_virtual_texture* vt, _gp_virtual_texture_tile* tile)
+{
+  gp_list_remove(&vt->mResident, &tile->mNode);
+  tile->mState = GP_VIRTUAL_TEXTURE_UNLOADED;
+  vt->mFree[vt->mFreeCount++] = tile->mSlot;
+  vt->mDirty = 1;
+}
+
+void _gp_virtual_texture_loaded(void* userdata)
+{
+  _gp_virtual_texture_tile* tile = (_gp_virtual_texture_tile*)userdata;
+  gp_virtual_texture* vt = tile->mTexture;
+  
+  tile->mState = GP_VIRTUAL_TEXTURE_RESIDENT;
+  gp_list_push_back(&vt->mResident, &tile->mNode);
+  vt->mLoads--;
+  vt->mDirty = 1;
+  
+  gp_object_unref((gp_object*)vt);
+}
+
+/*
+ * Take a free cache slot, evicting the least recently used tile not
+ * selected this frame if the cache is full.  Returns 0 if every slot is in
+ * use.
+ */
+static int _gp_virtual_texture_take_slot(gp_virtual_texture* vt, unsigned short* slot)
+{
+  if(vt->mFreeCount == 0)
+  {
+    if(gp_list_front(&vt->mResident) == gp_list_end(&vt->mResident)) return 0;
+    
+    _gp_virtual_texture_tile* lru = (_gp_virtual_texture_tile*)gp_list_front(&vt->mResident);
+    if(lru->mFrame == vt->mFrame) return 0;
+    _gp_virtual_texture_evict(vt, lru);
+  }
+  
+  *slot = vt->mFree[--vt->mFreeCount];
+  return 1;
+}
+
+typedef struct
+{
+  _gp_virtual_texture_tile* mTile;
+  void*                     mPixels;
+  int                       mSuccess;
+} _gp_virtual_texture_read;
+
+/*
+ * Runs on the worker thread, so slow loaders never stall a frame.  Every
+ * job has its own pixels as the upload of a tile may still be pending
+ * when the next tile is read.
+ */
+static void _gp_virtual_texture_read_func(void* userdata)
+{
+  _gp_virtual_texture_read* job = (_gp_virtual_texture_read*)userdata;
+  _gp_virtual_texture_tile* tile = job->mTile;
+  gp_virtual_texture* vt = tile->mTexture;
+  
+  const unsigned int padded = vt->mTileSize + 2*GP_VIRTUAL_TEXTURE_BORDER;
+  job->mPixels = malloc((size_t)padded*padded*_gp_virtual_texture_pixel_size(vt));
+  job->mSuccess = vt->mLoader(vt->mUserData, tile->mLevel, tile->mX, tile->mY, job->mPixels);
+}
+
+static void _gp_virtual_texture_read_join(void* userdata)
+{
+  _gp_virtual_texture_read* job = (_gp_virtual_texture_read*)userdata;
+  _gp_virtual_texture_tile* tile = job->mTile;
+  gp_virtual_texture* vt = tile->mTexture;
+  
+  if(job->mSuccess)
+  {
+    const unsigned int padded = vt->mTileSize + 2*GP_VIRTUAL_TEXTURE_BORDER;
+    gp_texture_data* td = gp_texture_data_new();
+    gp_texture_data_set_2d_chunk(td,
+                                 job->mPixels,
+                                 vt->mFormat,
+                                 vt->mType,
+                                 padded,
+                                 padded,
+                                 (tile->mSlot%vt->mCacheTiles)*padded,
+                                 (tile->mSlot/vt->mCacheTiles)*padded);
+    gp_texture_set_data_async(vt->mCache, td, _gp_virtual_texture_loaded, tile);
+    gp_object_unref((gp_object*)td);
+  }
+  else
+  {
+    gp_log_error("Failed to load virtual texture tile %u, %u at level %u", tile->mX, tile->mY, tile->mLevel);
+    tile->mState = GP_VIRTUAL_TEXTURE_FAILED;
+    vt->mFree[vt->mFreeCount++] = tile->mSlot;
+    vt->mLoads--;
+    gp_object_unref((gp_object*)vt);
+  }
+  
+  free(job->mPixels);
+  free(job);
+}
+
+static void _gp_virtual_texture_request(_gp_virtual_texture_tile* tile)
+{
+  _gp_virtual_texture_read* job = malloc(sizeof(_gp_virtual_texture_read));
+  job->mTile = tile;
+  job->mPixels = NULL;
+  job->mSuccess = 0;
+  _gp_api_work(_gp_virtual_texture_read_func, _gp_virtual_texture_read_join, job);
+}
+
+static void _gp_virtual_texture_load(gp_virtual_texture* vt, _gp_virtual_texture_tile* tile)
+{
+  if(vt->mLoader == NULL) return;
+  
+  unsigned short slot;
+  if(!_gp_virtual_texture_take_slot(vt, &slot)) return;
+  
+  tile->mSlot = slot;
+  tile->mState = GP_VIRTUAL_TEXTURE_LOADING;
+  vt->mLoads++;
+  
+  // Keep the virtual texture alive until the upload finishes.
+  gp_object_ref((gp_object*)vt);
+  vt->mRequest(tile);
+}
+
+void _gp_virtual_texture_free(gp_object* object)
+{
+  gp_virtual_texture* vt = (gp_virtual_texture*)object;
+  
+  gp_list_free(&vt->mResident);
+  gp_object_unref((gp_object*)vt->mCache);
+  gp_object_unref((gp_object*)vt->mPageTable);
+  
+  free(vt->mTiles);
+  free(vt->mPages);
+  free(vt->mFree);
+  free(vt);
+}
+
+gp_virtual_texture* gp_virtual_texture_new(gp_context* context,
+                                           unsigned int width,
+                                           unsigned int height,
+                                           GP_FORMAT format,
+                                           GP_DATA_TYPE type,
+                                           unsigned int tile_size,
+                                           unsigned int cache_tiles)
+{
+  if(width == 0 || height == 0 || tile_size == 0)
+  {
+    gp_log_error("Virtual textures must have a size");
+    return NULL;
+  }
+  if(cache_tiles == 0 || cache_tiles > 255)
+  {
+    gp_log_error("Virtual texture caches hold 1 to 255 tiles along each side");
+    return NULL;
+  }
+  
+  gp_virtual_texture* vt = calloc(1, sizeof(gp_virtual_texture));
+  _gp_object_init(&vt->mObject, _gp_virtual_texture_free);
+  vt->mRequest = _gp_virtual_texture_request;
+  vt->mFormat = format;
+  vt->mType = type;
+  vt->mWidth = width;
+  vt->mHeight = height;
+  vt->mTileSize = tile_size;
+  vt->mCacheTiles = cache_tiles;
+  
+  // The page table is a power of two so every level of its mipmap chain
+  // has room for the tiles of the matching pyramid level.
+  vt->mPagesX = 1;
+  vt->mPagesY = 1;
+  while(vt->mPagesX*tile_size < width) vt->mPagesX *= 2;
+  while(vt->mPagesY*tile_size < height) vt->mPagesY *= 2;
+  vt->mLevels = gp_mipmap_get_levels(vt->mPagesX, vt->mPagesY);
+  
+  unsigned int tiles = 0;
+  unsigned int pages = 0;
+  for(unsigned int level=0; level<vt->mLevels; ++level)
+  {
+    vt->mTilesX[level] = (_gp_virtual_texture_level_size(width, level) + tile_size - 1)/tile_size;
+    vt->mTilesY[level] = (_gp_virtual_texture_level_size(height, level) + tile_size - 1)/tile_size;
+    vt->mFirstTile[level] = tiles;
+    vt->mFirstPage[level] = pages;
+    tiles += vt->mTilesX[level]*vt->mTilesY[level];
+    pages += _gp_virtual_texture_level_size(vt->mPagesX, level)*_gp_virtual_texture_level_size(vt->mPagesY, level);
+  }
+  vt->mFirstPage[vt->mLevels] = pages;
+  
+  vt->mTiles = calloc(tiles, sizeof(_gp_virtual_texture_tile));
+  for(unsigned int level=0; level<vt->mLevels; ++level)
+  {
+    for(unsigned int y=0; y<vt->mTilesY[level]; ++y)
+    {
+      for(unsigned int x=0; x<vt->mTilesX[level]; ++x)
+      {
+        _gp_virtual_texture_tile* tile = _gp_virtual_texture_get_tile(vt, level, x, y);
+        tile->mTexture = vt;
+        tile->mLevel = level;
+        tile->mX = x;
+        tile->mY = y;
+        tile->mState = GP_VIRTUAL_TEXTURE_UNLOADED;
+      }
+    }
+  }
+  
+  vt->mPages = calloc(pages, 4);
+  
+  // Slots are handed out from the top left corner.
+  const unsigned int slots = cache_tiles*cache_tiles;
+  vt->mFree = malloc(sizeof(unsigned short)*slots);
+  for(unsigned int i=0; i<slots; ++i)
+    vt->mFree[i] = slots - 1 - i;
+  vt->mFreeCount = slots;
+  
+  gp_list_init(&vt->mResident);
+  vt->mCache = gp_texture_new(context);
+  vt->mPageTable = gp_texture_new(context);
+  vt->mDirty = 1;
+  
+  return vt;
+}
+
+void gp_virtual_texture_set_loader(gp_virtual_texture* vt,
+                                   int (*loader)(void* userdata,
+                                                 unsigned int level,
+                                                 unsigned int x,
+                                                 unsigned int y,
+                                                 void* data),
+                                   void* userdata)
+{
+  vt->mLoader = loader;
+  vt->mUserData = userdata;
+}
+
+unsigned int gp_virtual_texture_get_levels(gp_virtual_texture* vt)
+{
+  return vt->mLevels;
+}
+
+gp_texture* gp_virtual_texture_get_page_table(gp_virtual_texture* vt)
+{
+  return vt->mPageTable;
+}
+
+gp_texture* gp_virtual_texture_get_cache(gp_virtual_texture* vt)
+{
+  return vt->mCache;
+}
+
+void gp_virtual_texture_get_info(gp_virtual_texture* vt, float* info)
+{
+  info[0] = (float)vt->mWidth;
+  info[1] = (float)vt->mHeight;
+  info[2] = (float)vt->mTileSize;
+  info[3] = (float)vt->mLevels;
+}
+
+//
+// Tile selection
+//
+
+/*
+ * Range of tiles at a level covering a region of texture coordinates, as
+ * first x, first y, last x and last y.
+ */
+static void _gp_virtual_texture_range(gp_virtual_texture* vt, const float* region, unsigned int level, unsigned int* range)
+{
+  const float size[2] = {(float)_gp_virtual_texture_level_size(vt->mWidth, level),
+                         (float)_gp_virtual_texture_level_size(vt->mHeight, level)};
+  const unsigned int tiles[2] = {vt->mTilesX[level], vt->mTilesY[level]};
+  
+  for(int a=0; a<4; ++a)
+  {
+    float t = floorf(region[a]*size[a%2]/vt->mTileSize);
+    range[a] = t < 0.0f ? 0 : (t >= tiles[a%2] ? tiles[a%2]-1 : (unsigned int)t);
+  }
+}
+
+static unsigned int _gp_virtual_texture_count(gp_virtual_texture* vt, const float* region, unsigned int level)
+{
+  unsigned int count = 0;
+  for(; level<vt->mLevels; ++level)
+  {
+    unsigned int range[4];
+    _gp_virtual_texture_range(vt, region, level, range);
+    count += (range[2] - range[0] + 1)*(range[3] - range[1] + 1);
+  }
+  
+  return count;
+}
+
+static void _gp_virtual_texture_allocate(gp_virtual_texture* vt)
+{
+  const unsigned int side = vt->mCacheTiles*(vt->mTileSize + 2*GP_VIRTUAL_TEXTURE_BORDER);
+  gp_texture_set_filter(vt->mCache, GP_FILTER_LINEAR, GP_FILTER_LINEAR, GP_FILTER_NEAREST);
+  gp_texture_allocate(vt->mCache, vt->mFormat, vt->mType, side, side, 1);
+  
+  gp_texture_set_filter(vt->mPageTable, GP_FILTER_NEAREST, GP_FILTER_NEAREST, GP_FILTER_NEAREST);
+  gp_texture_allocate(vt->mPageTable, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, vt->mPagesX, vt->mPagesY, vt->mLevels);
+}
+
+unsigned int _gp_virtual_texture_select(gp_virtual_texture* vt,
+                                        const float* region,
+                                        unsigned int width,
+                                        unsigned int height)
+{
+  vt->mFrame++;
+  
+  // The finest level where a texel covers at least a pixel on screen.
+  float texels = (region[2] - region[0])*vt->mWidth/(width ? width : 1);
+  float texelsY = (region[3] - region[1])*vt->mHeight/(height ? height : 1);
+  if(texelsY > texels) texels = texelsY;
+  unsigned int target = texels > 1.0f ? (unsigned int)floorf(log2f(texels)) : 0;
+  if(target >= vt->mLevels) target = vt->mLevels-1;
+  
+  // Coarser levels until the selection and its ancestors fit in the cache.
+  while(target+1 < vt->mLevels && _gp_virtual_texture_count(vt, region, target) > vt->mCacheTiles*vt->mCacheTiles)
+    ++target;
+  
+  // Coarse levels are requested first so something is drawn early, and
+  // resident tiles move to the back of the LRU list.
+  unsigned int missing = 0;
+  for(int level=(int)vt->mLevels-1; level>=(int)target; --level)
+  {
+    unsigned int range[4];
+    _gp_virtual_texture_range(vt, region, level, range);
+    
+    for(unsigned int y=range[1]; y<=range[3]; ++y)
+    {
+      for(unsigned int x=range[0]; x<=range[2]; ++x)
+      {
+        _gp_virtual_texture_tile* tile = _gp_virtual_texture_get_tile(vt, level, x, y);
+        tile->mFrame = vt->mFrame;
+        
+        if(tile->mState == GP_VIRTUAL_TEXTURE_RESIDENT)
+        {
+          gp_list_remove(&vt->mResident, &tile->mNode);
+          gp_list_push_back(&vt->mResident, &tile->mNode);
+          continue;
+        }
+        if(tile->mState == GP_VIRTUAL_TEXTURE_FAILED) continue;
+        
+        ++missing;
+        if(tile->mState == GP_VIRTUAL_TEXTURE_UNLOADED && vt->mLoads < GP_VIRTUAL_TEXTURE_MAX_LOADS)
+          _gp_virtual_texture_load(vt, tile);
+      }
+    }
+  }
+  
+  return missing;
+}
+
+unsigned int gp_virtual_texture_update(gp_virtual_texture* vt,
+                                       const float* region,
+                                       unsigned int width,
+                                       unsigned int height)
+{
+  if(vt->mFrame == 0)
+    _gp_virtual_texture_allocate(vt);
+  
+  unsigned int missing = _gp_virtual_texture_select(vt, region, width, height);
+  
+  // NOTE: Evicted slots are dropped from the page table here, before any
+  // frame draws with them again.
+  if(vt->mDirty)
+    _gp_virtual_texture_upload_pages(vt);
+  
+  return missing;
+}
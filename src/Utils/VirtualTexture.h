@@ -0,0 +1,111 @@
+/************************************************************************
+* Copyright (C) 2021 Trevor Hanz
+* 
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <https://www.gnu.org/licenses/>.
+************************************************************************/
+
+
+#ifndef __GP_UTILS_VIRTUAL_TEXTURE_H__
+#define __GP_UTILS_VIRTUAL_TEXTURE_H__
+
+#include <GraphicsPipeline/VirtualTexture.h>
+#include "List.h"
+#include "Object.h"
+
+#include <stdint.h>
+
+#define GP_VIRTUAL_TEXTURE_MAX_LEVELS 32
+#define GP_VIRTUAL_TEXTURE_MAX_LOADS  4           // Tile uploads in flight at once.
+
+#define GP_VIRTUAL_TEXTURE_UNLOADED   0
+#define GP_VIRTUAL_TEXTURE_LOADING    1
+#define GP_VIRTUAL_TEXTURE_RESIDENT   2
+#define GP_VIRTUAL_TEXTURE_FAILED     3
+
+typedef struct _gp_virtual_texture_tile _gp_virtual_texture_tile;
+
+struct _gp_virtual_texture_tile
+{
+  gp_list_node              mNode;        // Position in the LRU list while resident.
+  gp_virtual_texture*       mTexture;
+  unsigned int              mFrame;       // Last frame the tile was selected.
+  unsigned short            mSlot;        // Cache slot while loading or resident.
+  unsigned char             mLevel;
+  unsigned char             mState;
+  unsigned int              mX;
+  unsigned int              mY;
+};
+
+struct _gp_virtual_texture
+{
+  gp_object                 mObject;
+  gp_texture*               mCache;
+  gp_texture*               mPageTable;
+  int                       (*mLoader)(void*, unsigned int, unsigned int, unsigned int, void*);
+  void*                     mUserData;
+  void(*mRequest)(_gp_virtual_texture_tile* tile); // Starts loading a tile.
+  GP_FORMAT                 mFormat;
+  GP_DATA_TYPE              mType;
+  unsigned int              mWidth;
+  unsigned int              mHeight;
+  unsigned int              mTileSize;
+  unsigned int              mCacheTiles;  // Slots along each side of the cache.
+  unsigned int              mLevels;
+  unsigned int              mTilesX[GP_VIRTUAL_TEXTURE_MAX_LEVELS];
+  unsigned int              mTilesY[GP_VIRTUAL_TEXTURE_MAX_LEVELS];
+  unsigned int              mFirstTile[GP_VIRTUAL_TEXTURE_MAX_LEVELS];
+  unsigned int              mFirstPage[GP_VIRTUAL_TEXTURE_MAX_LEVELS+1];
+  unsigned int              mPagesX;      // Page table size, a power of two.
+  unsigned int              mPagesY;
+  _gp_virtual_texture_tile* mTiles;
+  uint8_t*                  mPages;       // RGBA page table entries of every level.
+  unsigned short*           mFree;        // Unused cache slots.
+  unsigned int              mFreeCount;
+  gp_list                   mResident;    // Least recently used first.
+  unsigned int              mLoads;
+  unsigned int              mFrame;
+  int                       mDirty;       // Page table needs to be rebuilt.
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Rebuild the page table entries from the resident tiles.  Tiles that are
+ * not resident point at their closest resident ancestor.
+ */
+void _gp_virtual_texture_build_pages(gp_virtual_texture* vt);
+
+/*
+ * Select the tiles covering a region, move resident ones to the back of the
+ * LRU list and request missing ones.  Returns the number of selected tiles
+ * that are not resident.
+ */
+unsigned int _gp_virtual_texture_select(gp_virtual_texture* vt,
+                                        const float* region,
+                                        unsigned int width,
+                                        unsigned int height);
+
+/*
+ * Make a tile resident once its pixels have been uploaded.  Balances the
+ * reference taken on the virtual texture when the tile was requested.
+ */
+void _gp_virtual_texture_loaded(void* userdata);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GP_UTILS_VIRTUAL_TEXTURE_H__
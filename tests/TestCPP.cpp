@@ -19,6 +19,8 @@
 
 #include "gtest/gtest.h"
 
+#include <vector>
+
 using namespace GP;
 
 #ifdef __APPLE__
@@ -129,6 +131,105 @@ TEST(CPP, Memory)
   }
 }
 
+struct TestVertex
+{
+  float     position[3];
+  uint8_t   color[4];
+  float     uv[2];
+};
+
+typedef VertexLayout<TestVertex,
+                     GP_VERTEX_ATTRIBUTE(TestVertex, position, 0),
+                     GP_VERTEX_ATTRIBUTE(TestVertex, color, 1),
+                     GP_VERTEX_ATTRIBUTE(TestVertex, uv, 2)> TestLayout;
+
+TEST(CPP, VertexLayout)
+{
+  ASSERT_EQ(TestLayout::Stride, (int)sizeof(TestVertex));
+  
+  const size_t count = 1000;
+  std::vector<float> positions(count*3);
+  std::vector<uint8_t> colors(count*4);
+  std::vector<float> uvs(count*2);
+  for(size_t i=0; i<positions.size(); ++i) positions[i] = (float)i;
+  for(size_t i=0; i<colors.size(); ++i) colors[i] = (uint8_t)i;
+  for(size_t i=0; i<uvs.size(); ++i) uvs[i] = -(float)i;
+  
+  ArrayData ad = TestLayout::Interleave(count,
+                                        (const float(*)[3])&positions[0],
+                                        (const uint8_t(*)[4])&colors[0],
+                                        (const float(*)[2])&uvs[0]);
+  ASSERT_EQ(ad.GetSize(), count*sizeof(TestVertex));
+  
+  const TestVertex* vertices = (const TestVertex*)ad.GetData();
+  for(size_t i=0; i<count; ++i)
+  {
+    for(int c=0; c<3; ++c) ASSERT_EQ(vertices[i].position[c], positions[i*3+c]);
+    for(int c=0; c<4; ++c) ASSERT_EQ(vertices[i].color[c], colors[i*4+c]);
+    for(int c=0; c<2; ++c) ASSERT_EQ(vertices[i].uv[c], uvs[i*2+c]);
+  }
+}
+
+// Records the arrays a layout adds instead of drawing them.
+struct RecordingOperation
+{
+  struct Call
+  {
+    int index;
+    int components;
+    GP_DATA_TYPE type;
+    int stride;
+    int offset;
+  };
+  std::vector<Call> calls;
+  
+  void AddArrayByIndex(const Array&, int index, int components, GP_DATA_TYPE type, int stride, int offset)
+  {
+    Call call = {index, components, type, stride, offset};
+    calls.push_back(call);
+  }
+};
+
+TEST(CPP, VertexLayoutApply)
+{
+  RecordingOperation operation;
+  Array array;
+  TestLayout::Apply(operation, array);
+  
+  ASSERT_EQ(operation.calls.size(), 3u);
+  const RecordingOperation::Call expected[3] =
+  {
+    {0, 3, GP_DATA_TYPE_FLOAT, (int)sizeof(TestVertex), (int)offsetof(TestVertex, position)},
+    {1, 4, GP_DATA_TYPE_UBYTE, (int)sizeof(TestVertex), (int)offsetof(TestVertex, color)},
+    {2, 2, GP_DATA_TYPE_FLOAT, (int)sizeof(TestVertex), (int)offsetof(TestVertex, uv)}
+  };
+  for(int i=0; i<3; ++i)
+  {
+    ASSERT_EQ(operation.calls[i].index, expected[i].index);
+    ASSERT_EQ(operation.calls[i].components, expected[i].components);
+    ASSERT_EQ(operation.calls[i].type, expected[i].type);
+    ASSERT_EQ(operation.calls[i].stride, expected[i].stride);
+    ASSERT_EQ(operation.calls[i].offset, expected[i].offset);
+  }
+}
+
+TEST(CPP, DoubleSplit)
+{
+  const unsigned int count = 300;
+  std::vector<double> positions(count*3);
+  for(size_t i=0; i<positions.size(); ++i) positions[i] = 6378137.0 + i*0.0001;
+  
+  ArrayData ad;
+  ad.SetDoubleSplit(&positions[0], 3, count);
+  ASSERT_EQ(ad.GetSize(), count*6*sizeof(float));
+  
+  // Each element holds its high floats followed by its low floats.
+  const float* data = (const float*)ad.GetData();
+  for(size_t i=0; i<count; ++i)
+    for(int c=0; c<3; ++c)
+      ASSERT_NEAR((double)data[i*6+c] + (double)data[i*6+3+c], positions[i*3+c], 1e-6);
+}
+
 int main(int argc, char* argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);
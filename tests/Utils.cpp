@@ -16,11 +16,35 @@
 ************************************************************************/
 
 #include <GraphicsPipeline/GP.h>
+#include "../src/API/GL/GL.h"
+#include "../src/Utils/Copy.h"
+#include "../src/Utils/Image.h"
 #include "../src/Utils/List.h"
+#include "../src/Utils/Lock.h"
+#include "../src/Utils/PointCloud.h"
 #include "../src/Utils/RefCounter.h"
+#include "../src/Utils/ScrollTexture.h"
+#include "../src/Utils/Shared.h"
+#include "../src/Utils/TextureAtlas.h"
+#include "../src/Utils/TextureCanvas.h"
+#include "../src/Utils/VideoTexture.h"
+#include "../src/Utils/VirtualTexture.h"
 
 #include "gtest/gtest.h"
 
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 struct test_node
 {
   gp_list_node      mNode;
@@ -185,6 +209,1556 @@ TEST(RefCounter, decrement)
   ASSERT_EQ(gp_ref_dec(&counter), 1);
 }
 
+TEST(Lock, exclusive)
+{
+  gp_lock lock;
+  gp_lock_init(&lock);
+  
+  // Unguarded read-modify-write increments lose updates when they race.
+  volatile int counter = 0;
+  auto work = [&]()
+  {
+    for(int i=0; i<200000; ++i)
+    {
+      gp_lock_acquire(&lock);
+      counter = counter + 1;
+      gp_lock_release(&lock);
+    }
+  };
+  
+  std::thread first(work);
+  std::thread second(work);
+  first.join();
+  second.join();
+  
+  ASSERT_EQ(counter, 400000);
+}
+
+TEST(Copy, large)
+{
+  // Odd size and offsets exercise the unaligned head and tail of every chunk.
+  const size_t size = GP_COPY_PARALLEL_SIZE*2 + 77;
+  unsigned char* src = new unsigned char[size+3];
+  unsigned char* dst = new unsigned char[size+5];
+  
+  for(size_t i=0; i<size+3; ++i)
+    src[i] = (unsigned char)(i*7 + (i>>13));
+  memset(dst, 0, size+5);
+  
+  gp_copy(dst+5, src+3, size);
+  ASSERT_EQ(memcmp(dst+5, src+3, size), 0);
+  
+  for(int i=0; i<5; ++i)
+    ASSERT_EQ(dst[i], 0);
+  
+  delete[] src;
+  delete[] dst;
+}
+
+TEST(Copy, pitch)
+{
+  // Rows of mapped texture regions are padded to GL_UNPACK_ALIGNMENT.
+  ASSERT_EQ(gp_copy_pitch(0, 4), 0u);
+  ASSERT_EQ(gp_copy_pitch(1, 4), 4u);
+  ASSERT_EQ(gp_copy_pitch(3*5, 4), 16u);
+  ASSERT_EQ(gp_copy_pitch(4*5, 4), 20u);
+  ASSERT_EQ(gp_copy_pitch(4*3*3, 4), 36u);
+  ASSERT_EQ(gp_copy_pitch(3*7, 8), 24u);
+  ASSERT_EQ(gp_copy_pitch(3*7, 1), 21u);
+  
+  // Padding never reaches the next row.
+  for(size_t row=1; row<64; ++row)
+  {
+    const size_t pitch = gp_copy_pitch(row, 4);
+    ASSERT_GE(pitch, row);
+    ASSERT_LT(pitch - row, 4u);
+    ASSERT_EQ(pitch%4, 0u);
+  }
+}
+
+TEST(Copy, alignment)
+{
+  // Uploads use the largest unpack alignment tightly packed rows satisfy.
+  ASSERT_EQ(gp_copy_alignment(4*16), 8u);
+  ASSERT_EQ(gp_copy_alignment(4*3), 4u);
+  ASSERT_EQ(gp_copy_alignment(3*2), 2u);
+  ASSERT_EQ(gp_copy_alignment(3*5), 1u);
+  ASSERT_EQ(gp_copy_alignment(2*3), 2u);
+  ASSERT_EQ(gp_copy_alignment(1), 1u);
+  for(size_t row=1; row<64; ++row)
+    ASSERT_EQ(gp_copy_pitch(row, gp_copy_alignment(row)), row);
+}
+
+TEST(Copy, rows)
+{
+  std::vector<uint8_t> src(7*5);
+  for(unsigned int i=0; i<src.size(); ++i)
+    src[i] = (uint8_t)i;
+  
+  // Gather 3 bytes out of rows of 7, then scatter them back into rows of 4.
+  std::vector<uint8_t> packed(3*4);
+  gp_copy_rows(packed.data(), 3, src.data() + 7 + 2, 7, 3, 4);
+  for(unsigned int y=0; y<4; ++y)
+    for(unsigned int x=0; x<3; ++x)
+      ASSERT_EQ(packed[y*3 + x], src[(y+1)*7 + 2 + x]);
+  
+  std::vector<uint8_t> padded(4*4, 0xFF);
+  gp_copy_rows(padded.data(), 4, packed.data(), 3, 3, 4);
+  for(unsigned int y=0; y<4; ++y)
+  {
+    ASSERT_EQ(memcmp(&padded[y*4], &packed[y*3], 3), 0);
+    ASSERT_EQ(padded[y*4 + 3], 0xFF);
+  }
+  
+  std::vector<uint8_t> contiguous(src.size());
+  gp_copy_rows(contiguous.data(), 7, src.data(), 7, 7, 5);
+  ASSERT_EQ(contiguous, src);
+}
+
+TEST(Precision, split)
+{
+  // Earth-centered coordinates need sub-millimeter precision.
+  double data[11];
+  for(int i=0; i<11; ++i)
+    data[i] = 6378137.0 + i*1234.56789012 - (i%3)*9876543.21;
+  
+  float high[11], low[11];
+  gp_double_split(data, high, low, 11);
+  
+  for(int i=0; i<11; ++i)
+  {
+    ASSERT_EQ(high[i], (float)data[i]);
+    ASSERT_NEAR((double)high[i] + (double)low[i], data[i], 1e-6);
+  }
+}
+
+TEST(Precision, rebase)
+{
+  const double origin[3] = {6378137.0, -1234567.0, 42.5};
+  double data[3*7];
+  for(int i=0; i<7; ++i)
+    for(int c=0; c<3; ++c)
+      data[i*3+c] = origin[c] + i*0.001 - c*0.5;
+  
+  float result[3*7];
+  gp_double_rebase(data, result, 3, 7, origin);
+  
+  for(int i=0; i<7; ++i)
+    for(int c=0; c<3; ++c)
+      ASSERT_NEAR(result[i*3+c], i*0.001 - c*0.5, 1e-6);
+  
+  // Component counts outside 1 to 4 are rejected without writing.
+  float untouched[3*7];
+  memset(untouched, 0, sizeof(untouched));
+  gp_double_rebase(data, untouched, 0, 7, origin);
+  gp_double_rebase(data, untouched, 5, 4, origin);
+  for(int i=0; i<3*7; ++i)
+    ASSERT_EQ(untouched[i], 0.0f);
+  
+  gp_array_data* ad = gp_array_data_new();
+  gp_array_data_set_double_split(ad, data, 5, 4);
+  gp_array_data_set_double_split(ad, data, 0, 4);
+  gp_array_data_set_double_relative(ad, data, 6, 3, origin);
+  ASSERT_EQ(gp_array_data_get_size(ad), 0u);
+  gp_array_data_set_double_relative(ad, data, 3, 7, origin);
+  ASSERT_EQ(gp_array_data_get_size(ad), sizeof(float)*3*7);
+  gp_object_unref((gp_object*)ad);
+}
+
+TEST(Half, convert)
+{
+  const float values[] = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 1e6f, 5.9604645e-8f, 1.00048828125f, 0.333333f};
+  const uint16_t halves[] = {0x0000, 0x8000, 0x3C00, 0xC100, 0x7BFF, 0x7C00, 0x0001, 0x3C00, 0x3555};
+  
+  uint16_t result[9];
+  gp_half_from_float(values, result, 9);
+  for(int i=0; i<9; ++i)
+    ASSERT_EQ(result[i], halves[i]);
+  
+  // The vector kernels must match the scalar conversion of single values.
+  std::vector<float> data(1003);
+  for(unsigned int i=0; i<data.size(); ++i)
+    data[i] = (i*37.1f - 10000.0f)/(1 + i%13);
+  
+  std::vector<uint16_t> h(data.size());
+  gp_half_from_float(data.data(), h.data(), data.size());
+  std::vector<float> back(data.size());
+  gp_half_to_float(h.data(), back.data(), h.size());
+  for(unsigned int i=0; i<data.size(); ++i)
+  {
+    uint16_t single;
+    float f;
+    gp_half_from_float(&data[i], &single, 1);
+    gp_half_to_float(&single, &f, 1);
+    ASSERT_EQ(h[i], single);
+    ASSERT_EQ(back[i], f);
+    ASSERT_NEAR(back[i], data[i], fabsf(data[i])/1024.0f);
+  }
+}
+
+TEST(Mipmap, downsample)
+{
+  ASSERT_EQ(gp_mipmap_get_levels(1, 1), 1);
+  ASSERT_EQ(gp_mipmap_get_levels(1024, 3), 11);
+  
+  // Odd width and a format that leaves the SIMD path with a remainder.
+  const unsigned int width = 37, height = 20;
+  std::vector<uint8_t> src(width*height*3);
+  for(unsigned int i=0; i<src.size(); ++i)
+    src[i] = (i*7) & 0xFF;
+  
+  std::vector<uint8_t> dst((width/2)*(height/2)*3);
+  gp_mipmap_downsample(src.data(), dst.data(), GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, width, height, GP_MIPMAP_BOX);
+  for(unsigned int y=0; y<height/2; ++y)
+  {
+    for(unsigned int x=0; x<width/2; ++x)
+    {
+      for(unsigned int c=0; c<3; ++c)
+      {
+        unsigned int sum = src[((2*y)*width + 2*x)*3 + c] + src[((2*y)*width + 2*x + 1)*3 + c] +
+                           src[((2*y + 1)*width + 2*x)*3 + c] + src[((2*y + 1)*width + 2*x + 1)*3 + c];
+        ASSERT_NEAR(dst[(y*(width/2) + x)*3 + c], sum/4.0, 0.5);
+      }
+    }
+  }
+  
+  // A constant image stays constant through the Kaiser filter.
+  std::vector<float> constant(64*64*4, 0.25f);
+  std::vector<float> level(32*32*4);
+  gp_mipmap_downsample(constant.data(), level.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_FLOAT, 64, 64, GP_MIPMAP_KAISER);
+  for(unsigned int i=0; i<level.size(); ++i)
+    ASSERT_NEAR(level[i], 0.25f, 1e-5);
+}
+
+TEST(Convert, convert)
+{
+  ASSERT_EQ(gp_data_type_get_size(GP_DATA_TYPE_DOUBLE), 8u);
+  ASSERT_EQ(gp_data_type_get_size(GP_DATA_TYPE_HALF), 2u);
+  
+  // Counts that leave every vector loop with a remainder, checked against
+  // conversions of single elements which only take the scalar path.
+  const unsigned int count = 1003;
+  std::vector<double> d(count);
+  std::vector<float> f(count);
+  std::vector<uint8_t> rgb(count*3);
+  std::vector<uint16_t> u(count);
+  for(unsigned int i=0; i<count; ++i)
+  {
+    d[i] = (i*3.3 - 1500.0)/(1 + i%7);
+    f[i] = (i%300)/256.0f - 0.1f;
+    u[i] = (uint16_t)(i*65.5);
+  }
+  for(unsigned int i=0; i<rgb.size(); ++i)
+    rgb[i] = (i*13) & 0xFF;
+  
+  std::vector<float> df(count);
+  gp_convert(d.data(), GP_FORMAT_R, GP_DATA_TYPE_DOUBLE, df.data(), GP_FORMAT_R, GP_DATA_TYPE_FLOAT, NULL, count);
+  for(unsigned int i=0; i<count; ++i)
+    ASSERT_EQ(df[i], (float)d[i]);
+  
+  std::vector<uint8_t> fb(count);
+  gp_convert(f.data(), GP_FORMAT_R, GP_DATA_TYPE_FLOAT, fb.data(), GP_FORMAT_R, GP_DATA_TYPE_UBYTE, NULL, count);
+  for(unsigned int i=0; i<count; ++i)
+  {
+    uint8_t single;
+    gp_convert(&f[i], GP_FORMAT_R, GP_DATA_TYPE_FLOAT, &single, GP_FORMAT_R, GP_DATA_TYPE_UBYTE, NULL, 1);
+    ASSERT_EQ(fb[i], single);
+  }
+  const float edges[] = {-1.0f, 0.0f, 0.5f, 1.0f, 2.0f};
+  uint8_t bytes[5];
+  gp_convert(edges, GP_FORMAT_R, GP_DATA_TYPE_FLOAT, bytes, GP_FORMAT_R, GP_DATA_TYPE_UBYTE, NULL, 5);
+  ASSERT_EQ(bytes[0], 0);
+  ASSERT_EQ(bytes[1], 0);
+  ASSERT_EQ(bytes[2], 128);
+  ASSERT_EQ(bytes[3], 255);
+  ASSERT_EQ(bytes[4], 255);
+  
+  // RGB is padded with opaque alpha, and a swizzle reverses the colors.
+  std::vector<uint8_t> rgba(count*4);
+  gp_convert(rgb.data(), GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, rgba.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, NULL, count);
+  for(unsigned int i=0; i<count; ++i)
+  {
+    for(unsigned int c=0; c<3; ++c)
+      ASSERT_EQ(rgba[i*4 + c], rgb[i*3 + c]);
+    ASSERT_EQ(rgba[i*4 + 3], 255);
+  }
+  
+  const int bgra[] = {2, 1, 0, 3};
+  std::vector<uint8_t> swizzled(count*4);
+  gp_convert(rgba.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, swizzled.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, bgra, count);
+  for(unsigned int i=0; i<count; ++i)
+  {
+    for(unsigned int c=0; c<4; ++c)
+      ASSERT_EQ(swizzled[i*4 + c], rgba[i*4 + bgra[c]]);
+  }
+  
+  // Types without a dedicated kernel go through floats.
+  std::vector<uint16_t> h(count);
+  gp_convert(u.data(), GP_FORMAT_R, GP_DATA_TYPE_USHORT, h.data(), GP_FORMAT_R, GP_DATA_TYPE_HALF, NULL, count);
+  for(unsigned int i=0; i<count; ++i)
+  {
+    float value = u[i]/65535.0f;
+    uint16_t single;
+    gp_half_from_float(&value, &single, 1);
+    ASSERT_EQ(h[i], single);
+  }
+  
+  // INT is not normalized, so conversions with other integer types keep
+  // values and clamp them to the range of the converted type.
+  const uint8_t ub[] = {0, 1, 200, 255};
+  int ints[4];
+  gp_convert(ub, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, ints, GP_FORMAT_RGBA, GP_DATA_TYPE_INT, NULL, 1);
+  for(unsigned int c=0; c<4; ++c)
+    ASSERT_EQ(ints[c], (int)ub[c]);
+  
+  const int wide[] = {-5, 7, 300, 200};
+  uint8_t narrow[4];
+  gp_convert(wide, GP_FORMAT_RGBA, GP_DATA_TYPE_INT, narrow, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, NULL, 1);
+  ASSERT_EQ(narrow[0], 0);
+  ASSERT_EQ(narrow[1], 7);
+  ASSERT_EQ(narrow[2], 255);
+  ASSERT_EQ(narrow[3], 200);
+  
+  int16_t shorts[2];
+  const int extremes[] = {-100000, 100000};
+  gp_convert(extremes, GP_FORMAT_RG, GP_DATA_TYPE_INT, shorts, GP_FORMAT_RG, GP_DATA_TYPE_SHORT, NULL, 1);
+  ASSERT_EQ(shorts[0], -32768);
+  ASSERT_EQ(shorts[1], 32767);
+  
+  // Missing alpha is filled with the one of the converted type.
+  const uint8_t gray[] = {9, 10, 11};
+  uint8_t back[4];
+  gp_convert(gray, GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, ints, GP_FORMAT_RGBA, GP_DATA_TYPE_INT, NULL, 1);
+  ASSERT_EQ(ints[2], 11);
+  ASSERT_EQ(ints[3], 1);
+  gp_convert(ints, GP_FORMAT_RGB, GP_DATA_TYPE_INT, back, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, NULL, 1);
+  ASSERT_EQ(back[0], 9);
+  ASSERT_EQ(back[3], 255);
+}
+
+// Sorted corners of every triangle, by grid position rather than index.
+static std::vector<uint64_t> mesh_triangles(const uint32_t* indices, unsigned int count, const uint32_t* vertices)
+{
+  std::vector<uint64_t> triangles;
+  for(unsigned int i=0; i<count; i+=3)
+  {
+    uint32_t t[3] = {vertices[indices[i]], vertices[indices[i+1]], vertices[indices[i+2]]};
+    std::sort(t, t+3);
+    triangles.push_back(((uint64_t)t[0] << 42) | ((uint64_t)t[1] << 21) | t[2]);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+#ifdef GP_GL
+TEST(Uniform, buffer_format)
+{
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_R, GP_DATA_TYPE_UBYTE), (GLuint)GL_R8);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGBA, GP_DATA_TYPE_FLOAT), (GLuint)GL_RGBA32F);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RG, GP_DATA_TYPE_HALF), (GLuint)GL_RG16F);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGB, GP_DATA_TYPE_INT), (GLuint)GL_RGB32I);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGBA, GP_DATA_TYPE_SHORT), (GLuint)GL_RGBA16I);
+  
+  // Buffer textures have no three component formats below 32 bits.
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE), 0u);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGB, GP_DATA_TYPE_HALF), 0u);
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_RGB, GP_DATA_TYPE_USHORT), 0u);
+  
+  // Types without a buffer texture format, and formats out of range.
+  ASSERT_EQ(_gp_uniform_buffer_format(GP_FORMAT_R, GP_DATA_TYPE_DOUBLE), 0u);
+  ASSERT_EQ(_gp_uniform_buffer_format((GP_FORMAT)0, GP_DATA_TYPE_FLOAT), 0u);
+}
+#endif
+
+TEST(Sampler, share)
+{
+  gp_sampler* a = gp_sampler_new(NULL);
+  gp_sampler* b = gp_sampler_new(NULL);
+  gp_sampler_set_wrap(a, GP_WRAP_REPEAT, GP_WRAP_MIRROR, GP_WRAP_EDGE);
+  gp_sampler_set_wrap(b, GP_WRAP_REPEAT, GP_WRAP_MIRROR, GP_WRAP_EDGE);
+  gp_sampler_set_anisotropy(a, 8.0f);
+  gp_sampler_set_anisotropy(b, 8.0f);
+  ASSERT_EQ(_gp_sampler_key(a), _gp_sampler_key(b));
+  ASSERT_LT(_gp_sampler_bucket(_gp_sampler_key(a)), 64u);
+  
+  // Every parameter is part of the key.
+  const uint64_t key = _gp_sampler_key(a);
+  gp_sampler_set_wrap(b, GP_WRAP_REPEAT, GP_WRAP_MIRROR, GP_WRAP_REPEAT);
+  ASSERT_NE(_gp_sampler_key(b), key);
+  gp_sampler_set_wrap(b, GP_WRAP_REPEAT, GP_WRAP_MIRROR, GP_WRAP_EDGE);
+  ASSERT_EQ(_gp_sampler_key(b), key);
+  gp_sampler_set_filter(b, GP_FILTER_LINEAR, GP_FILTER_NEAREST, GP_FILTER_LINEAR);
+  ASSERT_NE(_gp_sampler_key(b), key);
+  gp_sampler_set_filter(b, GP_FILTER_LINEAR, GP_FILTER_LINEAR, GP_FILTER_NEAREST);
+  ASSERT_NE(_gp_sampler_key(b), key);
+  gp_sampler_set_filter(b, GP_FILTER_LINEAR, GP_FILTER_LINEAR, GP_FILTER_LINEAR);
+  gp_sampler_set_compare(b, GP_COMPARE_LESS);
+  ASSERT_NE(_gp_sampler_key(b), key);
+  gp_sampler_set_compare(b, GP_COMPARE_NONE);
+  gp_sampler_set_anisotropy(b, 4.0f);
+  ASSERT_NE(_gp_sampler_key(b), key);
+  
+  // Anisotropy below one is clamped, so it shares the default sampler.
+  gp_sampler_set_anisotropy(a, 0.5f);
+  gp_sampler_set_anisotropy(b, 1.0f);
+  ASSERT_EQ(_gp_sampler_key(a), _gp_sampler_key(b));
+  
+  gp_object_unref((gp_object*)a);
+  gp_object_unref((gp_object*)b);
+}
+
+TEST(TextureData, volume)
+{
+  const unsigned int width = 3, height = 2, depth = 4;
+  std::vector<uint16_t> pixels(width*height*depth*2);
+  for(unsigned int i=0; i<pixels.size(); ++i)
+    pixels[i] = (uint16_t)i;
+  
+  gp_texture_data* td = gp_texture_data_new();
+  unsigned int w, h, d;
+  int x, y, z;
+  
+  gp_texture_data_set_3d(td, pixels.data(), GP_FORMAT_RG, GP_DATA_TYPE_USHORT, width, height, depth);
+  gp_texture_data_get_size(td, &w, &h, &d);
+  gp_texture_data_get_offset(td, &x, &y, &z);
+  ASSERT_EQ(w, width);
+  ASSERT_EQ(h, height);
+  ASSERT_EQ(d, depth);
+  ASSERT_EQ(x, -1);
+  ASSERT_EQ(y, -1);
+  ASSERT_EQ(z, -1);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), pixels.data(), pixels.size()*sizeof(uint16_t)), 0);
+  
+  // Chunks keep every offset, and a smaller chunk only copies its pixels.
+  gp_texture_data_set_3d_chunk(td, pixels.data() + 2, GP_FORMAT_R, GP_DATA_TYPE_USHORT, 2, 1, 3, 5, 6, 7);
+  gp_texture_data_get_size(td, &w, &h, &d);
+  gp_texture_data_get_offset(td, &x, &y, &z);
+  ASSERT_EQ(w, 2u);
+  ASSERT_EQ(h, 1u);
+  ASSERT_EQ(d, 3u);
+  ASSERT_EQ(x, 5);
+  ASSERT_EQ(y, 6);
+  ASSERT_EQ(z, 7);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), pixels.data() + 2, 6*sizeof(uint16_t)), 0);
+  
+  // Array layers are the depth, and a layer chunk starts at its layer.
+  gp_texture_data_set_2d_array(td, pixels.data(), GP_FORMAT_RG, GP_DATA_TYPE_USHORT, width, height, depth);
+  gp_texture_data_get_size(td, &w, &h, &d);
+  gp_texture_data_get_offset(td, &x, &y, &z);
+  ASSERT_EQ(d, depth);
+  ASSERT_EQ(x, -1);
+  ASSERT_EQ(z, -1);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), pixels.data(), pixels.size()*sizeof(uint16_t)), 0);
+  
+  gp_texture_data_set_2d_array_chunk(td, pixels.data(), GP_FORMAT_RG, GP_DATA_TYPE_USHORT, width, height, 1, 0, 0, 3);
+  gp_texture_data_get_size(td, &w, &h, &d);
+  gp_texture_data_get_offset(td, &x, &y, &z);
+  ASSERT_EQ(w, width);
+  ASSERT_EQ(h, height);
+  ASSERT_EQ(d, 1u);
+  ASSERT_EQ(x, 0);
+  ASSERT_EQ(y, 0);
+  ASSERT_EQ(z, 3);
+  
+  // 2D data drops the depth again.
+  gp_texture_data_set_2d(td, pixels.data(), GP_FORMAT_RG, GP_DATA_TYPE_USHORT, width, height);
+  gp_texture_data_get_size(td, NULL, NULL, &d);
+  gp_texture_data_get_offset(td, NULL, NULL, &z);
+  ASSERT_EQ(d, 1u);
+  ASSERT_EQ(z, -1);
+  
+  // Without pixels only the size is kept, for allocating storage.
+  gp_texture_data_set_3d(td, NULL, GP_FORMAT_RG, GP_DATA_TYPE_USHORT, width, height, depth);
+  gp_texture_data_get_size(td, NULL, NULL, &d);
+  ASSERT_EQ(gp_texture_data_get_data(td), nullptr);
+  ASSERT_EQ(d, depth);
+  
+  gp_object_unref((gp_object*)td);
+}
+
+TEST(TextureData, grow)
+{
+  // Larger data after smaller data must grow the copy, not overrun it.
+  std::vector<uint8_t> small(2*2*4, 7);
+  std::vector<uint8_t> large(64*32*4);
+  for(unsigned int i=0; i<large.size(); ++i)
+    large[i] = (uint8_t)(i*31);
+  
+  gp_texture_data* td = gp_texture_data_new();
+  unsigned int w, h;
+  
+  gp_texture_data_set_2d(td, small.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 2, 2);
+  gp_texture_data_set_2d(td, large.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 64, 32);
+  gp_texture_data_get_size(td, &w, &h, NULL);
+  ASSERT_EQ(w, 64u);
+  ASSERT_EQ(h, 32u);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), large.data(), large.size()), 0);
+  
+  gp_texture_data_set_1d(td, small.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 2);
+  gp_texture_data_set_1d(td, large.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 64*32);
+  gp_texture_data_get_size(td, &w, &h, NULL);
+  ASSERT_EQ(w, 64u*32u);
+  ASSERT_EQ(h, 1u);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), large.data(), large.size()), 0);
+  
+  gp_object_unref((gp_object*)td);
+}
+
+TEST(TextureData, region)
+{
+  // A 3x2 RGB rectangle from column 2 and row 1 of a 7 pixel wide image.
+  const unsigned int length = 7, rows = 4;
+  std::vector<uint8_t> image(length*rows*3);
+  for(unsigned int i=0; i<image.size(); ++i)
+    image[i] = (uint8_t)i;
+  
+  gp_texture_data* td = gp_texture_data_new();
+  unsigned int w, h;
+  int x, y;
+  
+  gp_texture_data_set_2d_region(td, image.data(), GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, 3, 2, 10, 20, length, 2, 1);
+  gp_texture_data_get_size(td, &w, &h, NULL);
+  gp_texture_data_get_offset(td, &x, &y, NULL);
+  ASSERT_EQ(w, 3u);
+  ASSERT_EQ(h, 2u);
+  ASSERT_EQ(x, 10);
+  ASSERT_EQ(y, 20);
+  
+  const uint8_t* data = (const uint8_t*)gp_texture_data_get_data(td);
+  for(unsigned int row=0; row<2; ++row)
+    ASSERT_EQ(memcmp(data + row*3*3, &image[((row+1)*length + 2)*3], 3*3), 0);
+  
+  // Without a row length the rectangle is the whole width of the image.
+  gp_texture_data_set_2d_region(td, image.data(), GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, length, 2, 0, 0, 0, 0, 2);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(td), &image[2*length*3], length*2*3), 0);
+  
+  // Rectangles reaching past the row are rejected and keep the last data.
+  gp_texture_data_set_2d_region(td, image.data(), GP_FORMAT_RGB, GP_DATA_TYPE_UBYTE, 4, 1, 0, 0, length, 4, 0);
+  gp_texture_data_get_size(td, &w, &h, NULL);
+  ASSERT_EQ(w, length);
+  ASSERT_EQ(h, 2u);
+  
+  gp_object_unref((gp_object*)td);
+}
+
+TEST(Mesh, optimize)
+{
+  // A shuffled grid large enough to be split into several clusters, with
+  // one vertex that no triangle uses.
+  const unsigned int size = 300;
+  const unsigned int vertex_count = size*size + 1;
+  std::vector<uint32_t> vertices(vertex_count);
+  for(unsigned int i=0; i<vertex_count; ++i)
+    vertices[i] = i;
+  
+  std::vector<uint32_t> indices;
+  for(unsigned int y=0; y<size-1; ++y)
+  {
+    for(unsigned int x=0; x<size-1; ++x)
+    {
+      uint32_t v = y*size + x;
+      uint32_t quad[6] = {v, v+1, v+size, v+1, v+size+1, v+size};
+      indices.insert(indices.end(), quad, quad+6);
+    }
+  }
+  
+  unsigned int seed = 1;
+  for(size_t t=indices.size()/3-1; t>0; --t)
+  {
+    seed = seed*1103515245u + 12345u;
+    size_t other = (seed >> 8)%(t+1);
+    for(int c=0; c<3; ++c)
+      std::swap(indices[t*3+c], indices[other*3+c]);
+  }
+  
+  const unsigned int count = indices.size();
+  std::vector<uint64_t> before = mesh_triangles(indices.data(), count, vertices.data());
+  
+  gp_array_data* index_data = gp_array_data_new();
+  gp_array_data* vertex_data = gp_array_data_new();
+  gp_array_data_set(index_data, indices.data(), count*sizeof(uint32_t));
+  gp_array_data_set(vertex_data, vertices.data(), vertex_count*sizeof(uint32_t));
+  
+  gp_mesh_stats stats = gp_mesh_optimize(index_data, vertex_data, sizeof(uint32_t));
+  ASSERT_GT(stats.acmr_before, 1.5);
+  ASSERT_LT(stats.acmr_after, 0.8);
+  
+  // Unused vertices are dropped and vertices are stored in order of use.
+  ASSERT_EQ(gp_array_data_get_size(vertex_data), (vertex_count-1)*sizeof(uint32_t));
+  const uint32_t* optimized = (const uint32_t*)gp_array_data_get_data(index_data);
+  uint32_t next = 0;
+  for(unsigned int i=0; i<count; ++i)
+  {
+    ASSERT_LE(optimized[i], next);
+    if(optimized[i] == next) ++next;
+  }
+  
+  ASSERT_EQ(mesh_triangles(optimized, count, (const uint32_t*)gp_array_data_get_data(vertex_data)), before);
+  ASSERT_DOUBLE_EQ(gp_mesh_get_acmr(optimized, count, vertex_count-1), stats.acmr_after);
+  
+  gp_object_unref((gp_object*)index_data);
+  gp_object_unref((gp_object*)vertex_data);
+}
+
+TEST(Decimation, envelope)
+{
+  // Built in two appends, the second one starting inside a bucket.
+  const unsigned int count = 1000003;
+  std::vector<float> samples(count);
+  unsigned int seed = 7;
+  for(unsigned int i=0; i<count; ++i)
+  {
+    seed = seed*1103515245u + 12345u;
+    samples[i] = (float)((seed >> 8)%20001) - 10000.0f;
+  }
+  
+  gp_decimation* decimation = gp_decimation_new();
+  gp_decimation_set(decimation, samples.data(), 333333);
+  gp_decimation_append(decimation, samples.data() + 333333, count - 333333);
+  ASSERT_EQ(gp_decimation_get_count(decimation), count);
+  ASSERT_EQ(gp_decimation_get_levels(decimation), 21);
+  
+  // About two vertices per pixel column.
+  const unsigned int first = 12345, view = 900001, width = 1920;
+  unsigned int level = gp_decimation_get_level(decimation, view, width);
+  ASSERT_EQ(level, 8);
+  
+  gp_array_data* ad = gp_array_data_new();
+  unsigned int vertices = gp_decimation_get_data(decimation, ad, level, first, view);
+  ASSERT_GE(vertices, width*2);
+  ASSERT_LE(vertices, width*4);
+  ASSERT_EQ(gp_array_data_get_size(ad), vertices*2*sizeof(float));
+  
+  const float* data = (const float*)gp_array_data_get_data(ad);
+  const unsigned int size = 1 << level;
+  for(unsigned int v=0; v<vertices; v+=2)
+  {
+    unsigned int begin = (first/size + v/2)*size;
+    unsigned int end = std::min(begin + size, count);
+    float min = *std::min_element(samples.begin() + begin, samples.begin() + end);
+    float max = *std::max_element(samples.begin() + begin, samples.begin() + end);
+    
+    ASSERT_EQ(std::min(data[v*2+1], data[v*2+3]), min);
+    ASSERT_EQ(std::max(data[v*2+1], data[v*2+3]), max);
+  }
+  
+  // The coarsest level holds the envelope of the whole series.
+  ASSERT_EQ(gp_decimation_get_data(decimation, ad, 20, 0, count), 2);
+  data = (const float*)gp_array_data_get_data(ad);
+  ASSERT_EQ(std::min(data[1], data[3]), *std::min_element(samples.begin(), samples.end()));
+  ASSERT_EQ(std::max(data[1], data[3]), *std::max_element(samples.begin(), samples.end()));
+  
+  gp_object_unref((gp_object*)ad);
+  gp_object_unref((gp_object*)decimation);
+}
+
+TEST(PointCloud, build)
+{
+  // A dense cluster inside a sparse cube, plus duplicates that can never be
+  // split.
+  const unsigned int count = 200000;
+  std::vector<float> points(count*3);
+  unsigned int seed = 3;
+  for(unsigned int i=0; i<count*3; ++i)
+  {
+    seed = seed*1103515245u + 12345u;
+    float r = ((seed >> 8)%100000)/100000.0f;
+    points[i] = (i/3)%4 == 0 ? 100.0f*r : 40.0f + r;
+  }
+  for(unsigned int i=0; i<1000; ++i)
+    points[i*3+2] = points[i*3+1] = points[i*3] = 7.0f;
+  
+  const char* path = "point_cloud_test.gppc";
+  ASSERT_EQ(gp_point_cloud_build(path, points.data(), count, 1024), 1);
+  
+  gp_point_cloud* cloud = gp_point_cloud_new(NULL, path);
+  ASSERT_TRUE(cloud != NULL);
+  ASSERT_EQ(gp_point_cloud_get_count(cloud), count);
+  ASSERT_GT(gp_point_cloud_get_node_count(cloud), count/1024);
+  
+  // Every point is stored once, inside the bounds of its node.
+  FILE* file = fopen(path, "rb");
+  unsigned int stored = 0;
+  for(unsigned int n=0; n<cloud->mHeader.mNodeCount; ++n)
+  {
+    const _gp_point_cloud_file_node& node = cloud->mNodes[n].mFile;
+    std::vector<float> data(node.mCount*3);
+    fseek(file, (long)node.mOffset, SEEK_SET);
+    ASSERT_EQ(fread(data.data(), sizeof(float)*3, node.mCount, file), node.mCount);
+    
+    for(unsigned int i=0; i<node.mCount*3; ++i)
+    {
+      ASSERT_GE(data[i], node.mBounds[i%3]);
+      ASSERT_LE(data[i], node.mBounds[i%3+3]);
+    }
+    stored += node.mCount;
+  }
+  fclose(file);
+  ASSERT_EQ(stored, count);
+  
+  gp_object_unref((gp_object*)cloud);
+  remove(path);
+}
+
+static std::vector<_gp_point_cloud_node*> sPointCloudRequests;
+
+static void _point_cloud_request(_gp_point_cloud_node* node)
+{
+  sPointCloudRequests.push_back(node);
+}
+
+TEST(PointCloud, update)
+{
+  const unsigned int count = 50000;
+  std::vector<float> points(count*3);
+  unsigned int seed = 7;
+  for(unsigned int i=0; i<count*3; ++i)
+  {
+    seed = seed*1103515245u + 12345u;
+    points[i] = ((seed >> 8)%100000)/1000.0f;
+  }
+  
+  const char* path = "point_cloud_update_test.gppc";
+  ASSERT_EQ(gp_point_cloud_build(path, points.data(), count, 1024), 1);
+  gp_point_cloud* cloud = gp_point_cloud_new(NULL, path);
+  ASSERT_TRUE(cloud != NULL);
+  cloud->mRequest = _point_cloud_request;
+  sPointCloudRequests.clear();
+  
+  // Every plane holds every point and the eye is close enough to refine.
+  float view_projection[16] = {0};
+  view_projection[15] = 1.0f;
+  const float eye[3] = {50.0f, 50.0f, 300.0f};
+  const float scale = 1000.0f;
+  
+  _gp_point_cloud_node* root = cloud->mNodes;
+  const unsigned int rootCount = root->mFile.mCount;
+  
+  // The root is requested first and nothing is drawn until it arrives.
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), 0u);
+  ASSERT_EQ(sPointCloudRequests.size(), 1u);
+  ASSERT_EQ(sPointCloudRequests[0], root);
+  ASSERT_EQ(root->mState, GP_POINT_CLOUD_LOADING);
+  
+  // A node being read is not requested again.
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), 0u);
+  ASSERT_EQ(sPointCloudRequests.size(), 1u);
+  
+  _gp_point_cloud_loaded(root);
+  ASSERT_EQ(root->mState, GP_POINT_CLOUD_RESIDENT);
+  ASSERT_EQ(cloud->mResidentPoints, rootCount);
+  
+  // A budget holding only the root requests no children.
+  sPointCloudRequests.clear();
+  gp_point_cloud_set_point_budget(cloud, rootCount);
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), rootCount);
+  ASSERT_TRUE(sPointCloudRequests.empty());
+  
+  // With room for more, children are requested a few at a time.
+  gp_point_cloud_set_point_budget(cloud, count);
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), rootCount);
+  ASSERT_EQ(sPointCloudRequests.size(), (size_t)GP_POINT_CLOUD_MAX_LOADS);
+  std::vector<_gp_point_cloud_node*> children = sPointCloudRequests;
+  unsigned int childPoints = 0;
+  for(_gp_point_cloud_node* child : children)
+  {
+    ASSERT_NE(std::find(root->mFile.mChildren, root->mFile.mChildren + 8, (int32_t)(child - cloud->mNodes)),
+              root->mFile.mChildren + 8);
+    _gp_point_cloud_loaded(child);
+    childPoints += child->mFile.mCount;
+  }
+  ASSERT_EQ(cloud->mResidentPoints, rootCount + childPoints);
+  sPointCloudRequests.clear();
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), rootCount + childPoints);
+  
+  // Nodes that fail to read are never requested again.
+  std::vector<_gp_point_cloud_node*> failed = sPointCloudRequests;
+  ASSERT_FALSE(failed.empty());
+  for(_gp_point_cloud_node* node : failed)
+  {
+    _gp_point_cloud_failed(node);
+    ASSERT_EQ(node->mState, GP_POINT_CLOUD_FAILED);
+    ASSERT_EQ(node->mArray, nullptr);
+  }
+  ASSERT_EQ(cloud->mLoads, 0u);
+  sPointCloudRequests.clear();
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), rootCount + childPoints);
+  for(_gp_point_cloud_node* node : sPointCloudRequests)
+    ASSERT_EQ(std::find(failed.begin(), failed.end(), node), failed.end());
+  for(_gp_point_cloud_node* node : sPointCloudRequests)
+    _gp_point_cloud_failed(node);
+  
+  // Shrinking the budget and cache evicts the children but keeps the root
+  // drawn this frame.
+  gp_point_cloud_set_point_budget(cloud, rootCount);
+  gp_point_cloud_set_cache_size(cloud, rootCount);
+  ASSERT_EQ(gp_point_cloud_update(cloud, view_projection, eye, scale), rootCount);
+  ASSERT_EQ(root->mState, GP_POINT_CLOUD_RESIDENT);
+  for(_gp_point_cloud_node* child : children)
+  {
+    ASSERT_EQ(child->mState, GP_POINT_CLOUD_UNLOADED);
+    ASSERT_EQ(child->mArray, nullptr);
+  }
+  ASSERT_EQ(cloud->mResidentPoints, rootCount);
+  
+  gp_object_unref((gp_object*)cloud);
+  remove(path);
+}
+
+TEST(VirtualTexture, pages)
+{
+  // Tiles past the edges repeat the edge pixels.
+  const unsigned int width = 1000, height = 300, tile = 128;
+  std::vector<uint8_t> image(width*height);
+  for(unsigned int i=0; i<image.size(); ++i)
+    image[i] = (i*7) & 0xFF;
+  
+  const unsigned int padded = tile + 2*GP_VIRTUAL_TEXTURE_BORDER;
+  std::vector<uint8_t> data(padded*padded);
+  gp_virtual_texture_extract_tile(image.data(), width, height, GP_FORMAT_R, GP_DATA_TYPE_UBYTE, tile, 7, 0, data.data());
+  for(unsigned int j=0; j<padded; ++j)
+  {
+    for(unsigned int i=0; i<padded; ++i)
+    {
+      int x = std::min<int>(7*tile + i - 1, width - 1);
+      int y = std::max<int>((int)j - 1, 0);
+      ASSERT_EQ(data[j*padded + i], image[y*width + x]);
+    }
+  }
+  
+  gp_virtual_texture* vt = gp_virtual_texture_new(NULL, width, height, GP_FORMAT_R, GP_DATA_TYPE_UBYTE, tile, 4);
+  ASSERT_NE(vt, nullptr);
+  ASSERT_EQ(gp_virtual_texture_get_levels(vt), 4u);
+  ASSERT_EQ(vt->mTilesX[0], 8u);
+  ASSERT_EQ(vt->mTilesY[0], 3u);
+  ASSERT_EQ(vt->mTilesX[3], 1u);
+  ASSERT_EQ(vt->mTilesY[3], 1u);
+  
+  // Missing tiles point at their closest resident ancestor.
+  _gp_virtual_texture_build_pages(vt);
+  ASSERT_EQ(vt->mPages[3], 0);
+  
+  vt->mTiles[vt->mFirstTile[3]].mState = GP_VIRTUAL_TEXTURE_RESIDENT;
+  vt->mTiles[vt->mFirstTile[3]].mSlot = 0;
+  vt->mTiles[vt->mFirstTile[0] + 8 + 5].mState = GP_VIRTUAL_TEXTURE_RESIDENT;
+  vt->mTiles[vt->mFirstTile[0] + 8 + 5].mSlot = 6;
+  _gp_virtual_texture_build_pages(vt);
+  
+  const uint8_t resident[4] = {2, 1, 0, 255};
+  const uint8_t ancestor[4] = {0, 0, 3, 255};
+  for(unsigned int level=0; level<4; ++level)
+  {
+    const unsigned int pages = std::max(8u >> level, 1u)*std::max(4u >> level, 1u);
+    for(unsigned int i=0; i<pages; ++i)
+    {
+      const uint8_t* entry = vt->mPages + (vt->mFirstPage[level] + i)*4;
+      ASSERT_EQ(memcmp(entry, level == 0 && i == 8 + 5 ? resident : ancestor, 4), 0);
+    }
+  }
+  
+  gp_object_unref((gp_object*)vt);
+}
+
+static std::vector<_gp_virtual_texture_tile*> sVirtualTextureRequests;
+
+static int _virtual_texture_loader(void*, unsigned int, unsigned int, unsigned int, void*)
+{
+  return 1;
+}
+
+static void _virtual_texture_request(_gp_virtual_texture_tile* tile)
+{
+  sVirtualTextureRequests.push_back(tile);
+}
+
+TEST(VirtualTexture, update)
+{
+  const unsigned int width = 1000, height = 300, tile = 128;
+  gp_virtual_texture* vt = gp_virtual_texture_new(NULL, width, height, GP_FORMAT_R, GP_DATA_TYPE_UBYTE, tile, 2);
+  ASSERT_NE(vt, nullptr);
+  gp_virtual_texture_set_loader(vt, _virtual_texture_loader, NULL);
+  vt->mRequest = _virtual_texture_request;
+  sVirtualTextureRequests.clear();
+  
+  _gp_virtual_texture_tile* top = vt->mTiles + vt->mFirstTile[3];
+  auto at = [&](unsigned int level, unsigned int x, unsigned int y)
+  {
+    return vt->mTiles + vt->mFirstTile[level] + y*vt->mTilesX[level] + x;
+  };
+  
+  // The whole image on 125 pixels only needs the top tile.
+  const float whole[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  ASSERT_EQ(_gp_virtual_texture_select(vt, whole, 125, 38), 1u);
+  ASSERT_EQ(sVirtualTextureRequests.size(), 1u);
+  ASSERT_EQ(sVirtualTextureRequests[0], top);
+  ASSERT_EQ(top->mState, GP_VIRTUAL_TEXTURE_LOADING);
+  
+  // Tiles being loaded are not requested again.
+  ASSERT_EQ(_gp_virtual_texture_select(vt, whole, 125, 38), 1u);
+  ASSERT_EQ(sVirtualTextureRequests.size(), 1u);
+  
+  vt->mDirty = 0;
+  _gp_virtual_texture_loaded(top);
+  ASSERT_EQ(top->mState, GP_VIRTUAL_TEXTURE_RESIDENT);
+  ASSERT_EQ(vt->mDirty, 1);
+  ASSERT_EQ(_gp_virtual_texture_select(vt, whole, 125, 38), 0u);
+  
+  // Zooming in picks the finest level whose selection fits in the four
+  // cache slots, requesting coarse tiles first.
+  const float left[4] = {0.0f, 0.0f, 0.25f, 0.5f};
+  sVirtualTextureRequests.clear();
+  ASSERT_EQ(_gp_virtual_texture_select(vt, left, 250, 150), 2u);
+  ASSERT_EQ(sVirtualTextureRequests.size(), 2u);
+  ASSERT_EQ(sVirtualTextureRequests[0], at(2, 0, 0));
+  ASSERT_EQ(sVirtualTextureRequests[1], at(1, 0, 0));
+  for(_gp_virtual_texture_tile* t : sVirtualTextureRequests)
+    _gp_virtual_texture_loaded(t);
+  
+  const float right[4] = {0.75f, 0.5f, 1.0f, 1.0f};
+  sVirtualTextureRequests.clear();
+  ASSERT_EQ(_gp_virtual_texture_select(vt, right, 250, 150), 1u);
+  ASSERT_EQ(sVirtualTextureRequests.size(), 1u);
+  ASSERT_EQ(sVirtualTextureRequests[0], at(2, 1, 0));
+  _gp_virtual_texture_loaded(sVirtualTextureRequests[0]);
+  ASSERT_EQ(vt->mFreeCount, 0u);
+  
+  // With the cache full, the least recently used tile not selected this
+  // frame is evicted for the next request.
+  ASSERT_EQ(_gp_virtual_texture_select(vt, left, 250, 150), 0u);
+  const float below[4] = {0.0f, 0.5f, 0.25f, 1.0f};
+  sVirtualTextureRequests.clear();
+  vt->mDirty = 0;
+  ASSERT_EQ(_gp_virtual_texture_select(vt, below, 250, 150), 1u);
+  ASSERT_EQ(sVirtualTextureRequests.size(), 1u);
+  ASSERT_EQ(sVirtualTextureRequests[0], at(1, 0, 1));
+  ASSERT_EQ(at(2, 1, 0)->mState, GP_VIRTUAL_TEXTURE_UNLOADED);
+  ASSERT_EQ(sVirtualTextureRequests[0]->mSlot, at(2, 1, 0)->mSlot);
+  ASSERT_EQ(vt->mDirty, 1);
+  ASSERT_EQ(top->mState, GP_VIRTUAL_TEXTURE_RESIDENT);
+  ASSERT_EQ(at(2, 0, 0)->mState, GP_VIRTUAL_TEXTURE_RESIDENT);
+  ASSERT_EQ(at(1, 0, 0)->mState, GP_VIRTUAL_TEXTURE_RESIDENT);
+  _gp_virtual_texture_loaded(sVirtualTextureRequests[0]);
+  
+  gp_object_unref((gp_object*)vt);
+}
+
+TEST(TextureAtlas, pack)
+{
+  _gp_texture_atlas_page page;
+  page.mFree = NULL;
+  page.mFreeCapacity = 0;
+  page.mWidth = 256;
+  page.mHeight = 256;
+  _gp_texture_atlas_page_reset(&page);
+  
+  // Fill the page with rectangles of assorted sizes.
+  std::vector<_gp_texture_atlas_rect> rects;
+  unsigned int area = 0;
+  for(unsigned int i=0; i<1000; ++i)
+  {
+    _gp_texture_atlas_rect rect;
+    const unsigned int w = 4 + (i*37)%29, h = 4 + (i*53)%23;
+    if(!_gp_texture_atlas_page_insert(&page, w, h, &rect)) continue;
+    
+    ASSERT_EQ(rect.mWidth, w);
+    ASSERT_EQ(rect.mHeight, h);
+    ASSERT_LE(rect.mX + w, 256u);
+    ASSERT_LE(rect.mY + h, 256u);
+    for(const _gp_texture_atlas_rect& other : rects)
+    {
+      bool overlap = rect.mX < other.mX + other.mWidth && other.mX < rect.mX + rect.mWidth &&
+                     rect.mY < other.mY + other.mHeight && other.mY < rect.mY + rect.mHeight;
+      ASSERT_FALSE(overlap);
+    }
+    rects.push_back(rect);
+    area += w*h;
+  }
+  ASSERT_EQ(page.mUsed, rects.size());
+  ASSERT_GT(area, 256u*256u*8/10);
+  
+  // Removed rectangles are reused.
+  _gp_texture_atlas_rect removed = rects.back();
+  rects.pop_back();
+  _gp_texture_atlas_page_remove(&page, &removed);
+  _gp_texture_atlas_rect rect;
+  ASSERT_TRUE(_gp_texture_atlas_page_insert(&page, removed.mWidth, removed.mHeight, &rect));
+  rects.push_back(rect);
+  
+  // An empty page is whole again.
+  for(const _gp_texture_atlas_rect& r : rects)
+    _gp_texture_atlas_page_remove(&page, &r);
+  ASSERT_EQ(page.mUsed, 0u);
+  ASSERT_EQ(page.mFreeCount, 1u);
+  ASSERT_TRUE(_gp_texture_atlas_page_insert(&page, 256, 256, &rect));
+  
+  free(page.mFree);
+}
+
+static void test_bc1_decode(const unsigned char* block, unsigned char* rgb)
+{
+  unsigned int c[2] = {(unsigned int)(block[0] | block[1] << 8), (unsigned int)(block[2] | block[3] << 8)};
+  int palette[4][3];
+  for(int i=0; i<2; ++i)
+  {
+    palette[i][0] = ((c[i] >> 11) & 31)*255/31;
+    palette[i][1] = ((c[i] >> 5) & 63)*255/63;
+    palette[i][2] = (c[i] & 31)*255/31;
+  }
+  for(int j=0; j<3; ++j)
+  {
+    palette[2][j] = (2*palette[0][j] + palette[1][j])/3;
+    palette[3][j] = (palette[0][j] + 2*palette[1][j])/3;
+  }
+  for(int i=0; i<16; ++i)
+  {
+    int index = (block[4 + i/4] >> (2*(i%4))) & 3;
+    for(int j=0; j<3; ++j)
+      rgb[i*3+j] = (unsigned char)palette[index][j];
+  }
+}
+
+static void test_bc4_decode(const unsigned char* block, unsigned char* values)
+{
+  int palette[8] = {block[0], block[1]};
+  for(int i=1; i<7; ++i)
+    palette[i+1] = ((7-i)*block[0] + i*block[1])/7;
+  unsigned long long bits = 0;
+  for(int i=0; i<6; ++i)
+    bits |= (unsigned long long)block[2+i] << (8*i);
+  for(int i=0; i<16; ++i)
+    values[i] = (unsigned char)palette[(bits >> (3*i)) & 7];
+}
+
+TEST(Compress, blocks)
+{
+  ASSERT_EQ(gp_compress_get_size(GP_COMPRESSION_BC1, 5, 4), 16u);
+  ASSERT_EQ(gp_compress_get_size(GP_COMPRESSION_BC3, 8, 5), 64u);
+  ASSERT_EQ(gp_compress_get_size(GP_COMPRESSION_BC4, 1, 1), 8u);
+  
+  // Two colors land near the inset endpoints of their diagonal.
+  std::vector<unsigned char> rgba(8*8*4);
+  for(unsigned int i=0; i<8*8; ++i)
+  {
+    bool first = (i%8 + i/8)%2 == 0;
+    rgba[i*4+0] = first ? 255 : 0;
+    rgba[i*4+1] = first ? 0 : 255;
+    rgba[i*4+2] = first ? 0 : 255;
+    rgba[i*4+3] = 255;
+  }
+  std::vector<unsigned char> blocks(gp_compress_get_size(GP_COMPRESSION_BC1, 8, 8));
+  ASSERT_TRUE(gp_compress(rgba.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 8, 8, GP_COMPRESSION_BC1, blocks.data()));
+  for(unsigned int b=0; b<4; ++b)
+  {
+    unsigned char rgb[16*3];
+    test_bc1_decode(&blocks[b*8], rgb);
+    for(unsigned int i=0; i<16; ++i)
+    {
+      unsigned int x = (b%2)*4 + i%4, y = (b/2)*4 + i/4;
+      for(unsigned int j=0; j<3; ++j)
+        ASSERT_LE(abs((int)rgb[i*3+j] - (int)rgba[(y*8+x)*4+j]), 255/16 + 8);
+    }
+  }
+  
+  // Gradients stay within half a step of the eight value palette.
+  std::vector<unsigned char> red(4*4);
+  for(unsigned int i=0; i<16; ++i)
+    red[i] = (unsigned char)(40 + i*11);
+  unsigned char block[8];
+  ASSERT_TRUE(gp_compress(red.data(), GP_FORMAT_R, GP_DATA_TYPE_UBYTE, 4, 4, GP_COMPRESSION_BC4, block));
+  unsigned char values[16];
+  test_bc4_decode(block, values);
+  for(unsigned int i=0; i<16; ++i)
+    ASSERT_LE(abs((int)values[i] - (int)red[i]), 165/14 + 1);
+  
+  ASSERT_FALSE(gp_compress(rgba.data(), GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 8, 8, GP_COMPRESSION_ETC2_RGB, blocks.data()));
+}
+
+TEST(Compress, chunk)
+{
+  std::vector<unsigned char> blocks(gp_compress_get_size(GP_COMPRESSION_BC1, 8, 8), 1);
+  gp_texture_data* td = gp_texture_data_new();
+  unsigned int w, h;
+  int x, y;
+  
+  gp_texture_data_set_compressed_chunk(td, blocks.data(), GP_COMPRESSION_BC1, 8, 8, 4, 12);
+  gp_texture_data_get_offset(td, &x, &y, NULL);
+  ASSERT_EQ(x, 4);
+  ASSERT_EQ(y, 12);
+  
+  // Offsets inside a block are rejected and leave the data as it was.
+  gp_texture_data_set_compressed_chunk(td, blocks.data(), GP_COMPRESSION_BC1, 4, 4, 2, 0);
+  gp_texture_data_set_compressed_chunk(td, blocks.data(), GP_COMPRESSION_BC1, 4, 4, 0, 6);
+  gp_texture_data_get_offset(td, &x, &y, NULL);
+  gp_texture_data_get_size(td, &w, &h, NULL);
+  ASSERT_EQ(x, 4);
+  ASSERT_EQ(y, 12);
+  ASSERT_EQ(w, 8u);
+  ASSERT_EQ(h, 8u);
+  
+  gp_object_unref((gp_object*)td);
+}
+
+TEST(ScrollTexture, split)
+{
+  unsigned int spans[6];
+  unsigned int head = 2;
+  
+  // Lines fitting before the end are one upload.
+  ASSERT_EQ(_gp_scroll_texture_split(8, &head, 3, spans), 1u);
+  ASSERT_EQ(spans[0], 0u);
+  ASSERT_EQ(spans[1], 3u);
+  ASSERT_EQ(spans[2], 2u);
+  ASSERT_EQ(head, 5u);
+  
+  // Reaching exactly the end wraps the head without a second upload.
+  ASSERT_EQ(_gp_scroll_texture_split(8, &head, 3, spans), 1u);
+  ASSERT_EQ(spans[1], 3u);
+  ASSERT_EQ(spans[2], 5u);
+  ASSERT_EQ(head, 0u);
+  
+  // Lines past the end continue at line 0.
+  head = 6;
+  ASSERT_EQ(_gp_scroll_texture_split(8, &head, 5, spans), 2u);
+  ASSERT_EQ(spans[0], 0u);
+  ASSERT_EQ(spans[1], 2u);
+  ASSERT_EQ(spans[2], 6u);
+  ASSERT_EQ(spans[3], 2u);
+  ASSERT_EQ(spans[4], 3u);
+  ASSERT_EQ(spans[5], 0u);
+  ASSERT_EQ(head, 3u);
+  
+  // More lines than the texture holds skip the oldest, and the newest
+  // line still ends up right before the head.
+  head = 3;
+  ASSERT_EQ(_gp_scroll_texture_split(8, &head, 19, spans), 2u);
+  ASSERT_EQ(spans[0], 11u);
+  ASSERT_EQ(spans[1], 2u);
+  ASSERT_EQ(spans[2], 6u);
+  ASSERT_EQ(spans[3], 13u);
+  ASSERT_EQ(spans[4], 6u);
+  ASSERT_EQ(spans[5], 0u);
+  ASSERT_EQ(head, 6u);
+  
+  head = 0;
+  ASSERT_EQ(_gp_scroll_texture_split(8, &head, 16, spans), 1u);
+  ASSERT_EQ(spans[0], 8u);
+  ASSERT_EQ(spans[1], 8u);
+  ASSERT_EQ(spans[2], 0u);
+  ASSERT_EQ(head, 0u);
+}
+
+TEST(VideoTexture, gather)
+{
+  // NV12 with odd sizes, the Y rows padded to 8 bytes and UV rows to 8.
+  const unsigned int width = 5, height = 3;
+  std::vector<uint8_t> y(8*height), uv(8*2);
+  for(unsigned int i=0; i<y.size(); ++i)
+    y[i] = (uint8_t)i;
+  for(unsigned int i=0; i<uv.size(); ++i)
+    uv[i] = (uint8_t)(100 + i);
+  const void* planes[2] = {y.data(), uv.data()};
+  const unsigned int strides[2] = {8, 8};
+  
+  gp_video_texture* vt = gp_video_texture_new(NULL, width, height, GP_VIDEO_FORMAT_NV12);
+  gp_texture_data* data[6];
+  unsigned int w, h;
+  int x;
+  
+  // The first frame allocates both planes before writing them.
+  ASSERT_EQ(_gp_video_texture_gather(vt, planes, strides, data), 4u);
+  ASSERT_EQ(gp_texture_data_get_data(data[0]), nullptr);
+  ASSERT_EQ(gp_texture_data_get_data(data[1]), nullptr);
+  gp_texture_data_get_size(data[0], &w, &h, NULL);
+  gp_texture_data_get_offset(data[0], &x, NULL, NULL);
+  ASSERT_EQ(w, width);
+  ASSERT_EQ(h, height);
+  ASSERT_EQ(x, -1);
+  gp_texture_data_get_size(data[1], &w, &h, NULL);
+  ASSERT_EQ(w, 3u);
+  ASSERT_EQ(h, 2u);
+  
+  // Frames update the planes in place with the padding stripped.
+  gp_texture_data_get_offset(data[2], &x, NULL, NULL);
+  ASSERT_EQ(x, 0);
+  const uint8_t* luma = (const uint8_t*)gp_texture_data_get_data(data[2]);
+  for(unsigned int row=0; row<height; ++row)
+    ASSERT_EQ(memcmp(luma + row*width, &y[row*8], width), 0);
+  gp_texture_data_get_size(data[3], &w, &h, NULL);
+  ASSERT_EQ(w, 3u);
+  ASSERT_EQ(h, 2u);
+  const uint8_t* chroma = (const uint8_t*)gp_texture_data_get_data(data[3]);
+  for(unsigned int row=0; row<2; ++row)
+    ASSERT_EQ(memcmp(chroma + row*3*2, &uv[row*8], 3*2), 0);
+  
+  for(unsigned int i=0; i<4; ++i)
+    gp_object_unref((gp_object*)data[i]);
+  
+  // Later frames only write, and without strides the planes are packed.
+  ASSERT_EQ(_gp_video_texture_gather(vt, planes, NULL, data), 2u);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(data[0]), y.data(), width*height), 0);
+  ASSERT_EQ(memcmp(gp_texture_data_get_data(data[1]), uv.data(), 3*2*2), 0);
+  gp_object_unref((gp_object*)data[0]);
+  gp_object_unref((gp_object*)data[1]);
+  gp_object_unref((gp_object*)vt);
+  
+  // I420 has three single channel planes.
+  const void* yuv[3] = {y.data(), uv.data(), uv.data()};
+  const unsigned int yuvStrides[3] = {8, 4, 4};
+  vt = gp_video_texture_new(NULL, width, height, GP_VIDEO_FORMAT_I420);
+  ASSERT_EQ(_gp_video_texture_gather(vt, yuv, yuvStrides, data), 6u);
+  gp_texture_data_get_size(data[5], &w, &h, NULL);
+  ASSERT_EQ(w, 3u);
+  ASSERT_EQ(h, 2u);
+  chroma = (const uint8_t*)gp_texture_data_get_data(data[5]);
+  ASSERT_EQ(memcmp(chroma, &uv[0], 3), 0);
+  ASSERT_EQ(memcmp(chroma + 3, &uv[4], 3), 0);
+  for(unsigned int i=0; i<6; ++i)
+    gp_object_unref((gp_object*)data[i]);
+  gp_object_unref((gp_object*)vt);
+}
+
+TEST(TextureCanvas, coalesce)
+{
+  unsigned int rects[GP_TEXTURE_CANVAS_MAX_RECTS*4];
+  unsigned int count = 0;
+  
+  // A row of adjacent glyph sized writes becomes one rectangle.
+  for(unsigned int i=0; i<16; ++i)
+  {
+    const unsigned int rect[4] = {100 + i*8, 40, 8, 12};
+    count = _gp_texture_canvas_add_rect(rects, count, rect, 4);
+  }
+  ASSERT_EQ(count, 1u);
+  ASSERT_EQ(rects[0], 100u);
+  ASSERT_EQ(rects[1], 40u);
+  ASSERT_EQ(rects[2], 128u);
+  ASSERT_EQ(rects[3], 12u);
+  
+  // Rectangles far apart are cheaper to upload separately.
+  const unsigned int far[4] = {4000, 4000, 8, 8};
+  count = _gp_texture_canvas_add_rect(rects, count, far, 4);
+  ASSERT_EQ(count, 2u);
+  
+  // Scattered writes never exceed the limit and stay covered.
+  count = 0;
+  std::vector<unsigned int> written;
+  for(unsigned int i=0; i<1000; ++i)
+  {
+    const unsigned int rect[4] = {(i*7919)%8000, (i*104729)%8000, 4, 4};
+    count = _gp_texture_canvas_add_rect(rects, count, rect, 4);
+    written.insert(written.end(), rect, rect + 4);
+    ASSERT_LE(count, (unsigned int)GP_TEXTURE_CANVAS_MAX_RECTS);
+  }
+  for(size_t w=0; w<written.size(); w+=4)
+  {
+    bool covered = false;
+    for(unsigned int i=0; i<count && !covered; ++i)
+    {
+      const unsigned int* r = rects + i*4;
+      covered = written[w] >= r[0] && written[w] + written[w+2] <= r[0] + r[2] &&
+                written[w+1] >= r[1] && written[w+1] + written[w+3] <= r[1] + r[3];
+    }
+    ASSERT_TRUE(covered);
+  }
+}
+
+TEST(Image, qoi)
+{
+  // 3x2 image covering the RGB, RUN, DIFF, LUMA and INDEX operations.
+  const unsigned char file[] =
+  {
+    'q', 'o', 'i', 'f', 0, 0, 0, 3, 0, 0, 0, 2, 4, 0,
+    0xFE, 10, 20, 30,
+    0xC1,
+    0x40 | (3 << 4) | (1 << 2) | 2,
+    0xA5, 0x5A,
+    0x09,
+    0, 0, 0, 0, 0, 0, 0, 1
+  };
+  const unsigned char expected[6][4] =
+  {
+    {10, 20, 30, 255}, {10, 20, 30, 255}, {10, 20, 30, 255},
+    {11, 19, 30, 255}, {13, 24, 37, 255}, {10, 20, 30, 255}
+  };
+  
+  unsigned int width, height;
+  ASSERT_TRUE(gp_image_get_info(file, sizeof(file), &width, &height));
+  ASSERT_EQ(width, 3u);
+  ASSERT_EQ(height, 2u);
+  
+  // Rows are padded to check the pitch is honoured.
+  unsigned char pixels[2*16];
+  memset(pixels, 0x77, sizeof(pixels));
+  ASSERT_TRUE(gp_image_decode(file, sizeof(file), pixels, 16));
+  
+  for(int i=0; i<6; ++i)
+    ASSERT_EQ(memcmp(pixels + (i/3)*16 + (i%3)*4, expected[i], 4), 0);
+  ASSERT_EQ(pixels[12], 0x77);
+  
+  // Streams running out before the last pixel and unknown files fail.
+  ASSERT_FALSE(gp_image_decode(file, sizeof(file) - 9, pixels, 16));
+  ASSERT_FALSE(gp_image_get_info(file + 4, sizeof(file) - 4, &width, &height));
+}
+
+#ifdef GP_IMAGE_PNG
+TEST(Image, png)
+{
+  // 3x2 RGBA image with varying alpha.
+  const unsigned char file[] =
+  {
+    0x89, 0x50, 0x4E, 0x47, 0x0D, 0x0A, 0x1A, 0x0A, 0x00, 0x00, 0x00, 0x0D,
+    0x49, 0x48, 0x44, 0x52, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x02,
+    0x08, 0x06, 0x00, 0x00, 0x00, 0x9D, 0x74, 0x66, 0x1A, 0x00, 0x00, 0x00,
+    0x1F, 0x49, 0x44, 0x41, 0x54, 0x78, 0xDA, 0x63, 0xF8, 0xCF, 0xC0, 0xF0,
+    0x1F, 0x08, 0x1B, 0x40, 0x14, 0x03, 0x97, 0x88, 0xDC, 0x7F, 0x0D, 0x23,
+    0x1B, 0xB7, 0x13, 0x97, 0xEE, 0x3C, 0x03, 0x00, 0x73, 0xD7, 0x09, 0xF0,
+    0x6E, 0xC0, 0xAC, 0x3A, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4E, 0x44,
+    0xAE, 0x42, 0x60, 0x82
+  };
+  const unsigned char expected[6][4] =
+  {
+    {255, 0, 0, 255}, {0, 255, 0, 128}, {0, 0, 255, 0},
+    {10, 20, 30, 255}, {40, 50, 60, 70}, {200, 210, 220, 230}
+  };
+  
+  unsigned int width, height;
+  ASSERT_TRUE(gp_image_get_info(file, sizeof(file), &width, &height));
+  ASSERT_EQ(width, 3u);
+  ASSERT_EQ(height, 2u);
+  
+  unsigned char pixels[2*16];
+  memset(pixels, 0x77, sizeof(pixels));
+  ASSERT_TRUE(gp_image_decode(file, sizeof(file), pixels, 16));
+  for(int i=0; i<6; ++i)
+    ASSERT_EQ(memcmp(pixels + (i/3)*16 + (i%3)*4, expected[i], 4), 0);
+  ASSERT_EQ(pixels[12], 0x77);
+  
+  ASSERT_FALSE(gp_image_decode(file, sizeof(file) - 20, pixels, 16));
+}
+#endif
+
+#ifdef GP_IMAGE_JPEG
+TEST(Image, jpeg)
+{
+  // 16x8 grayscale image, bright on the left and dark on the right.
+  const unsigned char file[] =
+  {
+    0xFF, 0xD8, 0xFF, 0xDB, 0x00, 0x43, 0x00, 0x02, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x02, 0x01, 0x01, 0x01, 0x02, 0x02, 0x02, 0x02, 0x02, 0x04, 0x03,
+    0x02, 0x02, 0x02, 0x02, 0x05, 0x04, 0x04, 0x03, 0x04, 0x06, 0x05, 0x06,
+    0x06, 0x06, 0x05, 0x06, 0x06, 0x06, 0x07, 0x09, 0x08, 0x06, 0x07, 0x09,
+    0x07, 0x06, 0x06, 0x08, 0x0B, 0x08, 0x09, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A,
+    0x06, 0x08, 0x0B, 0x0C, 0x0B, 0x0A, 0x0C, 0x09, 0x0A, 0x0A, 0x0A, 0xFF,
+    0xC0, 0x00, 0x0B, 0x08, 0x00, 0x08, 0x00, 0x10, 0x01, 0x01, 0x11, 0x00,
+    0xFF, 0xC4, 0x00, 0x15, 0x00, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x0A, 0xFF,
+    0xC4, 0x00, 0x14, 0x10, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xDA, 0x00,
+    0x08, 0x01, 0x01, 0x00, 0x00, 0x3F, 0x00, 0x48, 0x12, 0xFE, 0xFF, 0xD9
+  };
+  
+  unsigned int width, height;
+  ASSERT_TRUE(gp_image_get_info(file, sizeof(file), &width, &height));
+  ASSERT_EQ(width, 16u);
+  ASSERT_EQ(height, 8u);
+  
+  // Grayscale is expanded to opaque RGBA.
+  std::vector<unsigned char> pixels(16*8*4);
+  ASSERT_TRUE(gp_image_decode(file, sizeof(file), pixels.data(), 16*4));
+  for(unsigned int y=0; y<8; ++y)
+  {
+    for(unsigned int x=0; x<16; ++x)
+    {
+      const unsigned char* p = &pixels[(y*16 + x)*4];
+      ASSERT_LE(abs((int)p[0] - (x < 8 ? 200 : 40)), 8);
+      ASSERT_EQ(p[0], p[1]);
+      ASSERT_EQ(p[0], p[2]);
+      ASSERT_EQ(p[3], 255);
+    }
+  }
+  
+  ASSERT_FALSE(gp_image_decode(file, 40, pixels.data(), 16*4));
+}
+#endif
+
+TEST(Image, read)
+{
+  // Files read by gp_texture_load_async() before decoding.
+  const unsigned char qoi[] =
+  {
+    'q', 'o', 'i', 'f', 0, 0, 0, 1, 0, 0, 0, 1, 4, 0,
+    0xFE, 10, 20, 30,
+    0, 0, 0, 0, 0, 0, 0, 1
+  };
+  const char* path = "gp_image_read.qoi";
+  size_t size;
+  unsigned int width, height;
+  
+  FILE* file = fopen(path, "wb");
+  ASSERT_NE(file, nullptr);
+  fwrite(qoi, 1, sizeof(qoi), file);
+  fclose(file);
+  
+  void* data = _gp_image_read(path, &size, &width, &height);
+  ASSERT_NE(data, nullptr);
+  ASSERT_EQ(size, sizeof(qoi));
+  ASSERT_EQ(width, 1u);
+  ASSERT_EQ(height, 1u);
+  ASSERT_EQ(memcmp(data, qoi, sizeof(qoi)), 0);
+  free(data);
+  
+  // Files that are not images, empty or missing fail.
+  file = fopen(path, "wb");
+  fwrite("text", 1, 4, file);
+  fclose(file);
+  ASSERT_EQ(_gp_image_read(path, &size, &width, &height), nullptr);
+  
+  file = fopen(path, "wb");
+  fclose(file);
+  ASSERT_EQ(_gp_image_read(path, &size, &width, &height), nullptr);
+  
+  remove(path);
+  ASSERT_EQ(_gp_image_read(path, &size, &width, &height), nullptr);
+  ASSERT_EQ(size, 0u);
+}
+
+#ifdef __linux__
+TEST(Shared, two_processes)
+{
+  const int count = 4096;
+  const int frames = 1000;
+  
+  gp_shared* shared = gp_shared_new(count*sizeof(int));
+  ASSERT_NE(shared, nullptr);
+  ASSERT_EQ(gp_shared_get_sequence(shared), 0u);
+  
+  pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if(pid == 0)
+  {
+    // Producer maps the memory again through its file descriptor.
+    gp_shared* producer = gp_shared_new_from_fd(gp_shared_get_fd(shared));
+    if(producer == NULL || gp_shared_get_size(producer) != count*sizeof(int)) _exit(1);
+    
+    for(int f=1; f<=frames; ++f)
+    {
+      int* data = (int*)gp_shared_begin_write(producer);
+      for(int i=0; i<count; ++i)
+        data[i] = f;
+      gp_shared_end_write(producer);
+    }
+    
+    gp_object_unref((gp_object*)producer);
+    _exit(0);
+  }
+  
+  // Every consistent read must see a whole frame, never a mix of two.
+  std::vector<int> copy(count);
+  int last = 0;
+  int consistent = 0;
+  while(last < frames)
+  {
+    unsigned int sequence = gp_shared_read_begin(shared);
+    memcpy(copy.data(), gp_shared_get_data(shared), count*sizeof(int));
+    if(!gp_shared_read_end(shared, sequence)) continue;
+    
+    ASSERT_EQ(sequence%2, 0u);
+    ASSERT_EQ(copy[0], (int)sequence/2);
+    for(int i=1; i<count; ++i)
+      ASSERT_EQ(copy[i], copy[0]);
+    ASSERT_GE(copy[0], last);
+    
+    last = copy[0];
+    ++consistent;
+  }
+  
+  int status = 0;
+  ASSERT_EQ(waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), 0);
+  ASSERT_GT(consistent, 0);
+  ASSERT_EQ(gp_shared_get_sequence(shared), (unsigned int)frames*2);
+  
+  gp_object_unref((gp_object*)shared);
+}
+
+TEST(Shared, invalid_fd)
+{
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_EQ(gp_shared_new_from_fd(fds[0]), nullptr);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(Shared, read_skips_torn)
+{
+  const int count = 64;
+  gp_shared* shared = gp_shared_new(count*sizeof(int));
+  ASSERT_NE(shared, nullptr);
+  
+  int* data = (int*)gp_shared_begin_write(shared);
+  for(int i=0; i<count; ++i)
+    data[i] = 1;
+  gp_shared_end_write(shared);
+  
+  std::vector<int> copy(count, 0);
+  unsigned int sequence = 0;
+  ASSERT_TRUE(_gp_shared_read(shared, copy.data(), count*sizeof(int), 4, &sequence));
+  ASSERT_EQ(sequence, 2u);
+  ASSERT_EQ(copy[count - 1], 1);
+  
+  // A frame in the middle of being written is never copied.
+  data = (int*)gp_shared_begin_write(shared);
+  data[0] = 2;
+  sequence = 0;
+  ASSERT_FALSE(_gp_shared_read(shared, copy.data(), count*sizeof(int), 4, &sequence));
+  ASSERT_EQ(sequence, 0u);
+  ASSERT_EQ(copy[0], 1);
+  
+  for(int i=1; i<count; ++i)
+    data[i] = 2;
+  gp_shared_end_write(shared);
+  ASSERT_TRUE(_gp_shared_read(shared, copy.data(), count*sizeof(int), 4, &sequence));
+  ASSERT_EQ(sequence, 4u);
+  ASSERT_EQ(copy[0], 2);
+  ASSERT_EQ(copy[count - 1], 2);
+  
+  gp_object_unref((gp_object*)shared);
+}
+
+TEST(Shared, mesh_optimize)
+{
+  const uint32_t indices[] = {0, 1, 2};
+  const float vertices[] = {0.0f, 1.0f, 2.0f, 3.0f};
+  
+  gp_shared* shared = gp_shared_new(sizeof(indices));
+  ASSERT_NE(shared, nullptr);
+  memcpy(gp_shared_begin_write(shared), indices, sizeof(indices));
+  gp_shared_end_write(shared);
+  
+  gp_array_data* index_data = gp_array_data_new_shared(shared);
+  gp_array_data* vertex_data = gp_array_data_new();
+  gp_array_data_set(vertex_data, (void*)vertices, sizeof(vertices));
+  
+  // Shared memory is only written by its producer, so nothing may change.
+  gp_mesh_stats stats = gp_mesh_optimize(index_data, vertex_data, sizeof(float));
+  ASSERT_EQ(stats.acmr_before, 0.0);
+  ASSERT_EQ(gp_array_data_get_shared(index_data), shared);
+  ASSERT_EQ(gp_array_data_get_size(vertex_data), sizeof(vertices));
+  
+  gp_object_unref((gp_object*)index_data);
+  gp_object_unref((gp_object*)vertex_data);
+  gp_object_unref((gp_object*)shared);
+}
+#endif // __linux__
+
+TEST(Shared, null)
+{
+  ASSERT_EQ(gp_array_data_new_shared(nullptr), nullptr);
+  ASSERT_EQ(gp_texture_data_new_shared(nullptr, GP_FORMAT_RGBA, GP_DATA_TYPE_UBYTE, 4, 4), nullptr);
+}
+
 int main(int argc, char* argv[])
 {
   ::testing::InitGoogleTest(&argc, argv);